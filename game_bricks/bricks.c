@@ -42,6 +42,10 @@
                                         // 2: Bitmap-Muster 2 wird verwendet
 #include "stones.h"
 
+#define spritemode        1             // 0: Ball und Schlaeger werden mit putpixel geloescht und neu gezeichnet
+                                        // 1: Ball und Schlaeger sind Sprites mit Hintergrundsicherung
+                                        //    (tft_sprite 1 in tftdisplay.h)
+
 
 // ----------------- Spieltasten ---------------
 
@@ -151,6 +155,45 @@ const uint8_t ball_img[] =
   0,2, 1,2, 2,2, 2,3
 };
 
+// ------------ Sprites Ball, Schlaeger ----------
+
+#if (spritemode == 1)
+
+  #if (tft_sprite == 0)
+    #error "spritemode 1 benoetigt tft_sprite 1 in tftdisplay.h"
+  #endif
+
+  #define spr_ball         0                        // Spritenummern
+  #define spr_paddle       1
+
+  #define sp_t        0xf81f                        // transparent
+  #define sp_w        0xffff                        // Ball, rgbfromega(15)
+  #define sp_d        0x8202                        // Schlaeger aussen, rgbfromvalue(0x80, 0x40, 0x10)
+  #define sp_l        0xc400                        // Schlaeger Mitte, rgbfromvalue(0xc0, 0x80, 0x04)
+
+  // gleiche Pixel wie ball_img
+  const uint16_t ball_spr[] =
+  {
+    4, 4, sp_t,
+    sp_t, sp_w, sp_w, sp_t,
+    sp_w, sp_w, sp_w, sp_w,
+    sp_w, sp_w, sp_w, sp_t,
+    sp_t, sp_w, sp_w, sp_t
+  };
+
+  const uint16_t paddle_spr[] =
+  {
+    paddlesizex+2, paddlesizey+1, sp_t,
+    sp_t, sp_d, sp_d, sp_d, sp_d, sp_d, sp_d, sp_d, sp_d, sp_d, sp_d, sp_d,
+          sp_d, sp_d, sp_d, sp_d, sp_d, sp_d, sp_d, sp_d, sp_d, sp_d, sp_d, sp_t,
+    sp_l, sp_l, sp_l, sp_l, sp_l, sp_l, sp_l, sp_l, sp_l, sp_l, sp_l, sp_l,
+          sp_l, sp_l, sp_l, sp_l, sp_l, sp_l, sp_l, sp_l, sp_l, sp_l, sp_l, sp_l,
+    sp_t, sp_d, sp_d, sp_d, sp_d, sp_d, sp_d, sp_d, sp_d, sp_d, sp_d, sp_d,
+          sp_d, sp_d, sp_d, sp_d, sp_d, sp_d, sp_d, sp_d, sp_d, sp_d, sp_d, sp_t
+  };
+
+#endif
+
 #define regulargame      1                          // zum Testen: 1 => normales Spiel
                                                     //             0 => vereinfachte Level
 #define levelanz         6
@@ -379,6 +422,12 @@ void brick_draw(uint8_t ind, uint16_t nr)
   x2= x1+bricksizex-4;
   y2= y1+bricksizey-4;
 
+  #if (spritemode == 1)
+    // Ball entfernen, er koennte den Stein beruehren (gesicherter Hintergrund
+    // waere nach dem Zeichnen veraltet). hit_check setzt ihn wieder
+    tft_sprite_hide(spr_ball);
+  #endif
+
   #if (brickset == 0)
 
     y2 -= 2;
@@ -459,6 +508,85 @@ void brick_getxy(uint8_t ind, uint8_t *x1, uint8_t *y1, uint8_t *x2, uint8_t *y2
   *y2= (*y1)+bricksizey-4;
 }
 
+#if (spritemode == 1)
+
+/* --------------------------------------------------------
+                          wall_bkget
+
+     liefert die Farbe des Spielfelds (ohne Ball und
+     Schlaeger) an der Koordinate x,y: Rahmen, Pixel eines
+     Mauersteins oder schwarz. Wird beim Verschieben des Ball-
+     Sprites fuer neu ueberdeckte Pixel abgefragt, da das
+     Display-Ram nicht gelesen werden kann.
+   -------------------------------------------------------- */
+uint16_t wall_bkget(int x, int y)
+{
+  int     px, py, bx, by;
+  uint8_t ind, nr;
+
+  // Rahmen des Spielfelds
+  if ((x == scrofsx) || (x == scrofsx+127) || (y == scrofsy) || (y == scrofsy+127))
+    return rgbfromega(7);
+
+  px= x - (brickofsx);
+  py= y - (brickofsy) + 1;                    // Bitmaps beginnen eine Zeile ueber y1
+  if ((px < 0) || (py < 0)) return 0;
+
+  bx= px / bricksizex;
+  by= py / bricksizey;
+  if ((bx >= brickanzx) || (by >= brickanzy)) return 0;
+  px -= bx * bricksizex;
+  py -= by * bricksizey;
+
+  ind= (by * brickanzx) + bx;
+  if (!(brickwall[(ind*2)+1])) return 0;      // Stein nicht (mehr) vorhanden
+  nr= brickwall[ind*2];
+
+  #if (brickset == 0)
+
+    // wie brick_draw: fillrect(x1,y1, x1+bricksizex-4, y1+bricksizey-6)
+    if ((px > bricksizex-4) || (py < 1) || (py > bricksizey-5)) return 0;
+    switch (nr)
+    {
+      case 1 : return rgbfromega(1);
+      case 2 : return rgbfromega(2);
+      case 3 : return rgbfromega(14);
+      case 4 : return rgbfromega(4);
+      default : return 0;
+    }
+
+  #else
+
+    {
+      const uint16_t *pal;
+      uint16_t width, height;
+      uint8_t  cvalue;
+
+      width= (brickcga_img[0] << 8) + brickcga_img[1];
+      height= (brickcga_img[2] << 8) + brickcga_img[3];
+      if ((px >= width) || (py >= height)) return 0;
+
+      switch (nr)
+      {
+        case 1 : pal= &brick01_pal[0]; break;
+        case 2 : pal= &brick02_pal[0]; break;
+        case 3 : pal= &brick03_pal[0]; break;
+        case 4 : pal= &brick04_pal[0]; break;
+        default : return 0;
+      }
+
+      // wie bmpcga2_show: 4 Pixel je Byte, jede Zeile beginnt mit einem neuen Byte
+      cvalue= brickcga_img[4 + (py * ((width+3) / 4)) + (px / 4)];
+      cvalue= (cvalue >> ((3-(px % 4))*2)) & 0x03;
+      if (cvalue) return pal[cvalue];
+      return 0;
+    }
+
+  #endif
+}
+
+#endif
+
 /* --------------------------------------------------------
                           paddle_draw
 
@@ -470,9 +598,19 @@ void brick_getxy(uint8_t ind, uint8_t *x1, uint8_t *y1, uint8_t *x2, uint8_t *y2
                         reihe werden geloescht (damit ein
                         nachfolgender Zeichenvorgang
                         keinen "Nachzieheffekt" hat
+
+     Mit spritemode 1 wird der Schlaeger als Sprite ver-
+     schoben (alte Position wird mit dem Zeichnen an der
+     neuen Position wiederhergestellt), show= 0 entfaellt.
    -------------------------------------------------------- */
 void paddle_draw(uint16_t x, uint8_t show)
 {
+#if (spritemode == 1)
+
+  if (show) tft_sprite_show(spr_paddle, x, paddleposy+scrofsy);
+
+#else
+
   int b;
   if (show)
   {
@@ -493,6 +631,8 @@ void paddle_draw(uint16_t x, uint8_t show)
     putpixel(x, paddleposy+1+scrofsy, 0);
     putpixel(x, paddleposy+2+scrofsy, 0);
   }
+
+#endif
 }
 
 /* --------------------------------------------------------
@@ -510,6 +650,15 @@ void paddle_draw(uint16_t x, uint8_t show)
    -------------------------------------------------------- */
 void ball_draw(struct balldefs *ball, uint8_t draw)
 {
+#if (spritemode == 1)
+
+  if (draw)
+    tft_sprite_show(spr_ball, ball->x, ball->y);
+  else
+    tft_sprite_hide(spr_ball);
+
+#else
+
   uint16_t x,y, col;
   uint8_t i;
 
@@ -520,6 +669,8 @@ void ball_draw(struct balldefs *ball, uint8_t draw)
 
   for (i= 0; i< sizeof(ball_img); i+= 2)
     putpixel(x+ball_img[i], y+ball_img[i+1], col);
+
+#endif
 }
 
 /* --------------------------------------------------------
@@ -577,10 +728,16 @@ void ball_move(struct balldefs *ball)
   else
     y--;                                       // dekrementieren
 
-  ball_draw(ball,0);
-  ball->x = x;
-  ball->y = y;
-  ball_draw(ball,1);
+  #if (spritemode == 1)
+    ball->x = x;                               // alte Position wird im selben Fenster
+    ball->y = y;                               // wiederhergestellt
+    ball_draw(ball,1);
+  #else
+    ball_draw(ball,0);
+    ball->x = x;
+    ball->y = y;
+    ball_draw(ball,1);
+  #endif
 }
 
 /* --------------------------------------------------------
@@ -928,6 +1085,9 @@ uint8_t hit_check(struct balldefs *ball, uint16_t *score)
 
   if (scrflag)
   {
+    #if (spritemode == 1)
+      ball_draw(ball, 1);                      // von brick_draw entfernten Ball wieder setzen
+    #endif
     textcolor= 0;
     itoa(oldscore, zstr, 10);
     outtextxy(35+scrofsx,3+scrofsy, 0, zstr);
@@ -1083,6 +1243,11 @@ int main(void)
   bkcolor= rgbfromega(0);
   textcolor= rgbfromega(7);
 
+  #if (spritemode == 1)
+    tft_sprite_init(spr_ball, &ball_spr[0], wall_bkget);
+    tft_sprite_init(spr_paddle, &paddle_spr[0], NULL);    // Hintergrund: bkcolor
+  #endif
+
   // Tasten initialisieren
   button_init()
 
@@ -1198,6 +1363,10 @@ int main(void)
 
     if (clearlevel)
     {
+      #if (spritemode == 1)
+        tft_sprite_hide(spr_ball);            // Spielfeld wird neu aufgebaut
+        tft_sprite_hide(spr_paddle);
+      #endif
       lostball= 0;
       level++;
       level_showlogo(level);
@@ -1217,6 +1386,9 @@ int main(void)
     {
       delay(1000);
       ball_draw(&ball, 0);
+      #if (spritemode == 1)
+        tft_sprite_hide(spr_paddle);
+      #endif
       fillrect(1+scrofsx, paddleposy+scrofsy, 126+scrofsx, paddleposy+4+scrofsy, 0);    // komplette Schlaegerlinie loeschen
       lifes--;
       if (!(lifes))
@@ -75,6 +75,14 @@
 
   #define lastascii 126                              // letztes verfuegbares Asciizeichen
 
+  #define fnt_cache                 0                // 1 : aufbereitete Zeichen (mit Hintergrund) werden zwischengespeichert
+  #define fnt_cacheanz              4                // Anzahl zwischengespeicherter Zeichen
+  #define fnt_cachepix            192                // max. Pixel je Zeichenzelle (12x16 einfach, 8x8 einfach)
+                                                     // Ram-Bedarf: fnt_cacheanz * (fnt_cachepix * 2 + 9) Bytes
+                                                     // (1572 Bytes), nur setzen, wenn das Programm so viel
+                                                     // RAM frei hat. Nutzen nur bei wenigen, immer wieder
+                                                     // gleichen Zeichen (Uhr), siehe host/fnt
+
   /*  ------------------------------------------------------------
                          Displayaufloesung
       ------------------------------------------------------------ */
@@ -135,6 +143,14 @@
     #define negativout              0                 // 0 : normal
                                                       // 1 : Farben werden invertiert wiedergegeben (fuer ST7789 notwendig)
 
+    #define tft_dma                 1                 // 1 : Fuellfunktionen (clrscr, fillrect) und tft_dma_pixels
+                                                      //     senden ueber DMA1 Kanal 3 im Hintergrund (16-Bit SPI)
+                                                      // 0 : Ausgabe ausschliesslich per Polling
+                                                      // belegt DMA1 Kanal 3 und dma1_channel3_isr, nur setzen, wenn
+                                                      // das Programm beides nicht selbst benutzt (geprueft mit
+                                                      // host/games: game_bricks, game_tetris, game_reversi,
+                                                      // game_viergewinnt)
+
     /*  ------------------------------------------------------------
           Sonderfall TFT 128x128 / ST7735 Controller 2. Generation
         ------------------------------------------------------------ */
@@ -174,6 +190,10 @@
       #define boardversion     1                           // 0: Nucleo R3
                                                            // 1: eigenes STM32F103 Board R3
 
+      #define tft_fastfill     1                           // 1 : Tabelle fuer die Byteausgabe, Fuellungen
+                                                           //     (clrscr, fillrect) mit vorberechneten
+                                                           //     Portzustaenden
+
       //  Defines LCD Darstellung
 
       #define MEM_Y    7
@@ -198,6 +218,48 @@
 
   #define  fastfillmode             0
 
+  #define  fillpoly_maxpoints       16               // max. Anzahl Eckpunkte fuer fillpoly (Stackbedarf 14 Bytes je Punkt)
+
+  /*  ------------------------------------------------------------
+       Kachelpuffer (Off-Screen, RGB565): bei eingeschaltetem
+       Puffer zeichnen alle Funktionen in Kacheln zu 32x32 Pixel
+       im RAM, tft_tiles_flush sendet einmal je Frame nur die
+       geaenderten Bereiche (flackerfreie Animationen)
+
+       Ram-Bedarf: tft_tilecount * 2182 Bytes
+     ------------------------------------------------------------- */
+
+  #define  tft_tilecache            0                // 1 : Kachelpuffer verfuegbar
+  #define  tft_tilecount            4                // Anzahl Kacheln im RAM
+
+  /*  ------------------------------------------------------------
+       Textkonsole: fortlaufende Textausgabe mit Zeilenpuffer und
+       VT100 Escape-Sequenzen. ILI9340 / ILI9341 scrollen ueber
+       den Scrollbereich des Controllers, andere Controller
+       zeichnen den Bildschirm neu
+
+       Ram-Bedarf: tft_conlines * tft_concols * 2 Bytes
+     ------------------------------------------------------------- */
+
+  #define  tft_console              0                // 1 : Konsole verfuegbar
+  #define  tft_conlines            48                // Zeilen im Ringpuffer (Bildschirm + Rueckblick)
+  #define  tft_concols             40                // max. Zeichen je Zeile
+
+  /*  ------------------------------------------------------------
+       Sprites mit Hintergrundsicherung: ein bewegtes Objekt wird
+       zusammen mit dem geretteten Hintergrund in einem Fenster
+       ueber alte und neue Position gesendet (kein Loeschen und
+       Neuzeichnen mit putpixel, kein Flackern)
+
+       Ram-Bedarf: tft_spriteanz * (tft_spritepix * 2 + 13)
+                   + (tft_spritebuf + tft_spritepix) * 2 Bytes
+     ------------------------------------------------------------- */
+
+  #define  tft_sprite               1                // 1 : Sprites verfuegbar
+  #define  tft_spriteanz            4                // Anzahl Sprites
+  #define  tft_spritepix           96                // max. Pixel je Sprite (Breite * Hoehe)
+  #define  tft_spritebuf          160                // Sendepuffer in Pixel (alte und neue Position)
+
   /*  ------------------------------------------------------------
                          P R O T O T Y P E N
       ------------------------------------------------------------ */
@@ -226,6 +288,9 @@
   void fillellipse(int xm, int ym, int a, int b, uint16_t color );            // zeichnet eine ausgefuellte Ellipse
   void circle(int x, int y, int r, uint16_t color );                          // zeichnet einen Kreis
   void fillcircle(int x, int y, int r, uint16_t color );                      // zeichnet einen ausgefuellten Kreis
+  void fillroundrect(int x1, int y1, int x2, int y2, int r, uint16_t color);  // zeichnet ein ausgefuelltes Rechteck mit runden Ecken
+  void filltriangle(int x0, int y0, int x1, int y1, int x2, int y2, uint16_t color);  // zeichnet ein ausgefuelltes Dreieck
+  void fillpoly(int anz, const int *pts, uint16_t color);                     // zeichnet ein ausgefuelltes Polygon
   void showimage(uint16_t ox, uint16_t oy, const unsigned char* const image, uint16_t fwert);     // zeichnet ein monochromes Bitmap
   void putstring(char *c);                                                    // schreibt einen Textstring auf das LCD
   void turtle_moveto(int x, int y);
@@ -238,6 +303,39 @@
   void setpage(int startpage);                  // setzt zu beschreibende Reihe
   void setxypos(int x, int y);                  // setzt die zu beschreibende Koordinate im Display-Ram
 
+  // ------------- Fensterausgabe (Burst-Transfer) ------------
+
+  void tft_window_begin(int x1, int y1, int x2, int y2);  // setzt ein Ausgabefenster (beruecksichtigt outmode)
+  void tft_push_pixels(const uint16_t *buf, int n);       // sendet n Farbwerte fortlaufend in das Fenster
+  void tft_push_color(uint16_t color, uint32_t n);        // sendet n mal denselben Farbwert in das Fenster
+  void tft_window_end(void);                              // beendet die Fensterausgabe
+
+  // ------------------ Kachelpuffer (Off-Screen) --------------
+
+  #if (tft_tilecache == 1)
+    void tft_tiles_enable(uint8_t on);                    // 1 : Ausgaben in den Kachelpuffer, 0 : direkt auf das Display
+    void tft_tiles_flush(void);                           // sendet die geaenderten Bereiche an das Display
+    void tft_tiles_invalidate(void);                      // verwirft den Kachelpuffer ohne zu senden
+  #endif
+
+  // ------------------------- Textkonsole ---------------------
+
+  #if (tft_console == 1)
+    void tft_con_init(uint8_t fg, uint8_t bg);            // Konsole fuer den aktuellen Font einrichten (EGA-Farben)
+    void tft_con_putchar(char ch);                        // Zeichen, Steuerzeichen, Escape-Sequenzen ausgeben
+    void tft_con_puts(char *s);                           // String ausgeben
+    int  tft_con_scrollback(int n);                       // n Zeilen zurueckblaettern, 0 : aktuelle Ausgabe
+    void tft_con_exit(void);                              // Scrollbereich zuruecksetzen, Display loeschen
+  #endif
+
+  // --------------------------- Sprites -----------------------
+
+  #if (tft_sprite == 1)
+    void tft_sprite_init(uint8_t nr, const uint16_t *img, uint16_t (*bkget)(int x, int y));  // Bild und Hintergrund zuweisen
+    void tft_sprite_show(uint8_t nr, int x, int y);       // Sprite an x,y zeichnen, ggf. von der alten Position verschieben
+    void tft_sprite_hide(uint8_t nr);                     // Hintergrund unter dem Sprite wiederherstellen
+  #endif
+
   // --------------------- SPI-Funktionen ---------------------
 
   void spi_init(void);
@@ -246,6 +344,15 @@
   void wrdata(uint8_t data);                    // schreibt einzelnen Registerwert oder Ramwert
   void wrdata16(int data);                      // schreibt einen Integerwert
 
+  // ------------- DMA-Transfer (nur SPI-Displays) -------------
+
+  #if ((USE_SPI_TFT == 1) && (tft_dma == 1))
+    void tft_dma_fill(uint16_t color, uint32_t n);                            // sendet n mal color im Hintergrund
+    void tft_dma_pixels(const uint16_t *buf, uint32_t n, void (*callback)(void));  // sendet einen Puffer im Hintergrund
+    uint8_t tft_dma_busy(void);                                               // 1 : DMA-Transfer laeuft noch
+    void tft_dma_wait(void);                                                  // wartet auf das Ende des DMA-Transfers
+  #endif
+
   /*  ------------------------------------------------------------
                       EGA - Farbzuweisungen
       ------------------------------------------------------------ */
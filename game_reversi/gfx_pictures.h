@@ -11,12 +11,15 @@
 
      hinzugelinkt werden, die die Ausgabe eines farbigen
      Punktes im RGB565-Format vornimmt (5 Bit fuer rot,
-     6 Bit fuer gruen, 5 Bit fuer blau)
+     6 Bit fuer gruen, 5 Bit fuer blau) sowie die Fenster-
+     ausgabe tft_window_begin / tft_push_pixels /
+     tft_push_color / tft_window_end
 
      Verfuegbare Formate sind:
 
        PCX 256 Farben
        BMP s/w, 4, 16, 256 Farben
+       LZ256 (komprimiert, image2c -z)
 
      MCU   :  AVR / STM32 / STM8
 
@@ -52,12 +55,26 @@
   #define bmp16_enable   1
   #define bmp256_enable  1
   #define pcx256_enable  1
+  #define lz256_enable   1
 
 
   // Putpixel ist hardwareabhaengig. Deshalb muss fuer das zu verwendende Display ein
   // putpixel innerhalb eines Programmes verfuegbar sein
   extern void putpixel(int x, int y,uint16_t color);
 
+  // Fensterausgabe des Displays (Burst-Transfer, siehe tftdisplay.c). Die Bilder werden
+  // zeilenweise dekodiert und in Bloecken zu gfx_bufsize Pixeln in ein Fenster geschrieben
+  extern void tft_window_begin(int x1, int y1, int x2, int y2);
+  extern void tft_push_pixels(const uint16_t *buf, int n);
+  extern void tft_push_color(uint16_t color, uint32_t n);
+  extern void tft_window_end(void);
+
+  #define gfx_bufsize        32              // Anzahl Pixel, die gesammelt in ein Fenster
+                                             // geschrieben werden
+
+  #define lz256_window     1024              // Ringpuffer (Bytes auf dem Stack) fuer lz256_show,
+                                             // muss zum Encoder (image2c -z) passen
+
   #if (avr_mcu == 1)
     #define readarray(arr,ind)       (pgm_read_byte(&(arr[ind])))
     #define readwarray(arr,ind)      (pgm_read_word(&(arr[ind])))
@@ -70,6 +87,9 @@
                          Prototypen
    ------------------------------------------------------- */
 
+  void gfx_srcrect(int x, int y, int w, int h);      // Ausschnitt der Quellgrafik fuer die folgenden Ausgaben
+                                                     // (w == 0 : gesamte Grafik)
+
   #if (bmpsw_enable == 1)
     void bmpsw_show(uint16_t ox, uint16_t oy, const unsigned char* const image, uint16_t fwert);
   #endif
@@ -90,4 +110,8 @@
     void pcx256_show(int16_t x, int16_t y, const unsigned char* const image, const uint16_t *const pal);
   #endif
 
+  #if (lz256_enable == 1)
+    void lz256_show(int16_t x, int16_t y, const unsigned char* const image, const uint16_t *const pal);
+  #endif
+
 #endif
@@ -11,6 +11,10 @@
         BMP -  16 Farben
         BMP -   2 Farben
 
+     256 Farben PCX- und BMP-Dateien koennen mit Option -z
+     in das komprimierte Format lz256 (siehe lz256_convert)
+     gewandelt werden.
+
       Besonderes Format:
         ASCII
 
@@ -909,6 +913,353 @@ int bmpsw_convert(char *inputfile, char *outputfile, char avrstyle)
 }
 
 
+/* ----------------------------------------------------------
+   lz256 - komprimiertes Format fuer 256 Farben Grafiken
+
+   LZ77-Verfahren auf den Palettenindizes, Aufbau des
+   erzeugten Arrays:
+
+     Byte 0..1 : Breite (High-, Lowbyte)
+     Byte 2..3 : Hoehe
+     Byte 4    : Kennung 'L'
+     ab Byte 5 : Tokenstrom, Bildpunkte zeilenweise von
+                 oben nach unten
+
+       0nnnnnnn              : n+1 Palettenindizes folgen
+                               unverschluesselt
+       1lllllaa aaaaaaaa     : l+3 Bildpunkte ab dem a+1 Bild-
+                               punkte zurueckliegenden Punkt
+                               kopieren (a max. 1023). Ist
+                               l == 31 folgt ein weiteres
+                               Byte das zur Laenge addiert wird
+
+   Der Dekoder (lz256_show in gfx_pictures.c) benoetigt
+   lediglich die letzten 1024 Bildpunkte (auf dem Stack).
+   ---------------------------------------------------------- */
+
+#define lz_window     1024
+#define lz_minlen     3
+#define lz_maxlen     (lz_minlen + 31 + 255)
+#define lz_hashsize   4096
+
+/* ----------------------------------------------------------
+   lz_matchlen
+
+   Laenge der Uebereinstimmung ab Position p und i (i > p)
+   ---------------------------------------------------------- */
+static int lz_matchlen(uint8_t *px, int n, int p, int i)
+{
+  int l= 0;
+
+  while ((i+l < n) && (l < lz_maxlen) && (px[p+l] == px[i+l])) l++;
+  return l;
+}
+
+/* ----------------------------------------------------------
+   lz_findmatch
+
+   sucht im Fenster die laengste Uebereinstimmung fuer
+   Position i (Hashketten ueber 3 Bildpunkte)
+   ---------------------------------------------------------- */
+static int lz_findmatch(uint8_t *px, int n, int *head, int *prev, int i, int *dist)
+{
+  int p, l, best, tries;
+
+  best= 0; *dist= 0;
+  if (i+lz_minlen > n) return 0;
+
+  p= head[((px[i] << 4) ^ (px[i+1] << 2) ^ px[i+2]) & (lz_hashsize-1)];
+  tries= 256;
+  while ((p >= 0) && (i-p <= lz_window) && (tries--))
+  {
+    l= lz_matchlen(px, n, p, i);
+    if (l > best) { best= l; *dist= i-p; }
+    p= prev[p];
+  }
+  // Wiederholung des vorherigen Punktes (Abstand 1) immer pruefen
+  if (i > 0)
+  {
+    l= lz_matchlen(px, n, i-1, i);
+    if (l > best) { best= l; *dist= 1; }
+  }
+  return best;
+}
+
+/* ----------------------------------------------------------
+   lz256_encode
+
+   komprimiert n Palettenindizes nach out. Rueckgabe:
+   Anzahl erzeugter Bytes
+   ---------------------------------------------------------- */
+int lz256_encode(uint8_t *px, int n, uint8_t *out)
+{
+  int *head, *prev;
+  int i, k, h, l, l2, d, d2, lit, litpos, o;
+
+  head= malloc(lz_hashsize * sizeof(int));
+  prev= malloc(n * sizeof(int));
+  for (i= 0; i< lz_hashsize; i++) head[i]= -1;
+
+  o= 0; lit= 0; litpos= 0;
+  i= 0;
+  while (i < n)
+  {
+    l= lz_findmatch(px, n, head, prev, i, &d);
+    if (l >= lz_minlen)
+    {
+      // einfache "lazy"-Suche: ist die Uebereinstimmung ab i+1 laenger,
+      // wird Punkt i als Literal ausgegeben
+      if (i+1 < n)
+      {
+        h= ((px[i] << 4) ^ (px[i+1] << 2) ^ ((i+2 < n) ? px[i+2] : 0)) & (lz_hashsize-1);
+        prev[i]= head[h]; head[h]= i;
+        l2= lz_findmatch(px, n, head, prev, i+1, &d2);
+        head[h]= prev[i];
+        if (l2 > l+1) l= 0;
+      }
+    }
+
+    if (l >= lz_minlen)
+    {
+      if (lit) { out[litpos]= lit-1; lit= 0; }
+      l -= lz_minlen;
+      out[o++]= 0x80 | (((l > 31) ? 31 : l) << 2) | ((d-1) >> 8);
+      out[o++]= (d-1) & 0xff;
+      if (l >= 31) out[o++]= l-31;
+      l += lz_minlen;
+    }
+    else
+    {
+      if (!lit) litpos= o++;
+      out[o++]= px[i];
+      lit++;
+      if (lit == 128) { out[litpos]= lit-1; lit= 0; }
+      l= 1;
+    }
+
+    for (k= 0; k< l; k++, i++)                       // Hashketten nachfuehren
+    {
+      if (i+2 < n)
+      {
+        h= ((px[i] << 4) ^ (px[i+1] << 2) ^ px[i+2]) & (lz_hashsize-1);
+        prev[i]= head[h];
+        head[h]= i;
+      }
+      else
+      {
+        prev[i]= -1;
+      }
+    }
+  }
+  if (lit) out[litpos]= lit-1;
+
+  free(head);
+  free(prev);
+  return o;
+}
+
+/* ----------------------------------------------------------
+   lz256_decode
+
+   dekodiert einen Tokenstrom zur Kontrolle (Rueckgabe:
+   Anzahl dekodierter Bildpunkte)
+   ---------------------------------------------------------- */
+int lz256_decode(uint8_t *in, int inlen, uint8_t *px, int n)
+{
+  int i, o, l, d;
+
+  i= 0; o= 0;
+  while ((i < inlen) && (o < n))
+  {
+    if (in[i] & 0x80)
+    {
+      l= ((in[i] >> 2) & 0x1f);
+      d= (((in[i] & 0x03) << 8) | in[i+1]) + 1;
+      i += 2;
+      if (l == 31) l += in[i++];
+      l += lz_minlen;
+      if (d > o) return -1;
+      while ((l--) && (o < n)) { px[o]= px[o-d]; o++; }
+    }
+    else
+    {
+      l= in[i++] + 1;
+      while ((l--) && (o < n)) px[o++]= in[i++];
+    }
+  }
+  return o;
+}
+
+/* ----------------------------------------------------------
+   pcx256_pixels
+
+   liest die Palettenindizes einer 256 Farben PCX-Datei
+   (Zeilen von oben nach unten, ohne Fuellbytes)
+
+   Rueckgabe: Zeiger auf die Indizes (malloc) oder NULL
+   ---------------------------------------------------------- */
+uint8_t *pcx256_pixels(char *inputfile, int *w, int *h, long *srclen)
+{
+  FILE     *binfile;
+  uint8_t  *dat, *px, b;
+  long     len, pos;
+  int      bpl, c, row, pack;
+
+  binfile= fopen(inputfile, "rb");
+  fseek(binfile, 0, SEEK_END);
+  len= ftell(binfile);
+  fseek(binfile, 0, SEEK_SET);
+  dat= malloc(len);
+  if (fread(dat, 1, len, binfile) != len) len= 0;
+  fclose(binfile);
+
+  if ((len < 128+768) || (dat[0] != 10) || (dat[3] != 8))
+  {
+    printf("\nError: %s is not a 256 color PCX file...\n\n", inputfile);
+    free(dat);
+    return NULL;
+  }
+
+  *w= ((dat[9] - dat[5])*256 + dat[8] - dat[4])+1;
+  *h= ((dat[11] - dat[7])*256 + dat[10] - dat[6])+1;
+  bpl= dat[66] + (dat[67] * 256);
+  if (bpl < *w) bpl= *w;
+  *srclen= len-128-768;
+
+  px= malloc((*w) * (*h));
+  c= 0; row= 0; pos= 128;
+  while ((row < *h) && (pos < len-768))
+  {
+    b= dat[pos++];
+    if ((b & 0xc0) == 0xc0) { pack= b & 0x3f; b= dat[pos++]; }
+                       else { pack= 1; }
+    while (pack--)
+    {
+      if (c < *w) px[row * (*w) + c]= b;
+      c++;
+      if (c == bpl) { c= 0; row++; if (row == *h) break; }
+    }
+  }
+  free(dat);
+  return px;
+}
+
+/* ----------------------------------------------------------
+   bmp256_pixels
+
+   liest die Palettenindizes einer 256 Farben BMP-Datei
+   (Zeilen von oben nach unten, ohne Fuellbytes)
+   ---------------------------------------------------------- */
+uint8_t *bmp256_pixels(char *inputfile, int *w, int *h, long *srclen)
+{
+  FILE     *binfile;
+  uint8_t  *px;
+  uint32_t bdatptr;
+  int      y, stride;
+
+  binfile= fopen(inputfile, "rb");
+  if ((fread16(binfile,0) != 0x4d42) || (fread16(binfile,28) != 8))
+  {
+    printf("\nError: %s is not a 256 color BMP file...\n\n", inputfile);
+    fclose(binfile);
+    return NULL;
+  }
+  *w= fread32(binfile,18);
+  *h= fread32(binfile,22);
+  bdatptr= fread32(binfile,10);
+  stride= (*w + 3) & ~3;
+  *srclen= (long)(*w) * (*h);
+
+  px= malloc((*w) * (*h));
+  for (y= 0; y< *h; y++)
+  {
+    fseek(binfile, bdatptr + (long)(*h-1-y) * stride, SEEK_SET);   // BMP: unterste Zeile zuerst
+    if (fread(&px[y * (*w)], 1, *w, binfile) != *w) break;
+  }
+  fclose(binfile);
+  return px;
+}
+
+/* ----------------------------------------------------------
+   lz256_convert
+
+   Konvertiert eine 256 Farben PCX- oder BMP-Datei in ein
+   lz256 komprimiertes C-Array und gibt das Kompressions-
+   verhaeltnis aus. Das Ergebnis wird zur Kontrolle wieder
+   dekodiert und mit der Quelle verglichen.
+
+   Uebergabe:
+
+       *inputfile  : Zeiger auf Dateinamensstring
+       *outputfile : Die anzulegende Datei, in der das
+                     C-Array gespeichert wird.
+       ispcx       : 1 = PCX-Datei, 0 = BMP-Datei
+       avrstyle    : 0 = Standard C-Array
+                     1 = Array wird fuer einen AVR-Controller
+                     angelegt (PROGMEM)
+   ---------------------------------------------------------- */
+int lz256_convert(char *inputfile, char *outputfile, char ispcx, char avrstyle)
+{
+  FILE     *cfile;
+  uint8_t  *px, *chk, *out;
+  int      w, h, n, len, i;
+  long     srclen;
+
+  if (!(fileexists(inputfile)))
+  {
+    printf("\nError: file %s not found...\n\n", inputfile);
+    return 1;
+  }
+
+  if (ispcx) px= pcx256_pixels(inputfile, &w, &h, &srclen);
+        else px= bmp256_pixels(inputfile, &w, &h, &srclen);
+  if (px == NULL) return 1;
+
+  n= w*h;
+  out= malloc(n + n/128 + 16);
+  out[0]= w >> 8; out[1]= w & 0xff;
+  out[2]= h >> 8; out[3]= h & 0xff;
+  out[4]= 'L';
+  len= lz256_encode(px, n, &out[5]) + 5;
+
+  chk= malloc(n);
+  if ((lz256_decode(&out[5], len-5, chk, n) != n) || (memcmp(px, chk, n)))
+  {
+    printf("\nError: lz256 verify failed...\n\n");
+    free(px); free(chk); free(out);
+    return 1;
+  }
+
+  printf("\nlz256: %d x %d pixel\n", w, h);
+  printf("  uncompressed : %6d bytes\n", n);
+  printf("  source (%s) : %6ld bytes\n", ispcx ? "pcx" : "bmp", srclen);
+  printf("  lz256        : %6d bytes (%.1f %% of uncompressed, %.1f %% of source)\n",
+         len, 100.0 * len / n, 100.0 * len / srclen);
+  printf("  verify       : ok\n\n");
+
+  cfile= fopen(outputfile, "w");
+  fprintf(cfile,"\n//Array generated with IMAGE2C by R. Seelig\n");
+  fprintf(cfile,"\n#define lz256_imagebytes        %u\n\n", len);
+  if (avrstyle)
+    fprintf(cfile,"static const unsigned char lz256_image[%u] PROGMEM = {\n", len);
+  else
+    fprintf(cfile,"static const unsigned char lz256_image[%u] = {\n", len);
+
+  for (i= 0; i< len; i++)
+  {
+    if (!(i % 16)) fprintf(cfile,"\n  ");
+    if (i != len-1)
+      fprintf(cfile,"0x%.2x, ", out[i]);
+    else
+      fprintf(cfile,"0x%.2x };\n\n", out[i]);
+  }
+
+  fclose(cfile);
+  free(px); free(chk); free(out);
+  return 0;
+}
+
+
 /* ----------------------------------------------------------
      help_show
 
@@ -933,9 +1284,12 @@ void help_show(void)
   printf("    -f inputfileformat (allowed formats are pcx256, bmp256, bmp16, bmpsw, ascii\n");
   printf("    -p : only generate the colorpalette. Available only with 256 color images\n");
   printf("         With 16 color images, the palette is generated with the data\n");
+  printf("    -z : compress the imagedata (lz256). Available only with pcx256 and bmp256\n");
+  printf("         The palette is generated separately with -p\n");
   printf("    -h : show this help\n\n");
   printf("Example:\n");
-  printf("    image2c -i testpic.pcx -o testpicdata -a -f pcx256 -p\n\n");
+  printf("    image2c -i testpic.pcx -o testpicdata -a -f pcx256 -p\n");
+  printf("    image2c -i testpic.pcx -o testpiclz -f pcx256 -z\n\n");
 }
 
 /* ----------------------------------------------------------------------------------
@@ -946,6 +1300,7 @@ int main(int argc, char **argv)
   int aflag = 0;
   int pflag = 1;
   int hflag = 0;
+  int zflag = 0;
   int parseerr = 0;
 
   char *ivalue = NULL;
@@ -958,7 +1313,7 @@ int main(int argc, char **argv)
 
   opterr = 0;
 
-  while ((c = getopt (argc, argv, "aphf:i:o:")) != -1)
+  while ((c = getopt (argc, argv, "aphzf:i:o:")) != -1)
   {
     switch (c)
       {
@@ -971,6 +1326,9 @@ int main(int argc, char **argv)
       case 'h':
         hflag = 1;
         break;
+      case 'z':
+        zflag = 1;
+        break;
       case 'i':
         ivalue = optarg;
         break;
@@ -1029,6 +1387,16 @@ int main(int argc, char **argv)
     return 1;
   }
 
+  if ((zflag) && (pflag))
+  {
+    if (strcmp(fvalue,"pcx256")== 0)
+      return lz256_convert(ivalue, ovalue, 1, aflag);
+    if (strcmp(fvalue,"bmp256")== 0)
+      return lz256_convert(ivalue, ovalue, 0, aflag);
+    printf("\nInfo: compression is available only with pcx256 and bmp256.\n");
+    printf("Option -z ignored...\n\n");
+  }
+
   if (strcmp(fvalue,"pcx256")== 0)
     pcx256_convert(ivalue, ovalue, pflag, aflag);
 
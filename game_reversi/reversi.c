@@ -361,13 +361,15 @@ void select_show(uint16_t xofs, uint16_t yofs, uint8_t select)
         xofs, yofs : Koordinaten, an der der Screen
                      gezeichnet wird
 
-     Rueckgabe: gewaehlte Schwierigkeit
-                  0 = leicht
-                  1 = mittel
-                  2 = schwierig
+     Rueckgabe: Index der Strategie in STRATEGIES
+                (reversi_ki.c) zur gewaehlten Schwierigkeit
+                  leicht    : diff3
+                  mittel    : wdiff3
+                  schwierig : wmob (iterative Vertiefung)
 ------------------------------------------------------- */
 uint8_t get_difficult(uint16_t xofs, uint16_t yofs)
 {
+  static const uint8_t strategy_of_level[3] = { 1, 3, 5 };
   uint8_t ch, sel;
 
   levellogo_show(xofs, yofs);
@@ -385,7 +387,7 @@ uint8_t get_difficult(uint16_t xofs, uint16_t yofs)
       if (sel< 2) sel++; else sel= 0;
     }
   } while(ch != 5);
-  return sel+1;
+  return strategy_of_level[sel];
 }
 
 
@@ -6,11 +6,15 @@
      Ausgangsprojekt war ein Quellcode fuer Linux-Konsole
      mit (leider) unbekanntem Author.
 
+     Die Suche arbeitet auf Bitboards und verwendet keinen
+     Heap (kein malloc), siehe "Bitboard-Suche".
+
      30.10.2019  R. Seelig
    ------------------------------------------------------------ */
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <stdint.h>
 
 #include "reversi_ki.h"
 
@@ -21,6 +25,8 @@
   int maxdiffstrategy3(int, int *);
   int maxweighteddiffstrategy1(int, int *);
   int maxweighteddiffstrategy3(int, int *);
+  int maxweighteddiffstrategy5(int, int *);
+  int mobilitystrategy(int, int *);
 
 
 /* -------------------------------------------------------------
@@ -38,15 +44,18 @@
   const int WIN   = 2000;          // a WIN and LOSS for player are outside
   const int LOSS  = -2000;         // the range of any board evaluation function */
 
-  long int BOARDS;
+  long int BOARDS;                 // Anzahl untersuchter Stellungen (Statistik)
+  int      ki_depth;               // zuletzt vollstaendig durchsuchte Tiefe (Strategie wmob)
 
 
-  void * STRATEGIES[5][4] =
+  void * STRATEGIES[7][4] =
   {
     {"human", "human", human},
     {"diff3", "maxdiff, 3-move minmax lookahead", maxdiffstrategy3},
     {"wdiff1", "maxweigteddiff, 1-move minmax lookahead", maxweighteddiffstrategy1},
     {"wdiff3", "maxweigteddiff, 3-move minmax lookahead", maxweighteddiffstrategy3},
+    {"wdiff5", "maxweigteddiff, 5-move alphabeta lookahead", maxweighteddiffstrategy5},
+    {"wmob", "weighted + mobility, iterative deepening (ki_timebudget)", mobilitystrategy},
     {NULL, NULL, NULL}
   };
 
@@ -81,30 +90,18 @@
     }
   }
 
-  /* --------------------------------------------------------------
-     The copyboard function mallocs space for a board, then copies
-     the values of a given board to the newly malloced board.
-     -------------------------------------------------------------- */
-  int *copyboard (int * board)
-  {
-    int i, * newboard;
-
-    newboard = (int *)malloc(BOARDSIZE * sizeof(int));
-    for (i= 0; i< BOARDSIZE; i++) newboard[i] = board[i];
-    return newboard;
-  }
-
-
   /* --------------------------------------------------------------
      the initial board has values of 3 (OUTER) on the perimeter,
      and EMPTY (0) everywhere else, except the center locations
      which will have two WHITE (1) and two BLACK (2) values.
+     The board is a static array (no heap is used).
      -------------------------------------------------------------- */
   int *initialboard (void)
   {
+    static int gameboard[100];
     int i, * board;
 
-    board = (int *)malloc(BOARDSIZE * sizeof(int));
+    board = &gameboard[0];
     for (i = 0; i<= 9; i++) board[i]=OUTER;
     for (i = 10; i<= 89; i++)
     {
@@ -230,23 +227,6 @@
   }
 
 
-  int *legalmoves (int player, int * board)
-  {
-    int move, i, * moves;
-
-    moves = (int *)malloc(65 * sizeof(int));
-    moves[0] = 0;
-    i = 0;
-    for (move=11; move<=88; move++)
-      if (legalp(move, player, board))
-      {
-        i++;
-        moves[i]=move;
-      }
-    moves[0]= i;
-    return moves;
-  }
-
   /* ---------------------------------------------------------------------
                           Strategies for playing
      --------------------------------------------------------------------- */
@@ -305,105 +285,311 @@
   }
 
 
-  int minmax (int player, int * board, int ply, int (* evalfn) (int, int *))
+  /* ---------------------------------------------------------------------
+                           Bitboard-Suche
+     ---------------------------------------------------------------------
+
+       Fuer die Suche wird das Spielfeld in zwei 64-Bit Bitboards
+       (eigene und gegnerische Steine) umgesetzt:
+
+         Feld zeile*10 + spalte  =>  Bit (zeile-1)*8 + (spalte-1)
+
+       Zugerzeugung, Zug setzen und zuruecknehmen (ueber die Maske
+       der umgedrehten Steine) kommen ohne Kopie des Spielfeldes und
+       ohne malloc aus, der Speicherbedarf ist lediglich der Stack
+       (ca. 40 Bytes je Suchtiefe).
+
+       Die Strategien 1..3 liefern dieselben Zuege wie die fruehere
+       Minimax-Suche (gleiche Bewertung, Alpha-Beta Suche, bei gleich
+       guten Zuegen gilt der erste in Feldreihenfolge).
+     --------------------------------------------------------------------- */
+
+  #define bb_bit(sq)       ( (((sq) / 10) - 1) * 8 + ((sq) % 10) - 1 )
+  #define bb_square(b)     ( (((b) / 8) + 1) * 10 + ((b) % 8) + 1 )
+
+  #define notA             0xfefefefefefefefeULL  // ohne Spalte 1
+  #define notH             0x7f7f7f7f7f7f7f7fULL  // ohne Spalte 8
+
+  typedef int (* bbevalfn) (uint64_t, uint64_t);
+
+  static const int8_t   bb_dirshift[8] = { -9, -8, -7, -1, 1, 7, 8, 9 };   // wie ALLDIRECTIONS
+  static const uint64_t bb_dirmask[8]  = { notH, ~0ULL, notA, notH, notA, notH, ~0ULL, notA };
+
+  static uint64_t bb[2];                          // [0]: Spieler am Zug der Wurzel, [1]: Gegner
+  static bbevalfn bb_evalfn;
+  static uint8_t  bb_ordered;                     // 1: Zuege nach Feldwertigkeit sortieren
+  static uint8_t  bb_aborted;
+  static int      bb_deadline;
+
+  /* Reihenfolge der Felder fuer die Zugsortierung: Ecken zuerst,
+     Felder neben den Ecken zuletzt (nach weighteddiffeval)        */
+  static const uint8_t bb_order[64] =
   {
-    int i, max, ntm, newscore, bestmove, * moves, * newboard;
-    int maxchoice (int, int *, int, int (*) (int, int *));
-    int minchoice (int, int *, int, int (*) (int, int *));
+     0,  7, 56, 63,  2,  5, 16, 23, 40, 47, 58, 61, 18, 21, 42, 45,
+     3,  4, 24, 31, 32, 39, 59, 60, 19, 20, 26, 27, 28, 29, 34, 35,
+    36, 37, 43, 44, 11, 12, 25, 30, 33, 38, 51, 52, 10, 13, 17, 22,
+    41, 46, 50, 53,  1,  6,  8, 15, 48, 55, 57, 62,  9, 14, 49, 54
+  };
 
-    moves = legalmoves(player, board);                     // get all legal moves for player
-    max = LOSS - 1;                                        // any legal move will exceed this score
-    for (i=1; i <= moves[0]; i++)
+  static uint64_t bb_shift(uint64_t b, uint8_t dir)
+  {
+    int8_t s;
+
+    s= bb_dirshift[dir];
+    if (s > 0) return (b << s) & bb_dirmask[dir];
+          else return (b >> -s) & bb_dirmask[dir];
+  }
+
+  /* --------------------------------------------------------------
+     bb_moves
+
+     alle legalen Zuege fuer own (Spielsteine opp werden ueber-
+     sprungen und muessen von einem eigenen Stein begrenzt sein)
+     -------------------------------------------------------------- */
+  static uint64_t bb_moves(uint64_t own, uint64_t opp)
+  {
+    uint64_t moves, empty, t;
+    uint8_t  dir, i;
+
+    empty= ~(own | opp);
+    moves= 0;
+    for (dir= 0; dir< 8; dir++)
     {
-      newboard = copyboard(board); BOARDS = BOARDS + 1;
-      makemove(moves[i], player, newboard);
-      ntm = nexttoplay(newboard, player);
-      if (ntm == 0)
-      {
-        // game over, so determine winner
-        newscore = diffeval(player, newboard);
-        if (newscore > 0) newscore = WIN;                  // Spieler gewinnt
-        if (newscore < 0) newscore = LOSS;                 // Computer gewinnt
-      }
-      if (ntm == player)                                   // Computer kann nicht ziehen
-         newscore = maxchoice(player, newboard, ply-1, evalfn);
-      if (ntm == opponent(player))
-         newscore = minchoice(player, newboard, ply-1, evalfn);
-      if (newscore > max)
+      t= bb_shift(own, dir) & opp;
+      for (i= 0; i< 5; i++) t |= bb_shift(t, dir) & opp;
+      moves |= bb_shift(t, dir) & empty;
+    }
+    return moves;
+  }
+
+  /* --------------------------------------------------------------
+     bb_flips
+
+     Maske der Steine, die ein Zug auf Feld m (ein Bit) umdreht
+     -------------------------------------------------------------- */
+  static uint64_t bb_flips(uint64_t own, uint64_t opp, uint64_t m)
+  {
+    uint64_t flips, f, x;
+    uint8_t  dir;
+
+    flips= 0;
+    for (dir= 0; dir< 8; dir++)
+    {
+      f= 0;
+      x= bb_shift(m, dir);
+      while (x & opp)
       {
-        max = newscore;
-        bestmove = moves[i];                               // besseren Spielzug gefunden
+        f |= x;
+        x= bb_shift(x, dir);
       }
-      free(newboard);
+      if (x & own) flips |= f;
     }
-    free(moves);
-    return(bestmove);
+    return flips;
   }
 
-  int maxchoice (int player, int * board, int ply,
-                 int (* evalfn) (int, int *))
+  static int bb_count(uint64_t b)
   {
+    return __builtin_popcountll(b);
+  }
 
-    int i, max, ntm, newscore, * moves, * newboard;
-    int minchoice (int, int *, int, int (*) (int, int *));
+  /* --------------------------------------------------------------
+     Bewertungsfunktionen (Sicht von own), identisch zu diffeval
+     und weighteddiffeval. Die Gewichtung wird ueber Masken der
+     Felder gleichen Gewichts berechnet.
+     -------------------------------------------------------------- */
+  static int bb_diffeval(uint64_t own, uint64_t opp)
+  {
+    return bb_count(own) - bb_count(opp);
+  }
 
-    if (ply == 0) return((* evalfn) (player, board));
-    moves = legalmoves(player, board);
-    max = LOSS - 1;
-    for (i=1; i <= moves[0]; i++)
+  static const int8_t   bb_wval[8]  = { 120, -20, 20, 5, -40, -5, 15, 3 };
+  static const uint64_t bb_wmask[8] =
+  {
+    0x8100000000000081ULL,                        //  120 : Ecken
+    0x4281000000008142ULL,                        //  -20 : neben den Ecken
+    0x2400810000810024ULL,                        //   20
+    0x1800008181000018ULL,                        //    5
+    0x0042000000004200ULL,                        //  -40 : diagonal zu den Ecken
+    0x003c424242423c00ULL,                        //   -5
+    0x0000240000240000ULL,                        //   15
+    0x0000183c3c180000ULL                         //    3
+  };
+
+  static int bb_weighteval(uint64_t own, uint64_t opp)
+  {
+    int     sum;
+    uint8_t i;
+
+    sum= 0;
+    for (i= 0; i< 8; i++)
+      sum += bb_wval[i] * (bb_count(own & bb_wmask[i]) - bb_count(opp & bb_wmask[i]));
+    return sum;
+  }
+
+  /* gewichtete Felder und Beweglichkeit (Anzahl moeglicher Zuege) */
+  static int bb_mobilityeval(uint64_t own, uint64_t opp)
+  {
+    return bb_weighteval(own, opp) +
+           5 * (bb_count(bb_moves(own, opp)) - bb_count(bb_moves(opp, own)));
+  }
+
+  /* --------------------------------------------------------------
+     bb_negamax
+
+     Alpha-Beta Suche fuer Spieler s (Index in bb[]), Bewertung
+     aus Sicht von s. Zuege werden in bb[] gesetzt und ueber die
+     Maske der umgedrehten Steine wieder zurueckgenommen.
+     -------------------------------------------------------------- */
+  static int bb_negamax(uint8_t s, int depth, int alpha, int beta)
+  {
+    uint64_t moves, m, flips;
+    int      best, v, d;
+    uint8_t  i;
+
+    BOARDS++;
+    if ((bb_deadline) && !(BOARDS & 0xff) && ((tick_ms - bb_deadline) >= 0))
+      bb_aborted= 1;
+    if (bb_aborted) return 0;
+
+    moves= bb_moves(bb[s], bb[s^1]);
+    if (!moves)
     {
-      newboard = copyboard(board); BOARDS = BOARDS + 1;
-      makemove(moves[i], player, newboard);
-      ntm = nexttoplay(newboard, player);
-      if (ntm == 0)
+      if (!bb_moves(bb[s^1], bb[s]))
       {
-        newscore = diffeval(player, newboard);
-        if (newscore > 0) newscore = WIN;
-        if (newscore < 0) newscore = LOSS;
+        d= bb_count(bb[s]) - bb_count(bb[s^1]);    // Spielende
+        if (d > 0) return WIN;
+        if (d < 0) return LOSS;
+        return 0;
       }
-      if (ntm == player)
-         newscore = maxchoice(player, newboard, ply-1, evalfn);
-      if (ntm == opponent(player))
-         newscore = minchoice(player, newboard, ply-1, evalfn);
-      if (newscore > max) max = newscore;
-      free(newboard);
+      return -bb_negamax(s^1, depth, -beta, -alpha); // passen
     }
-    free(moves);
-    return(max);
+
+    if (depth == 0) return (* bb_evalfn)(bb[s], bb[s^1]);
+
+    best= LOSS - 1;
+    for (i= 0; i< 64; i++)
+    {
+      m= (uint64_t)1 << (bb_ordered ? bb_order[i] : i);
+      if (!(moves & m)) continue;
+
+      flips= bb_flips(bb[s], bb[s^1], m);
+      bb[s] ^= flips | m;                           // Zug setzen
+      bb[s^1] ^= flips;
+      v= -bb_negamax(s^1, depth-1, -beta, -(alpha > best ? alpha : best));
+      bb[s] ^= flips | m;                           // und zuruecknehmen
+      bb[s^1] ^= flips;
+
+      if (v > best)
+      {
+        best= v;
+        if (best >= beta) break;
+      }
+    }
+    return best;
   }
 
-  int minchoice (int player, int * board, int ply,
-                 int (* evalfn) (int, int *))
-  {
-    int i, min, ntm, newscore, * moves, * newboard;
+  /* --------------------------------------------------------------
+     bb_root
+
+     untersucht alle Zuege der Wurzelstellung mit Suchtiefe ply
+     (inklusive des Wurzelzuges). first: Bitnummer des zuerst
+     zu untersuchenden Zuges (-1 = keiner)
 
-    if (ply == 0) return((* evalfn) (player, board));
-    moves = legalmoves(opponent(player), board);
-    min = WIN+1;
-    for (i=1; i <= moves[0]; i++)
+     Rueckgabe: Bitnummer des besten Zuges (bei gleicher Bewer-
+                tung der zuerst untersuchte), -1 bei Abbruch
+     -------------------------------------------------------------- */
+  static int bb_root(int ply, int first)
+  {
+    uint64_t moves, m, flips;
+    int      best, v, bestbit, b;
+    int8_t   i;
+
+    moves= bb_moves(bb[0], bb[1]);
+    best= LOSS - 1;
+    bestbit= -1;
+    for (i= -1; i< 64; i++)
     {
-      newboard = copyboard(board); BOARDS = BOARDS + 1;
-      makemove(moves[i], opponent(player), newboard);
-      ntm = nexttoplay(newboard, opponent(player));
-      if (ntm == 0)
+      if (i < 0)
+      {
+        if (first < 0) continue;
+        b= first;
+      }
+      else
+      {
+        b= bb_ordered ? bb_order[i] : i;
+        if (b == first) continue;
+      }
+      m= (uint64_t)1 << b;
+      if (!(moves & m)) continue;
+
+      flips= bb_flips(bb[0], bb[1], m);
+      bb[0] ^= flips | m;
+      bb[1] ^= flips;
+      v= -bb_negamax(1, ply-1, LOSS - 1, -best);
+      bb[0] ^= flips | m;
+      bb[1] ^= flips;
+      if (bb_aborted) return -1;
+
+      if (v > best)
       {
-        newscore = diffeval(player, newboard);
-        if (newscore > 0) newscore = WIN;
-        if (newscore < 0) newscore = LOSS;
+        best= v;
+        bestbit= b;
       }
-      if (ntm == player)
-         newscore = maxchoice(player, newboard, ply-1, evalfn);
-      if (ntm == opponent(player))
-         newscore = minchoice(player, newboard, ply-1, evalfn);
-      if (newscore < min) min = newscore;
-      free(newboard);
     }
-    free(moves);
-    return(min);
+    return bestbit;
   }
 
+  /* --------------------------------------------------------------
+     bb_search
+
+     setzt das Spielfeld board fuer player in Bitboards um und
+     sucht den besten Zug.
+
+       ply       : Suchtiefe
+       iterative : 0 = feste Suchtiefe ply
+                   1 = iterative Vertiefung bis ply, bis die Zeit
+                       ki_timebudget (ms) abgelaufen ist. Es gilt
+                       der Zug der letzten vollstaendig durch-
+                       suchten Tiefe
+
+     Rueckgabe: Spielfeld (11..88) des besten Zuges
+     -------------------------------------------------------------- */
+  static int bb_search(int player, int * board, int ply, bbevalfn evalfn, uint8_t iterative)
+  {
+    int i, best, b;
 
+    bb[0]= 0; bb[1]= 0;
+    for (i= 11; i<= 88; i++)
+    {
+      if (!validp(i)) continue;
+      if (board[i] == player) bb[0] |= (uint64_t)1 << bb_bit(i);
+      else if (board[i] == opponent(player)) bb[1] |= (uint64_t)1 << bb_bit(i);
+    }
 
+    bb_evalfn= evalfn;
+    bb_ordered= iterative;
+    bb_aborted= 0;
+    bb_deadline= 0;
+
+    if (!iterative)
+    {
+      best= bb_root(ply, -1);
+    }
+    else
+    {
+      bb_deadline= tick_ms + ki_timebudget;
+      best= -1;
+      for (i= 1; i<= ply; i++)
+      {
+        b= bb_root(i, best);
+        if (bb_aborted) break;
+        best= b;
+        ki_depth= i;
+      }
+    }
+    if (best < 0) return 0;
+    return bb_square(best);
+  }
 
   /* --------------------------------------------------------------
      the following strategies use minmax search
@@ -411,7 +597,7 @@
 
   int maxdiffstrategy3(int player, int * board)
   {
-    return(minmax(player, board, 3, diffeval));
+    return(bb_search(player, board, 3, bb_diffeval, 0));
   }
 
   /* --------------------------------------------------------------
@@ -419,12 +605,25 @@
      -------------------------------------------------------------- */
   int maxweighteddiffstrategy1(int player, int * board)
   {
-     return(minmax(player, board, 1, weighteddiffeval));
+     return(bb_search(player, board, 1, bb_weighteval, 0));
   }
 
   int maxweighteddiffstrategy3(int player, int * board)
   {
-     return(minmax(player, board, 3, weighteddiffeval));
+     return(bb_search(player, board, 3, bb_weighteval, 0));
+  }
+
+  int maxweighteddiffstrategy5(int player, int * board)
+  {
+     return(bb_search(player, board, 5, bb_weighteval, 0));
+  }
+
+  /* --------------------------------------------------------------
+      gewichtete Felder + Beweglichkeit, iterative Vertiefung
+     -------------------------------------------------------------- */
+  int mobilitystrategy(int player, int * board)
+  {
+     return(bb_search(player, board, ki_maxdepth, bb_mobilityeval, 1));
   }
 
 
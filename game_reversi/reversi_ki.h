@@ -12,8 +12,15 @@
 #ifndef in_reversi_ki
   #define in_reversi_ki
 
+  #include "sysf103_init.h"                             // tick_ms
+
   typedef int (* fpc) (int, int *);
 
+  // Strategie "wmob" (iterative Vertiefung): maximale Suchtiefe und
+  // Bedenkzeit je Zug in ms (Zeitbasis tick_ms aus sysf103_init.c)
+  #define ki_maxdepth       12
+  #define ki_timebudget     1500
+
 
   /* -------------------------------------------------------------
                              Prototypen
@@ -23,6 +30,9 @@
   extern void printboard (int *board);                  // externe Funktion zur Anzeige des Spielfeldes
   extern void status_meld(uint8_t nr);
 
+  extern long int BOARDS;                               // untersuchte Stellungen
+  extern int ki_depth;                                  // erreichte Suchtiefe (wmob)
+
   uint8_t playgame (int difficult);
 
 
@@ -115,6 +115,12 @@ volatile char keys;
 #define gamrows     15
 #define gamcol      11
 
+#define bitfeld     1                                       // 0: Spielfeld mit einem Byte je Feld, drawfeld zeichnet
+                                                            //    das gesamte Spielfeld neu
+                                                            // 1: eine 16-Bit Maske je Reihe (Kollision, volle Reihen
+                                                            //    ueber Wortoperationen), drawfeld zeichnet nur
+                                                            //    geaenderte Felder
+
 #define scorepos    5,0
 #define intime      60
 #define outerloop   2
@@ -153,8 +159,28 @@ const uint8_t colpair[figanz] =
 };
 
 
-uint8_t    tetfeld[gamrows][gamcol+2];       // Tetris Spielfeld, nimmt gamrows -  Reihen zu je gamcol Positionen + 2
-                                             // Feldbegrenzer
+#if (bitfeld == 1)
+
+  // Spielfeld als Bitmaske: Bit (15-x) ist Spalte x einer Reihe. Spalte 0 und gamcol+1
+  // sind die Feldbegrenzer, die Bits rechts davon (ausserhalb) sind ebenfalls belegt.
+  // Eine Figurenreihe (Nibble, Bit 3 = linke Spalte) wird um (12-figx) nach links
+  // geschoben und mit der Spielfeldreihe verundet.
+
+  #define feld_leer       (0x8000 | (0xffff >> (gamcol+1)))     // nur Feldbegrenzer
+  #define feld_voll       0xffff
+  #define feld_unbek      0xfe                                  // Inhalt in tetshown unbekannt
+
+  #define figrow(fig,r)   (((fig) >> (12 - ((r) * 4))) & 0x0f)  // Reihe r (0..3) einer Figur
+
+  uint16_t   tetfeld[gamrows];                 // belegte Felder je Reihe
+  uint8_t    tetcol[gamrows][gamcol+2];        // Figurnummer je Feld (0: leer, 0xff: Feldbegrenzer)
+  uint8_t    tetshown[gamrows][gamcol+2];      // auf dem Display gezeichnete Felder (fuer drawfeld)
+
+#else
+
+  uint8_t    tetfeld[gamrows][gamcol+2];       // Tetris Spielfeld, nimmt gamrows -  Reihen zu je gamcol Positionen + 2
+                                               // Feldbegrenzer
+#endif
 
 uint8_t    aktfig, aktrot;
 char       figx, figy;
@@ -301,6 +327,171 @@ char readkey()
   return 0;
 }
 
+#if (bitfeld == 1)
+
+void gamefeld_init(void)
+{
+  uint8_t x, y;
+
+  for (y= 0; y< gamrows; y++)
+  {
+    tetfeld[y]= feld_leer;
+    for (x= 1; x< (gamcol+1); x++)
+    {
+      tetcol[y][x]= 0;
+    }
+    tetcol[y][0]= 0xff;
+    tetcol[y][gamcol+1]= 0xff;
+  }
+  tetfeld[gamrows-1]= feld_voll;
+  for (x= 0; x< (gamcol+2); x++)
+  {
+    tetcol[gamrows-1][x]= 0xff;
+  }
+  memset(tetshown, feld_unbek, sizeof(tetshown));   // naechstes drawfeld zeichnet alles
+}
+
+/* -------------------------------------------------
+                        drawfeld
+     zeichnet die Felder, die sich gegenueber dem
+     Displayinhalt (tetshown) geaendert haben.
+     Nach dem Einrasten einer Figur ohne volle Reihe
+     wird nichts gezeichnet, nach dem Entfernen einer
+     Reihe nur die nachgerueckten Reihen
+   ------------------------------------------------- */
+void drawfeld(void)
+{
+  uint8_t x, y, b;
+
+  for (y= 0; y< gamrows-1; y++)
+  {
+    if (!memcmp(tetcol[y], tetshown[y], gamcol+2)) continue;   // Reihe unveraendert
+
+    for (x= 0; x< (gamcol+2); x++)
+    {
+      b= tetcol[y][x];
+      if (b == tetshown[y][x]) continue;
+      tetshown[y][x]= b;
+
+      if (b== 0xff)
+      {
+        drawklotz(x,y,0x08,1);
+      }
+      else if (b== 0x00)
+      {
+        drawklotz(x,y,0x07,0);
+      }
+      else
+      {
+        drawklotz(x,y,b+8,1);
+      }
+    }
+  }
+}
+
+/* -------------------------------------------------
+                        canposxy
+     testet, ob an der angegebenen Position die
+     uebergebene Figur positionierbar ist !
+
+     je Figurenreihe ein Schieben und Verunden mit
+     der Spielfeldreihe. Teile der Figur ausserhalb
+     des Spielfelds gelten als belegt.
+   ------------------------------------------------- */
+char canposxy(char fx, char fy, uint16_t fig)
+{
+  int      x, y;
+  uint8_t  r;
+  uint32_t m;
+
+  x= (signed char)fx;
+  if (x > 12) return 0;
+
+  for (r= 0; r< 4; r++)
+  {
+    m= figrow(fig, r);
+    if (!m) continue;
+
+    y= (signed char)fy + r;
+    if ((y < 0) || (y >= gamrows)) return 0;
+
+    m <<= (12 - x);
+    if ((m & 0xffff0000) || (m & tetfeld[y])) return 0;
+  }
+  return 1;
+}
+
+/* -------------------------------------------------
+                        copyfig
+    kopiert die aktuelle Spielefigur in der
+    aktuellenk Rotationslage ins Spielegamefeld
+    mit der angegeben Figurnummer.
+
+    Die Figur ist mit drawfig bereits in derselben
+    Farbe gezeichnet, tetshown wird mitgefuehrt.
+   ------------------------------------------------- */
+void copyfig(char figx, char figy, uint16_t fig, uint8_t nr)
+{
+  int     x, y;
+  uint8_t r, i, m;
+
+  x= (signed char)figx;
+  for (r= 0; r< 4; r++)
+  {
+    m= figrow(fig, r);
+    if (!m) continue;
+
+    y= (signed char)figy + r;
+    tetfeld[y] |= (uint16_t)m << (12 - x);
+    for (i= 0; i< 4; i++)
+    {
+      if (m & (0x08 >> i))
+      {
+        tetcol[y][x+i]= nr;
+        tetshown[y][x+i]= nr;
+      }
+    }
+  }
+}
+
+void delrow(char nr)
+{
+  int y;
+
+  for (y= nr; y> 0; y--)
+  {
+    tetfeld[y]= tetfeld[y-1];
+    memcpy(tetcol[y], tetcol[y-1], gamcol+2);
+  }
+  tetfeld[0]= feld_leer;
+  memset(&tetcol[0][1], 0, gamcol);
+  scorecx++;
+  showscore();
+}
+
+char scangamefeld(void)
+//   Scant das Spielfeld auf vollstaendig ausgefuellte Reihen und
+//   entfernt eine solchige bei gleichzeitiger Erhoehung des
+//   Spielstands <scorecx>
+
+{
+  signed char y;
+  char retval;
+
+  retval= 0;
+  for (y= gamrows-2; y>= 0 ; y--)
+  {
+    if (tetfeld[y] == feld_voll)
+    {
+      delrow(y);
+      retval= 1;
+    }
+  }
+  return retval;
+}
+
+#else
+
 void gamefeld_init(void)
 {
   uint8_t x, y;
@@ -436,6 +627,8 @@ char scangamefeld(void)
   return retval;
 }
 
+#endif
+
 void checkdownrow(void)
 {
   copyfig(figx,figy,tetfigures[aktfig][aktrot],aktfig+1);
@@ -519,6 +712,12 @@ int main(void)
       loopcx= outerloop;
       drawfig(figx,figy,tetfigures[aktfig][aktrot],aktfig+9,1);
 
+      #if (tft_tilecache == 1)
+        // waehrend des Spiels in den Kachelpuffer zeichnen: das Loeschen und
+        // Neuzeichnen einer Figur wird je Frame als ein Bereich gesendet
+        tft_tiles_enable(1);
+      #endif
+
       gameover= 0;
       while((gameover==0) && (endgame== 0))
       {
@@ -582,11 +781,26 @@ int main(void)
             }
             break;
           case 4:
-            while (canposxy(figx,figy+1,tetfigures[aktfig][aktrot])) {figy++;}
+            #if (bitfeld == 1)
+              // drawfeld zeichnet nur geaenderte Felder: Figur an der alten Position
+              // loeschen und an der Endposition zeichnen (copyfig setzt das voraus)
+              hb= figy;
+              while (canposxy(figx,figy+1,tetfigures[aktfig][aktrot])) {figy++;}
+              if (figy != hb)
+              {
+                drawfig(figx,hb,tetfigures[aktfig][aktrot],aktfig+9,0);
+                drawfig(figx,figy,tetfigures[aktfig][aktrot],aktfig+9,1);
+              }
+            #else
+              while (canposxy(figx,figy+1,tetfigures[aktfig][aktrot])) {figy++;}
+            #endif
             showscore();
             checkdownrow();
             break;
         }
+        #if (tft_tilecache == 1)
+          tft_tiles_flush();
+        #endif
 
         if (innerloop> 0)
         {
@@ -633,8 +847,14 @@ int main(void)
             showscore();
             checkdownrow();
           }
+          #if (tft_tilecache == 1)
+            tft_tiles_flush();
+          #endif
         }
       }
+      #if (tft_tilecache == 1)
+        tft_tiles_enable(0);
+      #endif
       if (!endgame)
       {
         for (y= 0; y < gamrows-1; y++)
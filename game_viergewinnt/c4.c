@@ -91,6 +91,12 @@ void c4_poll(void (*poll_func)(void), clock_t interval)
   poll_interval = interval;
 }
 
+/* Knotenbudget wird nur von c4_bb.c ausgewertet */
+void c4_budget(uint32_t nodes)
+{
+  (void) nodes;
+}
+
 void c4_new_game(int width, int height, int num)
 {
   register int i, j, k, x;
@@ -21,14 +21,24 @@
 #define C4_DEFINED
 
 #include <time.h>
+#include <stdint.h>
 #include <stdbool.h>
 
 #define C4_NONE      2
 #define C4_MAX_LEVEL 20
 
+/* Nur fuer die Bitboard-Engine c4_bb.c (Auswahl im Makefile):          */
+/* Tabellengroessen, statischer Ram-Bedarf ca. 8 * c4_ttsize + 2 KByte  */
+
+#define c4_ttsize        512       /* Eintraege Transpositionstabelle (2er-Potenz) */
+#define c4_maxcols       16        /* max. Spielfeldbreite                           */
+#define c4_maxlines      128       /* max. Anzahl Gewinnreihen                       */
+#define c4_linespercell  16        /* max. Gewinnreihen durch ein Feld               */
+
 /* See the file "c4.c" for documentation on the following functions. */
 
 extern void    c4_poll(void (*poll_func)(void), clock_t interval);
+extern void    c4_budget(uint32_t nodes);
 extern void    c4_new_game(int width, int height, int num);
 extern bool    c4_make_move(int player, int column, int *row);
 extern bool    c4_auto_move(int player, int level, int *column, int *row);
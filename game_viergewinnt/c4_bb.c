@@ -0,0 +1,689 @@
+/* -------------------------------------------------------
+                           c4_bb.c
+
+     Alternative Spielstaerke-Engine fuer "Vier gewinnt"
+     mit derselben Schnittstelle wie c4.c (c4.h), die
+     Auswahl erfolgt im Makefile (c4.o oder c4_bb.o).
+
+     Unterschiede zu c4.c:
+
+       - Spielfeld als 64-Bit Bitboards (je Spieler eine
+         Maske, Spalte x belegt die Bits x*(hoehe+1) ..
+         x*(hoehe+1)+hoehe-1, ein Leerbit je Spalte)
+       - Zuege werden gesetzt und zurueckgenommen, es
+         wird kein Spielstand kopiert und kein Speicher
+         alloziert (kein malloc)
+       - die Bewertung (Anzahl und Fuellgrad der noch
+         moeglichen Gewinnreihen) ist identisch zu c4.c
+         und wird beim Setzen / Zuruecknehmen inkrementell
+         nachgefuehrt
+       - inkrementeller Zobrist-Hash und Transpositions-
+         tabelle fester Groesse (c4_ttsize Eintraege zu
+         8 Bytes)
+       - iterative Vertiefung, der beste Zug der vorher-
+         gehenden Iteration bzw. aus der Transpositions-
+         tabelle wird zuerst untersucht
+       - Knotenbudget (c4_budget) anstelle der Zeitab-
+         frage per clock(): wird es ueberschritten, gilt
+         das Ergebnis der letzten vollstaendigen Iteration
+
+     Einschraenkung: (hoehe+1) * breite <= 64, breite
+     <= c4_maxcols, Anzahl Gewinnreihen <= c4_maxlines
+
+     Ram-Bedarf (Standardwerte): ca. 6 KByte statisch
+
+     18.10.2026
+   ------------------------------------------------------ */
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <assert.h>
+#include "c4.h"
+
+#define other(x)        ((x) ^ 1)
+#define real_player(x)  ((x) & 1)
+
+#define c4_inf          32000                   // groesser als jede Bewertung
+#define c4_win          30000                   // Gewinn in ply Zuegen: c4_win - ply
+#define c4_winlimit     (c4_win - 100)          // ab hier ist ein Wert ein Gewinnwert
+
+#define tt_exact        0
+#define tt_lower        1
+#define tt_upper        2
+#define tt_nomove       0x3f
+
+/* ------------------------------------------------------
+                   Spielstand (Bitboards)
+   ------------------------------------------------------ */
+
+static int      size_x, size_y, total_size;
+static int      num_to_connect;
+static int      win_places;
+static uint8_t  colh;                           // size_y + 1 (Bits je Spalte)
+
+static uint64_t bb_pos[2];                      // Steine der Spieler
+static uint64_t bb_mask;                        // alle Steine
+static uint64_t bb_bottom[c4_maxcols];          // unterstes Bit einer Spalte
+static uint64_t bb_top[c4_maxcols];             // oberstes Bit einer Spalte
+static uint64_t bb_col[c4_maxcols];             // alle Felder einer Spalte
+static int      num_of_pieces;
+static int      winner;
+
+static char     board_cells[64];                // Spalte x ab board_cells[x * colh]
+static char     *board_cols[c4_maxcols];        // fuer c4_board() (char **)
+
+/* ------------------------------------------------------
+     Bewertung wie in c4.c: fuer jede noch moegliche
+     Gewinnreihe eines Spielers (kein gegnerischer Stein
+     darin) zaehlt 2^(Anzahl eigener Steine),
+     score[spieler] ist die Summe ueber alle Reihen
+   ------------------------------------------------------ */
+
+static uint8_t  line_cnt[2][c4_maxlines];       // Steine eines Spielers in einer Reihe
+static uint8_t  cell_lines[64][c4_linespercell];// Reihen durch ein Feld (Index = Bitnummer)
+static uint8_t  cell_nlines[64];
+static int      score[2];
+
+/* ------------------------------------------------------
+                Zobrist-Hash, Transpositionstabelle
+   ------------------------------------------------------ */
+
+static uint32_t zob[2][64];
+static uint32_t zob_side;
+static uint32_t hash;
+
+static uint32_t tt_key[c4_ttsize];
+static int16_t  tt_val[c4_ttsize];
+static uint8_t  tt_depth[c4_ttsize];
+static uint8_t  tt_info[c4_ttsize];             // Bit 7..6 : Art des Wertes, Bit 5..0 : bester Zug
+
+/* ------------------------------------------------------
+                        Suche
+   ------------------------------------------------------ */
+
+static bool     game_in_progress = false, move_in_progress = false;
+static bool     seed_chosen = false;
+static uint8_t  drop_order[c4_maxcols];
+static int      side;                           // Spieler am Zug waehrend der Suche
+
+static void     (*poll_function)(void) = NULL;
+static uint32_t poll_interval, next_poll;
+static uint32_t node_budget = 0;
+static bool     search_aborted;
+
+static uint32_t c4_nodes;                       // untersuchte Stellungen je Computerzug
+
+/* ------------------------------------------------------
+                  Lokale Funktionen
+   ------------------------------------------------------ */
+
+/* ----------------------------------------------------------
+     line_get
+
+     liefert Startfeld und Richtung der Gewinnreihe nr in
+     derselben Reihenfolge wie c4.c (waagerecht, senkrecht,
+     diagonal steigend, diagonal fallend).
+     Rueckgabe: 0 = keine Reihe nr vorhanden
+   ---------------------------------------------------------- */
+static uint8_t line_get(int nr, int *x, int *y, int *dx, int *dy)
+{
+  int n, cnt;
+
+  n= num_to_connect;
+
+  cnt= (size_x-n+1 > 0) ? size_y * (size_x-n+1) : 0;            // waagerecht
+  if (nr < cnt) { *y= nr / (size_x-n+1); *x= nr % (size_x-n+1); *dx= 1; *dy= 0; return 1; }
+  nr -= cnt;
+
+  cnt= (size_y-n+1 > 0) ? size_x * (size_y-n+1) : 0;            // senkrecht
+  if (nr < cnt) { *x= nr / (size_y-n+1); *y= nr % (size_y-n+1); *dx= 0; *dy= 1; return 1; }
+  nr -= cnt;
+
+  cnt= ((size_x-n+1 > 0) && (size_y-n+1 > 0)) ? (size_y-n+1) * (size_x-n+1) : 0;
+  if (nr < cnt) { *y= nr / (size_x-n+1); *x= nr % (size_x-n+1); *dx= 1; *dy= 1; return 1; }
+  nr -= cnt;
+
+  if (nr < cnt) { *y= nr / (size_x-n+1); *x= size_x-1 - (nr % (size_x-n+1)); *dx= -1; *dy= 1; return 1; }
+
+  return 0;
+}
+
+/* ----------------------------------------------------------
+     is_connected
+
+     prueft ob im Bitboard b num_to_connect Steine in
+     einer Reihe liegen
+   ---------------------------------------------------------- */
+static bool is_connected(uint64_t b)
+{
+  uint64_t m;
+  int      d, k, s;
+
+  for (d= 0; d < 4; d++)
+  {
+    s= (d == 0) ? 1 : colh + d - 2;           // senkrecht, diagonal fallend, waagerecht, steigend
+    if (num_to_connect == 4)
+    {
+      m= b & (b >> s);
+      if (m & (m >> (2*s))) return true;
+    }
+    else
+    {
+      m= b;
+      for (k= 1; (k < num_to_connect) && m; k++) m &= b >> (k*s);
+      if (m) return true;
+    }
+  }
+  return false;
+}
+
+/* ----------------------------------------------------------
+     score_update
+
+     traegt die Aenderung der Bewertung fuer einen Stein
+     von player auf Feld bit ein (dir = 1 : setzen,
+     dir = -1 : zuruecknehmen)
+   ---------------------------------------------------------- */
+static void score_update(int player, int bit, int dir)
+{
+  int     i, a, b, dme, dop;
+  uint8_t l;
+
+  dme= 0; dop= 0;
+  for (i= 0; i < cell_nlines[bit]; i++)
+  {
+    l= cell_lines[bit][i];
+    if (dir < 0) line_cnt[player][l]--;
+    a= line_cnt[player][l];
+    b= line_cnt[other(player)][l];
+    if (!b) dme += 1 << a;                    // eigene Reihe: 2^a -> 2^(a+1)
+    if (!a) dop += 1 << b;                    // gegnerische Reihe faellt weg
+    if (dir > 0) line_cnt[player][l]++;
+  }
+  score[player] += dir * dme;
+  score[other(player)] -= dir * dop;
+}
+
+/* ----------------------------------------------------------
+     play
+
+     setzt einen Stein von player in Spalte col (Spalte
+     darf nicht voll sein).
+     Rueckgabe: true, wenn player damit gewonnen hat
+   ---------------------------------------------------------- */
+static bool play(int player, int col)
+{
+  uint64_t m;
+  int      bit;
+
+  m= (bb_mask + bb_bottom[col]) & bb_col[col];   // Uebertrag landet im untersten freien Feld
+  bit= __builtin_ctzll(m);
+  bb_mask |= m;
+  bb_pos[player] |= m;
+  num_of_pieces++;
+  hash ^= zob[player][bit] ^ zob_side;
+  score_update(player, bit, 1);
+  return is_connected(bb_pos[player]);
+}
+
+/* ----------------------------------------------------------
+     unplay
+
+     nimmt den obersten Stein aus Spalte col zurueck
+   ---------------------------------------------------------- */
+static void unplay(int col)
+{
+  uint64_t m;
+  int      bit, player;
+
+  m= bb_mask & bb_col[col];
+  bit= 63 - __builtin_clzll(m);
+  m= (uint64_t)1 << bit;
+  player= (bb_pos[1] & m) ? 1 : 0;
+  bb_mask &= ~m;
+  bb_pos[player] &= ~m;
+  num_of_pieces--;
+  hash ^= zob[player][bit] ^ zob_side;
+  score_update(player, bit, -1);
+}
+
+#define col_full(col)   (bb_mask & bb_top[col])
+
+/* ----------------------------------------------------------
+     tt_store, tt_probe
+
+     Gewinnwerte werden relativ zur aktuellen Stellung
+     abgelegt (unabhaengig von der Suchtiefe, in der die
+     Stellung erreicht wurde)
+   ---------------------------------------------------------- */
+static void tt_store(int ply, int depth, int value, uint8_t flag, uint8_t move)
+{
+  uint16_t i;
+
+  i= hash & (c4_ttsize-1);
+  if ((tt_key[i] == hash) && (tt_depth[i] > depth)) return;
+
+  if (value > c4_winlimit) value += ply;
+  else if (value < -c4_winlimit) value -= ply;
+
+  tt_key[i]= hash;
+  tt_val[i]= value;
+  tt_depth[i]= depth;
+  tt_info[i]= (flag << 6) | move;
+}
+
+static int tt_value(uint16_t i, int ply)
+{
+  int v;
+
+  v= tt_val[i];
+  if (v > c4_winlimit) v -= ply;
+  else if (v < -c4_winlimit) v += ply;
+  return v;
+}
+
+/* ----------------------------------------------------------
+     negamax
+
+     Alpha-Beta Suche, Bewertung aus Sicht des Spielers am
+     Zug (side). ply: Tiefe ab der Wurzel, depth: Rest-
+     tiefe. Gewinnwerte und Blattbewertung entsprechen
+     evaluate() in c4.c.
+   ---------------------------------------------------------- */
+static int negamax(int ply, int depth, int alpha, int beta)
+{
+  int     i, col, v, best, a0;
+  uint8_t ttmove, bestmove;
+  uint16_t ti;
+
+  c4_nodes++;
+  if (poll_function != NULL && c4_nodes >= next_poll)
+  {
+    next_poll += poll_interval;
+    (*poll_function)();
+  }
+  if (node_budget && c4_nodes > node_budget)
+  {
+    search_aborted= true;
+    return 0;
+  }
+
+  if (num_of_pieces == total_size) return 0;                 // unentschieden
+  if (depth == 0) return score[side] - score[other(side)];
+
+  ttmove= tt_nomove;
+  ti= hash & (c4_ttsize-1);
+  if (tt_key[ti] == hash)
+  {
+    ttmove= tt_info[ti] & 0x3f;
+    if (tt_depth[ti] >= depth)
+    {
+      v= tt_value(ti, ply);
+      switch (tt_info[ti] >> 6)
+      {
+        case tt_exact : return v;
+        case tt_lower : if (v > alpha) alpha= v; break;
+        case tt_upper : if (v < beta) beta= v; break;
+      }
+      if (alpha >= beta) return v;
+    }
+  }
+  a0= alpha;
+
+  best= -c4_inf;
+  bestmove= tt_nomove;
+  for (i= -1; i < size_x; i++)
+  {
+    if (i < 0)
+    {
+      if (ttmove == tt_nomove) continue;
+      col= ttmove;                            // Zug aus der Tabelle zuerst
+    }
+    else
+    {
+      col= drop_order[i];
+      if (col == ttmove) continue;
+    }
+    if (col_full(col)) continue;
+
+    if (play(side, col))
+    {
+      v= c4_win - (ply+1);
+    }
+    else
+    {
+      side= other(side);
+      v= -negamax(ply+1, depth-1, -beta, -(alpha > best ? alpha : best));
+      side= other(side);
+    }
+    unplay(col);
+    if (search_aborted) return 0;
+
+    if (v > best)
+    {
+      best= v;
+      bestmove= col;
+      if (best >= beta) break;
+    }
+  }
+
+  if (best <= a0)        tt_store(ply, depth, best, tt_upper, bestmove);
+  else if (best >= beta) tt_store(ply, depth, best, tt_lower, bestmove);
+  else                   tt_store(ply, depth, best, tt_exact, bestmove);
+
+  return best;
+}
+
+/* ----------------------------------------------------------
+     search_root
+
+     eine Iteration der Suche mit Tiefe level. Gleich gute
+     Zuege werden wie in c4.c zufaellig gewaehlt.
+     Rueckgabe: gewaehlte Spalte oder -1
+   ---------------------------------------------------------- */
+static int search_root(int player, int level, int first)
+{
+  int i, col, v, best_worst, best_column, num_of_equal;
+
+  best_worst= -c4_inf;
+  best_column= -1;
+  num_of_equal= 0;
+
+  for (i= -1; i < size_x; i++)
+  {
+    if (i < 0)
+    {
+      if (first < 0) continue;
+      col= first;                             // bester Zug der letzten Iteration
+    }
+    else
+    {
+      col= drop_order[i];
+      if (col == first) continue;
+    }
+    if (col_full(col)) continue;
+
+    if (play(player, col))
+    {
+      unplay(col);
+      return col;                             // sofortiger Gewinn
+    }
+    side= other(player);
+    // Fenster so, dass ein gleich guter Zug exakt bewertet wird
+    v= -negamax(1, level-1, -c4_inf, -best_worst+1);
+    unplay(col);
+    if (search_aborted) return -1;
+
+    if (v > best_worst)
+    {
+      best_worst= v;
+      best_column= col;
+      num_of_equal= 1;
+    }
+    else if (v == best_worst)
+    {
+      num_of_equal++;
+      if ((rand()>>4) % num_of_equal == 0) best_column= col;
+    }
+  }
+  return best_column;
+}
+
+/* ----------------------------------------------------------
+     drop_piece
+
+     ausgefuehrter Spielzug (nicht waehrend der Suche),
+     Rueckgabe: Zeile oder -1 wenn die Spalte voll ist
+   ---------------------------------------------------------- */
+static int drop_piece(int player, int column)
+{
+  int row;
+
+  if (col_full(column)) return -1;
+  row= __builtin_popcountll(bb_mask & bb_col[column]);
+  if (play(player, column) && (winner == C4_NONE)) winner= player;
+  board_cols[column][row]= player;
+  return row;
+}
+
+/* ------------------------------------------------------
+                  Oeffentliche Funktionen
+   ------------------------------------------------------ */
+
+/* ----------------------------------------------------------
+     c4_poll
+
+     poll_func wird waehrend der Suche alle interval
+     untersuchten Stellungen aufgerufen (anstelle einer
+     Zeitabfrage wie in c4.c)
+   ---------------------------------------------------------- */
+void c4_poll(void (*poll_func)(void), clock_t interval)
+{
+  poll_function= poll_func;
+  poll_interval= interval;
+}
+
+/* ----------------------------------------------------------
+     c4_budget
+
+     begrenzt die Anzahl untersuchter Stellungen je
+     Computerzug (0 = unbegrenzt). Bei Ueberschreitung
+     wird der Zug der letzten vollstaendig durchsuchten
+     Tiefe ausgefuehrt.
+   ---------------------------------------------------------- */
+void c4_budget(uint32_t nodes)
+{
+  node_budget= nodes;
+}
+
+void c4_new_game(int width, int height, int num)
+{
+  int      i, j, k, x, y, dx, dy, bit, column;
+  uint32_t r;
+
+  assert(!game_in_progress);
+  assert(width >= 1 && height >= 1 && num >= 1);
+  assert(width <= c4_maxcols && (height+1) * width <= 64);
+
+  size_x= width;
+  size_y= height;
+  total_size= width * height;
+  num_to_connect= num;
+  colh= height + 1;
+
+  if (!seed_chosen)
+  {
+    srand(95);
+    seed_chosen= true;
+  }
+
+  for (i= 0; i < size_x; i++)
+  {
+    bb_bottom[i]= (uint64_t)1 << (i * colh);
+    bb_top[i]= (uint64_t)1 << (i * colh + size_y - 1);
+    bb_col[i]= (bb_top[i] - bb_bottom[i]) | bb_top[i];
+    board_cols[i]= &board_cells[i * colh];
+    for (j= 0; j < size_y; j++) board_cols[i][j]= C4_NONE;
+  }
+  bb_pos[0]= 0; bb_pos[1]= 0; bb_mask= 0;
+  num_of_pieces= 0;
+  winner= C4_NONE;
+
+  // Gewinnreihen den Feldern zuordnen
+  for (i= 0; i < 64; i++) cell_nlines[i]= 0;
+  win_places= 0;
+  while (line_get(win_places, &x, &y, &dx, &dy))
+  {
+    assert(win_places < c4_maxlines);
+    for (k= 0; k < num; k++)
+    {
+      bit= (x + k*dx) * colh + y + k*dy;
+      assert(cell_nlines[bit] < c4_linespercell);
+      cell_lines[bit][cell_nlines[bit]++]= win_places;
+    }
+    line_cnt[0][win_places]= 0;
+    line_cnt[1][win_places]= 0;
+    win_places++;
+  }
+  score[0]= score[1]= win_places;
+
+  // Zobrist-Schluessel (xorshift32)
+  r= 0x9e3779b9;
+  for (i= 0; i < 2; i++)
+    for (j= 0; j < 64; j++)
+    {
+      r ^= r << 13; r ^= r >> 17; r ^= r << 5;
+      zob[i][j]= r;
+    }
+  r ^= r << 13; r ^= r >> 17; r ^= r << 5;
+  zob_side= r;
+  hash= 0;
+
+  for (i= 0; i < c4_ttsize; i++) { tt_key[i]= 0xffffffff; tt_depth[i]= 0; tt_info[i]= tt_nomove; }
+
+  column= (size_x-1) / 2;
+  for (i= 1; i <= size_x; i++)
+  {
+    drop_order[i-1]= column;
+    column += ((i%2) ? i : -i);
+  }
+
+  game_in_progress= true;
+}
+
+bool c4_make_move(int player, int column, int *row)
+{
+  int result;
+
+  assert(game_in_progress);
+  assert(!move_in_progress);
+
+  if (column >= size_x || column < 0) return false;
+
+  result= drop_piece(real_player(player), column);
+  if (row != NULL && result >= 0) *row= result;
+  return (result >= 0);
+}
+
+/* ----------------------------------------------------------
+     c4_auto_move
+
+     sucht mit iterativer Vertiefung (Tiefe 1 .. level) den
+     besten Zug fuer player und fuehrt ihn aus
+   ---------------------------------------------------------- */
+bool c4_auto_move(int player, int level, int *column, int *row)
+{
+  int d, col, best_column, result, real_player;
+
+  assert(game_in_progress);
+  assert(!move_in_progress);
+  assert(level >= 1 && level <= C4_MAX_LEVEL);
+
+  real_player= real_player(player);
+
+  // Eroeffnung wie in c4.c: mittlere Spalte
+  if (num_of_pieces < 2 &&
+      size_x == 7 && size_y == 6 && num_to_connect == 4 &&
+      (num_of_pieces == 0 || board_cols[3][0] != C4_NONE))
+  {
+    if (column != NULL) *column= 3;
+    if (row != NULL) *row= num_of_pieces;
+    drop_piece(real_player, 3);
+    return true;
+  }
+
+  move_in_progress= true;
+  c4_nodes= 0;
+  next_poll= poll_interval;
+  search_aborted= false;
+
+  best_column= -1;
+  for (d= 1; d <= level; d++)
+  {
+    col= search_root(real_player, d, best_column);
+    if (search_aborted) break;
+    best_column= col;
+    if (best_column < 0) break;
+  }
+
+  move_in_progress= false;
+
+  if (best_column >= 0)
+  {
+    result= drop_piece(real_player, best_column);
+    if (column != NULL) *column= best_column;
+    if (row != NULL) *row= result;
+    return true;
+  }
+  return false;
+}
+
+char **c4_board(void)
+{
+  assert(game_in_progress);
+  return board_cols;
+}
+
+int c4_score_of_player(int player)
+{
+  assert(game_in_progress);
+  return score[real_player(player)];
+}
+
+bool c4_is_winner(int player)
+{
+  assert(game_in_progress);
+  return (winner == real_player(player));
+}
+
+bool c4_is_tie(void)
+{
+  assert(game_in_progress);
+  return (num_of_pieces == total_size && winner == C4_NONE);
+}
+
+/* ----------------------------------------------------------
+     c4_win_coords
+
+     Anfangs- und Endfeld der (ersten) Gewinnreihe, wie
+     in c4.c liegt x1,y1 in der unteren Zeile der Reihe
+   ---------------------------------------------------------- */
+void c4_win_coords(int *x1, int *y1, int *x2, int *y2)
+{
+  int nr, k, x, y, dx, dy;
+
+  assert(game_in_progress);
+  assert(winner != C4_NONE);
+
+  for (nr= 0; line_get(nr, &x, &y, &dx, &dy); nr++)
+  {
+    for (k= 0; k < num_to_connect; k++)
+      if (board_cols[x + k*dx][y + k*dy] != winner) break;
+    if (k == num_to_connect)
+    {
+      *x1= x; *y1= y;
+      *x2= x + (num_to_connect-1)*dx;
+      *y2= y + (num_to_connect-1)*dy;
+      return;
+    }
+  }
+}
+
+void c4_end_game(void)
+{
+  assert(game_in_progress);
+  assert(!move_in_progress);
+  game_in_progress= false;
+}
+
+void c4_reset(void)
+{
+  assert(!move_in_progress);
+  if (game_in_progress) c4_end_game();
+  poll_function= NULL;
+}
+
+const char *c4_get_version(void)
+{
+  return "c4_bb.c 1.0 (Bitboard)";
+}
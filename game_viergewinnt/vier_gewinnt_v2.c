@@ -437,9 +437,10 @@ int main(void)
 
     turn= 0;                          // 0 = Spieler beginnt, 1 = Computer beginnt
 
-    level[1]= 7;
+    level[1]= 9;
 
     c4_new_game(width, height, 4);
+    c4_budget(300000);                // max. untersuchte Stellungen je Computerzug
     selectpos= 3;
 
     do {
@@ -0,0 +1,280 @@
+/* -------------------------------------------------------
+                        tft_alt.c
+
+   Urspruengliche Textausgabe und showimage aus
+   src/tftdisplay.c (Stand vor der Fensterausgabe): jeder
+   gesetzte Punkt eines Zeichens bzw. Bitmaps wird einzeln
+   mit putpixeltx / putpixel gezeichnet, bei textsize 1
+   vier Punkte je Fontbit.
+
+   Dazu fillellipse und fillcircle vor tft_spanfill.c:
+   jede Zeile wird je Bresenham-Schritt erneut (und nicht
+   beschnitten) mit fastxline gezeichnet.
+
+   Die Funktionen sind bis auf den Vorsatz alt_ unveraen-
+   dert und dienen den Testrahmen als Vergleich.
+  -------------------------------------------------------- */
+
+#include "tftdisplay.h"
+#include "tft_alt.h"
+
+#if (fnt8x8_enable == 1)
+  #include "font8x8.fnt"
+#endif
+#if (fnt12x16_enable == 1)
+  #include "font12x16.fnt"
+#endif
+
+extern uint8_t txoutmode;
+void putpixeltx(int x, int y, uint16_t color);
+
+/* --------------------------------------------------
+     alt_lcd_putchar8x8
+   -------------------------------------------------- */
+void alt_lcd_putchar8x8(unsigned char ch)
+{
+
+  #if (fnt8x8_enable == 1)
+
+    uint8_t   i,i2;
+    uint8_t   b;
+    int       oldx,oldy;
+    uint16_t  fontint;
+    uint16_t  fmask;
+
+    if (ch== 13)                                          // Fuer <printf> "/r" Implementation
+    {
+      aktxp= 0;
+      return;
+    }
+    if (ch== 10)                                          // fuer <printf> "/n" Implementation
+    {
+      aktyp= aktyp+fontsizey+(fontsizey*textsize);
+      return;
+    }
+
+    fmask= 1<<(fontsizex-1);
+
+    oldx= aktxp;
+    oldy= aktyp;
+    for (i=0; i<fontsizey; i++)
+    {
+      b= font8x8[(ch-32)][i];
+      fontint= b;
+
+      for (i2= 0; i2<fontsizex; i2++)
+      {
+        if (fmask & fontint)
+        {
+          putpixeltx(oldx,oldy,textcolor);
+          if ((textsize==1))
+          {
+            putpixeltx(oldx+1,oldy,textcolor);
+            putpixeltx(oldx,oldy+1,textcolor);
+            putpixeltx(oldx+1,oldy+1,textcolor);
+          }
+        }
+        else
+        {
+          if (fntfilled)
+          {
+            putpixeltx(oldx,oldy,bkcolor);
+            if ((textsize==1))
+            {
+              putpixeltx(oldx+1,oldy,bkcolor);
+              putpixeltx(oldx,oldy+1,bkcolor);
+              putpixeltx(oldx+1,oldy+1,bkcolor);
+            }
+          }
+        }
+        fontint= fontint<<1;
+        oldx= oldx+1+textsize;
+      }
+      oldy++;
+      if ((textsize==1)) {oldy++; }
+      oldx= aktxp;
+    }
+    aktxp= aktxp+fontsizex+(fontsizex*textsize);
+
+  #endif
+}
+
+/* --------------------------------------------------
+     alt_lcd_putchar12x16
+   -------------------------------------------------- */
+void alt_lcd_putchar12x16(unsigned char ch)
+{
+
+  #if (fnt12x16_enable == 1)
+
+    uint8_t   i,i2;
+    uint16_t  b;
+    int       oldx,oldy;
+    uint16_t  fontint;
+    uint16_t  fmask;
+    uint16_t  findex;
+
+    if (ch== 13)                                          // Fuer <printf> "/r" Implementation
+    {
+      aktxp= 0;
+      return;
+    }
+    if (ch== 10)                                          // fuer <printf> "/n" Implementation
+    {
+      aktyp= aktyp+16+(16*textsize);
+      return;
+    }
+
+    fmask= 1<<(16-1);
+    oldx= aktxp;
+    oldy= aktyp;
+    for (i=0; i<16; i++)
+    {
+      findex= (ch-32);
+      b= (font12x16[findex][i*2])<<4;
+      b|= ((font12x16[findex][(i*2)+1])<<12);
+      fontint= b;
+
+      for (i2= 0; i2<12; i2++)
+      {
+        if (fmask & fontint)
+        {
+          putpixeltx(oldx,oldy,textcolor);
+          if ((textsize==1))
+          {
+            putpixeltx(oldx+1,oldy,textcolor);
+            putpixeltx(oldx,oldy+1,textcolor);
+            putpixeltx(oldx+1,oldy+1,textcolor);
+          }
+        }
+        else
+        {
+          if (fntfilled)
+          {
+            putpixeltx(oldx,oldy,bkcolor);
+            if ((textsize==1))
+            {
+              putpixeltx(oldx+1,oldy,bkcolor);
+              putpixeltx(oldx,oldy+1,bkcolor);
+              putpixeltx(oldx+1,oldy+1,bkcolor);
+            }
+          }
+        }
+        fontint= fontint<<1;
+        oldx= oldx+1+textsize;
+      }
+      oldy++;
+      if ((textsize==1)) {oldy++; }
+      oldx= aktxp;
+    }
+    if (textsize==1) aktxp= aktxp + 24; else aktxp = aktxp +12;
+
+  #endif
+}
+
+/* --------------------------------------------------
+     alt_lcd_putchar
+   -------------------------------------------------- */
+void alt_lcd_putchar(char ch)
+{
+  switch (fontnr)
+  {
+    case 0:  alt_lcd_putchar8x8(ch); break;
+    case 1:  alt_lcd_putchar12x16(ch); break;
+    case 2:  lcd_putchar5x7(ch); break;
+    default: break;
+  }
+}
+
+/* --------------------------------------------------
+     alt_outtextxy
+   -------------------------------------------------- */
+void alt_outtextxy(int x, int y, uint8_t dir, char *dataPtr)
+{
+  uint8_t oldfill, oldx, oldy;
+
+  unsigned char c;
+  int tmp;
+
+  if (dir)
+  {
+    txoutmode= 1;
+    x= _xres-x-fontsizex;
+    tmp= x; x= y; y= tmp;
+  }
+
+  oldfill= fntfilled;
+  fntfilled= 0;
+  oldx= aktxp; oldy= aktyp;
+
+  aktxp= x; aktyp= y;
+  for (c= *dataPtr; c; ++dataPtr, c= *dataPtr)
+  {
+    alt_lcd_putchar(c);
+  }
+  fntfilled= oldfill; aktxp= oldx; aktyp= oldy;
+  txoutmode= 0;
+}
+
+/* ----------------------------------------------------------
+     alt_showimage
+   ---------------------------------------------------------- */
+void alt_showimage(uint16_t ox, uint16_t oy, const unsigned char* const image, uint16_t fwert)
+{
+  int x,y;
+  uint8_t b,bp;
+  uint16_t resX, resY;
+
+  resX= (image[0] << 8) + image[1];
+  resY= (image[2] << 8) + image[3];
+  if ((resX % 8) == 0) { resX= resX / 8; }
+                 else  { resX= (resX / 8)+1; }
+
+  for (y=0;y< resY;y++)
+  {
+    for (x= 0;x<resX;x++)
+    {
+      b= image[y *resX +x+4];
+      for (bp=8;bp>0;bp--)
+      {
+        if (b & (1 << (bp-1))) {putpixel(ox+(x*8)+8-bp,oy+y,fwert);}
+      }
+    }
+  }
+}
+
+/* -------------------------------------------------------------
+     alt_fillellipse
+   ------------------------------------------------------------- */
+void alt_fillellipse(int xm, int ym, int a, int b, uint16_t color )
+{
+  // Algorithmus nach Bresenham (www.wikipedia.org)
+
+  int dx = 0, dy = b;                       // im I. Quadranten von links oben nach rechts unten
+  long a2 = a*a, b2 = b*b;
+  long err = b2-(2*b-1)*a2, e2;             // Fehler im 1. Schritt */
+
+  do
+  {
+    fastxline(xm+dx, ym+dy,xm-dx, color);            // I. und II.   Quadrant
+    fastxline(xm-dx, ym-dy,xm+dx, color);            // III. und IV. Quadrant
+
+    e2 = 2*err;
+    if (e2 <  (2*dx+1)*b2) { dx++; err += (2*dx+1)*b2; }
+    if (e2 > -(2*dy-1)*a2) { dy--; err -= (2*dy-1)*a2; }
+  } while (dy >= 0);
+
+  while (dx++ < a)                        // fehlerhafter Abbruch bei flachen Ellipsen (b=1)
+  {
+    putpixel(xm+dx, ym,color);             // -> Spitze der Ellipse vollenden
+    putpixel(xm-dx, ym,color);
+  }
+}
+
+/* -------------------------------------------------------------
+     alt_fillcircle
+   ------------------------------------------------------------- */
+void alt_fillcircle(int x, int y, int r, uint16_t color )
+{
+  alt_fillellipse(x,y,r,r,color);
+}
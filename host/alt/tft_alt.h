@@ -0,0 +1,33 @@
+/* -------------------------------------------------------
+                        tft_alt.h
+
+   Urspruengliche Zeichenfunktionen (Einzelpunktausgabe
+   ueber putpixel / putpixeltx) als Vergleich fuer die
+   Testrahmen. Die Funktionen entsprechen dem Stand von
+   src/tftdisplay.c und src/gfx_pictures.c vor der
+   Fensterausgabe bzw. vor tft_spanfill.c, sie benutzen putpixel und die
+   globalen Variablen des aktuellen tftdisplay.c.
+  -------------------------------------------------------- */
+
+#ifndef in_tft_alt
+  #define in_tft_alt
+
+  #include <stdint.h>
+
+  // tft_alt.c
+  void alt_lcd_putchar8x8(unsigned char ch);
+  void alt_lcd_putchar12x16(unsigned char ch);
+  void alt_lcd_putchar(char ch);
+  void alt_outtextxy(int x, int y, uint8_t dir, char *dataPtr);
+  void alt_showimage(uint16_t ox, uint16_t oy, const unsigned char* const image, uint16_t fwert);
+  void alt_fillellipse(int xm, int ym, int a, int b, uint16_t color );
+  void alt_fillcircle(int x, int y, int r, uint16_t color );
+
+  // gfx_pictures_alt.c
+  void alt_bmpsw_show(uint16_t ox, uint16_t oy, const unsigned char* const image, uint16_t fwert);
+  void alt_bmpcga_show(int ox, int oy, const uint8_t* const image, const uint16_t* const pal);
+  void alt_bmp16_show(int16_t ox, int16_t oy, const uint8_t* const image, const uint16_t* const palette);
+  void alt_bmp256_show(uint16_t ox, uint16_t oy, const uint8_t* const image, const uint16_t* const palette);
+  void alt_pcx256_show(int16_t x, int16_t y, const unsigned char* const image, const uint16_t *const pal);
+
+#endif
@@ -0,0 +1,387 @@
+/* -------------------------------------------------------
+                      bilder_bench.c
+
+   Pixel je Sekunde der Bilddekoder von gfx_pictures.c
+   (Zeilenpipeline: Zeile dekodieren, Palette, Zeilen-
+   puffer, Fensterausgabe) je Format gegenueber den ur-
+   spruenglichen Dekodern mit putpixel je Bildpunkt
+   (../alt).
+
+   Je Format wird zuerst das Bild geprueft: die Bytes auf
+   dem Displaybus laufen in je eine Controller-Nachbildung
+   (lcdemu) fuer die alte und die aktuelle Ausgabe, beide
+   muessen dasselbe Bild zeigen. Danach wird die Zeit ge-
+   messen, die Bytes werden dabei nur gezaehlt.
+
+     bilder_spi : SPI (S6D02A1 128x160), Bild 128x160,
+                  D/C ueber host_spi_hook
+     bilder_par : 8-Bit Parallelbus (ILI9341 240x320),
+                  Bild 240x240, RS und D0..D7 bei jeder
+                  fallenden WR-Flanke ueber host_gpio_hook
+                  (die alten Dekoder adressieren das Bild
+                  mit 16 Bit, hoechstens 64 KByte)
+
+   Pixel je Sekunde sind die des PC (Rechenzeit von
+   tftdisplay.c, gfx_pictures.c und host_hal.c), nicht die
+   des STM32. Das Verhaeltnis alt / neu und die Bytes je
+   Pixel auf dem Displaybus sind uebertragbar.
+
+   Formate (Testbild wie ../burst, beim Start erzeugt):
+
+     bmpsw      : s/w, 1 Bit je Pixel
+     bmpcga     : 4 Farben, 2 Bit je Pixel
+     bmp16      : 16 Farben, unterste Zeile zuerst
+     bmp256     : 256 Farben, unterste Zeile zuerst
+     pcx256     : 256 Farben, RLE
+     bmp256_aus : 32x32 Ausschnitt (gfx_srcrect) aus
+                  bmp256, alt: putpixel je Bildpunkt des
+                  Ausschnitts (wie bmp256_show eine Zeile
+                  tiefer)
+
+   Rueckgabewert 1, wenn sich ein Bild unterscheidet.
+  -------------------------------------------------------- */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "tftdisplay.h"
+#include "gfx_pictures.h"
+#include "host_hal.h"
+#include "lcdemu.h"
+#include "tft_alt.h"
+
+#define mess_ns        100000000ull           // Mindestdauer einer Zeitmessung
+
+#define img_w          _xres
+#if (_yres > 240)
+  #define img_h        240
+#else
+  #define img_h        _yres
+#endif
+
+#define aus_x          32                     // Ausschnitt fuer bmp256_aus
+#define aus_y          40
+#define aus_w          32
+#define aus_h          32
+
+static lcdemu_t  emu_neu, emu_alt;
+static lcdemu_t *emu;                         // Ziel der Bus-Bytes, NULL : nur zaehlen
+static uint32_t  busbytes;
+static int       alt;                         // 1 : Ausgabe ueber die alten Funktionen
+
+#if (USE_SPI_TFT == 1)
+
+  static uint32_t dc_port;
+  static uint16_t dc_mask;
+
+  // Port und Pin von D/C aus den Makros in tft_pindefs.h ermitteln
+  static void find_dc(void)
+  {
+    uint16_t a, b;
+
+    dc_clr();
+    a= host_port(GPIOA); b= host_port(GPIOB);
+    dc_set();
+    if (host_port(GPIOA) != a) { dc_port= GPIOA; dc_mask= host_port(GPIOA) ^ a; }
+                          else { dc_port= GPIOB; dc_mask= host_port(GPIOB) ^ b; }
+  }
+
+  static void spi_decode(uint32_t spi, uint16_t data)
+  {
+    (void)spi;
+    busbytes++;
+    if (emu) lcdemu_byte(emu, (host_port(dc_port) & dc_mask) ? 1 : 0, data);
+  }
+
+  static void bus_ein(void) { find_dc(); host_spi_hook= spi_decode; }
+
+#else
+
+  #define port_nr(p)   ( ((p) - GPIOA) / (GPIOB - GPIOA) )
+  #define wr_bit       GPIO1                  // PA1, beide Boardversionen
+  #if (boardversion == 0)
+    #define rs_bit     GPIO2                  // PA2
+  #else
+    #define rs_bit     GPIO4                  // PA4
+  #endif
+
+  static uint16_t odr[3];                     // Spiegel der Ausgangsregister
+
+  // liest das an D0..D7 anliegende Byte aus den Ausgangsregistern (wie ../parfill)
+  static uint8_t busbyte(void)
+  {
+    uint16_t a= odr[0], b= odr[1];
+
+    #if (boardversion == 0)
+      (void)a;
+      return ((b >> 4) & 0xfc) | ((b >> 12) & 0x03);
+    #else
+      return ((b & 0x2000) ? 0x01 : 0) | ((b & 0x0080) ? 0x02 : 0)
+           | ((b & 0x0002) ? 0x04 : 0) | ((b & 0x0008) ? 0x08 : 0)
+           | ((b & 0x0020) ? 0x10 : 0) | ((b & 0x0010) ? 0x20 : 0)
+           | ((a & 0x8000) ? 0x40 : 0) | ((a & 0x0100) ? 0x80 : 0);
+    #endif
+  }
+
+  static void gpio_decode(uint32_t gpioport, uint16_t oldval, uint16_t newval)
+  {
+    uint32_t nr;
+
+    nr= port_nr(gpioport);
+    if (nr > 2) return;
+    odr[nr]= newval;
+    if ((nr == 0) && ((oldval ^ newval) & wr_bit) && !(newval & wr_bit))
+    {
+      busbytes++;
+      if (emu) lcdemu_byte(emu, (odr[0] & rs_bit) ? 1 : 0, busbyte());
+    }
+  }
+
+  static void bus_ein(void)
+  {
+    odr[0]= host_port(GPIOA); odr[1]= host_port(GPIOB); odr[2]= host_port(GPIOC);
+    host_gpio_hook= gpio_decode;
+  }
+
+#endif
+
+static uint32_t image_hash(const lcdemu_t *e)
+{
+  uint32_t h= 2166136261u;
+  uint16_t c;
+  int      x, y;
+
+  for (y= 0; y < e->h; y++)
+    for (x= 0; x < e->w; x++)
+    {
+      c= lcdemu_pixel(e, x, y);
+      h= (h ^ (c & 0xff)) * 16777619u;
+      h= (h ^ (c >> 8)) * 16777619u;
+    }
+  return h;
+}
+
+static uint64_t ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+/* -------------------------------------------------------
+                        Testbilder
+
+   Kopf (Breite, Hoehe), Bilddaten wie von image2c
+   ------------------------------------------------------- */
+
+static uint8_t  img_sw[4 + (img_w/8)*img_h];
+static uint8_t  img_cga[4 + (img_w/4)*img_h];
+static uint8_t  img_16[4 + (img_w/2)*img_h];
+static uint8_t  img_256[4 + img_w*img_h];
+static uint8_t  img_pcx[128 + 2*img_w*img_h + 16];
+static uint16_t pal[256];
+
+// Palettenindex des Bildpunktes x,y (von oben gezaehlt)
+static uint8_t motiv(int x, int y)
+{
+  int dx= x - img_w/2, dy= y - img_h/2;
+
+  if (dx*dx + 2*dy*dy < 20*img_w) return 0x20 + ((x ^ y) & 7);
+  return ((x / 12) + (y / 10) * 8) & 0xff;
+}
+
+static void kopf(uint8_t *p, int w, int h)
+{
+  p[0]= w >> 8; p[1]= w & 0xff;
+  p[2]= h >> 8; p[3]= h & 0xff;
+}
+
+static void bilder_erzeugen(void)
+{
+  int x, y, i, n, pos;
+  uint8_t b;
+
+  for (i= 0; i < 256; i++) pal[i]= rgbfromvalue(i * 37, i * 91, i * 13);
+
+  kopf(img_sw, img_w, img_h);
+  kopf(img_cga, img_w, img_h);
+  kopf(img_16, img_w, img_h);
+  kopf(img_256, img_w, img_h);
+  for (y= 0; y < img_h; y++)
+    for (x= 0; x < img_w; x++)
+    {
+      b= motiv(x, y);
+      if (b & 1) img_sw[4 + y*(img_w/8) + x/8] |= 0x80 >> (x & 7);
+      img_cga[4 + y*(img_w/4) + x/4] |= (b & 3) << ((3 - (x & 3)) * 2);
+      // BMP: unterste Reihe zuerst
+      img_16[4 + (img_h-1-y)*(img_w/2) + x/2] |= (x & 1) ? (b & 0x0f) : ((b & 0x0f) << 4);
+      img_256[4 + (img_h-1-y)*img_w + x]= b;
+    }
+
+  // PCX: Kopf 128 Bytes, RLE je Zeile
+  img_pcx[0]= 10; img_pcx[3]= 8;
+  img_pcx[8]= (img_w-1) & 0xff; img_pcx[9]= (img_w-1) >> 8;
+  img_pcx[10]= (img_h-1) & 0xff; img_pcx[11]= (img_h-1) >> 8;
+  img_pcx[66]= img_w & 0xff; img_pcx[67]= img_w >> 8;
+  pos= 128;
+  for (y= 0; y < img_h; y++)
+    for (x= 0; x < img_w; x += n)
+    {
+      b= motiv(x, y);
+      for (n= 1; (x+n < img_w) && (n < 63) && (motiv(x+n, y) == b); n++);
+      if ((n > 1) || ((b & 0xc0) == 0xc0)) img_pcx[pos++]= 0xc0 | n;
+      img_pcx[pos++]= b;
+    }
+}
+
+/* -------------------------------------------------------
+                         Formate
+
+   jede Funktion liefert die Anzahl der gezeichneten Pixel
+   ------------------------------------------------------- */
+
+static int w_bmpsw(void)
+{
+  if (alt) alt_bmpsw_show(0, 0, img_sw, rgbfromega(10));
+      else bmpsw_show(0, 0, img_sw, rgbfromega(10));
+  return img_w * img_h;
+}
+
+static int w_bmpcga(void)
+{
+  if (alt) alt_bmpcga_show(0, 0, img_cga, pal);
+      else bmpcga_show(0, 0, img_cga, pal);
+  return img_w * img_h;
+}
+
+static int w_bmp16(void)
+{
+  if (alt) alt_bmp16_show(0, 0, img_16, pal);
+      else bmp16_show(0, 0, img_16, pal);
+  return img_w * img_h;
+}
+
+static int w_bmp256(void)
+{
+  if (alt) alt_bmp256_show(0, 0, img_256, pal);
+      else bmp256_show(0, 0, img_256, pal);
+  return img_w * img_h;
+}
+
+static int w_pcx256(void)
+{
+  if (alt) alt_pcx256_show(0, 0, img_pcx, pal);
+      else pcx256_show(0, 0, img_pcx, pal);
+  return img_w * img_h;
+}
+
+static int w_bmp256_aus(void)
+{
+  int x, y;
+
+  if (alt)
+  {
+    // bmp256_show zeichnet wie die alte Fassung eine Zeile tiefer (oy+1)
+    for (y= 1; y <= aus_h; y++)
+      for (x= 0; x < aus_w; x++) putpixel(10+x, 10+y, pal[motiv(aus_x+x, aus_y+y-1)]);
+  }
+  else
+  {
+    gfx_srcrect(aus_x, aus_y, aus_w, aus_h);
+    bmp256_show(10, 10, img_256, pal);
+    gfx_srcrect(0, 0, 0, 0);
+  }
+  return aus_w * aus_h;
+}
+
+typedef struct
+{
+  const char *name;
+  int (*fn)(void);
+} workload_t;
+
+static const workload_t workloads[] =
+{
+  { "bmpsw",       w_bmpsw      },
+  { "bmpcga",      w_bmpcga     },
+  { "bmp16",       w_bmp16      },
+  { "bmp256",      w_bmp256     },
+  { "pcx256",      w_pcx256     },
+  { "bmp256_aus",  w_bmp256_aus },
+};
+
+#define workload_anz   (sizeof(workloads) / sizeof(workloads[0]))
+
+/* -------------------------------------------------------
+     messen
+
+     fuehrt fn so oft aus, bis mess_ns vergangen sind,
+     liefert Pixel je Sekunde, *bytes : Bus-Bytes je Pixel
+   ------------------------------------------------------- */
+static double messen(int mit_alt, int (*fn)(void), double *bytes)
+{
+  uint64_t t0, t;
+  uint32_t b0;
+  long     anz;
+  int      n;
+
+  emu= NULL;
+  alt= mit_alt;
+  anz= 0;
+  b0= busbytes;
+  n= fn();
+  *bytes= (double)(busbytes - b0) / n;
+  t0= ns();
+  do
+  {
+    anz += fn();
+    t= ns() - t0;
+  } while (t < mess_ns);
+  return anz * 1e9 / t;
+}
+
+int main(void)
+{
+  uint32_t i;
+  int      gleich, fail= 0;
+  double   pa, pn, ba, bn;
+
+  host_reset();
+  bus_ein();
+
+  #if (USE_SPI_TFT == 1)
+    lcdemu_init_ctrl(&emu_neu, lcdemu_s6d02a1, _xres, _yres);
+    lcdemu_init_ctrl(&emu_alt, lcdemu_s6d02a1, _xres, _yres);
+  #else
+    lcdemu_init_ctrl(&emu_neu, lcdemu_ili9340, _xres, _yres);
+    lcdemu_init_ctrl(&emu_alt, lcdemu_ili9340, _xres, _yres);
+  #endif
+  emu= &emu_alt; lcd_init();
+  emu= &emu_neu; lcd_init();
+  outmode= 0;
+
+  bilder_erzeugen();
+
+  printf("\nBilddekoder, Display %dx%d, Bild %dx%d, Pixel je s (PC)\n", _xres, _yres, img_w, img_h);
+  printf("  %-11s %13s %13s %7s %11s %11s  %s\n", "Format", "Pixel/s alt", "Pixel/s neu",
+         "Faktor", "Bytes/P alt", "Bytes/P neu", "Bild");
+  for (i= 0; i < workload_anz; i++)
+  {
+    emu= &emu_alt; alt= 1; bkcolor= 0; clrscr(); workloads[i].fn();
+    emu= &emu_neu; alt= 0; bkcolor= 0; clrscr(); workloads[i].fn();
+    gleich= (image_hash(&emu_alt) == image_hash(&emu_neu));
+    if (!gleich) fail= 1;
+
+    pa= messen(1, workloads[i].fn, &ba);
+    pn= messen(0, workloads[i].fn, &bn);
+
+    printf("  %-11s %13.0f %13.0f %7.1f %11.2f %11.2f  %s\n", workloads[i].name,
+           pa, pn, pa > 0 ? pn / pa : 0.0, ba, bn, gleich ? "gleich" : "FEHLER");
+  }
+
+  lcdemu_free(&emu_neu);
+  lcdemu_free(&emu_alt);
+  return fail;
+}
@@ -0,0 +1,252 @@
+/* -------------------------------------------------------
+                      bricks_replay.c
+
+   Wiedergabe des ersten Levels von game_bricks/bricks.c
+   auf dem PC, ohne Display und ohne Tasten.
+
+   bricks.c wird hier eingebunden (main heisst dann
+   bricks_main), die ueber SPI gesendeten Bytes laufen in
+   die Controller-Nachbildung host/lcdemu.c. Die Tasten
+   werden ueber host_input_hook nachgebildet:
+
+     Start    : wechselt bei jeder Abfrage zwischen
+                gedrueckt und losgelassen (jede Warte-
+                schleife wird sofort verlassen)
+     links,   : ein einfacher Spieler fuehrt den Schlaeger
+     rechts     unter den Ball (Position des Schlaegers
+                wird aus dem Displayinhalt gelesen), mit
+                einem Versatz aus einer festen Zufallsfolge,
+                damit sich die Abprallwinkel aendern
+
+   Ein Frame ist ein Durchlauf der Hauptschleife von
+   bricks.c (Ball bewegen, Treffer pruefen, zwei Takte
+   Schlaegerbewegung mit delay(6) / delay(7)). Die Wieder-
+   gabe endet, wenn das Level geloest ist, das Spiel
+   verloren ist oder nach maxframes Frames.
+
+   Ausgabe: Bytes auf dem Displaybus (Kommandos und Daten)
+   je Frame, getrennt nach Frames ohne und mit Schlaeger-
+   bewegung, und ein Pruefwert des letzten Bildes.
+  -------------------------------------------------------- */
+
+#include <stdio.h>
+#include <setjmp.h>
+
+#include "host_hal.h"
+#include "lcdemu.h"
+
+char *itoa(int value, char *s, int radix);
+void sys_init(void);
+
+#define main bricks_main
+#include "bricks.c"
+#undef main
+
+#define maxframes   30000
+
+static lcdemu_t emu;
+static uint32_t dc_port;
+static uint16_t dc_mask;
+static jmp_buf  replay_end;
+
+static uint8_t  btn_l, btn_r, btn_s;
+static uint32_t rnd_state= 4711;
+static int      aim;                          // Versatz des Schlaegers zum Ball
+static uint8_t  lastydir;
+static uint8_t  started;                      // 1 : Spielstand ist gesetzt (lifes > 0)
+
+static uint32_t frames, ticks;
+static uint32_t frame_b0;                     // Bytezaehler zu Beginn des Frames
+static uint8_t  frame_moved;                  // 1 : Schlaeger wurde im Frame bewegt
+static uint32_t sum[2], anz[2], maxb;         // [0] : ohne, [1] : mit Schlaegerbewegung
+
+/* -------------------------------------------------------
+     Ersatz fuer sysf103_init.c und fehlende Funktionen
+     der Host-Bibliothek
+   ------------------------------------------------------- */
+void sys_init(void)
+{
+}
+
+char *itoa(int value, char *s, int radix)
+{
+  (void)radix;
+  sprintf(s, "%d", value);
+  return s;
+}
+
+/* -------------------------------------------------------
+     Displaybus
+   ------------------------------------------------------- */
+
+// Port und Pin von D/C aus den Makros in tft_pindefs.h ermitteln
+static void find_dc(void)
+{
+  uint16_t a, b;
+
+  dc_clr();
+  a= host_port(GPIOA); b= host_port(GPIOB);
+  dc_set();
+  if (host_port(GPIOA) != a) { dc_port= GPIOA; dc_mask= host_port(GPIOA) ^ a; }
+                        else { dc_port= GPIOB; dc_mask= host_port(GPIOB) ^ b; }
+}
+
+static void spi_decode(uint32_t spi, uint16_t data)
+{
+  (void)spi;
+  lcdemu_byte(&emu, (host_port(dc_port) & dc_mask) ? 1 : 0, data);
+}
+
+static uint32_t busbytes(void)
+{
+  return emu.ncmd + emu.ndata;
+}
+
+// sichtbarer Bildpunkt in logischen Koordinaten (wie putpixel)
+static uint16_t screen_pixel(int x, int y)
+{
+  switch (outmode)
+  {
+    case 1  : return lcdemu_pixel(&emu, y, _yres-1-x);
+    case 2  : return lcdemu_pixel(&emu, _xres-1-y, x);
+    case 3  : return lcdemu_pixel(&emu, _xres-1-x, _yres-1-y);
+    default : return lcdemu_pixel(&emu, x, y);
+  }
+}
+
+// linke Kante des Schlaegers (mittlere Zeile ist ueber die ganze Breite gezeichnet)
+static int paddle_pos(void)
+{
+  int x;
+
+  for (x= 0; x < scrofsx + scrsizex; x++)
+    if (screen_pixel(x, paddleposy+1+scrofsy) == rgbfromvalue(0xc0, 0x80, 0x04)) return x;
+  return -1;
+}
+
+/* -------------------------------------------------------
+     Tasten
+   ------------------------------------------------------- */
+static uint16_t replay_input(uint32_t gpioport, uint16_t gpios)
+{
+  uint16_t v= 0xffff;                         // losgelassen (Pullup)
+
+  if ((gpioport == GPIOB) && (btn_l)) v &= ~GPIO7;
+  if (gpioport == GPIOC)
+  {
+    if (btn_r) v &= ~GPIO15;
+    if (gpios & GPIO14)
+    {
+      btn_s ^= 1;
+      if (btn_s) v &= ~GPIO14;
+    }
+  }
+  return v;
+}
+
+static void player(void)
+{
+  int px, want;
+
+  // nach jedem Abprall am Schlaeger einen neuen Versatz waehlen
+  if ((lastydir) && (!ball.ydir))
+  {
+    rnd_state= rnd_state * 1103515245u + 12345u;
+    aim= (int)((rnd_state >> 16) % 19) - 9;
+  }
+  lastydir= ball.ydir;
+
+  btn_l= 0; btn_r= 0;
+  px= paddle_pos();
+  if (px < 0) return;
+
+  want= (int)ball.x + 2 - (paddlesizex / 2) + aim;
+  if (px > want) btn_l= 1;
+  if (px < want) btn_r= 1;
+}
+
+/* -------------------------------------------------------
+     Frames
+   ------------------------------------------------------- */
+static void frame_end(void)
+{
+  uint32_t b;
+
+  b= busbytes() - frame_b0;
+  sum[frame_moved] += b;
+  anz[frame_moved]++;
+  if (b > maxb) maxb= b;
+  frames++;
+  frame_b0= busbytes();
+  frame_moved= 0;
+}
+
+static void replay_delay(int ms)
+{
+  if ((level > 0) || (frames >= maxframes)) longjmp(replay_end, 1);
+  if (lifes) started= 1;
+  if ((started) && (!lifes)) longjmp(replay_end, 2);
+
+  if (ms >= 50)
+  {
+    // Warten auf Start, Levelanzeige: kein Frame der Hauptschleife
+    ticks= 0;
+    frame_b0= busbytes();
+    frame_moved= 0;
+    player();
+    return;
+  }
+
+  if ((ms == 6) || (ms == 7))
+  {
+    if (ms == 6) frame_moved= 1;
+    ticks++;
+    if (!(ticks & 1)) frame_end();
+    player();
+  }
+}
+
+int main(void)
+{
+  uint32_t hash= 2166136261u;
+  int      x, y, r;
+  uint16_t c;
+  uint8_t  left;
+
+  host_reset();
+  find_dc();
+  lcdemu_init(&emu, _xres, _yres);
+  host_spi_hook= spi_decode;
+  host_input_hook= replay_input;
+  host_delay_hook= replay_delay;
+
+  r= setjmp(replay_end);
+  if (!r) bricks_main();
+
+  for (y= 0; y < _yres; y++)
+    for (x= 0; x < _xres; x++)
+    {
+      c= lcdemu_pixel(&emu, x, y);
+      hash= (hash ^ (c & 0xff)) * 16777619u;
+      hash= (hash ^ (c >> 8)) * 16777619u;
+    }
+
+  left= 0;
+  for (x= 0; x < brickanz; x++)
+    if (brickwall[(x*2)+1]) left++;
+
+  printf("\nspritemode %d: %s nach %lu Frames (Score %d, %d Steine uebrig)\n", spritemode,
+         (r == 2) ? "Spiel verloren" : (level > 0) ? "Level geloest" : "abgebrochen",
+         (unsigned long)frames, score, left);
+  printf("  %-30s %8.1f\n", "Bytes/Frame gesamt",
+         (double)(sum[0] + sum[1]) / (frames ? frames : 1));
+  printf("  %-30s %8.1f  (%lu Frames)\n", "Bytes/Frame nur Ball",
+         anz[0] ? (double)sum[0] / anz[0] : 0.0, (unsigned long)anz[0]);
+  printf("  %-30s %8.1f  (%lu Frames)\n", "Bytes/Frame Ball + Schlaeger",
+         anz[1] ? (double)sum[1] / anz[1] : 0.0, (unsigned long)anz[1]);
+  printf("  %-30s %8lu\n", "Bytes/Frame maximal", (unsigned long)maxb);
+  printf("  %-30s %08lx\n", "Pruefwert letztes Bild", (unsigned long)hash);
+
+  lcdemu_free(&emu);
+  return 0;
+}
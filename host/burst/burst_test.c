@@ -0,0 +1,322 @@
+/* -------------------------------------------------------
+                       burst_test.c
+
+   Busaufwand der Fensterausgabe (tft_window_begin /
+   tft_push_pixels / tft_window_end) gegenueber der
+   Einzelpunktausgabe auf dem PC.
+
+   tftdisplay.c und gfx_pictures.c werden unveraendert
+   uebersetzt, als Vergleich dienen die urspruenglichen
+   Funktionen mit putpixel je Bildpunkt (../alt). Die
+   Bytes auf dem SPI-Bus laufen mit D/C in zwei Control-
+   ler-Nachbildungen (lcdemu), eine fuer die aktuelle und
+   eine fuer die alte Ausgabe. Gezaehlt werden die Bytes
+   je Kommandoklasse (wrcmd / wrdata fuer Adressierung,
+   Farbdaten), das sichtbare Bild muss in beiden Nach-
+   bildungen gleich sein.
+
+   Jede Funktion wird in allen Ausgaberichtungen (outmode
+   0..3) geprueft.
+
+   Rueckgabewert 1, wenn sich ein Bild unterscheidet.
+  -------------------------------------------------------- */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "tftdisplay.h"
+#include "gfx_pictures.h"
+#include "host_hal.h"
+#include "lcdemu.h"
+#include "tft_alt.h"
+
+static lcdemu_t  emu_neu, emu_alt;
+static lcdemu_t *emu;                         // Ziel der SPI-Bytes
+static uint32_t  dc_port;
+static uint16_t  dc_mask;
+static int       alt;                         // 1 : Ausgabe ueber die alten Funktionen
+
+// Port und Pin von D/C aus den Makros in tft_pindefs.h ermitteln
+static void find_dc(void)
+{
+  uint16_t a, b;
+
+  dc_clr();
+  a= host_port(GPIOA); b= host_port(GPIOB);
+  dc_set();
+  if (host_port(GPIOA) != a) { dc_port= GPIOA; dc_mask= host_port(GPIOA) ^ a; }
+                        else { dc_port= GPIOB; dc_mask= host_port(GPIOB) ^ b; }
+}
+
+static void spi_decode(uint32_t spi, uint16_t data)
+{
+  (void)spi;
+  lcdemu_byte(emu, (host_port(dc_port) & dc_mask) ? 1 : 0, data);
+}
+
+static uint32_t image_hash(const lcdemu_t *e)
+{
+  uint32_t h= 2166136261u;
+  uint16_t c;
+  int      x, y;
+
+  for (y= 0; y < e->h; y++)
+    for (x= 0; x < e->w; x++)
+    {
+      c= lcdemu_pixel(e, x, y);
+      h= (h ^ (c & 0xff)) * 16777619u;
+      h= (h ^ (c >> 8)) * 16777619u;
+    }
+  return h;
+}
+
+/* -------------------------------------------------------
+                        Testbilder
+
+   werden beim Start im jeweiligen Format erzeugt:
+   Kopf (Breite, Hoehe), Bilddaten wie von image2c
+   ------------------------------------------------------- */
+
+#define img_w          96
+#define img_h          60
+
+static uint8_t  img_sw[4 + (img_w/8)*img_h];
+static uint8_t  img_cga[4 + (img_w/4)*img_h];
+static uint8_t  img_16[4 + (img_w/2)*img_h];
+static uint8_t  img_256[4 + img_w*img_h];
+static uint8_t  img_pcx[128 + 2*img_w*img_h + 16];
+static uint16_t pal[256];
+
+// Palettenindex des Bildpunktes x,y (von oben gezaehlt)
+static uint8_t motiv(int x, int y)
+{
+  int dx= x - img_w/2, dy= y - img_h/2;
+
+  if (dx*dx + 2*dy*dy < 500) return 0x20 + ((x ^ y) & 7);
+  return ((x / 12) + (y / 10) * 8) & 0xff;
+}
+
+static void kopf(uint8_t *p, int w, int h)
+{
+  p[0]= w >> 8; p[1]= w & 0xff;
+  p[2]= h >> 8; p[3]= h & 0xff;
+}
+
+static void bilder_erzeugen(void)
+{
+  int x, y, i, n, pos;
+  uint8_t b;
+
+  for (i= 0; i < 256; i++) pal[i]= rgbfromvalue(i * 37, i * 91, i * 13);
+
+  kopf(img_sw, img_w, img_h);
+  kopf(img_cga, img_w, img_h);
+  kopf(img_16, img_w, img_h);
+  kopf(img_256, img_w, img_h);
+  for (y= 0; y < img_h; y++)
+    for (x= 0; x < img_w; x++)
+    {
+      b= motiv(x, y);
+      if (b & 1) img_sw[4 + y*(img_w/8) + x/8] |= 0x80 >> (x & 7);
+      img_cga[4 + y*(img_w/4) + x/4] |= (b & 3) << ((3 - (x & 3)) * 2);
+      // BMP: unterste Reihe zuerst
+      img_16[4 + (img_h-1-y)*(img_w/2) + x/2] |= (x & 1) ? (b & 0x0f) : ((b & 0x0f) << 4);
+      img_256[4 + (img_h-1-y)*img_w + x]= b;
+    }
+
+  // PCX: Kopf 128 Bytes, RLE je Zeile
+  img_pcx[0]= 10; img_pcx[3]= 8;
+  img_pcx[8]= (img_w-1) & 0xff; img_pcx[9]= (img_w-1) >> 8;
+  img_pcx[10]= (img_h-1) & 0xff; img_pcx[11]= (img_h-1) >> 8;
+  img_pcx[66]= img_w & 0xff; img_pcx[67]= img_w >> 8;
+  pos= 128;
+  for (y= 0; y < img_h; y++)
+    for (x= 0; x < img_w; x += n)
+    {
+      b= motiv(x, y);
+      for (n= 1; (x+n < img_w) && (n < 63) && (motiv(x+n, y) == b); n++);
+      if ((n > 1) || ((b & 0xc0) == 0xc0)) img_pcx[pos++]= 0xc0 | n;
+      img_pcx[pos++]= b;
+    }
+}
+
+/* -------------------------------------------------------
+                        Funktionen
+   ------------------------------------------------------- */
+
+static void text(int x, int y, const char *s)
+{
+  aktxp= x; aktyp= y;
+  while (*s)
+  {
+    if (alt) alt_lcd_putchar(*s); else lcd_putchar(*s);
+    s++;
+  }
+}
+
+// 4 Zeilen, so viele Zeichen wie in eine Zeile passen (alte Funktionen zeichnen
+// ausserhalb des Displays an falsche Adressen)
+static void textzeilen(uint8_t font, uint8_t size)
+{
+  char s[20];
+  int  i, n;
+
+  setfont(font);
+  textsize= size;
+  fntfilled= 1;
+  textcolor= rgbfromega(14); bkcolor= rgbfromega(1);
+  n= 128 / (fontsizex * (size+1));
+  for (i= 0; i < 4; i++)
+  {
+    snprintf(s, n+1, "Burst %d123456789", i);
+    text(0, i * fontsizey * (size+1), s);
+  }
+  textsize= 0;
+}
+
+static void w_text8(void)    { textzeilen(0, 0); }
+static void w_text8x2(void)  { textzeilen(0, 1); }
+static void w_text12(void)   { textzeilen(1, 0); }
+static void w_text12x2(void) { textzeilen(1, 1); }
+
+static void w_outtext(void)
+{
+  setfont(0);
+  textcolor= rgbfromega(15);
+  if (alt)
+  {
+    alt_outtextxy(4, 40, 0, "transparent");
+    alt_outtextxy(100, 4, 1, "senkrecht");
+  }
+  else
+  {
+    outtextxy(4, 40, 0, "transparent");
+    outtextxy(100, 4, 1, "senkrecht");
+  }
+}
+
+static void w_showimage(void)
+{
+  if (alt) alt_showimage(10, 20, img_sw, rgbfromega(12));
+      else showimage(10, 20, img_sw, rgbfromega(12));
+}
+
+static void w_bmpsw(void)
+{
+  if (alt) alt_bmpsw_show(10, 24, img_sw, rgbfromega(10));
+      else bmpsw_show(10, 24, img_sw, rgbfromega(10));
+}
+
+static void w_bmpcga(void)
+{
+  if (alt) alt_bmpcga_show(10, 20, img_cga, pal);
+      else bmpcga_show(10, 20, img_cga, pal);
+}
+
+static void w_bmp16(void)
+{
+  if (alt) alt_bmp16_show(10, 20, img_16, pal);
+      else bmp16_show(10, 20, img_16, pal);
+}
+
+static void w_bmp256(void)
+{
+  if (alt) alt_bmp256_show(10, 20, img_256, pal);
+      else bmp256_show(10, 20, img_256, pal);
+}
+
+static void w_pcx256(void)
+{
+  if (alt) alt_pcx256_show(10, 20, img_pcx, pal);
+      else pcx256_show(10, 20, img_pcx, pal);
+}
+
+typedef struct
+{
+  const char *name;
+  void (*fn)(void);
+} workload_t;
+
+static const workload_t workloads[] =
+{
+  { "text_8x8",       w_text8     },
+  { "text_8x8_x2",    w_text8x2   },
+  { "text_12x16",     w_text12    },
+  { "text_12x16_x2",  w_text12x2  },
+  { "outtextxy",      w_outtext   },
+  { "showimage",      w_showimage },
+  { "bmpsw_show",     w_bmpsw     },
+  { "bmpcga_show",    w_bmpcga    },
+  { "bmp16_show",     w_bmp16     },
+  { "bmp256_show",    w_bmp256    },
+  { "pcx256_show",    w_pcx256    },
+};
+
+#define workload_anz   (sizeof(workloads) / sizeof(workloads[0]))
+
+/* -------------------------------------------------------
+     messen
+
+     Bildschirm loeschen, Zaehler der Nachbildung e zu-
+     ruecksetzen und die Funktion ausfuehren
+   ------------------------------------------------------- */
+static void messen(lcdemu_t *e, int mit_alt, void (*fn)(void))
+{
+  emu= e;
+  alt= mit_alt;
+  bkcolor= rgbfromega(0);
+  clrscr();
+  e->ncmd= 0; e->ndata= 0;
+  memset(e->nkl, 0, sizeof(e->nkl));
+  fn();
+}
+
+int main(void)
+{
+  uint32_t i, bn, ba, sumn= 0, suma= 0;
+  int      om, gleich, fail= 0;
+
+  host_reset();
+  find_dc();
+  host_spi_hook= spi_decode;
+
+  lcdemu_init_ctrl(&emu_neu, lcdemu_s6d02a1, _xres, _yres);
+  lcdemu_init_ctrl(&emu_alt, lcdemu_s6d02a1, _xres, _yres);
+  emu= &emu_alt; lcd_init();
+  emu= &emu_neu; lcd_init();
+
+  bilder_erzeugen();
+
+  printf("\nFensterausgabe gegen Einzelpunkte, %dx%d, Bytes auf dem Displaybus\n", _xres, _yres);
+  for (om= 0; om < 4; om++)
+  {
+    outmode= om;
+    printf("\noutmode %d\n", om);
+    printf("  %-14s %9s %9s %7s %11s %11s  %s\n", "Funktion", "Bytes alt", "Bytes neu", "Faktor",
+           "Adr. alt", "Adr. neu", "Bild");
+    for (i= 0; i < workload_anz; i++)
+    {
+      messen(&emu_alt, 1, workloads[i].fn);
+      messen(&emu_neu, 0, workloads[i].fn);
+
+      ba= emu_alt.ncmd + emu_alt.ndata;
+      bn= emu_neu.ncmd + emu_neu.ndata;
+      suma += ba; sumn += bn;
+      gleich= (image_hash(&emu_alt) == image_hash(&emu_neu));
+      if (!gleich) fail= 1;
+
+      printf("  %-14s %9lu %9lu %7.1f %11lu %11lu  %s\n", workloads[i].name,
+             (unsigned long)ba, (unsigned long)bn, bn ? (double)ba / bn : 0.0,
+             (unsigned long)emu_alt.nkl[lcdemu_kl_fenster], (unsigned long)emu_neu.nkl[lcdemu_kl_fenster],
+             gleich ? "gleich" : "FEHLER");
+    }
+  }
+  outmode= 0;
+
+  printf("\nSumme: alt %lu Bytes, neu %lu Bytes (Faktor %.1f)\n",
+         (unsigned long)suma, (unsigned long)sumn, sumn ? (double)suma / sumn : 0.0);
+
+  lcdemu_free(&emu_neu);
+  lcdemu_free(&emu_alt);
+  return fail;
+}
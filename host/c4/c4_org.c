@@ -0,0 +1,43 @@
+/* -------------------------------------------------------
+                         c4_org.c
+
+   Original-Engine c4.c fuer c4_test: die oeffentlichen
+   Funktionen heissen hier org_..., damit sie neben
+   c4_bb.c gebunden werden koennen.
+
+   c4.c fragt in jedem Aufruf von evaluate() (und einmal
+   je Wurzelzug) clock() ab, sobald eine Pollfunktion
+   gesetzt ist. clock() ist hier durch einen Zaehler
+   ersetzt, der immer 0 liefert: org_nodes zaehlt so die
+   untersuchten Stellungen, die Pollfunktion wird mit
+   einem grossen Intervall nie aufgerufen.
+  -------------------------------------------------------- */
+
+#include <stdint.h>
+#include <time.h>
+
+uint32_t org_nodes;
+
+static clock_t org_clock(void)
+{
+  org_nodes++;
+  return 0;
+}
+
+#define clock()              org_clock()
+
+#define c4_poll              org_poll
+#define c4_budget            org_budget
+#define c4_new_game          org_new_game
+#define c4_make_move         org_make_move
+#define c4_auto_move         org_auto_move
+#define c4_board             org_board
+#define c4_score_of_player   org_score_of_player
+#define c4_is_winner         org_is_winner
+#define c4_is_tie            org_is_tie
+#define c4_win_coords        org_win_coords
+#define c4_end_game          org_end_game
+#define c4_reset             org_reset
+#define c4_get_version       org_get_version
+
+#include "c4.c"
@@ -0,0 +1,351 @@
+/* -------------------------------------------------------
+                         c4_test.c
+
+   Bitboard-Engine c4_bb.c gegen das Original c4.c auf
+   dem PC (Spielfeld 7x6, 4 in einer Reihe). c4_bb.c ist
+   direkt eingebunden, damit perft und die Suche mit
+   festem Fenster an play / unplay / negamax kommen, das
+   Original wird ueber c4_org.c (org_...) aufgerufen.
+
+     perft        : Anzahl der Zugfolgen je Tiefe mit
+                    play / unplay gegen ein einfaches
+                    Feld-Modell (char-Array, Gewinnpruefung
+                    um den gesetzten Stein). Nach einem
+                    Gewinn wird nicht weitergezogen.
+     Partien      : Zufallspartien ueber c4_make_move mit
+                    beiden Engines, Zeile, Gewinner,
+                    Unentschieden und c4_win_coords
+                    muessen gleich sein.
+     bester Zug   : Zufallsstellungen, je Spielstaerke
+                    (level) die Bewertung aller Zuege mit
+                    negamax und vollem Fenster. Der Zug von
+                    c4_auto_move beider Engines muss zu den
+                    am besten bewerteten gehoeren (gleich
+                    gute Zuege waehlen beide zufaellig),
+                    dazu die Anzahl gleicher Spalten.
+     Stellungen/s : untersuchte Stellungen und Zeit je Zug
+                    beider Engines (ohne Knotenbudget)
+
+   Rueckgabewert 1 bei einem Unterschied
+  -------------------------------------------------------- */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "c4_bb.c"
+
+#define breite         7
+#define hoehe          6
+#define perft_tiefe    9
+#define partien        2000
+#define stellungen     40
+
+// Original (c4_org.c)
+extern uint32_t org_nodes;
+void  org_poll(void (*poll_func)(void), clock_t interval);
+void  org_new_game(int width, int height, int num);
+bool  org_make_move(int player, int column, int *row);
+bool  org_auto_move(int player, int level, int *column, int *row);
+bool  org_is_winner(int player);
+bool  org_is_tie(void);
+void  org_win_coords(int *x1, int *y1, int *x2, int *y2);
+void  org_end_game(void);
+
+static const int level_tab[] = { 5, 7, 9 };
+#define level_anz      (sizeof(level_tab) / sizeof(level_tab[0]))
+
+static uint32_t zufall_r = 12345;
+
+static uint32_t zufall(void)
+{
+  zufall_r ^= zufall_r << 13; zufall_r ^= zufall_r >> 17; zufall_r ^= zufall_r << 5;
+  return zufall_r;
+}
+
+static uint64_t ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+static void org_kein_poll(void) { }
+
+/* -------------------------------------------------------
+                 perft, einfaches Feld-Modell
+   ------------------------------------------------------- */
+
+static char fld[breite][hoehe];
+static int  fld_h[breite];
+
+static int fld_zaehle(int x, int y, int dx, int dy, char p)
+{
+  int n= 0;
+
+  for (x += dx, y += dy; (x >= 0) && (x < breite) && (y >= 0) && (y < hoehe) && (fld[x][y] == p); x += dx, y += dy) n++;
+  return n;
+}
+
+static bool fld_gewinn(int x, int y)
+{
+  static const int d[4][2] = { {0,1}, {1,0}, {1,1}, {1,-1} };
+  char p= fld[x][y];
+  int  i;
+
+  for (i= 0; i < 4; i++)
+    if (1 + fld_zaehle(x, y, d[i][0], d[i][1], p) + fld_zaehle(x, y, -d[i][0], -d[i][1], p) >= 4)
+      return true;
+  return false;
+}
+
+static uint64_t fld_perft(int tiefe, int player)
+{
+  uint64_t n= 0;
+  int      x, y;
+  bool     g;
+
+  for (x= 0; x < breite; x++)
+  {
+    if (fld_h[x] == hoehe) continue;
+    y= fld_h[x]++;
+    fld[x][y]= player + 1;                    // 0 : leer
+    g= fld_gewinn(x, y);
+    if (tiefe == 1) n++;
+      else if (!g) n += fld_perft(tiefe-1, other(player));
+    fld[x][y]= 0;
+    fld_h[x]--;
+  }
+  return n;
+}
+
+static uint64_t bb_perft(int tiefe, int player)
+{
+  uint64_t n= 0;
+  int      x;
+  bool     g;
+
+  for (x= 0; x < breite; x++)
+  {
+    if (col_full(x)) continue;
+    g= play(player, x);
+    if (tiefe == 1) n++;
+      else if (!g) n += bb_perft(tiefe-1, other(player));
+    unplay(x);
+  }
+  return n;
+}
+
+static int perft_test(void)
+{
+  uint64_t n1, n2, t0, t1, t2;
+  int      d, fail= 0;
+
+  printf("\nperft (Leerfeld %dx%d)\n", breite, hoehe);
+  printf("  %5s %12s %12s %10s %10s\n", "Tiefe", "Feld-Modell", "c4_bb", "ms Modell", "ms c4_bb");
+  c4_new_game(breite, hoehe, 4);
+  memset(fld, 0, sizeof(fld));
+  memset(fld_h, 0, sizeof(fld_h));
+  for (d= 1; d <= perft_tiefe; d++)
+  {
+    t0= ns();
+    n1= fld_perft(d, 1);
+    t1= ns();
+    n2= bb_perft(d, 1);
+    t2= ns();
+    if (n1 != n2) fail= 1;
+    printf("  %5d %12llu %12llu %10.1f %10.1f %s\n", d, (unsigned long long)n1, (unsigned long long)n2,
+           (t1-t0) / 1e6, (t2-t1) / 1e6, (n1 == n2) ? "" : "FEHLER");
+  }
+  c4_end_game();
+  return fail;
+}
+
+/* -------------------------------------------------------
+                      Zufallspartien
+   ------------------------------------------------------- */
+
+static int partien_test(void)
+{
+  int  i, zug, col, r1, r2, a[4], b[4], player, fail= 0, gewonnen= 0, remis= 0;
+  bool ok1, ok2;
+
+  for (i= 0; i < partien; i++)
+  {
+    c4_new_game(breite, hoehe, 4);
+    org_new_game(breite, hoehe, 4);
+    player= 0;
+    for (zug= 0; zug < 200; zug++)
+    {
+      col= zufall() % breite;
+      ok1= c4_make_move(player, col, &r1);
+      ok2= org_make_move(player, col, &r2);
+      if ((ok1 != ok2) || (ok1 && (r1 != r2))) { fail= 1; break; }
+      if (!ok1) continue;
+      if (c4_is_winner(player) != org_is_winner(player)) { fail= 1; break; }
+      if (c4_is_tie() != org_is_tie()) { fail= 1; break; }
+      if (c4_is_winner(player))
+      {
+        c4_win_coords(&a[0], &a[1], &a[2], &a[3]);
+        org_win_coords(&b[0], &b[1], &b[2], &b[3]);
+        if (memcmp(a, b, sizeof(a))) fail= 1;
+        gewonnen++;
+        break;
+      }
+      if (c4_is_tie()) { remis++; break; }
+      player= other(player);
+    }
+    c4_end_game();
+    org_end_game();
+    if (fail)
+    {
+      printf("  Partie %d, Zug %d: FEHLER\n", i, zug);
+      break;
+    }
+  }
+  printf("\nZufallspartien: %d, davon %d gewonnen, %d unentschieden: %s\n",
+         i, gewonnen, remis, fail ? "FEHLER" : "gleich");
+  return fail;
+}
+
+/* -------------------------------------------------------
+                 bester Zug, Stellungen je s
+   ------------------------------------------------------- */
+
+static uint8_t pos_zuege[stellungen][32];
+static int     pos_anz[stellungen];
+
+// spielt Stellung nr mit beiden Engines nach, Rueckgabe: Spieler am Zug
+static int aufbauen(int nr)
+{
+  int i, player= 0;
+
+  c4_new_game(breite, hoehe, 4);
+  org_new_game(breite, hoehe, 4);
+  for (i= 0; i < pos_anz[nr]; i++)
+  {
+    c4_make_move(player, pos_zuege[nr][i], NULL);
+    org_make_move(player, pos_zuege[nr][i], NULL);
+    player= other(player);
+  }
+  return player;
+}
+
+static void abbauen(void)
+{
+  c4_end_game();
+  org_end_game();
+}
+
+// Zufallsstellungen mit 4 bis 14 Steinen ohne Gewinner und ohne sofortigen Gewinn
+static void stellungen_erzeugen(void)
+{
+  int  nr, i, x, player;
+  bool ok;
+
+  for (nr= 0; nr < stellungen; )
+  {
+    pos_anz[nr]= 4 + zufall() % 11;
+    c4_new_game(breite, hoehe, 4);
+    player= 0; ok= true;
+    for (i= 0; (i < pos_anz[nr]) && ok; i++)
+    {
+      do x= zufall() % breite; while (col_full(x));
+      pos_zuege[nr][i]= x;
+      c4_make_move(player, x, NULL);
+      ok= (winner == C4_NONE);
+      player= other(player);
+    }
+    for (x= 0; (x < breite) && ok; x++)
+      if (!col_full(x))
+      {
+        if (play(player, x)) ok= false;
+        unplay(x);
+      }
+    c4_end_game();
+    if (ok) nr++;
+  }
+}
+
+// Bewertung aller Zuege mit festem level und vollem Fenster, Bitmaske der besten Spalten
+static uint32_t beste_zuege(int player, int level)
+{
+  int      x, v, best= -c4_inf;
+  uint32_t m= 0;
+
+  for (x= 0; x < breite; x++)
+  {
+    if (col_full(x)) continue;
+    if (play(player, x)) v= c4_win;
+    else
+    {
+      side= other(player);
+      search_aborted= false;
+      node_budget= 0;
+      v= -negamax(1, level-1, -c4_inf, c4_inf);
+    }
+    unplay(x);
+    if (v > best) { best= v; m= 0; }
+    if (v == best) m |= 1 << x;
+  }
+  return m;
+}
+
+static int zug_test(void)
+{
+  uint64_t t0, t_bb, t_org, n_bb, n_org;
+  uint32_t m;
+  int      l, nr, player, c1, c2, gleich, bb_ok, org_ok, fail= 0;
+
+  stellungen_erzeugen();
+  org_poll(org_kein_poll, 0x7fffffff);
+
+  printf("\nbester Zug, %d Zufallsstellungen (4..14 Steine)\n", stellungen);
+  printf("  %5s %8s %8s %8s %12s %12s %12s %12s %7s\n", "level", "c4_bb ok", "c4.c ok", "gleich",
+         "Stell. c4_bb", "Stell. c4.c", "Stell/s bb", "Stell/s c4.c", "Zeit");
+  for (l= 0; l < (int)level_anz; l++)
+  {
+    gleich= 0; bb_ok= 0; org_ok= 0;
+    t_bb= 0; t_org= 0; n_bb= 0; n_org= 0;
+    for (nr= 0; nr < stellungen; nr++)
+    {
+      player= aufbauen(nr);
+      m= beste_zuege(player, level_tab[l]);
+      abbauen();
+
+      player= aufbauen(nr);
+      c4_budget(0);
+      t0= ns();
+      c4_auto_move(player, level_tab[l], &c1, NULL);
+      t_bb += ns() - t0;
+      n_bb += c4_nodes;
+      org_nodes= 0;
+      t0= ns();
+      org_auto_move(player, level_tab[l], &c2, NULL);
+      t_org += ns() - t0;
+      n_org += org_nodes;
+      abbauen();
+
+      if (m & (1 << c1)) bb_ok++;
+      if (m & (1 << c2)) org_ok++;
+      if (c1 == c2) gleich++;
+    }
+    if ((bb_ok != stellungen) || (org_ok != stellungen)) fail= 1;
+    printf("  %5d %8d %8d %8d %12llu %12llu %12.0f %12.0f %6.2fx\n", level_tab[l], bb_ok, org_ok, gleich,
+           (unsigned long long)n_bb, (unsigned long long)n_org,
+           n_bb * 1e9 / t_bb, n_org * 1e9 / t_org, (double)t_org / t_bb);
+  }
+  printf("  (ok: Zug gehoert zu den am besten bewerteten, Zeit: c4.c / c4_bb je Zug)\n");
+  return fail;
+}
+
+int main(void)
+{
+  int fail= 0;
+
+  fail |= perft_test();
+  fail |= partien_test();
+  fail |= zug_test();
+  printf("\n%s\n", fail ? "FEHLER" : "alles gleich");
+  return fail;
+}
@@ -0,0 +1,248 @@
+/* -------------------------------------------------------
+                        con_test.c
+
+   Test der Textkonsole (src/tft_console.c) auf dem PC.
+
+   tftdisplay.c wird mit der Konfiguration aus cfg_hw
+   (ILI9340 240x320, Hardware-Scrolling) bzw. cfg_sw
+   (S6D02A1 128x160, Neuzeichnen) uebersetzt. Die ueber
+   SPI gesendeten Bytes laufen in die Controller-Nach-
+   bildung host/lcdemu.c (inkl. Scrollregister 0x33 /
+   0x37). Das sichtbare Bild wird Zeichenzelle fuer
+   Zeichenzelle mit dem erwarteten Bildschirminhalt
+   (Zeichen, Vorder- und Hintergrundfarbe) verglichen.
+
+   Ausgegeben werden ausserdem die Anzahl der Bytes auf
+   dem Displaybus fuer eine neue Zeile am unteren Rand.
+
+   Rueckgabewert 1, wenn ein Vergleich fehlschlaegt.
+  -------------------------------------------------------- */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "tftdisplay.h"
+#include "host_hal.h"
+#include "lcdemu.h"
+#include "font8x8.fnt"
+
+#define maxrows   64
+#define maxcols   64
+
+static lcdemu_t emu;
+static uint32_t dc_port;
+static uint16_t dc_mask;
+
+static int     rows, cols;
+static uint8_t exp_ch[maxrows][maxcols];     // erwarteter Bildschirminhalt
+static uint8_t exp_at[maxrows][maxcols];
+static int     fails;
+
+// Port und Pin von D/C aus den Makros in tft_pindefs.h ermitteln
+static void find_dc(void)
+{
+  uint16_t a, b;
+
+  dc_clr();
+  a= host_port(GPIOA); b= host_port(GPIOB);
+  dc_set();
+  if (host_port(GPIOA) != a) { dc_port= GPIOA; dc_mask= host_port(GPIOA) ^ a; }
+                        else { dc_port= GPIOB; dc_mask= host_port(GPIOB) ^ b; }
+}
+
+static void spi_decode(uint32_t spi, uint16_t data)
+{
+  (void)spi;
+  lcdemu_byte(&emu, (host_port(dc_port) & dc_mask) ? 1 : 0, data);
+}
+
+static uint32_t busbytes(void)
+{
+  return emu.ncmd + emu.ndata;
+}
+
+/* -------------------------------------------------------
+     exp_clear, exp_text
+
+     erwarteten Bildschirminhalt setzen
+   ------------------------------------------------------- */
+static void exp_clear(uint8_t at)
+{
+  memset(exp_ch, ' ', sizeof(exp_ch));
+  memset(exp_at, at, sizeof(exp_at));
+}
+
+static void exp_text(int row, int col, const char *s, uint8_t at)
+{
+  while (*s && (col < cols))
+  {
+    exp_ch[row][col]= *s++;
+    exp_at[row][col++]= at;
+  }
+}
+
+/* -------------------------------------------------------
+     check
+
+     vergleicht das sichtbare Bild mit dem erwarteten
+     Inhalt (Font 8x8, Zelle 8x8 Pixel)
+   ------------------------------------------------------- */
+static void check(const char *name)
+{
+  int      r, c, x, y, bad= 0;
+  uint8_t  bits;
+  uint16_t fg, bg, want;
+
+  for (r= 0; r < rows; r++)
+    for (c= 0; c < cols; c++)
+    {
+      fg= egapalette[exp_at[r][c] & 0x0f];
+      bg= egapalette[exp_at[r][c] >> 4];
+      for (y= 0; y < 8; y++)
+      {
+        bits= font8x8[exp_ch[r][c] - 32][y];
+        for (x= 0; x < 8; x++)
+        {
+          want= (bits & (0x80 >> x)) ? fg : bg;
+          if (lcdemu_pixel(&emu, c*8 + x, r*8 + y) != want) { bad++; x= 8; y= 8; }
+        }
+      }
+    }
+
+  printf("  %-28s %s", name, bad ? "FEHLER" : "ok");
+  if (bad) { printf(" (%d Zellen)", bad); fails++; }
+  printf("\n");
+}
+
+/* -------------------------------------------------------
+     scroll_lines
+
+     gibt n Zeilen aus (jede dritte rot, jede siebte
+     laenger als eine Bildschirmzeile) und baut dabei die
+     Liste der erwarteten Bildschirmzeilen auf
+   ------------------------------------------------------- */
+#define histmax   512
+
+static char    hist_txt[histmax][maxcols+1];
+static uint8_t hist_at[histmax];
+static int     hist_anz;
+
+static void scroll_lines(int n, uint8_t defat)
+{
+  char line[2 * maxcols + 1];
+  int  k, len, i;
+  uint8_t at;
+
+  for (k= 0; k < n; k++)
+  {
+    len= snprintf(line, sizeof(line), "Zeile %03d", k);
+    if (k % 7 == 0)
+      while (len < cols + 5) { line[len]= 'a' + (len % 26); len++; }
+    line[len]= 0;
+
+    at= (k % 3 == 1) ? (defat & 0xf0) | 4 : defat;      // ESC [ 31 m => rot (EGA 4)
+    if (k % 3 == 1) tft_con_puts("\033[31m");
+    tft_con_puts(line);
+    if (k % 3 == 1) tft_con_puts("\033[0m");
+    tft_con_puts("\r\n");
+
+    for (i= 0; i < len; i += cols)
+    {
+      snprintf(hist_txt[hist_anz % histmax], maxcols+1, "%.*s", cols, line + i);
+      hist_at[hist_anz % histmax]= at;
+      hist_anz++;
+    }
+  }
+}
+
+// erwarteter Bildschirm: letzte rows-1 Zeilen (back Zeilen zurueck), unten die leere Eingabezeile
+static void exp_history(int back, uint8_t defat)
+{
+  int r, h;
+
+  exp_clear(defat);
+  for (r= 0; r < rows; r++)
+  {
+    h= hist_anz - (rows-1) - back + r;
+    if ((h >= 0) && (h < hist_anz)) exp_text(r, 0, hist_txt[h % histmax], hist_at[h % histmax]);
+  }
+}
+
+int main(void)
+{
+  uint8_t  defat;
+  uint32_t b0, bnl, bch;
+  int      got;
+
+  host_reset();
+  find_dc();
+  #if (s6d02a1 == 1)
+    lcdemu_init_ctrl(&emu, lcdemu_s6d02a1, _xres, _yres);
+  #else
+    lcdemu_init(&emu, _xres, _yres);
+  #endif
+  host_spi_hook= spi_decode;
+
+  lcd_init();
+  setfont(0);
+  textsize= 0;
+  tft_con_init(grey, black);
+  defat= (black << 4) | grey;
+
+  cols= _xres / 8; if (cols > tft_concols) cols= tft_concols;
+  rows= _yres / 8; if (rows > tft_conlines) rows= tft_conlines;
+
+  printf("\nDisplay %dx%d, Konsole %d x %d Zeichen, %s\n", _xres, _yres, cols, rows,
+         emu.nscroll ? "Hardware-Scrolling (0x33 / 0x37)" : "Neuzeichnen");
+
+  exp_clear(defat);
+  check("leere Konsole");
+
+  scroll_lines(3 * rows, defat);
+  exp_history(0, defat);
+  check("3 Bildschirme Text");
+
+  got= tft_con_scrollback(5);
+  exp_history(got, defat);
+  check("5 Zeilen zurueckgeblaettert");
+
+  got= tft_con_scrollback(1000);
+  exp_history(got, defat);
+  check("maximal zurueckgeblaettert");
+  printf("  %-28s %d Zeilen\n", "Rueckblick", got);
+
+  tft_con_scrollback(0);
+  exp_history(0, defat);
+  check("aktuelle Ausgabe");
+
+  // Escape-Sequenzen
+  tft_con_puts("\033[2J\033[3;5HABC\033[3;6H\033[K");
+  tft_con_puts("\033[10;1H\033[44mXY\033[0m");
+  tft_con_puts("\033[5;1H1234567890\033[5;4H\033[1K");
+  tft_con_puts("\033[7;2H\033[1;33mgelb\033[7m inv\033[0m");
+  exp_clear(defat);
+  exp_text(2, 4, "A", defat);
+  exp_text(9, 0, "XY", (blue << 4) | grey);
+  exp_text(4, 4, "567890", defat);
+  exp_text(6, 1, "gelb", (black << 4) | yellow);
+  exp_text(6, 5, " inv", (yellow << 4) | black);
+  check("Escape-Sequenzen");
+
+  // Kosten einer neuen Zeile am unteren Rand
+  tft_con_puts("\033[1;1H\033[2J");
+  scroll_lines(rows, defat);
+  b0= busbytes();
+  tft_con_puts("\n");
+  bnl= busbytes() - b0;
+  b0= busbytes();
+  tft_con_puts("x");
+  bch= busbytes() - b0;
+  printf("  %-28s %lu Bytes\n", "neue Zeile (Scrollen)", (unsigned long)bnl);
+  printf("  %-28s %lu Bytes\n", "ein Zeichen", (unsigned long)bch);
+
+  tft_con_exit();
+  lcdemu_free(&emu);
+
+  if (fails) printf("\n%d Abweichungen\n", fails);
+  return fails ? 1 : 0;
+}
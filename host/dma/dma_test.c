@@ -0,0 +1,310 @@
+/* -------------------------------------------------------
+                        dma_test.c
+
+   Test der DMA-Ausgabe (tft_dma 1) von tftdisplay.c auf
+   dem PC.
+
+   Die DMA-Register des Kanals werden bei jedem Start
+   (dma_enable_channel) ueber host_dma_hook mitgeschnitten
+   und geprueft:
+
+     - Kanal 3, Peripherieadresse SPI1_DR
+     - 16-Bit Speicherzugriffe, SPI steht auf 16-Bit
+       Datenrahmen, D/C auf Daten
+     - Fuellmodus: Speicheradresse fest, Puffermodus:
+       Adresse wird erhoeht
+     - hoechstens 65535 Datenrahmen je Abschnitt
+
+   Jedes Byte auf dem Displaybus (16-Bit Rahmen als zwei
+   Bytes, MSB zuerst) wird mit D/C in einen Pruefwert
+   eingerechnet und in die Controller-Nachbildung lcdemu
+   geschrieben. Eine Uebersetzung mit tft_dma 1 ist
+   gleichwertig zur Ausgabe per Polling (tft_dma 0), wenn
+   Anzahl Bytes und Pruefwert je Funktion uebereinstimmen.
+
+   Zusaetzlich muss clrscr das ganze sichtbare Bild mit
+   bkcolor fuellen (ILI9225: Fensterregister 0x36..0x39
+   statt Spalten- / Zeilenadresse).
+
+       dma_<ctrl>_0            : Ausgabe der Werte je
+                                 Funktion (Referenz)
+       dma_<ctrl>_1 ref.txt    : Vergleich mit der Referenz
+
+   Rueckgabewert 1, wenn sich ein Mitschnitt unterscheidet
+   oder eine Pruefung fehlschlaegt.
+  -------------------------------------------------------- */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "tftdisplay.h"
+#include "host_hal.h"
+#include "lcdemu.h"
+
+#if (ili9225 == 1)
+  #define emu_ctrl    lcdemu_ili9225
+#elif (st7735r == 1)
+  #define emu_ctrl    lcdemu_st7735
+#elif (s6d02a1 == 1)
+  #define emu_ctrl    lcdemu_s6d02a1
+#else
+  #define emu_ctrl    lcdemu_ili9340
+#endif
+
+static lcdemu_t emu;
+static uint32_t dc_port;
+static uint16_t dc_mask;
+
+static uint32_t bytes, hash;
+static uint32_t dma_starts, dma_frames, dma_fill, dma_buf;
+static uint32_t errors;
+static uint32_t callbacks;
+
+// Port und Pin von D/C aus den Makros in tft_pindefs.h ermitteln
+static void find_dc(void)
+{
+  uint16_t a, b;
+
+  dc_clr();
+  a= host_port(GPIOA); b= host_port(GPIOB);
+  dc_set();
+  if (host_port(GPIOA) != a) { dc_port= GPIOA; dc_mask= host_port(GPIOA) ^ a; }
+                        else { dc_port= GPIOB; dc_mask= host_port(GPIOB) ^ b; }
+}
+
+static void bus_byte(int dc, uint8_t b)
+{
+  bytes++;
+  hash= (hash ^ dc) * 16777619u;
+  hash= (hash ^ b) * 16777619u;
+  lcdemu_byte(&emu, dc, b);
+}
+
+static void spi_decode(uint32_t spi, uint16_t data)
+{
+  int dc;
+
+  (void)spi;
+  dc= (host_port(dc_port) & dc_mask) ? 1 : 0;
+  if (host_spi_bits(SPI1) == 16) bus_byte(dc, data >> 8);
+  bus_byte(dc, data & 0xff);
+}
+
+static void dma_record(uint8_t channel, uintptr_t paddr, uintptr_t maddr,
+                       uint16_t anz, uint8_t msize16, uint8_t minc)
+{
+  (void)maddr;
+  dma_starts++;
+  dma_frames += anz;
+  if (minc) dma_buf += anz; else dma_fill += anz;
+
+  if (channel != DMA_CHANNEL3) errors++;
+  if (paddr != (uintptr_t)&SPI1_DR) errors++;
+  if (!msize16) errors++;
+  if (host_spi_bits(SPI1) != 16) errors++;
+  if (!(host_port(dc_port) & dc_mask)) errors++;
+  if (!anz) errors++;
+}
+
+/* -------------------------------------------------------
+                        Funktionen
+   ------------------------------------------------------- */
+
+static uint32_t rnd_state= 4711;
+
+static int rnd(int n)
+{
+  rnd_state= rnd_state * 1103515245u + 12345u;
+  return (rnd_state >> 16) % n;
+}
+
+static uint16_t pixbuf[64*40];
+
+#if (tft_dma == 1)
+static void dma_callback(void)
+{
+  callbacks++;
+}
+#endif
+
+static void w_init(void)       { lcd_init(); }
+static void w_clr_black(void)  { bkcolor= 0x0000; clrscr(); }
+static void w_clr_red(void)    { bkcolor= 0xf800; clrscr(); }
+static void w_rect_gross(void) { fillrect(10, 20, 120, 150, 0x1234); }
+static void w_rect_klein(void) { fillrect(3, 3, 6, 6, 0xabcd); }   // 16 Pixel: Polling
+
+static void w_rect_zufall(void)
+{
+  int i;
+
+  for (i= 0; i < 100; i++)
+    fillrect(rnd(_xres), rnd(_yres), rnd(_xres), rnd(_yres), rnd(0x10000));
+}
+
+static void w_fillcircle(void)
+{
+  int i;
+
+  for (i= 0; i < 20; i++)
+    fillcircle(rnd(_xres), rnd(_yres), rnd(50), rnd(0x10000));
+}
+
+static void w_text(void)
+{
+  const char *s= "DMA 0123456789";
+
+  setfont(0);
+  textcolor= 0xffe0; bkcolor= 0x0010;
+  fntfilled= 1;
+  gotoxy(0, 2);
+  while (*s) lcd_putchar(*s++);
+}
+
+// 4 Bildschirminhalte in ein Fenster: mehr als 65535 Datenrahmen
+static void w_fill_gross(void)
+{
+  tft_window_begin(0, 0, _xres-1, _yres-1);
+  tft_push_color(0x5555, (uint32_t)_xres * _yres * 4);
+  tft_window_end();
+}
+
+// Puffer: tft_dma 0 ueber tft_push_pixels, tft_dma 1 ueber tft_dma_pixels
+static void w_puffer(void)
+{
+  tft_window_begin(30, 40, 30+64-1, 40+40-1);
+  #if (tft_dma == 1)
+    tft_dma_pixels(pixbuf, 64*40, dma_callback);
+    tft_dma_wait();
+  #else
+    tft_push_pixels(pixbuf, 64*40);
+    callbacks++;
+  #endif
+  tft_window_end();
+  putpixel(0, 0, 0xffff);
+}
+
+static void w_ori1(void)
+{
+  outmode= 1;
+  bkcolor= 0x07e0; clrscr();
+  fillrect(5, 5, 150, 100, 0xa5a5);
+  outmode= 0;
+}
+
+typedef struct
+{
+  const char *name;
+  void (*fn)(void);
+} workload_t;
+
+static const workload_t workloads[] =
+{
+  { "lcd_init",        w_init        },
+  { "clrscr_schwarz",  w_clr_black   },
+  { "clrscr_rot",      w_clr_red     },
+  { "fillrect_gross",  w_rect_gross  },
+  { "fillrect_klein",  w_rect_klein  },
+  { "fillrect_zufall", w_rect_zufall },
+  { "fillcircle",      w_fillcircle  },
+  { "text_8x8",        w_text        },
+  { "fill_65535+",     w_fill_gross  },
+#if (ili9225 == 0)
+  { "puffer",          w_puffer      },                // ILI9225: keine direkte Fensterausgabe
+#endif
+  { "outmode_1",       w_ori1        },
+};
+
+#define workload_anz   (sizeof(workloads) / sizeof(workloads[0]))
+
+/* -------------------------------------------------------
+     clrscr_voll
+
+     prueft, ob nach clrscr alle sichtbaren Punkte die
+     Farbe bkcolor haben
+   ------------------------------------------------------- */
+static int clrscr_voll(uint16_t color)
+{
+  int x, y;
+
+  bkcolor= color;
+  clrscr();
+  #if (tft_dma == 1)
+    tft_dma_wait();
+  #endif
+  for (y= 0; y < emu.h; y++)
+    for (x= 0; x < emu.w; x++)
+      if (lcdemu_pixel(&emu, x, y) != color) return 0;
+  return 1;
+}
+
+int main(int argc, char **argv)
+{
+  FILE     *f= NULL;
+  char      rname[32];
+  unsigned long rbytes, rhash;
+  uint32_t  i;
+  int       ok, fail= 0;
+
+  host_reset();
+  find_dc();
+  host_spi_hook= spi_decode;
+  host_dma_hook= dma_record;
+  lcdemu_init_ctrl(&emu, emu_ctrl, _xres, _yres);
+
+  for (i= 0; i < 64*40; i++) pixbuf[i]= rgbfromvalue(i * 3, i >> 3, i * 7);
+
+  if (argc > 1)
+  {
+    f= fopen(argv[1], "r");
+    if (!f) { perror(argv[1]); return 1; }
+    printf("\ntft_dma %d gegen %s\n", tft_dma, argv[1]);
+    printf("  %-16s %9s %6s %6s %10s %10s %10s\n", "Funktion", "Bytes", "Trace",
+           "DMA", "Rahmen", "Fuellung", "Puffer");
+  }
+
+  for (i= 0; i < workload_anz; i++)
+  {
+    bytes= 0; hash= 2166136261u; errors= 0;
+    dma_starts= 0; dma_frames= 0; dma_fill= 0; dma_buf= 0;
+    callbacks= 0;
+
+    workloads[i].fn();
+    #if (tft_dma == 1)
+      tft_dma_wait();
+    #endif
+
+    if ((workloads[i].fn == w_puffer) && (callbacks != 1)) errors++;
+
+    if (!f)
+    {
+      printf("%s %lu %08lx\n", workloads[i].name, (unsigned long)bytes, (unsigned long)hash);
+      if (errors) fail= 1;
+      continue;
+    }
+
+    if ((fscanf(f, "%31s %lu %lx", rname, &rbytes, &rhash) != 3) || strcmp(rname, workloads[i].name))
+    {
+      printf("  %-16s Referenz fehlt\n", workloads[i].name);
+      fail= 1;
+      continue;
+    }
+    ok= (rbytes == bytes) && (rhash == hash);
+    if (!ok || errors) fail= 1;
+    printf("  %-16s %9lu %6s %6lu %10lu %10lu %10lu", workloads[i].name, (unsigned long)bytes,
+           ok ? "gleich" : "FEHLER", (unsigned long)dma_starts, (unsigned long)dma_frames,
+           (unsigned long)dma_fill, (unsigned long)dma_buf);
+    if (errors) printf("  %lu Registerfehler", (unsigned long)errors);
+    printf("\n");
+  }
+
+  ok= clrscr_voll(0xf800) && clrscr_voll(0x001f);
+  if (!ok) fail= 1;
+  if (f)
+  {
+    printf("  clrscr fuellt das ganze Bild: %s\n", ok ? "ja" : "FEHLER");
+    fclose(f);
+  }
+
+  lcdemu_free(&emu);
+  return fail;
+}
@@ -0,0 +1,235 @@
+/* -------------------------------------------------------
+                       fnt_bench.c
+
+   Zeichen je Sekunde der Textausgabe von tftdisplay.c
+   (Zeichenzelle als Spans ueber die Fensterausgabe, mit
+   oder ohne Zwischenspeicher fnt_cache) gegenueber den
+   urspruenglichen Funktionen mit putpixel je Fontbit
+   (../alt).
+
+   Je Text wird zuerst das Bild geprueft: die SPI-Bytes
+   laufen mit D/C in je eine Controller-Nachbildung
+   (lcdemu) fuer die alte und die aktuelle Ausgabe, beide
+   muessen dasselbe Bild zeigen. Danach wird die Zeit ge-
+   messen, die SPI-Bytes werden dabei nur gezaehlt (die
+   Controller-Nachbildung zaehlt nicht mit).
+
+   Zeichen je Sekunde sind die des PC (Rechenzeit von
+   tftdisplay.c und host_hal.c), nicht die des STM32. Das
+   Verhaeltnis alt / neu und die Bytes je Zeichen auf dem
+   Displaybus sind uebertragbar.
+
+   Texte:
+
+     uhr_8x8        : "00:10 " wiederholt, Font 8x8, mit
+                      Hintergrund, 4 verschiedene Zeichen
+                      (Treffer im Zwischenspeicher)
+     uhr_12x16      : dto. Font 12x16
+     ziffern_8x8    : "0123456789" wiederholt, 8x8 (mehr
+                      verschiedene Zeichen als fnt_cacheanz)
+     ascii_8x8      : alle druckbaren Zeichen, 8x8
+     ziffern_12x16  : wie ziffern_8x8, Font 12x16
+     ascii_12x16    : alle druckbaren Zeichen, 12x16
+     ziffern_8x8_x2 : Ziffern 8x8 doppelt gross
+     transp_8x8     : ascii 8x8 ohne Hintergrund
+                      (fntfilled 0)
+
+   Rueckgabewert 1, wenn sich ein Bild unterscheidet.
+  -------------------------------------------------------- */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "tftdisplay.h"
+#include "host_hal.h"
+#include "lcdemu.h"
+#include "tft_alt.h"
+
+#define mess_ns        100000000ull           // Mindestdauer einer Zeitmessung
+
+static lcdemu_t  emu_neu, emu_alt;
+static lcdemu_t *emu;                         // Ziel der SPI-Bytes, NULL : nur zaehlen
+static uint32_t  dc_port;
+static uint16_t  dc_mask;
+static uint32_t  spibytes;
+static int       alt;                         // 1 : Ausgabe ueber die alten Funktionen
+
+// Port und Pin von D/C aus den Makros in tft_pindefs.h ermitteln
+static void find_dc(void)
+{
+  uint16_t a, b;
+
+  dc_clr();
+  a= host_port(GPIOA); b= host_port(GPIOB);
+  dc_set();
+  if (host_port(GPIOA) != a) { dc_port= GPIOA; dc_mask= host_port(GPIOA) ^ a; }
+                        else { dc_port= GPIOB; dc_mask= host_port(GPIOB) ^ b; }
+}
+
+static void spi_decode(uint32_t spi, uint16_t data)
+{
+  (void)spi;
+  spibytes++;
+  if (emu) lcdemu_byte(emu, (host_port(dc_port) & dc_mask) ? 1 : 0, data);
+}
+
+static uint32_t image_hash(const lcdemu_t *e)
+{
+  uint32_t h= 2166136261u;
+  uint16_t c;
+  int      x, y;
+
+  for (y= 0; y < e->h; y++)
+    for (x= 0; x < e->w; x++)
+    {
+      c= lcdemu_pixel(e, x, y);
+      h= (h ^ (c & 0xff)) * 16777619u;
+      h= (h ^ (c >> 8)) * 16777619u;
+    }
+  return h;
+}
+
+static uint64_t ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+/* -------------------------------------------------------
+                          Texte
+
+   jede Funktion schreibt eine Bildschirmseite Text und
+   liefert die Anzahl der Zeichen
+   ------------------------------------------------------- */
+
+static int seite(uint8_t font, uint8_t size, uint8_t filled, const char *zeichen)
+{
+  int x, y, n, anz, len;
+
+  setfont(font);
+  textsize= size;
+  fntfilled= filled;
+  textcolor= rgbfromega(14); bkcolor= rgbfromega(1);
+  len= strlen(zeichen);
+  anz= 0;
+  n= 0;
+  for (y= 0; y + fontsizey*(size+1) <= _yres; y += fontsizey*(size+1))
+  {
+    aktxp= 0; aktyp= y;
+    for (x= 0; x + fontsizex*(size+1) <= _xres; x += fontsizex*(size+1))
+    {
+      if (alt) alt_lcd_putchar(zeichen[n]); else lcd_putchar(zeichen[n]);
+      n= (n + 1) % len;
+      anz++;
+    }
+  }
+  textsize= 0;
+  fntfilled= 1;
+  return anz;
+}
+
+static const char ziffern[] = "0123456789";
+static const char uhr[]     = "00:10 ";       // 4 verschiedene Zeichen, passt in den Zwischenspeicher
+static char       ascii[96];
+
+static int w_uhr8(void)        { return seite(0, 0, 1, uhr); }
+static int w_uhr12(void)       { return seite(1, 0, 1, uhr); }
+static int w_ziffern8(void)    { return seite(0, 0, 1, ziffern); }
+static int w_ascii8(void)      { return seite(0, 0, 1, ascii); }
+static int w_ziffern12(void)   { return seite(1, 0, 1, ziffern); }
+static int w_ascii12(void)     { return seite(1, 0, 1, ascii); }
+static int w_ziffern8x2(void)  { return seite(0, 1, 1, ziffern); }
+static int w_transp8(void)     { return seite(0, 0, 0, ascii); }
+
+typedef struct
+{
+  const char *name;
+  int (*fn)(void);
+} workload_t;
+
+static const workload_t workloads[] =
+{
+  { "uhr_8x8",         w_uhr8       },
+  { "uhr_12x16",       w_uhr12      },
+  { "ziffern_8x8",     w_ziffern8   },
+  { "ascii_8x8",       w_ascii8     },
+  { "ziffern_12x16",   w_ziffern12  },
+  { "ascii_12x16",     w_ascii12    },
+  { "ziffern_8x8_x2",  w_ziffern8x2 },
+  { "transp_8x8",      w_transp8    },
+};
+
+#define workload_anz   (sizeof(workloads) / sizeof(workloads[0]))
+
+/* -------------------------------------------------------
+     messen
+
+     fuehrt fn so oft aus, bis mess_ns vergangen sind,
+     liefert Zeichen je Sekunde, *bytes : SPI-Bytes je
+     Zeichen
+   ------------------------------------------------------- */
+static double messen(int mit_alt, int (*fn)(void), double *bytes)
+{
+  uint64_t t0, t;
+  uint32_t b0;
+  long     anz;
+  int      n;
+
+  emu= NULL;
+  alt= mit_alt;
+  anz= 0;
+  b0= spibytes;
+  n= fn();                                    // einmal vorab (Zwischenspeicher gefuellt)
+  *bytes= (double)(spibytes - b0) / n;
+  t0= ns();
+  do
+  {
+    anz += fn();
+    t= ns() - t0;
+  } while (t < mess_ns);
+  return anz * 1e9 / t;
+}
+
+int main(void)
+{
+  uint32_t i;
+  int      gleich, fail= 0;
+  double   za, zn, ba, bn;
+
+  for (i= 0; i < sizeof(ascii)-1; i++) ascii[i]= ' ' + i;
+
+  host_reset();
+  find_dc();
+  host_spi_hook= spi_decode;
+
+  lcdemu_init_ctrl(&emu_neu, lcdemu_s6d02a1, _xres, _yres);
+  lcdemu_init_ctrl(&emu_alt, lcdemu_s6d02a1, _xres, _yres);
+  emu= &emu_alt; lcd_init();
+  emu= &emu_neu; lcd_init();
+  outmode= 0;
+
+  printf("\nTextausgabe, fnt_cache %d (%d Zeichen), %dx%d, Zeichen je s (PC)\n",
+         fnt_cache, fnt_cacheanz, _xres, _yres);
+  printf("  %-15s %11s %11s %7s %9s %9s  %s\n", "Text", "Zeichen/s alt", "Zeichen/s neu",
+         "Faktor", "Bytes/Z alt", "Bytes/Z neu", "Bild");
+  for (i= 0; i < workload_anz; i++)
+  {
+    emu= &emu_alt; alt= 1; bkcolor= 0; clrscr(); workloads[i].fn();
+    emu= &emu_neu; alt= 0; bkcolor= 0; clrscr(); workloads[i].fn();
+    gleich= (image_hash(&emu_alt) == image_hash(&emu_neu));
+    if (!gleich) fail= 1;
+
+    za= messen(1, workloads[i].fn, &ba);
+    zn= messen(0, workloads[i].fn, &bn);
+
+    printf("  %-15s %13.0f %13.0f %7.1f %11.1f %11.1f  %s\n", workloads[i].name,
+           za, zn, za > 0 ? zn / za : 0.0, ba, bn, gleich ? "gleich" : "FEHLER");
+  }
+
+  lcdemu_free(&emu_neu);
+  lcdemu_free(&emu_alt);
+  return fail;
+}
@@ -0,0 +1,453 @@
+/* -------------------------------------------------------
+                         sim.c
+
+   Simulationsrahmen fuer die Spiele auf dem PC (siehe
+   sim.h), ohne Display, Tasten und Controller.
+
+   Display  : die ueber SPI gesendeten Bytes laufen in die
+              Controller-Nachbildung host/lcdemu.c (S6D02A1,
+              Bild RGB565, Bytes je Kommandoklasse)
+   Tasten   : oben, unten, links, rechts wie boardvers 3
+              der Spiele (PC14, PA0, PB7, PC15, low aktiv),
+              Zustand aus einem Eingabeskript
+   Zeit     : tick_ms zaehlt nur virtuell: delay zaehlt um
+              die angegebene Zeit weiter, jede Tastenab-
+              frage um 1 us (Warteschleifen auf eine Taste
+              kommen so voran). Je virtueller ms wird der
+              Timer-Interrupt des Spiels (sim_isr) aufge-
+              rufen.
+
+   Eingabeskript (Textdatei, # leitet einen Kommentar ein):
+
+       <zeit> <taste> <dauer>   Taste zum Zeitpunkt zeit (ms)
+                                fuer dauer ms druecken,
+                                +zeit : relativ zur Zeit der
+                                vorherigen Zeile
+       ende <zeit>              Ende der Simulation
+
+   Ein Frame ist die Ausgabe an das Display zwischen zwei
+   Zeitpunkten, an denen das Spiel wartet (delay oder 1 ms
+   Tastenabfrage). Je Frame wird erfasst: Bytes auf dem
+   Displaybus, daraus die Busdauer bei 36 MHz SPI (Takt
+   von tftdisplay.c, ohne Pausen zwischen den Bytes), und
+   die Zyklen des PC (Zeitstempelzaehler, ohne die Zeit
+   der Controller-Nachbildung, nicht des STM32!).
+
+   Aufruf:
+
+       sim_<spiel> skript [-r ref] [-w ref] [-c csv] [-p ppm]
+
+         -r ref   : Ergebnis (Frames, Bytes, Pruefwert des
+                    letzten Bildes) mit der Datei ref ver-
+                    gleichen, Rueckgabewert 1 bei Abweichung
+         -w ref   : Ergebnis in die Datei ref schreiben
+         -c csv   : Werte je Frame als CSV schreiben
+         -p ppm   : letztes Bild als PPM schreiben
+
+   Alle Werte ausser den Zyklen des PC sind bei gleichem
+   Skript und gleichen Quellen immer gleich.
+  -------------------------------------------------------- */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <setjmp.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+  #include <x86intrin.h>
+  static inline uint64_t cycles(void) { return __rdtsc(); }
+#else
+  #include <time.h>
+  static inline uint64_t cycles(void)
+  {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+  }
+#endif
+
+#include "host_hal.h"
+#include "lcdemu.h"
+#include "tftdisplay.h"
+#include "sim.h"
+
+#define spi_mhz       36                      // SPI1 mit PCLK2 / 2
+#define maxevents     1024
+
+typedef struct
+{
+  uint32_t t;                                 // Zeitpunkt in ms
+  uint8_t  key;                               // Index in keytab
+  uint8_t  down;                              // 1 : druecken, 0 : loslassen
+} event_t;
+
+typedef struct
+{
+  uint32_t t;                                 // virtuelle Zeit am Ende des Frames
+  uint32_t bytes;
+  uint64_t cyc;
+} frame_t;
+
+static const struct
+{
+  const char *name;
+  uint32_t    port;
+  uint16_t    pin;
+} keytab[] =
+{
+  { "oben",   GPIOC, GPIO14 },
+  { "unten",  GPIOA, GPIO0  },
+  { "links",  GPIOB, GPIO7  },
+  { "rechts", GPIOC, GPIO15 }
+};
+
+#define keyanz        (sizeof(keytab) / sizeof(keytab[0]))
+
+static event_t  events[maxevents];
+static int      eventanz, eventpos;
+static uint32_t endtime;
+static uint8_t  keydown[keyanz];
+
+static lcdemu_t emu;
+static uint32_t dc_port;
+static uint16_t dc_mask;
+static jmp_buf  sim_end;
+
+static uint32_t poll_us;                      // Zeit der Tastenabfragen seit dem letzten ms-Schritt
+static uint8_t  in_isr;
+
+static frame_t  *frames;
+static uint32_t frameanz, framemax;
+static uint32_t fr_b0;                        // Bytezaehler zu Beginn des Frames
+static uint64_t fr_t0, emu_cyc;               // Beginn des Frames, Zeit in lcdemu
+
+/* -------------------------------------------------------
+     Ersatz fuer sysf103_init.c und fehlende Funktionen
+     der Host-Bibliothek
+   ------------------------------------------------------- */
+void sys_init(void)
+{
+}
+
+char *itoa(int value, char *s, int radix)
+{
+  (void)radix;
+  sprintf(s, "%d", value);
+  return s;
+}
+
+/* -------------------------------------------------------
+     Eingabeskript
+   ------------------------------------------------------- */
+static int add_event(uint32_t t, int key, int down)
+{
+  int i;
+
+  if (eventanz >= maxevents) return 0;
+
+  // nach Zeit sortiert einfuegen, bei gleicher Zeit hinter vorhandenen Eintraegen
+  for (i= eventanz; (i > 0) && (events[i-1].t > t); i--) events[i]= events[i-1];
+  events[i].t= t;
+  events[i].key= key;
+  events[i].down= down;
+  eventanz++;
+  return 1;
+}
+
+static int script_load(const char *fname)
+{
+  FILE     *f;
+  char     line[256], name[32], zeit[32], *p;
+  unsigned dauer;
+  uint32_t t, last= 0;
+  int      nr= 0, k;
+
+  f= fopen(fname, "r");
+  if (!f) { perror(fname); return 0; }
+
+  while (fgets(line, sizeof(line), f))
+  {
+    nr++;
+    if ((p= strchr(line, '#'))) *p= 0;
+    if (sscanf(line, "%31s", zeit) != 1) continue;
+
+    if ((!strcmp(zeit, "ende")) && (sscanf(line, "%*s %31s", zeit) == 1))
+    {
+      endtime= (zeit[0] == '+') ? last + atoi(zeit+1) : (uint32_t)atoi(zeit);
+      continue;
+    }
+
+    if (sscanf(line, "%31s %31s %u", zeit, name, &dauer) != 3) goto fehler;
+    t= (zeit[0] == '+') ? last + atoi(zeit+1) : (uint32_t)atoi(zeit);
+    for (k= 0; k < (int)keyanz; k++)
+      if (!strcmp(name, keytab[k].name)) break;
+    if (k == (int)keyanz) goto fehler;
+    if ((!add_event(t, k, 1)) || (!add_event(t + dauer, k, 0))) goto fehler;
+    last= t;
+  }
+  fclose(f);
+  if (!endtime)
+  {
+    fprintf(stderr, "%s: keine Zeile \"ende\"\n", fname);
+    return 0;
+  }
+  return 1;
+
+fehler:
+  fprintf(stderr, "%s:%d: Fehler im Skript\n", fname, nr);
+  fclose(f);
+  return 0;
+}
+
+/* -------------------------------------------------------
+     Displaybus
+   ------------------------------------------------------- */
+
+// Port und Pin von D/C aus den Makros in tft_pindefs.h ermitteln
+static void find_dc(void)
+{
+  uint16_t a, b;
+
+  dc_clr();
+  a= host_port(GPIOA); b= host_port(GPIOB);
+  dc_set();
+  if (host_port(GPIOA) != a) { dc_port= GPIOA; dc_mask= host_port(GPIOA) ^ a; }
+                        else { dc_port= GPIOB; dc_mask= host_port(GPIOB) ^ b; }
+}
+
+static void spi_decode(uint32_t spi, uint16_t data)
+{
+  uint64_t t;
+  int      dc;
+
+  (void)spi;
+  t= cycles();
+  dc= (host_port(dc_port) & dc_mask) ? 1 : 0;
+  if (host_spi_bits(SPI1) == 16) lcdemu_byte(&emu, dc, data >> 8);   // DMA (tft_dma 1)
+  lcdemu_byte(&emu, dc, data & 0xff);
+  emu_cyc += cycles() - t;
+}
+
+static uint32_t busbytes(void)
+{
+  return emu.ncmd + emu.ndata;
+}
+
+/* -------------------------------------------------------
+     Frames und Zeit
+   ------------------------------------------------------- */
+
+// das Spiel wartet: Ausgabe seit dem letzten Aufruf ist ein Frame
+static void frame_mark(void)
+{
+  uint64_t c;
+  uint32_t b;
+
+  c= cycles() - fr_t0 - emu_cyc;
+  b= busbytes() - fr_b0;
+  if (b)
+  {
+    if (frameanz >= framemax)
+    {
+      framemax= framemax ? framemax * 2 : 4096;
+      frames= realloc(frames, framemax * sizeof(frame_t));
+      if (!frames) { perror("realloc"); exit(2); }
+    }
+    frames[frameanz].t= tick_ms;
+    frames[frameanz].bytes= b;
+    frames[frameanz].cyc= c;
+    frameanz++;
+  }
+  emu_cyc= 0;
+  fr_b0= busbytes();
+  fr_t0= cycles();
+}
+
+// tick_ms ist eine ms weiter: Skript anwenden, Timer-Interrupt
+static void sim_step(void)
+{
+  while ((eventpos < eventanz) && (events[eventpos].t <= (uint32_t)tick_ms))
+  {
+    keydown[events[eventpos].key]= events[eventpos].down;
+    eventpos++;
+  }
+  if ((uint32_t)tick_ms >= endtime) longjmp(sim_end, 1);
+
+  if (sim_isr)
+  {
+    in_isr= 1;
+    sim_isr();
+    in_isr= 0;
+  }
+}
+
+static void sim_delay(int ms)
+{
+  int t0, i;
+
+  t0= tick_ms - ms;                           // host_hal hat tick_ms schon weitergezaehlt
+  tick_ms= t0;
+  frame_mark();
+  for (i= 1; i <= ms; i++)
+  {
+    tick_ms= t0 + i;
+    sim_step();
+  }
+}
+
+static uint16_t sim_input(uint32_t gpioport, uint16_t gpios)
+{
+  uint16_t v= 0xffff;                         // losgelassen (Pullup)
+  unsigned k;
+
+  (void)gpios;
+  if (!in_isr)
+  {
+    if (++poll_us >= 1000)
+    {
+      poll_us= 0;
+      frame_mark();
+      tick_ms++;
+      sim_step();
+    }
+  }
+  for (k= 0; k < keyanz; k++)
+    if ((keydown[k]) && (keytab[k].port == gpioport)) v &= ~keytab[k].pin;
+  return v;
+}
+
+/* -------------------------------------------------------
+     Ausgabe
+   ------------------------------------------------------- */
+static uint32_t image_hash(void)
+{
+  uint32_t hash= 2166136261u;
+  uint16_t c;
+  int      x, y;
+
+  for (y= 0; y < _yres; y++)
+    for (x= 0; x < _xres; x++)
+    {
+      c= lcdemu_pixel(&emu, x, y);
+      hash= (hash ^ (c & 0xff)) * 16777619u;
+      hash= (hash ^ (c >> 8)) * 16777619u;
+    }
+  return hash;
+}
+
+static int write_csv(const char *fname)
+{
+  FILE     *f;
+  uint32_t i;
+
+  f= fopen(fname, "w");
+  if (!f) { perror(fname); return 0; }
+  fprintf(f, "frame,zeit_ms,bytes,bus_us,zyklen\n");
+  for (i= 0; i < frameanz; i++)
+    fprintf(f, "%lu,%lu,%lu,%.1f,%llu\n", (unsigned long)i, (unsigned long)frames[i].t,
+            (unsigned long)frames[i].bytes, frames[i].bytes * 8.0 / spi_mhz,
+            (unsigned long long)frames[i].cyc);
+  fclose(f);
+  return 1;
+}
+
+int main(int argc, char **argv)
+{
+  const char *script= NULL, *ref_r= NULL, *ref_w= NULL, *csv= NULL, *ppm= NULL;
+  unsigned long rframes= 0, rbytes= 0, rmax= 0, rhash= 0;
+  uint32_t hash, bytes= 0, maxb= 0, i;
+  uint64_t maxc= 0, sumc= 0;
+  FILE     *f;
+  int      fail= 0;
+
+  for (i= 1; i < (uint32_t)argc; i++)
+  {
+    if ((argv[i][0] == '-') && (i + 1 < (uint32_t)argc))
+    {
+      switch (argv[i][1])
+      {
+        case 'r' : ref_r= argv[++i]; continue;
+        case 'w' : ref_w= argv[++i]; continue;
+        case 'c' : csv= argv[++i]; continue;
+        case 'p' : ppm= argv[++i]; continue;
+        default  : break;
+      }
+    }
+    if ((argv[i][0] != '-') && (!script)) { script= argv[i]; continue; }
+    script= NULL;
+    break;
+  }
+  if (!script)
+  {
+    fprintf(stderr, "Aufruf: %s skript [-r ref] [-w ref] [-c csv] [-p ppm]\n", argv[0]);
+    return 2;
+  }
+  if (!script_load(script)) return 2;
+
+  host_reset();
+  find_dc();
+  lcdemu_init_ctrl(&emu, lcdemu_s6d02a1, _xres, _yres);
+  host_spi_hook= spi_decode;
+  host_input_hook= sim_input;
+  host_delay_hook= sim_delay;
+  host_irq_ein= 0;                            // Interrupts ruft der Testrahmen selbst auf
+
+  fr_t0= cycles();
+  if (!setjmp(sim_end)) sim_game();
+  frame_mark();
+
+  for (i= 0; i < frameanz; i++)
+  {
+    bytes += frames[i].bytes;
+    if (frames[i].bytes > maxb) maxb= frames[i].bytes;
+    if (frames[i].cyc > maxc) maxc= frames[i].cyc;
+    sumc += frames[i].cyc;
+  }
+  hash= image_hash();
+
+  printf("\n%s: Skript %s, %lu ms virtuelle Zeit\n", sim_name, script, (unsigned long)tick_ms);
+  printf("  %-28s %10lu  (%.1f je s)\n", "Frames", (unsigned long)frameanz,
+         frameanz * 1000.0 / (tick_ms ? tick_ms : 1));
+  printf("  %-28s %10lu\n", "Bytes gesamt", (unsigned long)bytes);
+  printf("  %-28s %10.0f %10lu\n", "Bytes/Frame mittel, max",
+         (double)bytes / (frameanz ? frameanz : 1), (unsigned long)maxb);
+  printf("  %-28s %10.0f %10.0f\n", "Busdauer/Frame us",
+         bytes * 8.0 / spi_mhz / (frameanz ? frameanz : 1), maxb * 8.0 / spi_mhz);
+  printf("  %-28s %10.0f %10llu\n", "Zyklen/Frame (PC)",
+         (double)sumc / (frameanz ? frameanz : 1), (unsigned long long)maxc);
+  for (i= 0; i < lcdemu_klassen; i++)
+    printf("  Bytes %-22s %10lu\n", lcdemu_klname[i], (unsigned long)emu.nkl[i]);
+  printf("  %-28s   %08lx\n", "Pruefwert letztes Bild", (unsigned long)hash);
+
+  if ((csv) && (!write_csv(csv))) fail= 2;
+  if ((ppm) && (!lcdemu_write_ppm(&emu, ppm))) fail= 2;
+
+  if (ref_w)
+  {
+    f= fopen(ref_w, "w");
+    if (!f) { perror(ref_w); return 2; }
+    fprintf(f, "%lu %lu %lu %08lx\n", (unsigned long)frameanz, (unsigned long)bytes,
+            (unsigned long)maxb, (unsigned long)hash);
+    fclose(f);
+  }
+  if (ref_r)
+  {
+    f= fopen(ref_r, "r");
+    if (!f) { perror(ref_r); return 2; }
+    if ((fscanf(f, "%lu %lu %lu %lx", &rframes, &rbytes, &rmax, &rhash) != 4) ||
+        (rframes != frameanz) || (rbytes != bytes) || (rmax != maxb) || (rhash != hash))
+    {
+      printf("  %-28s   FEHLER (Referenz: %lu Frames, %lu Bytes, max %lu, %08lx)\n",
+             "Vergleich mit Referenz", rframes, rbytes, rmax, rhash);
+      fail= 1;
+    }
+    else
+      printf("  %-28s   gleich\n", "Vergleich mit Referenz");
+    fclose(f);
+  }
+
+  lcdemu_free(&emu);
+  free(frames);
+  return fail;
+}
@@ -0,0 +1,23 @@
+/* -------------------------------------------------------
+                         sim.h
+
+   Simulationsrahmen fuer die Spiele (game_bricks,
+   game_tetris, game_reversi, game_viergewinnt) auf dem PC.
+
+   sim.c enthaelt main: Displaynachbildung (host/lcdemu),
+   Tasten aus einem Eingabeskript, virtuelle Zeit, Mes-
+   sung je Frame und Ausgabe der Ergebnisse. Je Spiel
+   gibt es eine Anpassung sim_<spiel>.c, die die Quellen
+   des Spiels einbindet und die folgenden Symbole
+   bereitstellt.
+  -------------------------------------------------------- */
+
+#ifndef in_sim
+  #define in_sim
+
+  extern const char sim_name[];               // Name des Spiels (Ausgabe)
+  extern void (*const sim_isr)(void);         // wird jede virtuelle ms aufgerufen (Timer-
+                                              // Interrupt des Spiels), NULL : keiner
+  void sim_game(void);                        // Hauptprogramm des Spiels
+
+#endif
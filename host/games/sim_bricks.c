@@ -0,0 +1,22 @@
+/* -------------------------------------------------------
+                      sim_bricks.c
+
+   Anpassung von game_bricks/bricks.c an den
+   Simulationsrahmen sim.c
+  -------------------------------------------------------- */
+
+#include "sim.h"
+
+char *itoa(int value, char *s, int radix);
+
+#define main bricks_main
+#include "bricks.c"
+#undef main
+
+const char sim_name[]= "bricks";
+void (*const sim_isr)(void)= NULL;
+
+void sim_game(void)
+{
+  bricks_main();
+}
@@ -0,0 +1,22 @@
+/* -------------------------------------------------------
+                      sim_reversi.c
+
+   Anpassung von game_reversi/reversi.c an den
+   Simulationsrahmen sim.c
+  -------------------------------------------------------- */
+
+#include "sim.h"
+
+char *itoa(int value, char *s, int radix);
+
+#define main reversi_main
+#include "reversi.c"
+#undef main
+
+const char sim_name[]= "reversi";
+void (*const sim_isr)(void)= NULL;
+
+void sim_game(void)
+{
+  reversi_main();
+}
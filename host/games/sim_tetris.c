@@ -0,0 +1,24 @@
+/* -------------------------------------------------------
+                      sim_tetris.c
+
+   Anpassung von game_tetris/tetris_v2.c an den
+   Simulationsrahmen sim.c. Die Tasten liest das Spiel
+   nur im Timerinterrupt (tim3_isr, sonst jede ms von
+   Timer3 aufgerufen), sim.c ruft ihn jede virtuelle ms.
+  -------------------------------------------------------- */
+
+#include "sim.h"
+
+char *itoa(int value, char *s, int radix);
+
+#define main tetris_main
+#include "tetris_v2.c"
+#undef main
+
+const char sim_name[]= "tetris";
+void (*const sim_isr)(void)= tim3_isr;
+
+void sim_game(void)
+{
+  tetris_main();
+}
@@ -0,0 +1,22 @@
+/* -------------------------------------------------------
+                      sim_viergewinnt.c
+
+   Anpassung von game_viergewinnt/vier_gewinnt_v2.c an den
+   Simulationsrahmen sim.c
+  -------------------------------------------------------- */
+
+#include "sim.h"
+
+char *itoa(int value, char *s, int radix);
+
+#define main viergewinnt_main
+#include "vier_gewinnt_v2.c"
+#undef main
+
+const char sim_name[]= "viergewinnt";
+void (*const sim_isr)(void)= NULL;
+
+void sim_game(void)
+{
+  viergewinnt_main();
+}
@@ -0,0 +1,563 @@
+/* -------------------------------------------------------
+                        hex_test.c
+
+   Intel-HEX Parser von stm32flash_rts (parsers/hex.c) auf
+   dem PC.
+
+     Modell  : Zufallsdateien aus Datensaetzen mit ELA-
+               (04) und ESA-Adressen (02), ungeordneten
+               Saetzen, Saetzen ueber das Segmentende
+               (Umlauf im 64 KByte Segment nur bei ESA,
+               bei ELA linear weiter), Start-
+               adressen (03 / 05), Saetzen der Laenge 0,
+               Kleinbuchstaben, CR/LF und Daten nach EOF.
+               Ein Modell (Adresse -> Byte) berechnet das
+               erwartete Abbild: Basis ist die erste
+               Adresse, wenn sie vor allen Daten steht,
+               sonst 0, Luecken sind 0xff. Ueberlappende
+               Saetze und Daten unterhalb der Basis
+               muessen PARSER_ERR_INVALID_FILE liefern.
+               Abbild, Groesse und Segmentliste (hex_
+               segment) muessen stimmen, hex_read in
+               zufaellig grossen Stuecken, hex_read_at
+               ueber das ganze Abbild.
+     Grenze  : ein Satz ueber eine 64 KByte Grenze mit
+               ELA-Basis (linear weiter) und mit ESA-
+               Basis (Umlauf an den Segmentanfang)
+     Mutation: gueltige Dateien mit 1..4 zufaelligen
+               Aenderungen (Zeichen ersetzen, einfuegen,
+               loeschen, abschneiden). Der Parser darf nur
+               nicht abstuerzen (hex_test_san ist mit
+               ASan / UBSan uebersetzt, siehe Makefile).
+     alt     : aufsteigende Dateien wie aus dem Linker,
+               Abbild gleich dem des urspruenglichen
+               Parsers (../alt/hex_alt.c)
+     Groesse : Datei mit mb MByte Abbild (16 Byte je Satz),
+               Zeit fuer hex_open + hex_read alt / neu
+
+   Aufruf: hex_test [-n dateien] [-m mb]
+
+   Rueckgabewert 1 bei einem Unterschied
+  -------------------------------------------------------- */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "hex.h"
+
+extern parser_t alt_PARSER_HEX;
+
+#define datei_name     "hex_test.hex"
+#define fenster        0x60000                 // Adressbereich des Modells
+
+static uint32_t zufall_r = 0x2545f491;
+
+static uint32_t zufall(void)
+{
+  zufall_r ^= zufall_r << 13; zufall_r ^= zufall_r >> 17; zufall_r ^= zufall_r << 5;
+  return zufall_r;
+}
+
+#define zufall_n(n)    ( zufall() % (n) )
+
+static uint64_t ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+/* -------------------------------------------------------
+                    Dateien schreiben
+   ------------------------------------------------------- */
+
+static char    *txt;                          // Dateiinhalt
+static size_t   txt_len, txt_cap;
+static uint8_t  klein, crlf;
+
+static void txt_add(const char *s, size_t n)
+{
+  if (txt_len + n > txt_cap)
+  {
+    txt_cap= (txt_len + n) * 2;
+    txt= realloc(txt, txt_cap);
+  }
+  memcpy(&txt[txt_len], s, n);
+  txt_len += n;
+}
+
+static void satz(uint8_t type, uint16_t addr, const uint8_t *dat, uint8_t len)
+{
+  static const char *hx[2] = { "0123456789ABCDEF", "0123456789abcdef" };
+  char    z[1 + 2*(4+255+1) + 2], *p= z;
+  uint8_t sum, b[4];
+  int     i;
+
+  b[0]= len; b[1]= addr >> 8; b[2]= addr; b[3]= type;
+  sum= b[0] + b[1] + b[2] + b[3];
+  *p++= ':';
+  for (i= 0; i < 4; i++) { *p++= hx[klein][b[i] >> 4]; *p++= hx[klein][b[i] & 15]; }
+  for (i= 0; i < len; i++)
+  {
+    *p++= hx[klein][dat[i] >> 4]; *p++= hx[klein][dat[i] & 15];
+    sum += dat[i];
+  }
+  sum= -sum;
+  *p++= hx[klein][sum >> 4]; *p++= hx[klein][sum & 15];
+  if (crlf) *p++= '\r';
+  *p++= '\n';
+  txt_add(z, p - z);
+}
+
+static void ext_satz(uint8_t type, uint16_t v)
+{
+  uint8_t d[2] = { v >> 8, v & 0xff };
+
+  satz(type, 0, d, 2);
+}
+
+static void datei_schreiben(const char *name)
+{
+  FILE *f= fopen(name, "wb");
+
+  fwrite(txt, 1, txt_len, f);
+  fclose(f);
+}
+
+/* -------------------------------------------------------
+                   Parser aufrufen
+   ------------------------------------------------------- */
+
+typedef struct
+{
+  parser_err_t err;
+  uint32_t     size, base;
+  uint8_t     *img;
+} ergebnis_t;
+
+// oeffnet die Datei und liest das Abbild in Stuecken von 1..stueck Bytes (0: in einem)
+static ergebnis_t parsen(parser_t *pr, const char *name, unsigned stueck, void **storage)
+{
+  ergebnis_t e;
+  unsigned   n, pos;
+  void      *st;
+
+  memset(&e, 0, sizeof(e));
+  st= pr->init();
+  e.err= pr->open(st, name, 0);
+  if (e.err == PARSER_ERR_OK)
+  {
+    e.size= pr->size(st);
+    e.img= malloc(e.size + 1);
+    pos= 0;
+    while (pos < e.size)
+    {
+      n= stueck ? 1 + zufall_n(stueck) : e.size;
+      pr->read(st, &e.img[pos], &n);
+      if (!n) break;
+      pos += n;
+    }
+    if (pos != e.size) e.err= PARSER_ERR_SYSTEM;
+  }
+  if (storage) *storage= st;
+    else pr->close(st);
+  return e;
+}
+
+/* -------------------------------------------------------
+                          Modell
+   ------------------------------------------------------- */
+
+typedef struct
+{
+  uint8_t  type;                              // 0, 2, 4
+  uint16_t ext;
+  uint16_t addr;
+  uint8_t  len;
+  uint8_t  dat[40];
+} rec_t;
+
+#define rec_max        400
+
+static rec_t    recs[rec_max];
+static int      rec_anz;
+static int16_t  modell[fenster];              // -1 : leer
+
+// Zufallsdatei aus Bloecken, Rueckgabe: erwarteter Fehlercode, *base / *end : Abbild
+static parser_err_t modell_datei(uint32_t *base, uint32_t *end, uint8_t geordnet)
+{
+  int      i, j, k, nb, anz, ovl;
+  uint32_t ext, a, abs, lo, hi;
+  uint8_t  ela, cur_type, have_data, have_base, err, seite[64];
+  uint16_t cur_ext;
+  rec_t    t;
+
+  for (i= 0; i < 64; i++) seite[i]= i;        // 4 Segmente zu 16 Seiten
+  for (i= 63; i > 0; i--)
+  {
+    j= zufall_n(i+1);
+    k= seite[i]; seite[i]= seite[j]; seite[j]= k;
+  }
+
+  klein= geordnet ? 0 : zufall_n(4) == 0;
+  crlf= zufall_n(2);
+  ela= geordnet ? 1 : zufall_n(4) != 0;
+
+  // Bloecke zu Saetzen von 1..32 Bytes (geordnet: 16 Bytes, je Block eine eigene 4 KByte Seite)
+  rec_anz= 0;
+  nb= 1 + zufall_n(5);
+  for (i= 0; (i < nb) && (rec_anz < rec_max - 40); i++)
+  {
+    if (ela)
+    {
+      ext= zufall_n(4) << 16;
+      a= geordnet ? ((seite[i] & 15) << 12) : zufall_n(0x10000);
+      if (geordnet) ext= (seite[i] >> 4) << 16;
+    }
+    else
+    {
+      ext= zufall_n(0x4000) << 4;
+      a= zufall_n(0x10000);
+    }
+    anz= 1 + zufall_n(geordnet ? 1500 : 600);
+    for (j= 0; (j < anz) && (rec_anz < rec_max - 2); )
+    {
+      t.type= ela ? 4 : 2;
+      t.ext= ela ? ext >> 16 : ext >> 4;
+      t.addr= a;
+      t.len= geordnet ? 16 : 1 + zufall_n(32);
+      if (t.len > anz - j) t.len= anz - j;
+      for (k= 0; k < t.len; k++) t.dat[k]= zufall();
+      recs[rec_anz++]= t;
+      j += t.len;
+      a= (a + t.len) & 0xffff;                // ungeordnet auch ueber das Segmentende
+    }
+  }
+  if (!geordnet)
+  {
+    // gelegentlich ein ueberlappender Satz, Saetze der Laenge 0 und ungeordnet
+    if (zufall_n(5) == 0)
+    {
+      t= recs[zufall_n(rec_anz)];
+      t.addr += zufall_n(t.len);
+      recs[rec_anz++]= t;
+    }
+    if (zufall_n(4) == 0)
+    {
+      t= recs[zufall_n(rec_anz)];
+      t.len= 0;
+      recs[rec_anz++]= t;
+    }
+    if (zufall_n(3) == 0)
+      for (i= rec_anz-1; i > 0; i--)
+      {
+        j= zufall_n(i+1);
+        t= recs[i]; recs[i]= recs[j]; recs[j]= t;
+      }
+  }
+  else
+  {
+    // Linker: Bloecke aufsteigend
+    for (i= 1; i < rec_anz; i++)
+      for (j= i; j > 0; j--)
+      {
+        if (((uint32_t)recs[j-1].ext << 16 | recs[j-1].addr) <= ((uint32_t)recs[j].ext << 16 | recs[j].addr)) break;
+        t= recs[j]; recs[j]= recs[j-1]; recs[j-1]= t;
+      }
+  }
+
+  // Datei und Modell
+  txt_len= 0;
+  for (i= 0; i < fenster; i++) modell[i]= -1;
+  cur_type= 0; cur_ext= 0;
+  have_data= 0; have_base= 0; err= 0; ovl= 0;
+  *base= 0;
+  lo= 0xffffffff; hi= 0;
+
+  if (!geordnet && zufall_n(4) == 0)          // Daten vor der ersten Adresse: Basis 0
+  {
+    recs[0].type= 4; recs[0].ext= 0;
+    cur_type= 4; cur_ext= 0;
+  }
+  else cur_type= 0;                           // erster Satz bekommt eine Adresse
+
+  for (i= 0; i < rec_anz; i++)
+  {
+    if ((recs[i].type != cur_type) || (recs[i].ext != cur_ext) || (!geordnet && zufall_n(10) == 0))
+    {
+      ext_satz(recs[i].type, recs[i].ext);
+      cur_type= recs[i].type; cur_ext= recs[i].ext;
+      if (!have_base && !have_data)
+        *base= (cur_type == 4) ? (uint32_t)cur_ext << 16 : (uint32_t)cur_ext << 4;
+      have_base= 1;
+    }
+    if (!geordnet && zufall_n(20) == 0)
+    {
+      uint8_t s[4] = { 0x08, 0x00, 0x01, 0x23 };
+      satz(zufall_n(2) ? 3 : 5, 0, s, 4);     // Startadresse
+    }
+    satz(0, recs[i].addr, recs[i].dat, recs[i].len);
+    have_data |= recs[i].len != 0;
+
+    ext= (cur_type == 4) ? (uint32_t)cur_ext << 16 : (uint32_t)cur_ext << 4;
+    for (k= 0; k < recs[i].len; k++)
+    {
+      if (cur_type == 4) abs= ext + recs[i].addr + k;
+      else               abs= ext + ((recs[i].addr + k) & 0xffff);
+      if (modell[abs] >= 0) ovl= 1;
+      modell[abs]= recs[i].dat[k];
+      if (abs < lo) lo= abs;
+      if (abs + 1 > hi) hi= abs + 1;
+    }
+  }
+  satz(1, 0, NULL, 0);
+  if (!geordnet && zufall_n(3) == 0) txt_add("nach EOF\n", 9);
+
+  if (hi == 0) { *end= *base; return PARSER_ERR_OK; }   // keine Daten
+  *end= hi;
+  if (ovl || (lo < *base)) err= 1;
+  return err ? PARSER_ERR_INVALID_FILE : PARSER_ERR_OK;
+}
+
+// Abbild und Segmentliste gegen das Modell
+static int modell_pruefen(const ergebnis_t *e, void *st, uint32_t base, uint32_t end)
+{
+  uint32_t i, a, l, n, seg_len;
+  int      c, s;
+
+  uint8_t *at;
+
+  if ((e->size != end - base) || (hex_base(st) != base)) return 0;
+  for (i= 0; i < e->size; i++)
+  {
+    c= modell[base + i];
+    if (e->img[i] != ((c < 0) ? 0xff : c)) return 0;
+  }
+  at= malloc(e->size + 1);
+  hex_read_at(st, base, at, e->size);
+  c= memcmp(at, e->img, e->size);
+  free(at);
+  if (c) return 0;
+  // Segmente: aufsteigend, getrennt, lueckenlos belegt, decken alle Daten ab
+  n= 0; seg_len= 0;
+  for (s= 0; hex_segment(st, s, &a, &l) == 0; s++)
+  {
+    if (s && (a <= seg_len)) return 0;
+    for (i= 0; i < l; i++) if (modell[a + i] < 0) return 0;
+    seg_len= a + l;
+    n += l;
+  }
+  if ((unsigned)s != hex_segment_count(st)) return 0;
+  for (i= base, l= 0; i < end; i++) if (modell[i] >= 0) l++;
+  return n == l;
+}
+
+static int modell_test(int dateien)
+{
+  int          i, ok= 0, ungueltig= 0, fail= 0;
+  uint32_t     base, end;
+  parser_err_t soll;
+  ergebnis_t   e;
+  void        *st;
+
+  for (i= 0; i < dateien; i++)
+  {
+    soll= modell_datei(&base, &end, 0);
+    datei_schreiben(datei_name);
+    e= parsen(&PARSER_HEX, datei_name, 300, &st);
+    if (e.err != soll)
+    {
+      printf("  Datei %d: %s statt %s\n", i, parser_errstr(e.err), parser_errstr(soll));
+      fail++;
+    }
+    else if (soll == PARSER_ERR_OK)
+    {
+      if (modell_pruefen(&e, st, base, end)) ok++;
+      else
+      {
+        printf("  Datei %d: Abbild falsch\n", i);
+        fail++;
+      }
+    }
+    else ungueltig++;
+    PARSER_HEX.close(st);
+    free(e.img);
+  }
+  printf("\nModell: %d Dateien, %d Abbilder gleich, %d richtig abgelehnt, %d Fehler\n",
+         dateien, ok, ungueltig, fail);
+  return fail != 0;
+}
+
+static void mutation_test(int dateien)
+{
+  static const char zeichen[] = ":0123456789ABCDEFabcdef\r\nxG ";
+  int          i, m, anz, pos, n[5] = { 0 };
+  uint32_t     base, end;
+  ergebnis_t   e;
+
+  for (i= 0; i < dateien; i++)
+  {
+    modell_datei(&base, &end, 0);
+    anz= 1 + zufall_n(4);
+    for (m= 0; (m < anz) && txt_len; m++)
+    {
+      pos= zufall_n(txt_len);
+      switch (zufall_n(4))
+      {
+        case 0 : txt[pos]= zeichen[zufall_n(sizeof(zeichen)-1)]; break;
+        case 1 : memmove(&txt[pos], &txt[pos+1], txt_len - pos - 1); txt_len--; break;
+        case 2 : txt_add(" ", 1);
+                 memmove(&txt[pos+1], &txt[pos], txt_len - pos - 1);
+                 txt[pos]= zeichen[zufall_n(sizeof(zeichen)-1)]; break;
+        default: txt_len= pos; break;
+      }
+    }
+    datei_schreiben(datei_name);
+    e= parsen(&PARSER_HEX, datei_name, 200, NULL);
+    n[e.err]++;
+    free(e.img);
+  }
+  printf("Mutation: %d Dateien, %d gelesen, %d ungueltig, %d Systemfehler\n",
+         dateien, n[PARSER_ERR_OK], n[PARSER_ERR_INVALID_FILE], n[PARSER_ERR_SYSTEM]);
+}
+
+static int alt_test(int dateien)
+{
+  int        i, gleich= 0;
+  uint32_t   base, end;
+  ergebnis_t e1, e2;
+
+  for (i= 0; i < dateien; i++)
+  {
+    modell_datei(&base, &end, 1);
+    datei_schreiben(datei_name);
+    e1= parsen(&PARSER_HEX, datei_name, 0, NULL);
+    e2= parsen(&alt_PARSER_HEX, datei_name, 0, NULL);
+    if ((e1.err == e2.err) && (e1.size == e2.size) && !memcmp(e1.img, e2.img, e1.size)) gleich++;
+    free(e1.img);
+    free(e2.img);
+  }
+  printf("alt: %d aufsteigende Dateien, %d Abbilder gleich dem urspruenglichen Parser\n", dateien, gleich);
+  return gleich != dateien;
+}
+
+/* -------------------------------------------------------
+        Satz ueber eine 64 KByte Grenze: ELA / ESA
+   ------------------------------------------------------- */
+static int grenze_test(void)
+{
+  uint8_t    d[32], r[32];
+  uint32_t   a[2], l[2];
+  ergebnis_t e;
+  void      *st;
+  int        k, ela, esa;
+
+  for (k= 0; k < 32; k++) d[k]= zufall();
+  klein= 0; crlf= 0;
+
+  // ELA 0x0800: 0x0800fff0 .. 0x0801000f, ein Segment
+  txt_len= 0;
+  ext_satz(4, 0x0800);
+  satz(0, 0xfff0, d, 32);
+  satz(1, 0, NULL, 0);
+  datei_schreiben(datei_name);
+  e= parsen(&PARSER_HEX, datei_name, 0, &st);
+  hex_read_at(st, 0x0800fff0, r, 32);
+  ela= (e.err == PARSER_ERR_OK) && (hex_segment_count(st) == 1) &&
+       (hex_segment(st, 0, &a[0], &l[0]) == 0) && (a[0] == 0x0800fff0) && (l[0] == 32) &&
+       !memcmp(r, d, 32);
+  PARSER_HEX.close(st);
+  free(e.img);
+
+  // ESA 0x1000: 0x1fff0 .. 0x1ffff, dann Umlauf nach 0x10000 .. 0x1000f
+  txt_len= 0;
+  ext_satz(2, 0x1000);
+  satz(0, 0xfff0, d, 32);
+  satz(1, 0, NULL, 0);
+  datei_schreiben(datei_name);
+  e= parsen(&PARSER_HEX, datei_name, 0, &st);
+  esa= (e.err == PARSER_ERR_OK) && (hex_segment_count(st) == 2) &&
+       (hex_segment(st, 0, &a[0], &l[0]) == 0) && (hex_segment(st, 1, &a[1], &l[1]) == 0) &&
+       (a[0] == 0x10000) && (l[0] == 16) && (a[1] == 0x1fff0) && (l[1] == 16);
+  hex_read_at(st, 0x1fff0, r, 16);
+  hex_read_at(st, 0x10000, r + 16, 16);
+  esa= esa && !memcmp(r, d, 32);
+  PARSER_HEX.close(st);
+  free(e.img);
+
+  printf("Grenze: ELA linear %s, ESA Umlauf %s\n", ela ? "gleich" : "FEHLER", esa ? "gleich" : "FEHLER");
+  return !(ela && esa);
+}
+
+/* -------------------------------------------------------
+               grosse Datei: Zeit alt / neu
+   ------------------------------------------------------- */
+static int gross_test(int mb)
+{
+  uint32_t   a, ext= 0xffff;
+  uint8_t    d[16];
+  uint64_t   t0, t1, t2;
+  ergebnis_t e1, e2;
+  int        k, ok;
+
+  klein= 0; crlf= 1;
+  txt_len= 0;
+  for (a= 0; a < (uint32_t)mb << 20; a += 16)
+  {
+    if ((a >> 16) != ext)
+    {
+      ext= a >> 16;
+      ext_satz(4, 0x0800 + ext);
+    }
+    for (k= 0; k < 16; k++) d[k]= zufall();
+    satz(0, a & 0xffff, d, 16);
+  }
+  satz(1, 0, NULL, 0);
+  datei_schreiben(datei_name);
+
+  t0= ns();
+  e1= parsen(&PARSER_HEX, datei_name, 0, NULL);
+  t1= ns();
+  e2= parsen(&alt_PARSER_HEX, datei_name, 0, NULL);
+  t2= ns();
+  ok= (e1.err == PARSER_ERR_OK) && (e1.err == e2.err) && (e1.size == e2.size) && !memcmp(e1.img, e2.img, e1.size);
+  printf("\nDatei %.1f MByte (Abbild %d MByte): neu %.3f s (%.0f MByte/s), alt %.3f s (%.1f MByte/s), "
+         "Faktor %.0f, Abbild %s\n", txt_len / 1048576.0, mb,
+         (t1-t0) / 1e9, txt_len / 1048576.0 / ((t1-t0) / 1e9),
+         (t2-t1) / 1e9, txt_len / 1048576.0 / ((t2-t1) / 1e9),
+         (double)(t2-t1) / (t1-t0), ok ? "gleich" : "FEHLER");
+  free(e1.img);
+  free(e2.img);
+  return !ok;
+}
+
+int main(int argc, char **argv)
+{
+  int c, dateien= 2000, mb= 4, fail= 0;
+
+  while ((c= getopt(argc, argv, "n:m:")) != -1)
+  {
+    switch (c)
+    {
+      case 'n' : dateien= atoi(optarg); break;
+      case 'm' : mb= atoi(optarg); break;
+      default  : fprintf(stderr, "Aufruf: hex_test [-n dateien] [-m mb]\n"); return 2;
+    }
+  }
+
+  fail |= modell_test(dateien);
+  mutation_test(dateien);
+  fail |= alt_test(dateien / 20);
+  fail |= grenze_test();
+  if (mb) fail |= gross_test(mb);
+  unlink(datei_name);
+  free(txt);
+
+  printf("\n%s\n", fail ? "FEHLER" : "alles gleich");
+  return fail;
+}
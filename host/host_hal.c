@@ -0,0 +1,1178 @@
+/* -------------------------------------------------------
+                        host_hal.c
+
+   Nachbildung der von den Softwaremodulen benutzten
+   libopencm3 - Funktionen auf dem PC (Linux), damit die
+   Module aus src und die Projekte ohne Controller ueber-
+   setzt, getestet und vermessen werden koennen.
+
+   Die Ausgangsregister der Ports werden in Variablen ge-
+   halten. Jede Aenderung eines Ausgangsregisters und jedes
+   ueber SPI gesendete Datum wird an die in host_hal.h
+   deklarierten Hookfunktionen gemeldet (falls gesetzt) und
+   mit der virtuellen Zeit in den Tracepuffer geschrieben
+   (falls angelegt).
+
+   Direkte Registerzugriffe (GPIO_BSRR(GPIOB) = wert;)
+   schreiben in ein Zwischenregister, das beim naechsten
+   Aufruf einer Funktion dieser Datei (spaetestens also beim
+   naechsten gpio_set/clear, z.B. dem WR-Strobe eines Paral-
+   lelbusses) in der geschriebenen Reihenfolge auf das Aus-
+   gangsregister uebertragen wird.
+
+   tick_ms, delay und die Interruptfunktionen sind "weak":
+   wird sysf103_init.c (smallio.c ...) mit uebersetzt, gelten
+   dessen Fassungen, delay wartet dann per wfi (host_wfi) auf
+   den Systick-Interrupt.
+  -------------------------------------------------------- */
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <poll.h>
+#include <unistd.h>
+
+#include "libopencm3.h"
+#include "host_hal.h"
+
+#define host_portanz        3                 // GPIOA, GPIOB, GPIOC
+
+// Dauer eines Registerzugriffs in Takten (Funktionsaufruf der libopencm3
+// mit Ruecksprung bzw. direkter Zugriff ueber GPIO_BSRR / GPIO_BRR)
+#define host_takte_aufruf   6
+#define host_takte_reg      2
+
+#define host_weak           __attribute__((weak))
+
+typedef struct
+{
+  uint16_t odr;                               // Ausgangsregister
+  uint32_t bsrr;                              // noch nicht uebernommener BSRR-Schreibzugriff
+  uint32_t brr;                               // dto. BRR
+  uint8_t  bsrr_pend;
+  uint8_t  brr_pend;
+  uint16_t ausgang;                           // als Ausgang konfigurierte Pins
+  uint16_t pud;                               // Eingaenge mit Pullup/-down (Pegel nach ODR)
+  uint16_t offen;                             // schwebende Eingaenge (Pegel 1, Pullup am Bus
+                                              // angenommen, z.B. I2C)
+  uint16_t pegel;                             // Pegel an den Pins (Trace)
+} host_gpio_t;
+
+// nach Reset sind alle Pins schwebende Eingaenge
+#define host_gpio_reset     { 0, 0, 0, 0, 0, 0, 0, 0xffff, 0xffff }
+
+static host_gpio_t host_gpio[host_portanz] = { host_gpio_reset, host_gpio_reset, host_gpio_reset };
+
+host_spi_hook_t  host_spi_hook  = NULL;
+host_gpio_hook_t host_gpio_hook = NULL;
+host_input_hook_t host_input_hook = NULL;
+host_delay_hook_t host_delay_hook = NULL;
+host_uart_tx_hook_t host_uart_tx_hook = NULL;
+host_uart_rx_hook_t host_uart_rx_hook = NULL;
+host_i2c_hook_t  host_i2c_hook  = NULL;
+host_dma_hook_t  host_dma_hook  = NULL;
+
+volatile int tick_ms host_weak = 0;
+uint32_t     host_gpio_writes = 0;
+uint32_t     host_gpio_calls  = 0;
+uint16_t     host_adc[18];
+uint8_t      host_irq_ein     = 1;
+
+uint32_t     rcc_ahb_frequency  = 8000000;
+uint32_t     rcc_apb1_frequency = 8000000;
+uint32_t     rcc_apb2_frequency = 8000000;
+
+const char *const host_tr_name[host_tr_arten] =
+  { "spi", "gpio", "i2c", "uart_tx", "uart_rx", "systick", "timer", "dma" };
+
+uint32_t         host_tr_anz[host_tr_arten];
+host_ereignis_t *host_trace          = NULL;
+uint32_t         host_trace_anz      = 0;
+uint32_t         host_trace_max      = 0;
+uint32_t         host_trace_verloren = 0;
+
+static uint64_t  host_ps = 0;                 // virtuelle Zeit in ps
+static uint64_t  host_ende_ps = 0;            // HOST_ZEIT, 0 = kein Ende
+static uint8_t   host_in_isr = 0;             // 1 : Interruptfunktion laeuft
+static uint8_t   host_nvic[64];               // freigegebene Interrupts
+
+/* -------------------------------------------------------
+                      Tracepuffer
+   ------------------------------------------------------- */
+
+static void host_ereignis(uint8_t art, uint8_t nr, uint16_t wert, uint16_t wert2)
+{
+  host_ereignis_t *e;
+
+  host_tr_anz[art]++;
+  if (!host_trace) return;
+  if (host_trace_anz >= host_trace_max)
+  {
+    host_trace_verloren++;
+    return;
+  }
+  e= &host_trace[host_trace_anz++];
+  e->ns= host_ps / 1000;
+  e->art= art;
+  e->nr= nr;
+  e->wert= wert;
+  e->wert2= wert2;
+}
+
+int host_trace_start(uint32_t max)
+{
+  host_trace_stop();
+  host_trace= malloc((size_t)max * sizeof(host_ereignis_t));
+  if (!host_trace) return 0;
+  host_trace_max= max;
+  return 1;
+}
+
+void host_trace_stop(void)
+{
+  free(host_trace);
+  host_trace= NULL;
+  host_trace_anz= 0;
+  host_trace_max= 0;
+  host_trace_verloren= 0;
+}
+
+/* -------------------------------------------------------
+     host_trace_write
+
+     schreibt den Tracepuffer als Text, eine Zeile je
+     Ereignis:
+
+       Zeit (us)  Art  Nr  Werte
+   ------------------------------------------------------- */
+int host_trace_write(const char *fname)
+{
+  FILE            *f;
+  host_ereignis_t *e;
+
+  f= fopen(fname, "w");
+  if (!f) return 0;
+  fprintf(f, "# zeit_us      art      nr  werte\n");
+  for (e= host_trace; e < host_trace + host_trace_anz; e++)
+  {
+    fprintf(f, "%10llu.%03u  %-8s ", (unsigned long long)(e->ns / 1000), (unsigned)(e->ns % 1000),
+            host_tr_name[e->art]);
+    switch (e->art)
+    {
+      case host_tr_spi     : fprintf(f, "%-3u 0x%0*x\n", e->nr, (e->wert2 > 8) ? 4 : 2, e->wert); break;
+      case host_tr_gpio    : fprintf(f, "%-3c 0x%04x 0x%04x\n", 'A' + e->nr, e->wert, e->wert2); break;
+      case host_tr_i2c     : fprintf(f, "%-3u %c 0x%02x\n", e->nr, e->wert2, e->wert); break;
+      case host_tr_uart_tx :
+      case host_tr_uart_rx : fprintf(f, "%-3u 0x%02x\n", e->nr, e->wert); break;
+      case host_tr_systick : fprintf(f, "\n"); break;
+      default              : fprintf(f, "%-3u %u\n", e->nr, e->wert); break;
+    }
+  }
+  if (host_trace_verloren) fprintf(f, "# %u Ereignisse nicht aufgezeichnet (Puffer voll)\n", host_trace_verloren);
+  fclose(f);
+  return 1;
+}
+
+/* -------------------------------------------------------
+                 virtuelle Zeit, Interrupts
+   ------------------------------------------------------- */
+
+static uint8_t    host_st_csr;                // Systick: Bit 0 Zaehler, Bit 1 Interrupt, Bit 2 AHB
+static uint32_t   host_st_reload;
+static uint64_t   host_st_next;               // naechster Nulldurchgang, 0 = Zaehler aus
+
+static host_tim_t host_tim_reg[2];            // TIM2, TIM3
+static uint64_t   host_tim_next[2];           // naechster Update-Event, 0 = Zaehler aus
+
+static const char *host_trace_datei = NULL;
+
+// Dauer von takte Takten der Frequenz f (Hz) in ps
+static uint64_t host_ps_f(uint64_t takte, uint32_t f)
+{
+  return takte * 1000000000000ull / (f ? f : 1);
+}
+
+// dto. Systemtakt
+static uint64_t host_ps_takte(uint64_t takte)
+{
+  return host_ps_f(takte, rcc_ahb_frequency);
+}
+
+static uint64_t host_st_periode(void)
+{
+  uint64_t takte;
+
+  takte= (uint64_t)(host_st_reload & 0xffffff) + 1;
+  if (!(host_st_csr & STK_CSR_CLKSOURCE_AHB)) takte *= 8;
+  return host_ps_takte(takte);
+}
+
+// Timertakt = APB1-Takt, bei geteiltem APB1-Takt dessen doppelter Wert
+static uint64_t host_tim_periode(int i)
+{
+  uint32_t f;
+
+  f= rcc_apb1_frequency;
+  if (f != rcc_ahb_frequency) f *= 2;
+  return host_ps_f((uint64_t)((host_tim_reg[i].psc & 0xffff) + 1) *
+                             ((host_tim_reg[i].arr & 0xffff) + 1), f);
+}
+
+/* -------------------------------------------------------
+     host_naechster
+
+     liefert den Zeitpunkt (ps) des naechsten Systick- oder
+     Timerereignisses, 0 = keines. Zaehler koennen auch
+     direkt ueber die Register eingeschaltet werden und
+     werden deshalb hier (beim ersten Abfragen) gestartet.
+
+       *q : 0 = Systick, 1 = TIM2, 2 = TIM3
+   ------------------------------------------------------- */
+static uint64_t host_naechster(int *q)
+{
+  uint64_t t= 0;
+  int      i;
+
+  if (!host_irq_ein) return 0;
+
+  if (!(host_st_csr & 1)) host_st_next= 0;
+  else if (!host_st_next) host_st_next= host_ps + host_st_periode();
+  if (host_st_next)
+  {
+    t= host_st_next;
+    *q= 0;
+  }
+  for (i= 0; i < 2; i++)
+  {
+    if (!(host_tim_reg[i].cr1 & TIM_CR1_CEN))
+    {
+      host_tim_next[i]= 0;
+      continue;
+    }
+    if (!host_tim_next[i]) host_tim_next[i]= host_ps + host_tim_periode(i);
+    if ((!t) || (host_tim_next[i] < t))
+    {
+      t= host_tim_next[i];
+      *q= i+1;
+    }
+  }
+  return t;
+}
+
+/* -------------------------------------------------------
+     host_irq
+
+     fuehrt das Ereignis q aus (siehe host_naechster) und
+     ruft die Interruptfunktion auf, wenn der Interrupt
+     freigegeben ist. Waehrend einer Interruptfunktion
+     werden keine weiteren Interrupts ausgefuehrt.
+   ------------------------------------------------------- */
+static void host_irq(int q)
+{
+  host_tim_t *t;
+  uint8_t     alt;
+
+  alt= host_in_isr;
+  host_in_isr= 1;
+  if (q == 0)
+  {
+    host_st_next += host_st_periode();
+    if (host_st_csr & 2)
+    {
+      host_ereignis(host_tr_systick, 0, 0, 0);
+      sys_tick_handler();
+    }
+  }
+  else
+  {
+    t= &host_tim_reg[q-1];
+    host_tim_next[q-1] += host_tim_periode(q-1);
+    t->sr |= TIM_SR_UIF;
+    if ((t->dier & TIM_DIER_UIE) && (host_nvic[(q == 1) ? NVIC_TIM2_IRQ : NVIC_TIM3_IRQ]))
+    {
+      host_ereignis(host_tr_timer, q+1, 0, 0);
+      if (q == 1) tim2_isr(); else tim3_isr();
+    }
+  }
+  host_in_isr= alt;
+}
+
+/* -------------------------------------------------------
+     host_zeit_ps
+
+     zaehlt die virtuelle Zeit um ps weiter und fuehrt alle
+     bis dahin faelligen Interrupts aus. Die Dauer einer
+     Interruptfunktion verlaengert die Wartezeit.
+   ------------------------------------------------------- */
+static void host_zeit_ps(uint64_t ps)
+{
+  uint64_t ziel, t;
+  int      q;
+
+  ziel= host_ps + ps;
+  if (!host_in_isr)
+  {
+    while (((t= host_naechster(&q)) != 0) && (t <= ziel))
+    {
+      if (t > host_ps) host_ps= t;
+      t= host_ps;
+      host_irq(q);
+      ziel += host_ps - t;
+    }
+  }
+  if (host_ps < ziel) host_ps= ziel;
+  if ((host_ende_ps) && (host_ps >= host_ende_ps)) host_ende();
+}
+
+static void host_takte(uint32_t takte)
+{
+  host_zeit_ps(host_ps_takte(takte));
+}
+
+uint64_t host_zeit_ns(void)
+{
+  return host_ps / 1000;
+}
+
+void host_zeit_add(uint64_t ns)
+{
+  host_zeit_ps(ns * 1000);
+}
+
+/* -------------------------------------------------------
+     host_wfi
+
+     wird vom Assemblermakro wfi (libopencm3.h) aufgerufen:
+     die virtuelle Zeit laeuft bis zum naechsten Interrupt
+   ------------------------------------------------------- */
+void host_wfi(void)
+{
+  uint64_t t;
+  int      q;
+
+  host_flush();
+  t= host_naechster(&q);
+  if (!t)
+  {
+    fprintf(stderr, "host: wfi ohne laufenden Systick / Timer\n");
+    host_ende();
+  }
+  host_zeit_ps((t > host_ps) ? t - host_ps : 0);
+}
+
+/* -------------------------------------------------------
+     host_ende, host_start
+
+     Programmende und Auswertung der Umgebungsvariable
+     HOST_ZEIT, HOST_TRACE, HOST_TRACE_MAX (vor main)
+   ------------------------------------------------------- */
+void host_ende(void)
+{
+  fflush(stdout);
+  exit(0);
+}
+
+static void host_bilanz(void)
+{
+  int i;
+
+  fflush(stdout);
+  if ((host_trace_datei) && (!host_trace_write(host_trace_datei)))
+    fprintf(stderr, "host: %s kann nicht geschrieben werden\n", host_trace_datei);
+  fprintf(stderr, "\nhost: %llu.%03llu ms virtuelle Zeit",
+          (unsigned long long)(host_ps / 1000000000), (unsigned long long)(host_ps / 1000000 % 1000));
+  for (i= 0; i < host_tr_arten; i++)
+    fprintf(stderr, ", %s %u", host_tr_name[i], host_tr_anz[i]);
+  fprintf(stderr, "\n");
+}
+
+__attribute__((constructor)) static void host_start(void)
+{
+  const char *zeit, *max;
+
+  zeit= getenv("HOST_ZEIT");
+  if (zeit) host_ende_ps= strtoull(zeit, NULL, 10) * 1000000000ull;
+  host_trace_datei= getenv("HOST_TRACE");
+  if (host_trace_datei)
+  {
+    max= getenv("HOST_TRACE_MAX");
+    if (!host_trace_start(max ? (uint32_t)strtoul(max, NULL, 10) : 1000000))
+      fprintf(stderr, "host: kein Speicher fuer den Tracepuffer\n");
+  }
+  if ((zeit) || (host_trace_datei)) atexit(host_bilanz);
+}
+
+/* -------------------------------------------------------
+     host_gpio_of
+
+     liefert den Portzustand zu einer Portadresse (GPIOA
+     .. GPIOC), unbekannte Adressen landen bei GPIOC
+   ------------------------------------------------------- */
+static host_gpio_t *host_gpio_of(uint32_t gpioport)
+{
+  uint32_t nr;
+
+  nr= (gpioport - GPIOA) / (GPIOB - GPIOA);
+  if (nr >= host_portanz) nr= host_portanz-1;
+  return &host_gpio[nr];
+}
+
+/* -------------------------------------------------------
+     host_odr_write
+
+     schreibt einen neuen Wert in das Ausgangsregister und
+     meldet eine Aenderung an host_gpio_hook
+   ------------------------------------------------------- */
+/* -------------------------------------------------------
+     host_pegel
+
+     berechnet die Pegel an den Pins aus Ausgangsregister
+     und Pinkonfiguration und schreibt jede Aenderung in
+     den Trace (Ausgaenge nach ODR, schwebende Eingaenge
+     1, so dass z.B. ein Software-I2C mit Umschalten
+     zwischen Eingang und Ausgang Low die Buspegel zeigt)
+   ------------------------------------------------------- */
+static void host_pegel(host_gpio_t *p)
+{
+  uint16_t neu;
+
+  neu= (p->odr & (p->ausgang | p->pud)) | (p->offen & ~p->ausgang);
+  if (neu == p->pegel) return;
+  host_ereignis(host_tr_gpio, (uint8_t)(p - host_gpio), p->pegel, neu);
+  p->pegel= neu;
+}
+
+static void host_odr_write(host_gpio_t *p, uint16_t val)
+{
+  uint16_t old;
+
+  old= p->odr;
+  p->odr= val;
+  if (old == val) return;
+  host_pegel(p);
+  if (host_gpio_hook)
+    host_gpio_hook(GPIOA + (uint32_t)(p - host_gpio) * (GPIOB - GPIOA), old, val);
+}
+
+void host_flush(void)
+{
+  host_gpio_t *p;
+  uint16_t     val;
+
+  for (p= host_gpio; p < host_gpio + host_portanz; p++)
+  {
+    if (p->brr_pend)
+    {
+      p->brr_pend= 0;
+      host_odr_write(p, p->odr & ~(uint16_t)p->brr);
+    }
+    if (p->bsrr_pend)
+    {
+      p->bsrr_pend= 0;
+      // bei gleichzeitig gesetztem Set- und Resetbit hat Set Vorrang
+      val= (p->odr & ~(uint16_t)(p->bsrr >> 16)) | (uint16_t)p->bsrr;
+      host_odr_write(p, val);
+    }
+  }
+}
+
+void host_reset(void)
+{
+  int i;
+
+  for (i= 0; i < host_portanz; i++)
+    host_gpio[i]= (host_gpio_t)host_gpio_reset;
+  tick_ms= 0;
+  host_gpio_writes= 0;
+  host_gpio_calls= 0;
+  host_ps= 0;
+  host_st_csr= 0;
+  host_st_next= 0;
+  for (i= 0; i < 2; i++)
+  {
+    memset((void *)&host_tim_reg[i], 0, sizeof(host_tim_t));
+    host_tim_next[i]= 0;
+  }
+  for (i= 0; i < host_tr_arten; i++) host_tr_anz[i]= 0;
+  host_trace_anz= 0;
+  host_trace_verloren= 0;
+}
+
+uint16_t host_port(uint32_t gpioport)
+{
+  host_flush();
+  return host_gpio_of(gpioport)->odr;
+}
+
+volatile uint32_t *host_bsrr(uint32_t gpioport)
+{
+  host_gpio_t *p;
+
+  host_takte(host_takte_reg);
+  host_flush();
+  host_gpio_writes++;
+  p= host_gpio_of(gpioport);
+  p->bsrr= 0;
+  p->bsrr_pend= 1;
+  return &p->bsrr;
+}
+
+volatile uint32_t *host_brr(uint32_t gpioport)
+{
+  host_gpio_t *p;
+
+  host_takte(host_takte_reg);
+  host_flush();
+  host_gpio_writes++;
+  p= host_gpio_of(gpioport);
+  p->brr= 0;
+  p->brr_pend= 1;
+  return &p->brr;
+}
+
+// Schreibzugriffe ueber diesen Zeiger gehen an host_gpio_hook vorbei
+volatile uint32_t *host_odr(uint32_t gpioport)
+{
+  static uint32_t odr32;
+
+  odr32= host_port(gpioport);
+  return &odr32;
+}
+
+/* -------------------------------------------------------
+                            GPIO
+   ------------------------------------------------------- */
+
+void gpio_set_mode(uint32_t gpioport, uint8_t mode, uint8_t cnf, uint16_t gpios)
+{
+  host_gpio_t *p;
+
+  host_flush();
+  p= host_gpio_of(gpioport);
+  p->ausgang &= ~gpios;
+  p->pud &= ~gpios;
+  p->offen &= ~gpios;
+  if (mode != GPIO_MODE_INPUT)                     p->ausgang |= gpios;
+  else if (cnf == GPIO_CNF_INPUT_PULL_UPDOWN)      p->pud |= gpios;
+  else if (cnf == GPIO_CNF_INPUT_FLOAT)            p->offen |= gpios;
+  host_pegel(p);
+  host_takte(host_takte_aufruf);
+}
+
+void gpio_set(uint32_t gpioport, uint16_t gpios)
+{
+  host_gpio_t *p;
+
+  host_flush();
+  host_gpio_writes++;
+  host_gpio_calls++;
+  p= host_gpio_of(gpioport);
+  host_odr_write(p, p->odr | gpios);
+  host_takte(host_takte_aufruf);
+}
+
+void gpio_clear(uint32_t gpioport, uint16_t gpios)
+{
+  host_gpio_t *p;
+
+  host_flush();
+  host_gpio_writes++;
+  host_gpio_calls++;
+  p= host_gpio_of(gpioport);
+  host_odr_write(p, p->odr & ~gpios);
+  host_takte(host_takte_aufruf);
+}
+
+void gpio_toggle(uint32_t gpioport, uint16_t gpios)
+{
+  host_gpio_t *p;
+
+  host_flush();
+  host_gpio_writes++;
+  host_gpio_calls++;
+  p= host_gpio_of(gpioport);
+  host_odr_write(p, p->odr ^ gpios);
+  host_takte(host_takte_aufruf);
+}
+
+uint16_t gpio_get(uint32_t gpioport, uint16_t gpios)
+{
+  host_takte(host_takte_aufruf);
+  if (host_input_hook) return host_input_hook(gpioport, gpios) & gpios;
+  host_flush();
+  return host_gpio_of(gpioport)->pegel & gpios;
+}
+
+void gpio_port_write(uint32_t gpioport, uint16_t data)
+{
+  host_flush();
+  host_gpio_writes++;
+  host_gpio_calls++;
+  host_odr_write(host_gpio_of(gpioport), data);
+  host_takte(host_takte_aufruf);
+}
+
+uint16_t gpio_port_read(uint32_t gpioport)
+{
+  host_takte(host_takte_aufruf);
+  if (host_input_hook) return host_input_hook(gpioport, 0xffff);
+  host_flush();
+  return host_gpio_of(gpioport)->pegel;
+}
+
+/* -------------------------------------------------------
+                       RCC, AFIO, NVIC
+   ------------------------------------------------------- */
+
+void rcc_periph_clock_enable(enum rcc_periph_clken clken)
+{
+  (void)clken;
+}
+
+static void host_rcc(uint32_t ahb, uint32_t apb1)
+{
+  rcc_ahb_frequency= ahb;
+  rcc_apb1_frequency= apb1;
+  rcc_apb2_frequency= ahb;
+}
+
+void rcc_clock_setup_in_hse_8mhz_out_72mhz(void)  { host_rcc(72000000, 36000000); }
+void rcc_clock_setup_in_hsi_out_64mhz(void)       { host_rcc(64000000, 32000000); }
+void rcc_clock_setup_in_hsi_out_48mhz(void)       { host_rcc(48000000, 24000000); }
+
+void gpio_primary_remap(uint32_t swjenable, uint32_t maps)
+{
+  (void)swjenable; (void)maps;
+}
+
+void nvic_enable_irq(uint8_t irqn)
+{
+  if (irqn < sizeof(host_nvic)) host_nvic[irqn]= 1;
+}
+
+void nvic_disable_irq(uint8_t irqn)
+{
+  if (irqn < sizeof(host_nvic)) host_nvic[irqn]= 0;
+}
+
+void nvic_set_priority(uint8_t irqn, uint8_t priority)
+{
+  (void)irqn; (void)priority;
+}
+
+/* -------------------------------------------------------
+                      Interruptfunktionen
+
+     leere Fassungen, falls ein Programm die Funktion
+     nicht selbst enthaelt
+   ------------------------------------------------------- */
+
+host_weak void sys_tick_handler(void)   { }
+host_weak void tim2_isr(void)           { }
+host_weak void tim3_isr(void)           { }
+host_weak void dma1_channel3_isr(void)  { }
+
+/* -------------------------------------------------------
+                          Systick
+   ------------------------------------------------------- */
+
+void systick_set_clocksource(uint8_t clocksource)
+{
+  host_st_csr= (host_st_csr & ~STK_CSR_CLKSOURCE_AHB) | (clocksource & STK_CSR_CLKSOURCE_AHB);
+}
+
+void systick_set_reload(uint32_t value)   { host_st_reload= value & 0xffffff; }
+void systick_interrupt_enable(void)       { host_st_csr |= 2; }
+void systick_interrupt_disable(void)      { host_st_csr &= ~2; }
+void systick_counter_enable(void)         { host_st_csr |= 1; }
+void systick_counter_disable(void)        { host_st_csr &= ~1; }
+void systick_clear(void)                  { host_st_next= 0; }
+
+// Zaehlerstand aus der Zeit bis zum naechsten Nulldurchgang
+uint32_t systick_get_value(void)
+{
+  uint64_t takt;
+
+  if (!host_st_next) return 0;
+  takt= host_ps_takte((host_st_csr & STK_CSR_CLKSOURCE_AHB) ? 1 : 8);
+  return (uint32_t)((host_st_next - host_ps) / takt);
+}
+
+/* -------------------------------------------------------
+                           Timer
+   ------------------------------------------------------- */
+
+host_tim_t *host_tim(uint32_t timer_peripheral)
+{
+  return &host_tim_reg[(timer_peripheral == TIM3) ? 1 : 0];
+}
+
+void timer_reset(uint32_t timer_peripheral)
+{
+  memset((void *)host_tim(timer_peripheral), 0, sizeof(host_tim_t));
+  host_tim(timer_peripheral)->arr= 0xffff;
+}
+
+void timer_set_prescaler(uint32_t timer_peripheral, uint32_t value) { host_tim(timer_peripheral)->psc= value; }
+void timer_set_period(uint32_t timer_peripheral, uint32_t period)   { host_tim(timer_peripheral)->arr= period; }
+void timer_enable_update_event(uint32_t timer_peripheral)           { (void)timer_peripheral; }
+void timer_enable_irq(uint32_t timer_peripheral, uint32_t irq)      { host_tim(timer_peripheral)->dier |= irq; }
+void timer_enable_counter(uint32_t timer_peripheral)                { host_tim(timer_peripheral)->cr1 |= TIM_CR1_CEN; }
+
+/* -------------------------------------------------------
+                            SPI
+
+     Dauer eines Datenrahmens: Bits * Baudratenteiler
+     Takte des Peripherietakts (SPI1: APB2, SPI2: APB1)
+   ------------------------------------------------------- */
+
+typedef struct
+{
+  uint8_t  bits;                              // Rahmenbreite
+  uint16_t teiler;                            // Baudratenteiler
+  volatile uint32_t sr, dr;
+} host_spi_t;
+
+static host_spi_t host_spi[2] = { { 8, 2, 0, 0 }, { 8, 2, 0, 0 } };
+
+static host_spi_t *host_spi_of(uint32_t spi)
+{
+  return &host_spi[(spi == SPI2) ? 1 : 0];
+}
+
+uint8_t host_spi_bits(uint32_t spi)
+{
+  return host_spi_of(spi)->bits;
+}
+
+volatile uint32_t *host_spi_sr(uint32_t spi)
+{
+  host_spi_t *p;
+
+  host_takte(host_takte_reg);
+  p= host_spi_of(spi);
+  p->sr= SPI_SR_TXE;
+  return &p->sr;
+}
+
+volatile uint32_t *host_spi_dr(uint32_t spi)
+{
+  return &host_spi_of(spi)->dr;
+}
+
+void spi_reset(uint32_t spi_peripheral)                  { (void)spi_peripheral; }
+void spi_enable(uint32_t spi)                            { (void)spi; }
+void spi_disable(uint32_t spi)                           { (void)spi; }
+void spi_enable_software_slave_management(uint32_t spi)  { (void)spi; }
+void spi_set_nss_high(uint32_t spi)                      { (void)spi; }
+void spi_set_dff_8bit(uint32_t spi)                      { host_spi_of(spi)->bits= 8; }
+void spi_set_dff_16bit(uint32_t spi)                     { host_spi_of(spi)->bits= 16; }
+void spi_enable_tx_dma(uint32_t spi)                     { (void)spi; }
+void spi_disable_tx_dma(uint32_t spi)                    { (void)spi; }
+
+int spi_init_master(uint32_t spi, uint32_t br, uint32_t cpol, uint32_t cpha,
+                    uint32_t dff, uint32_t lsbfirst)
+{
+  host_spi_t *p;
+
+  (void)cpol; (void)cpha; (void)lsbfirst;
+  p= host_spi_of(spi);
+  p->teiler= 2 << ((br >> 3) & 0x07);
+  p->bits= (dff & SPI_CR1_DFF_16BIT) ? 16 : 8;
+  return 0;
+}
+
+void spi_send(uint32_t spi, uint16_t data)
+{
+  host_spi_t *p;
+
+  host_flush();                               // D/C, CS muessen vor dem Datum gueltig sein
+  p= host_spi_of(spi);
+  host_ereignis(host_tr_spi, (spi == SPI2) ? 2 : 1, data, p->bits);
+  if (host_spi_hook) host_spi_hook(spi, data);
+  host_zeit_ps(host_ps_f((uint64_t)p->bits * p->teiler,
+                         (spi == SPI2) ? rcc_apb1_frequency : rcc_apb2_frequency));
+}
+
+uint16_t spi_read(uint32_t spi)
+{
+  (void)spi;
+  return 0;
+}
+
+uint16_t spi_xfer(uint32_t spi, uint16_t data)
+{
+  spi_send(spi, data);
+  return 0;
+}
+
+/* -------------------------------------------------------
+                            I2C
+
+     Bittakt im Standardmodus 2 * CCR, im Fast-Mode 3 * CCR
+     Takte des in CR2 angegebenen Peripherietakts. Ein Byte
+     dauert 9 Bit (mit ACK), Start und Stop je 1 Bit.
+   ------------------------------------------------------- */
+
+typedef struct
+{
+  uint8_t  freq;                              // Peripherietakt in MHz
+  uint8_t  fast;
+  uint16_t ccr;
+  volatile uint32_t sr1, sr2;
+} host_i2c_t;
+
+static host_i2c_t host_i2c[2] = { { 8, 0, 40, 0, 0 }, { 8, 0, 40, 0, 0 } };
+
+static host_i2c_t *host_i2c_of(uint32_t i2c)
+{
+  return &host_i2c[(i2c == I2C2) ? 1 : 0];
+}
+
+// Uebertragung von bits Bit mit Mitschnitt, art: 'S'tart, 'A'dresse, 'D'aten, 'P' (Stop)
+static void host_i2c_bits(uint32_t i2c, uint8_t art, uint8_t data, uint32_t bits)
+{
+  host_i2c_t *p;
+
+  host_flush();
+  p= host_i2c_of(i2c);
+  host_ereignis(host_tr_i2c, (i2c == I2C2) ? 2 : 1, data, art);
+  if (host_i2c_hook) host_i2c_hook(i2c, art, data);
+  host_zeit_ps(host_ps_f((uint64_t)bits * p->ccr * (p->fast ? 3 : 2), (uint32_t)p->freq * 1000000));
+}
+
+volatile uint32_t *host_i2c_sr1(uint32_t i2c)
+{
+  host_i2c_t *p;
+
+  host_takte(host_takte_reg);
+  p= host_i2c_of(i2c);
+  p->sr1= I2C_SR1_SB | I2C_SR1_ADDR | I2C_SR1_BTF | I2C_SR1_TxE;
+  return &p->sr1;
+}
+
+volatile uint32_t *host_i2c_sr2(uint32_t i2c)
+{
+  host_i2c_t *p;
+
+  host_takte(host_takte_reg);
+  p= host_i2c_of(i2c);
+  p->sr2= I2C_SR2_MSL | I2C_SR2_BUSY;
+  return &p->sr2;
+}
+
+void i2c_peripheral_enable(uint32_t i2c)                          { (void)i2c; }
+void i2c_peripheral_disable(uint32_t i2c)                         { (void)i2c; }
+void i2c_set_clock_frequency(uint32_t i2c, uint8_t freq)          { host_i2c_of(i2c)->freq= freq; }
+void i2c_set_standard_mode(uint32_t i2c)                          { host_i2c_of(i2c)->fast= 0; }
+void i2c_set_fast_mode(uint32_t i2c)                              { host_i2c_of(i2c)->fast= 1; }
+void i2c_set_ccr(uint32_t i2c, uint16_t freq)                     { host_i2c_of(i2c)->ccr= freq & 0x0fff; }
+void i2c_set_trise(uint32_t i2c, uint16_t trise)                  { (void)i2c; (void)trise; }
+void i2c_set_own_7bit_slave_address(uint32_t i2c, uint8_t slave)  { (void)i2c; (void)slave; }
+
+void i2c_send_start(uint32_t i2c)                                 { host_i2c_bits(i2c, 'S', 0, 1); }
+void i2c_send_stop(uint32_t i2c)                                  { host_i2c_bits(i2c, 'P', 0, 1); }
+void i2c_send_data(uint32_t i2c, uint8_t data)                    { host_i2c_bits(i2c, 'D', data, 9); }
+
+void i2c_send_7bit_address(uint32_t i2c, uint8_t slave, uint8_t readwrite)
+{
+  host_i2c_bits(i2c, 'A', (uint8_t)((slave << 1) | (readwrite & 1)), 9);
+}
+
+/* -------------------------------------------------------
+                           USART
+
+     Dauer eines Zeichens: 10 Bit (8N1) bei der einge-
+     stellten Baudrate. Gesendete Zeichen gehen an
+     host_uart_tx_hook oder stdout, empfangene kommen aus
+     host_uart_rx_hook oder stdin (Ende von stdin beendet
+     das Programm, wenn auf ein Zeichen gewartet wird).
+   ------------------------------------------------------- */
+
+static uint32_t          host_baud[3]     = { 115200, 115200, 115200 };
+static int               host_rx_puf[3]   = { -1, -1, -1 };
+static volatile uint32_t host_usart_sr_reg[3];
+static uint8_t           host_stdin_ende  = 0;
+
+static int host_usart_nr(uint32_t usart)
+{
+  return (usart == USART2) ? 1 : (usart == USART3) ? 2 : 0;
+}
+
+static uint64_t host_zeichen_ps(int nr)
+{
+  return 10 * 1000000000000ull / (host_baud[nr] ? host_baud[nr] : 1);
+}
+
+// ein Zeichen von stdin, -1 = keines; warten = 1 : blockierend lesen
+static int host_stdin(int warten)
+{
+  struct pollfd pfd;
+  unsigned char ch;
+
+  if (host_stdin_ende) return -1;
+  if (!warten)
+  {
+    pfd.fd= 0;
+    pfd.events= POLLIN;
+    if (poll(&pfd, 1, 0) <= 0) return -1;
+  }
+  fflush(stdout);
+  if (read(0, &ch, 1) != 1)
+  {
+    host_stdin_ende= 1;
+    return -1;
+  }
+  return ch;
+}
+
+// holt das naechste empfangene Zeichen in den Empfangspuffer
+static int host_rx_bereit(uint32_t usart, int warten)
+{
+  int nr;
+
+  nr= host_usart_nr(usart);
+  if (host_rx_puf[nr] >= 0) return 1;
+  if (host_uart_rx_hook) host_rx_puf[nr]= host_uart_rx_hook(usart);
+                    else host_rx_puf[nr]= host_stdin(warten);
+  return (host_rx_puf[nr] >= 0);
+}
+
+volatile uint32_t *host_usart_sr(uint32_t usart)
+{
+  int nr;
+
+  host_takte(host_takte_reg);
+  nr= host_usart_nr(usart);
+  host_usart_sr_reg[nr]= USART_SR_TXE | USART_SR_TC | (host_rx_bereit(usart, 0) ? USART_SR_RXNE : 0);
+  return &host_usart_sr_reg[nr];
+}
+
+void usart_set_baudrate(uint32_t usart, uint32_t baud)               { host_baud[host_usart_nr(usart)]= baud; }
+void usart_set_databits(uint32_t usart, uint32_t bits)               { (void)usart; (void)bits; }
+void usart_set_stopbits(uint32_t usart, uint32_t stopbits)           { (void)usart; (void)stopbits; }
+void usart_set_mode(uint32_t usart, uint32_t mode)                   { (void)usart; (void)mode; }
+void usart_set_parity(uint32_t usart, uint32_t parity)               { (void)usart; (void)parity; }
+void usart_set_flow_control(uint32_t usart, uint32_t flowcontrol)    { (void)usart; (void)flowcontrol; }
+void usart_enable(uint32_t usart)                                    { (void)usart; }
+void usart_disable(uint32_t usart)                                   { (void)usart; }
+
+void usart_send_blocking(uint32_t usart, uint16_t data)
+{
+  int nr;
+
+  host_flush();
+  nr= host_usart_nr(usart);
+  host_ereignis(host_tr_uart_tx, nr+1, data, 0);
+  if (host_uart_tx_hook) host_uart_tx_hook(usart, data);
+                    else fputc(data & 0xff, stdout);     // putchar ist evtl. vom Programm ersetzt (smallio)
+  host_zeit_ps(host_zeichen_ps(nr));
+}
+
+void usart_send(uint32_t usart, uint16_t data)
+{
+  usart_send_blocking(usart, data);
+}
+
+uint16_t usart_recv(uint32_t usart)
+{
+  int nr, ch;
+
+  nr= host_usart_nr(usart);
+  if (!host_rx_bereit(usart, 0)) return 0;
+  ch= host_rx_puf[nr];
+  host_rx_puf[nr]= -1;
+  host_ereignis(host_tr_uart_rx, nr+1, ch, 0);
+  return ch;
+}
+
+uint16_t usart_recv_blocking(uint32_t usart)
+{
+  int nr;
+
+  host_flush();
+  nr= host_usart_nr(usart);
+  while (!host_rx_bereit(usart, 1))
+  {
+    if ((!host_uart_rx_hook) && (host_stdin_ende)) host_ende();
+    host_zeit_ps(host_zeichen_ps(nr));       // Hook: virtuell auf das Zeichen warten
+  }
+  return usart_recv(usart);
+}
+
+/* -------------------------------------------------------
+                            DMA
+
+     dma_enable_channel fuehrt den Transfer sofort aus:
+     ist die Peripherieadresse ein SPI-Datenregister, wird
+     jeder Datenrahmen wie mit spi_send gesendet. Danach
+     ist TCIF gesetzt und dma1_channel3_isr wird aufge-
+     rufen (wenn freigegeben, auch bei host_irq_ein = 0).
+   ------------------------------------------------------- */
+
+typedef struct
+{
+  uintptr_t paddr, maddr;
+  uint16_t  anz;
+  uint8_t   msize16, minc, tcie;
+  uint32_t  flags;
+} host_dma_t;
+
+static host_dma_t host_dma[8];
+
+static host_dma_t *host_dma_of(uint8_t channel)
+{
+  return &host_dma[channel & 7];
+}
+
+void dma_channel_reset(uint32_t dma, uint8_t channel)
+{
+  (void)dma;
+  memset(host_dma_of(channel), 0, sizeof(host_dma_t));
+}
+
+void dma_set_peripheral_address(uint32_t dma, uint8_t channel, uintptr_t address)  { (void)dma; host_dma_of(channel)->paddr= address; }
+void dma_set_memory_address(uint32_t dma, uint8_t channel, uintptr_t address)      { (void)dma; host_dma_of(channel)->maddr= address; }
+void dma_set_number_of_data(uint32_t dma, uint8_t channel, uint16_t number)        { (void)dma; host_dma_of(channel)->anz= number; }
+void dma_set_read_from_memory(uint32_t dma, uint8_t channel)                       { (void)dma; (void)channel; }
+void dma_set_peripheral_size(uint32_t dma, uint8_t channel, uint32_t peripheral_size) { (void)dma; (void)channel; (void)peripheral_size; }
+void dma_set_memory_size(uint32_t dma, uint8_t channel, uint32_t mem_size)         { (void)dma; host_dma_of(channel)->msize16= (mem_size == DMA_CCR_MSIZE_16BIT); }
+void dma_enable_memory_increment_mode(uint32_t dma, uint8_t channel)               { (void)dma; host_dma_of(channel)->minc= 1; }
+void dma_disable_memory_increment_mode(uint32_t dma, uint8_t channel)              { (void)dma; host_dma_of(channel)->minc= 0; }
+void dma_set_priority(uint32_t dma, uint8_t channel, uint32_t prio)                { (void)dma; (void)channel; (void)prio; }
+void dma_enable_transfer_complete_interrupt(uint32_t dma, uint8_t channel)         { (void)dma; host_dma_of(channel)->tcie= 1; }
+void dma_disable_channel(uint32_t dma, uint8_t channel)                            { (void)dma; (void)channel; }
+
+bool dma_get_interrupt_flag(uint32_t dma, uint8_t channel, uint32_t interrupts)
+{
+  (void)dma;
+  return (host_dma_of(channel)->flags & interrupts) != 0;
+}
+
+void dma_clear_interrupt_flags(uint32_t dma, uint8_t channel, uint32_t interrupts)
+{
+  (void)dma;
+  host_dma_of(channel)->flags &= ~interrupts;
+}
+
+void dma_enable_channel(uint32_t dma, uint8_t channel)
+{
+  host_dma_t *d;
+  uint32_t    spi;
+  uint16_t    data;
+  uint8_t     alt;
+
+  (void)dma;
+  d= host_dma_of(channel);
+  spi= 0;
+  if (d->paddr == (uintptr_t)&SPI1_DR) spi= SPI1;
+  if (d->paddr == (uintptr_t)&SPI2_DR) spi= SPI2;
+
+  host_ereignis(host_tr_dma, channel, d->anz, 0);
+  if (host_dma_hook) host_dma_hook(channel, d->paddr, d->maddr, d->anz, d->msize16, d->minc);
+  for (; d->anz; d->anz--)
+  {
+    if (d->msize16) data= *(const uint16_t *)d->maddr;
+               else data= *(const uint8_t *)d->maddr;
+    if (d->minc) d->maddr += d->msize16 ? 2 : 1;
+    if (spi) spi_send(spi, data);
+  }
+  d->flags |= DMA_TCIF;
+
+  if ((d->tcie) && (channel == DMA_CHANNEL3) && (host_nvic[NVIC_DMA1_CHANNEL3_IRQ]))
+  {
+    alt= host_in_isr;
+    host_in_isr= 1;
+    dma1_channel3_isr();
+    host_in_isr= alt;
+  }
+}
+
+/* -------------------------------------------------------
+                            ADC
+
+     jede Wandlung ist nach 14 ADC-Takten (12 MHz) fertig,
+     der Messwert steht in host_adc[kanal]
+   ------------------------------------------------------- */
+
+static uint8_t host_adc_kanal = 0;
+
+void adc_power_on(uint32_t adc)                           { (void)adc; }
+void adc_power_off(uint32_t adc)                          { (void)adc; }
+void adc_disable_scan_mode(uint32_t adc)                  { (void)adc; }
+void adc_set_single_conversion_mode(uint32_t adc)         { (void)adc; }
+void adc_disable_external_trigger_regular(uint32_t adc)   { (void)adc; }
+void adc_set_right_aligned(uint32_t adc)                  { (void)adc; }
+void adc_reset_calibration(uint32_t adc)                  { (void)adc; }
+void adc_calibration(uint32_t adc)                        { (void)adc; }
+bool adc_eoc(uint32_t adc)                                { (void)adc; return 1; }
+
+void adc_set_regular_sequence(uint32_t adc, uint8_t length, uint8_t channel[])
+{
+  (void)adc;
+  if (length) host_adc_kanal= channel[0] % 18;
+}
+
+void adc_start_conversion_direct(uint32_t adc)
+{
+  (void)adc;
+  host_zeit_ps(14 * 1000000000000ull / 12000000);
+}
+
+uint32_t adc_read_regular(uint32_t adc)
+{
+  (void)adc;
+  return host_adc[host_adc_kanal] & 0x0fff;
+}
+
+/* -------------------------------------------------------
+     delay
+
+     ersetzt delay aus sysf103_init.c, wenn dieses nicht
+     mit uebersetzt ist: es wird nicht gewartet, nur die
+     virtuelle Zeit weitergezaehlt
+   ------------------------------------------------------- */
+host_weak void delay(int c)
+{
+  host_flush();
+  host_zeit_ps((uint64_t)c * 1000000000ull);
+  tick_ms += c;
+  if (host_delay_hook) host_delay_hook(c);
+}
+
+/* -------------------------------------------------------
+     itoa
+
+     Erweiterung der newlib (Controller), in der glibc
+     nicht vorhanden: value als Zahl zur Basis base
+     (2..36) nach str, bei Basis 10 mit Vorzeichen
+   ------------------------------------------------------- */
+host_weak char *itoa(int value, char *str, int base)
+{
+  char         tmp[34];
+  unsigned int v;
+  int          i, j;
+
+  if ((base < 2) || (base > 36))
+  {
+    str[0]= 0;
+    return str;
+  }
+  j= 0;
+  v= (unsigned int)value;
+  if ((base == 10) && (value < 0))
+  {
+    str[j++]= '-';
+    v= -v;
+  }
+  i= 0;
+  do
+  {
+    tmp[i++]= "0123456789abcdefghijklmnopqrstuvwxyz"[v % base];
+    v /= base;
+  } while (v);
+  while (i) str[j++]= tmp[--i];
+  str[j]= 0;
+  return str;
+}
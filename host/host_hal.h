@@ -0,0 +1,139 @@
+/* -------------------------------------------------------
+                        host_hal.h
+
+   Schnittstelle der Host-Nachbildung (host_hal.c) zu
+   Testprogrammen auf dem PC: Zustand der GPIO-Ports,
+   virtuelle Zeit, Tracepuffer und Hookfunktionen, ueber
+   die gesendete SPI-Bytes, Pinwechsel und UART-Zeichen
+   mitgeschnitten werden.
+
+   Virtuelle Zeit
+
+   Jeder Aufruf einer nachgebildeten libopencm3-Funktion
+   zaehlt die Zeit um die Dauer des Zugriffs weiter (GPIO
+   einige Takte, SPI-Rahmen nach Baudratenteiler, I2C nach
+   CCR, UART-Zeichen nach Baudrate). Rechenzeit des Programms selbst
+   wird nicht gezaehlt. Systick, Timer 2/3 und DMA-Ende
+   rufen die Interruptfunktionen des Programms auf, sobald
+   die virtuelle Zeit den naechsten Interrupt erreicht.
+
+   Umgebungsvariable fuer die mit "make host" uebersetzten
+   Projekte:
+
+     HOST_ZEIT=ms        Programm endet nach ms virtueller Zeit
+     HOST_TRACE=datei    Tracepuffer am Ende in datei schreiben
+     HOST_TRACE_MAX=n    Groesse des Tracepuffers (Ereignisse)
+
+   Ist eine der Variablen gesetzt, wird am Programmende eine
+   Zusammenfassung (Zeit, Anzahl je Ereignisart) auf stderr
+   ausgegeben.
+  -------------------------------------------------------- */
+
+#ifndef in_host_hal
+  #define in_host_hal
+
+  #include <stdint.h>
+
+  #ifdef __cplusplus
+  extern "C" {
+  #endif
+
+  // wird fuer jedes mit spi_send / spi_xfer (oder DMA) gesendete Datum aufgerufen
+  typedef void (*host_spi_hook_t)(uint32_t spi, uint16_t data);
+
+  // wird bei jeder Aenderung eines Ausgangsregisters aufgerufen
+  // (gpio_set, gpio_clear, gpio_port_write, GPIO_BSRR ...)
+  typedef void (*host_gpio_hook_t)(uint32_t gpioport, uint16_t oldval, uint16_t newval);
+
+  // liefert den Zustand der Eingaenge gpios (gpio_get, gpio_port_read),
+  // ohne Hook wird der Pegel gelesen (Ausgaenge: Ausgangsregister,
+  // schwebende Eingaenge: 1)
+  typedef uint16_t (*host_input_hook_t)(uint32_t gpioport, uint16_t gpios);
+
+  // wird bei jedem Aufruf von delay aufgerufen (nach dem Weiterzaehlen von tick_ms)
+  typedef void (*host_delay_hook_t)(int ms);
+
+  // UART: gesendetes Zeichen (ohne Hook: Ausgabe auf stdout) und
+  // naechstes empfangenes Zeichen, -1 = keines vorhanden (ohne Hook: stdin)
+  typedef void (*host_uart_tx_hook_t)(uint32_t usart, uint16_t data);
+  typedef int  (*host_uart_rx_hook_t)(uint32_t usart);
+
+  // I2C (Hardware): art 'S' Start, 'A' Adressbyte (mit R/W Bit), 'D' Datum, 'P' Stop
+  typedef void (*host_i2c_hook_t)(uint32_t i2c, uint8_t art, uint8_t data);
+
+  // DMA: wird bei dma_enable_channel mit den Registerwerten des Kanals aufgerufen,
+  // bevor die Datenrahmen gesendet werden
+  typedef void (*host_dma_hook_t)(uint8_t channel, uintptr_t paddr, uintptr_t maddr,
+                                  uint16_t anz, uint8_t msize16, uint8_t minc);
+
+  extern host_spi_hook_t  host_spi_hook;
+  extern host_gpio_hook_t host_gpio_hook;
+  extern host_input_hook_t host_input_hook;
+  extern host_delay_hook_t host_delay_hook;
+  extern host_uart_tx_hook_t host_uart_tx_hook;
+  extern host_uart_rx_hook_t host_uart_rx_hook;
+  extern host_i2c_hook_t  host_i2c_hook;
+  extern host_dma_hook_t  host_dma_hook;
+
+  extern volatile int tick_ms;                       // ms (delay oder sys_tick_handler zaehlt hoch)
+  extern uint32_t host_gpio_writes;                  // Anzahl Schreibzugriffe auf GPIO-Register
+                                                     // (gpio_set/clear/toggle/port_write, BSRR, BRR)
+  extern uint32_t host_gpio_calls;                   // davon ueber Funktionsaufrufe der libopencm3
+  extern uint16_t host_adc[18];                      // Messwerte je ADC-Kanal (adc_read_regular)
+  extern uint8_t  host_irq_ein;                      // 0 : Systick und Timer loesen keine Inter-
+                                                     // rupts aus (Testrahmen ruft die Interrupt-
+                                                     // funktionen selbst auf)
+
+  uint16_t host_port(uint32_t gpioport);             // aktueller Zustand des Ausgangsregisters
+  void host_flush(void);                             // noch nicht uebernommene BSRR/BRR-Schreib-
+                                                     // zugriffe auf die Ausgangsregister anwenden
+  void host_reset(void);                             // alle Ports auf 0, Zeit auf 0, Hooks bleiben
+  uint8_t host_spi_bits(uint32_t spi);               // Rahmenbreite 8 / 16 Bit
+
+  /* ----------------------- virtuelle Zeit ----------------------- */
+
+  uint64_t host_zeit_ns(void);                       // virtuelle Zeit seit Start / host_reset
+  void host_zeit_add(uint64_t ns);                   // Zeit weiterzaehlen, faellige Interrupts
+                                                     // ausfuehren
+  void host_ende(void);                              // Programm beenden (Trace schreiben)
+
+  /* ------------------------ Tracepuffer ------------------------- */
+
+  #define host_tr_spi         0                      // nr: SPI 1/2, wert: Datum, wert2: Bits
+  #define host_tr_gpio        1                      // nr: Port 0..2 (A..C), Pegel wert: alt, wert2: neu
+  #define host_tr_i2c         2                      // nr: I2C 1/2, wert: Datum, wert2: Art (Hook)
+  #define host_tr_uart_tx     3                      // nr: USART 1..3, wert: Zeichen
+  #define host_tr_uart_rx     4                      // dto.
+  #define host_tr_systick     5
+  #define host_tr_timer       6                      // nr: Timer 2/3 (Update-Interrupt)
+  #define host_tr_dma         7                      // nr: Kanal, wert: Anzahl Datenrahmen
+  #define host_tr_arten       8
+
+  typedef struct
+  {
+    uint64_t ns;                                     // virtuelle Zeit
+    uint8_t  art;                                    // host_tr_...
+    uint8_t  nr;
+    uint16_t wert, wert2;
+  } host_ereignis_t;
+
+  extern const char *const host_tr_name[host_tr_arten];
+  extern uint32_t host_tr_anz[host_tr_arten];        // Ereignisse je Art (auch ohne Trace)
+
+  extern host_ereignis_t *host_trace;                // Tracepuffer, NULL = aus
+  extern uint32_t host_trace_anz;                    // Eintraege im Puffer
+  extern uint32_t host_trace_max;                    // Groesse des Puffers
+  extern uint32_t host_trace_verloren;               // bei vollem Puffer nicht aufgezeichnet
+
+  int  host_trace_start(uint32_t max);               // Puffer fuer max Ereignisse anlegen, 0 = Fehler
+  void host_trace_stop(void);                        // Puffer freigeben
+  int  host_trace_write(const char *fname);          // Puffer als Text schreiben, 0 = Fehler
+
+  void delay(int c);                                 // ersetzt delay aus sysf103_init.c, wenn
+                                                     // dieses nicht mit uebersetzt wird
+
+  #ifdef __cplusplus
+  }
+  #endif
+
+#endif
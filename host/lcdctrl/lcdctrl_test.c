@@ -0,0 +1,331 @@
+/* -------------------------------------------------------
+                      lcdctrl_test.c
+
+   Test der Controller-Nachbildung host/lcdemu.c mit dem
+   Treiber src/tftdisplay.c auf dem PC.
+
+   tftdisplay.c wird je Controller (ILI9340, ST7735R,
+   S6D02A1, ILI9225) mit der Konfiguration cfg_<ctrl>
+   (128x160, kein DMA) uebersetzt und zeichnet dieselbe
+   Testszene in jeder Ausgaberichtung (outmode 0..3). Die
+   Bytes laufen mit D/C in lcdemu, jeweils als der Con-
+   troller, fuer den uebersetzt wurde. Das sichtbare Bild
+   muss fuer alle Controller gleich sein.
+
+   Ausgegeben werden je Ausgaberichtung die Bytes auf dem
+   Displaybus je Kommandoklasse und ein Pruefwert des
+   Bildes.
+
+       lcdctrl_<ctrl>           : Pruefwerte in ref.txt
+                                  schreiben
+       lcdctrl_<ctrl> ref.txt   : mit ref.txt vergleichen
+
+   Zusaetzlich werden Adressierung, MADCTL bzw. Entry
+   Mode und Scrollregister der Nachbildung direkt mit
+   Kommandobytes geprueft.
+
+   Rueckgabewert 1, wenn ein Vergleich fehlschlaegt.
+  -------------------------------------------------------- */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "tftdisplay.h"
+#include "host_hal.h"
+#include "lcdemu.h"
+
+#if (ili9225 == 1)
+  #define emu_ctrl    lcdemu_ili9225
+  #define emu_name    "ILI9225"
+#elif (st7735r == 1)
+  #define emu_ctrl    lcdemu_st7735
+  #define emu_name    "ST7735R"
+#elif (s6d02a1 == 1)
+  #define emu_ctrl    lcdemu_s6d02a1
+  #define emu_name    "S6D02A1"
+#else
+  #define emu_ctrl    lcdemu_ili9340
+  #define emu_name    "ILI9340"
+#endif
+
+static lcdemu_t emu;
+static uint32_t dc_port;
+static uint16_t dc_mask;
+static int      fails;
+
+// Port und Pin von D/C aus den Makros in tft_pindefs.h ermitteln
+static void find_dc(void)
+{
+  uint16_t a, b;
+
+  dc_clr();
+  a= host_port(GPIOA); b= host_port(GPIOB);
+  dc_set();
+  if (host_port(GPIOA) != a) { dc_port= GPIOA; dc_mask= host_port(GPIOA) ^ a; }
+                        else { dc_port= GPIOB; dc_mask= host_port(GPIOB) ^ b; }
+}
+
+static void spi_decode(uint32_t spi, uint16_t data)
+{
+  (void)spi;
+  lcdemu_byte(&emu, (host_port(dc_port) & dc_mask) ? 1 : 0, data);
+}
+
+static uint32_t image_hash(const lcdemu_t *e)
+{
+  uint32_t h= 2166136261u;
+  uint16_t c;
+  int      x, y;
+
+  for (y= 0; y < e->h; y++)
+    for (x= 0; x < e->w; x++)
+    {
+      c= lcdemu_pixel(e, x, y);
+      h= (h ^ (c & 0xff)) * 16777619u;
+      h= (h ^ (c >> 8)) * 16777619u;
+    }
+  return h;
+}
+
+/* -------------------------------------------------------
+     scene
+
+     Testszene im Bereich 128x128 (in allen Ausgabe-
+     richtungen sichtbar): Fuellungen, Linien, Kreise,
+     Text, Fensterausgabe und Einzelpunkte
+   ------------------------------------------------------- */
+static void scene(void)
+{
+  static uint16_t buf[16*16];
+  int i;
+
+  bkcolor= rgbfromega(1);
+  clrscr();
+  fillrect(5, 5, 60, 40, rgbfromega(12));
+  rectangle(2, 2, 125, 125, rgbfromega(15));
+  line(0, 0, 100, 120, rgbfromega(14));
+  line(120, 10, 10, 90, rgbfromega(10));
+  circle(64, 70, 30, rgbfromega(11));
+  fillcircle(95, 30, 12, rgbfromega(13));
+  fillroundrect(70, 95, 120, 118, 5, rgbfromega(6));
+  setfont(0);
+  textcolor= rgbfromega(15);
+  outtextxy(8, 100, 0, "lcdemu");
+
+  for (i= 0; i < 16*16; i++) buf[i]= rgbfromvalue(i & 0xf0, (i << 4) & 0xf0, 0x80);
+  tft_window_begin(40, 50, 55, 65);
+  tft_push_pixels(buf, 16*16);
+  tft_window_end();
+
+  putpixel(0, 0, rgbfromega(15));
+  putpixel(1, 0, rgbfromega(4));
+  putpixel(0, 1, rgbfromega(2));
+}
+
+/* -------------------------------------------------------
+     Direkttest der Nachbildung mit Kommandobytes
+   ------------------------------------------------------- */
+static lcdemu_t t;
+
+static void tcmd(uint8_t c)
+{
+  lcdemu_byte(&t, 0, c);
+}
+
+static void tdat16(uint16_t v)
+{
+  lcdemu_byte(&t, 1, v >> 8);
+  lcdemu_byte(&t, 1, v & 0xff);
+}
+
+static void tcheck(const char *name, int ok)
+{
+  printf("  %-36s %s\n", name, ok ? "ok" : "FEHLER");
+  if (!ok) fails++;
+}
+
+#if (emu_ctrl == lcdemu_ili9340)
+
+// MADCTL fuer Drehung 0..3 (wie lcd_orientation der 8-Bit Displays), BGR gesetzt
+static const uint8_t madrot[4]= { 0x48, 0x28, 0x88, 0xe8 };
+
+// erwartete Lage (sichtbar) der logischen Punkte (0,0) und (1,0) bei 240x320
+static const int madpos[4][4]=
+{
+  {   0,   0,   1,   0 },
+  { 239,   0, 239,   1 },
+  { 239, 319, 238, 319 },
+  {   0, 319,   0, 318 }
+};
+
+static void emu_selftest(void)
+{
+  char name[40];
+  int  r;
+
+  lcdemu_init(&t, 240, 320);
+  tcmd(0x36); lcdemu_byte(&t, 1, 0x48);
+  tcmd(0x2c);                                         // Einbaulage 0x48
+
+  for (r= 0; r < 4; r++)
+  {
+    tcmd(0x36); lcdemu_byte(&t, 1, madrot[r]);
+    tcmd(0x2a); tdat16(0); tdat16(1);
+    tcmd(0x2b); tdat16(0); tdat16(0);
+    tcmd(0x2c); tdat16(0xf800); tdat16(0x07e0);
+    sprintf(name, "MADCTL %02x (Drehung %d)", madrot[r], r);
+    tcheck(name, (lcdemu_pixel(&t, madpos[r][0], madpos[r][1]) == 0xf800) &&
+                 (lcdemu_pixel(&t, madpos[r][2], madpos[r][3]) == 0x07e0));
+  }
+
+  tcmd(0x36); lcdemu_byte(&t, 1, 0x40);               // BGR geloescht
+  tcmd(0x2a); tdat16(5); tdat16(5);
+  tcmd(0x2b); tdat16(5); tdat16(5);
+  tcmd(0x2c); tdat16(0xf800);
+  tcheck("MADCTL BGR (rot wird blau)", lcdemu_pixel(&t, 5, 5) == 0x001f);
+
+  tcmd(0x36); lcdemu_byte(&t, 1, 0x48);
+  tcmd(0x2a); tdat16(7); tdat16(7);
+  tcmd(0x2b); tdat16(10); tdat16(10);
+  tcmd(0x2c); tdat16(0x1234);
+  tcmd(0x33); tdat16(0); tdat16(320); tdat16(0);
+  tcmd(0x37); tdat16(10);
+  tcheck("Vertical Scrolling (Zeile 10 oben)", lcdemu_pixel(&t, 7, 0) == 0x1234);
+
+  lcdemu_free(&t);
+}
+
+#endif
+
+#if (emu_ctrl == lcdemu_ili9225)
+
+static void treg(uint8_t reg, uint16_t v)
+{
+  tcmd(reg);
+  tdat16(v);
+}
+
+static void emu_selftest(void)
+{
+  lcdemu_init_ctrl(&t, lcdemu_ili9225, 176, 220);
+  treg(0x01, 0x011c);
+  treg(0x03, 0x1038);
+  tcmd(0x22);                                         // Einbaulage
+
+  // Fenster 2x2 bei 10,20, AM= 1 : zuerst vertikal
+  treg(0x37, 10); treg(0x36, 11);
+  treg(0x39, 20); treg(0x38, 21);
+  treg(0x20, 10); treg(0x21, 20);
+  tcmd(0x22); tdat16(1); tdat16(2); tdat16(3); tdat16(4);
+  tcheck("Entry Mode AM= 1, ID= 11",
+         (lcdemu_pixel(&t, 10, 20) == 1) && (lcdemu_pixel(&t, 10, 21) == 2) &&
+         (lcdemu_pixel(&t, 11, 20) == 3) && (lcdemu_pixel(&t, 11, 21) == 4));
+
+  // AM= 0, ID= 01 : horizontal aufwaerts, vertikal abwaerts
+  treg(0x03, 0x1010);
+  treg(0x20, 10); treg(0x21, 21);
+  tcmd(0x22); tdat16(5); tdat16(6); tdat16(7); tdat16(8);
+  tcheck("Entry Mode AM= 0, ID= 01",
+         (lcdemu_pixel(&t, 10, 21) == 5) && (lcdemu_pixel(&t, 11, 21) == 6) &&
+         (lcdemu_pixel(&t, 10, 20) == 7) && (lcdemu_pixel(&t, 11, 20) == 8));
+
+  treg(0x32, 0); treg(0x31, 219); treg(0x33, 20);
+  tcheck("Scrollweite 20 (Zeile 20 oben)", lcdemu_pixel(&t, 10, 0) == 7);
+
+  lcdemu_free(&t);
+}
+
+#endif
+
+#if ((emu_ctrl == lcdemu_st7735) || (emu_ctrl == lcdemu_s6d02a1))
+
+static void emu_selftest(void)
+{
+  int i;
+
+  lcdemu_init_ctrl(&t, emu_ctrl, 128, 160);
+  tcmd(0x36); lcdemu_byte(&t, 1, 0x00);
+  tcmd(0x2c);                                         // Einbaulage 0x00
+
+  // MX spiegelt ueber alle 132 Spalten des Display-Rams: Spalten 0..3 sind
+  // danach unsichtbar (deshalb colofs bei manchen Modulen)
+  tcmd(0x36); lcdemu_byte(&t, 1, 0x40);
+  tcmd(0x2a); tdat16(0); tdat16(4);
+  tcmd(0x2b); tdat16(0); tdat16(0);
+  tcmd(0x2c);
+  for (i= 1; i <= 5; i++) tdat16(i);
+  tcheck("MX, Display-Ram 132 Spalten",
+         (lcdemu_pixel(&t, 127, 0) == 5) && (lcdemu_pixel(&t, 126, 0) == 0));
+
+  lcdemu_free(&t);
+}
+
+#endif
+
+int main(int argc, char **argv)
+{
+  uint32_t kl0[lcdemu_klassen], hash[4], rhash[4];
+  uint32_t sum;
+  int      m, k;
+  FILE     *f;
+
+  host_reset();
+  find_dc();
+  lcdemu_init_ctrl(&emu, emu_ctrl, _xres, _yres);
+  host_spi_hook= spi_decode;
+
+  printf("\n%s %dx%d (Display-Ram %dx%d)\n", emu_name, _xres, _yres, emu.gw, emu.gh);
+
+  emu_selftest();
+
+  lcd_init();
+  printf("  %-10s", "");
+  for (k= 0; k < lcdemu_klassen; k++) printf(" %9.9s", lcdemu_klname[k]);
+  printf(" %9s  Pruefwert\n", "gesamt");
+  printf("  %-10s", "lcd_init");
+  for (k= 0, sum= 0; k < lcdemu_klassen; k++) { printf(" %9lu", (unsigned long)emu.nkl[k]); sum += emu.nkl[k]; }
+  printf(" %9lu\n", (unsigned long)sum);
+
+  for (m= 0; m < 4; m++)
+  {
+    outmode= m;
+    memcpy(kl0, emu.nkl, sizeof(kl0));
+    scene();
+    hash[m]= image_hash(&emu);
+    printf("  outmode %d ", m);
+    for (k= 0, sum= 0; k < lcdemu_klassen; k++)
+    {
+      printf(" %9lu", (unsigned long)(emu.nkl[k] - kl0[k]));
+      sum += emu.nkl[k] - kl0[k];
+    }
+    printf(" %9lu  %08lx\n", (unsigned long)sum, (unsigned long)hash[m]);
+  }
+
+  if (argc > 1)
+  {
+    f= fopen(argv[1], "r");
+    if (!f) { perror(argv[1]); return 1; }
+    for (m= 0; m < 4; m++)
+      if (fscanf(f, "%x", &rhash[m]) != 1) rhash[m]= 0;
+    fclose(f);
+    for (m= 0; m < 4; m++)
+      if (hash[m] != rhash[m])
+      {
+        printf("  outmode %d: Bild weicht ab (Referenz %08lx)\n", m, (unsigned long)rhash[m]);
+        fails++;
+      }
+    printf("  %-36s %s\n", "Vergleich mit Referenz", fails ? "FEHLER" : "gleich");
+  }
+  else
+  {
+    f= fopen("ref.txt", "w");
+    if (f)
+    {
+      for (m= 0; m < 4; m++) fprintf(f, "%08lx\n", (unsigned long)hash[m]);
+      fclose(f);
+    }
+  }
+
+  lcdemu_free(&emu);
+  return fails ? 1 : 0;
+}
@@ -0,0 +1,350 @@
+/* -------------------------------------------------------
+                        lcdemu.c
+
+   Nachbildung eines Displaycontrollers, siehe lcdemu.h
+  -------------------------------------------------------- */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "lcdemu.h"
+
+const char *const lcdemu_klname[lcdemu_klassen]=
+  { "Fenster", "Ram / Farbdaten", "Modus", "Scroll", "sonstige" };
+
+void lcdemu_init_ctrl(lcdemu_t *e, int ctrl, int w, int h)
+{
+  memset(e, 0, sizeof(*e));
+  e->ctrl= ctrl;
+  e->w= w;
+  e->h= h;
+  e->gw= w;
+  e->gh= h;
+  switch (ctrl)
+  {
+    case lcdemu_st7735  :
+    case lcdemu_s6d02a1 : if ((w <= 132) && (h <= 162)) { e->gw= 132; e->gh= 162; }
+                          break;
+    case lcdemu_ili9225 : if ((w <= 176) && (h <= 220)) { e->gw= 176; e->gh= 220; }
+                          e->entry= 0x0030;
+                          break;
+    default             : break;
+  }
+  e->gram= calloc((size_t)e->gw * e->gh, sizeof(uint16_t));
+  e->c2= e->gw-1;
+  e->r2= e->gh-1;
+  e->vsa= e->gh;
+}
+
+void lcdemu_init(lcdemu_t *e, int w, int h)
+{
+  lcdemu_init_ctrl(e, lcdemu_ili9340, w, h);
+}
+
+void lcdemu_free(lcdemu_t *e)
+{
+  free(e->gram);
+  e->gram= NULL;
+}
+
+static uint16_t arg16(const lcdemu_t *e, int i)
+{
+  return (e->args[i] << 8) | e->args[i+1];
+}
+
+static uint16_t bgrswap(uint16_t c)
+{
+  return (c >> 11) | (c & 0x07e0) | ((c & 0x1f) << 11);
+}
+
+/* -------------------------------------------------------
+     dcs_phys
+
+     Adresse (Spalte c, Zeile r) bei MADCTL mad in die
+     physikalische Position im Display-Ram: MX spiegelt die
+     Spalten-, MY die Zeilenadresse, MV vertauscht beide
+     (die Spaltenadresse waehlt dann die Ram-Zeile).
+
+     Rueckgabe 0 : Adresse ausserhalb des Display-Rams
+   ------------------------------------------------------- */
+static int dcs_phys(const lcdemu_t *e, uint8_t mad, int c, int r, int *px, int *py)
+{
+  int cw, ch;
+
+  if (mad & 0x20) { cw= e->gh; ch= e->gw; }
+             else { cw= e->gw; ch= e->gh; }
+  if ((c < 0) || (c >= cw) || (r < 0) || (r >= ch)) return 0;
+  if (mad & 0x40) c= cw-1-c;
+  if (mad & 0x80) r= ch-1-r;
+  if (mad & 0x20) { *px= r; *py= c; }
+             else { *px= c; *py= r; }
+  return 1;
+}
+
+static int klasse(const lcdemu_t *e, uint8_t cmd)
+{
+  if (e->ctrl == lcdemu_ili9225)
+  {
+    switch (cmd)
+    {
+      case 0x20 : case 0x21 :
+      case 0x36 : case 0x37 : case 0x38 : case 0x39 : return lcdemu_kl_fenster;
+      case 0x22 :                                      return lcdemu_kl_ram;
+      case 0x01 : case 0x03 :                          return lcdemu_kl_modus;
+      case 0x31 : case 0x32 : case 0x33 :              return lcdemu_kl_scroll;
+      default   :                                      return lcdemu_kl_sonst;
+    }
+  }
+  switch (cmd)
+  {
+    case 0x2a : case 0x2b :                            return lcdemu_kl_fenster;
+    case 0x2c :                                        return lcdemu_kl_ram;
+    case 0x36 : case 0x3a :                            return lcdemu_kl_modus;
+    case 0x12 : case 0x13 : case 0x33 : case 0x37 :    return lcdemu_kl_scroll;
+    default   :                                        return lcdemu_kl_sonst;
+  }
+}
+
+/* -------------------------------------------------------
+     ILI9225: Registerwert schreiben
+   ------------------------------------------------------- */
+static void reg9225(lcdemu_t *e, uint8_t reg, uint16_t v)
+{
+  switch (reg)
+  {
+    case 0x01 : e->drv= v; break;
+    case 0x03 : e->entry= v; break;
+    case 0x20 : e->cc= v; break;
+    case 0x21 : e->rr= v; break;
+    case 0x36 : e->c2= v; break;
+    case 0x37 : e->c1= v; break;
+    case 0x38 : e->r2= v; break;
+    case 0x39 : e->r1= v; break;
+    case 0x31 : e->sea= v; break;
+    case 0x32 : e->ssa= v; break;
+    case 0x33 : e->sst= v; e->scroll= 1; e->nscroll++; break;
+    default   : return;
+  }
+  // Scrollbereich ssa .. sea, erste Zeile zeigt Ram-Zeile ssa + sst
+  e->tfa= e->ssa;
+  e->vsa= (e->sea >= e->ssa) ? e->sea - e->ssa + 1 : 0;
+  e->vsp= e->ssa + e->sst;
+}
+
+/* -------------------------------------------------------
+     ILI9225: Farbwert schreiben, Adresse zaehlt nach
+     Entry Mode (ID0 : horizontal aufwaerts, ID1 : vertikal
+     aufwaerts, AM : zuerst vertikal) im Fenster weiter
+   ------------------------------------------------------- */
+static void ram9225(lcdemu_t *e, uint16_t c)
+{
+  int hinc, vinc;
+
+  if ((e->entry ^ e->entryref) & 0x1000) c= bgrswap(c);
+  if ((e->cc >= 0) && (e->cc < e->gw) && (e->rr >= 0) && (e->rr < e->gh))
+    e->gram[e->rr * e->gw + e->cc]= c;
+
+  hinc= (e->entry & 0x10) ? 1 : -1;
+  vinc= (e->entry & 0x20) ? 1 : -1;
+  if (e->entry & 0x08)
+  {
+    e->rr += vinc;
+    if ((e->rr < e->r1) || (e->rr > e->r2))
+    {
+      e->rr= (vinc > 0) ? e->r1 : e->r2;
+      e->cc += hinc;
+      if ((e->cc < e->c1) || (e->cc > e->c2)) e->cc= (hinc > 0) ? e->c1 : e->c2;
+    }
+  }
+  else
+  {
+    e->cc += hinc;
+    if ((e->cc < e->c1) || (e->cc > e->c2))
+    {
+      e->cc= (hinc > 0) ? e->c1 : e->c2;
+      e->rr += vinc;
+      if ((e->rr < e->r1) || (e->rr > e->r2)) e->rr= (vinc > 0) ? e->r1 : e->r2;
+    }
+  }
+}
+
+static void byte9225(lcdemu_t *e, uint8_t b)
+{
+  if (e->cmd != 0x22)
+  {
+    // jedes 16-Bit Wort nach dem Index schreibt das Register (das letzte gilt)
+    if (!(e->argi & 1)) e->args[0]= b;
+                   else reg9225(e, e->cmd, (e->args[0] << 8) | b);
+    e->argi++;
+    return;
+  }
+  if (!e->half) { e->hi= b; e->half= 1; return; }
+  e->half= 0;
+  ram9225(e, (e->hi << 8) | b);
+}
+
+/* -------------------------------------------------------
+     ILI9340, ST7735, S6D02A1: Datenbyte
+   ------------------------------------------------------- */
+static void bytedcs(lcdemu_t *e, uint8_t b)
+{
+  uint16_t c;
+  int      px, py;
+
+  if (e->cmd != 0x2c)
+  {
+    if (e->argi < sizeof(e->args)) e->args[e->argi]= b;
+    e->argi++;
+    switch (e->cmd)
+    {
+      case 0x2a : if (e->argi == 2) e->c1= arg16(e, 0);
+                  if (e->argi == 4) e->c2= arg16(e, 2);
+                  break;
+      case 0x2b : if (e->argi == 2) e->r1= arg16(e, 0);
+                  if (e->argi == 4) e->r2= arg16(e, 2);
+                  break;
+      case 0x36 : if (e->argi == 1) e->mad= b;
+                  break;
+      case 0x33 : if (e->argi == 6)
+                  {
+                    e->tfa= arg16(e, 0);
+                    e->vsa= arg16(e, 2);
+                    e->bfa= arg16(e, 4);
+                  }
+                  break;
+      case 0x37 : if (e->argi == 2)
+                  {
+                    e->vsp= arg16(e, 0);
+                    e->scroll= 1;
+                    e->nscroll++;
+                  }
+                  break;
+      default   : break;
+    }
+    return;
+  }
+
+  if (!e->half) { e->hi= b; e->half= 1; return; }
+  e->half= 0;
+  c= (e->hi << 8) | b;
+  if ((e->mad ^ e->madref) & 0x08) c= bgrswap(c);
+  if (dcs_phys(e, e->mad, e->cc, e->rr, &px, &py)) e->gram[py * e->gw + px]= c;
+  if (++e->cc > e->c2)
+  {
+    e->cc= e->c1;
+    if (++e->rr > e->r2) e->rr= e->r1;
+  }
+}
+
+void lcdemu_byte(lcdemu_t *e, int dc, uint8_t b)
+{
+  if (!dc)
+  {
+    e->ncmd++;
+    e->cmd= b;
+    e->kl= klasse(e, b);
+    e->nkl[e->kl]++;
+    e->argi= 0;
+    if ((e->kl == lcdemu_kl_ram) && (!e->refset))
+    {
+      // erster Memory Write: Initialisierung beendet, Einbaulage festhalten
+      e->madref= e->mad;
+      e->drvref= e->drv;
+      e->entryref= e->entry;
+      e->refset= 1;
+    }
+    if (e->ctrl == lcdemu_ili9225)
+    {
+      if (b == 0x22) e->half= 0;
+      return;
+    }
+    switch (b)
+    {
+      case 0x2c : e->cc= e->c1; e->rr= e->r1; e->half= 0; break;
+      case 0x13 : e->scroll= 0; break;
+      case 0x01 : e->mad= 0; e->scroll= 0;
+                  e->c1= 0; e->r1= 0; e->c2= e->gw-1; e->r2= e->gh-1;
+                  break;
+      default   : break;
+    }
+    return;
+  }
+
+  e->ndata++;
+  e->nkl[e->kl]++;
+  if (e->ctrl == lcdemu_ili9225) byte9225(e, b);
+                            else bytedcs(e, b);
+}
+
+/* -------------------------------------------------------
+     lcdemu_memrow
+
+     Im Scrollbereich (tfa .. tfa+vsa-1) zeigt die erste
+     Displayzeile die Ram-Zeile vsp, die folgenden Zeilen
+     schliessen sich im Scrollbereich umlaufend an. Die
+     festen Bereiche oben und unten werden nicht verschoben.
+     y ist eine physikalische Zeile (Gate-Leitung).
+   ------------------------------------------------------- */
+int lcdemu_memrow(const lcdemu_t *e, int y)
+{
+  if (!e->scroll || !e->vsa) return y;
+  if ((y < e->tfa) || (y >= e->tfa + e->vsa)) return y;
+  return e->tfa + (y - e->tfa + e->vsp - e->tfa + e->vsa) % e->vsa;
+}
+
+/* -------------------------------------------------------
+     lcdemu_pixel
+
+     sichtbarer Bildpunkt x,y: Position im Display-Ram wie
+     bei einem Schreibzugriff in der Einbaulage, danach die
+     Scrollregister
+   ------------------------------------------------------- */
+uint16_t lcdemu_pixel(const lcdemu_t *e, int x, int y)
+{
+  int px, py;
+
+  if ((x < 0) || (x >= e->w) || (y < 0) || (y >= e->h)) return 0;
+  x += e->xo;
+  y += e->yo;
+  if (e->ctrl == lcdemu_ili9225)
+  {
+    if ((x >= e->gw) || (y >= e->gh)) return 0;
+    px= ((e->drv ^ e->drvref) & 0x100) ? e->gw-1-x : x;     // SS
+    py= ((e->drv ^ e->drvref) & 0x200) ? e->gh-1-y : y;     // GS
+  }
+  else
+  {
+    if (!dcs_phys(e, e->madref, x, y, &px, &py)) return 0;
+  }
+  py= lcdemu_memrow(e, py);
+  if ((py < 0) || (py >= e->gh)) return 0;
+  return e->gram[py * e->gw + px];
+}
+
+/* -------------------------------------------------------
+     lcdemu_write_ppm
+
+     schreibt das sichtbare Bild als PPM (P6, 8 Bit je
+     Farbe). Rueckgabe 0 : Datei nicht schreibbar
+   ------------------------------------------------------- */
+int lcdemu_write_ppm(const lcdemu_t *e, const char *fname)
+{
+  FILE     *f;
+  uint16_t c;
+  int      x, y;
+
+  f= fopen(fname, "wb");
+  if (!f) { perror(fname); return 0; }
+  fprintf(f, "P6\n%d %d\n255\n", e->w, e->h);
+  for (y= 0; y < e->h; y++)
+    for (x= 0; x < e->w; x++)
+    {
+      c= lcdemu_pixel(e, x, y);
+      fputc(((c >> 11) & 0x1f) << 3, f);
+      fputc(((c >> 5) & 0x3f) << 2, f);
+      fputc((c & 0x1f) << 3, f);
+    }
+  fclose(f);
+  return 1;
+}
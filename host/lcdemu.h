@@ -0,0 +1,113 @@
+/* -------------------------------------------------------
+                        lcdemu.h
+
+   Nachbildung eines Displaycontrollers auf dem PC: die
+   ueber SPI oder den Parallelbus gesendeten Kommando- und
+   Datenbytes werden mit dem D/C Signal so ausgewertet wie
+   im jeweiligen Controller und in ein Display-Ram (RGB565)
+   geschrieben.
+
+   Controller (lcdemu_init_ctrl):
+
+     lcdemu_ili9340   ILI9340 / ILI9341 / ILI9163 / ST7789
+                      (Display-Ram = sichtbare Groesse)
+     lcdemu_st7735    ST7735R, Display-Ram 132x162
+     lcdemu_s6d02a1   S6D02A1, Display-Ram 132x162
+     lcdemu_ili9225   ILI9225, Display-Ram 176x220
+
+   ausgewertete Kommandos ILI9340, ST7735, S6D02A1:
+
+     0x2a / 0x2b   Spalten- / Zeilenadresse (Fenster)
+     0x2c          Memory Write (Adresse zaehlt im Fenster)
+     0x36          MADCTL (MY, MX, MV, BGR)
+     0x33          Vertical Scrolling Definition
+     0x37          Vertical Scrolling Start Address
+     0x13          Normal Display Mode (Scrolling aus)
+     0x01          Software Reset
+
+   ausgewertete Register ILI9225 (1 Byte Index, 16 Bit
+   Registerwert):
+
+     0x01          Driver Output Control (SS, GS)
+     0x03          Entry Mode (BGR, ID1..0, AM)
+     0x20 / 0x21   Adresszaehler horizontal / vertikal
+     0x22          Ram schreiben (Adresse zaehlt im Fenster
+                   nach ID / AM)
+     0x31 / 0x32   Ende / Anfang Scrollbereich
+     0x33          Scrollweite
+     0x36..0x39    Fenster (Ende / Anfang horizontal,
+                   Ende / Anfang vertikal)
+
+   Einbaulage: das Bild erscheint aufrecht mit den MADCTL-
+   (bzw. Driver Output- und Entry Mode-) Werten beim ersten
+   Memory Write, also am Ende der Initialisierung. Spaetere
+   Aenderungen drehen / spiegeln die Ausgabe wie auf dem
+   Display. lcdemu_pixel liefert das sichtbare
+   Bild (Einbaulage, Versatz xo / yo fuer Module mit
+   kleinerem Glas als das Display-Ram, Scrollregister).
+
+   Jedes Byte wird zusaetzlich einer Kommandoklasse zuge-
+   ordnet (nkl), damit sich der Busaufwand einer Zeichen-
+   funktion nach Adressierung, Farbdaten usw. aufteilen
+   laesst.
+  -------------------------------------------------------- */
+
+#ifndef in_lcdemu
+  #define in_lcdemu
+
+  #include <stdint.h>
+
+  #ifdef __cplusplus
+  extern "C" {
+  #endif
+
+  #define lcdemu_ili9340      0
+  #define lcdemu_st7735       1
+  #define lcdemu_s6d02a1      2
+  #define lcdemu_ili9225      3
+
+  // Kommandoklassen (Index in nkl)
+  #define lcdemu_kl_fenster   0             // Spalten- / Zeilenadresse, Fenster
+  #define lcdemu_kl_ram       1             // Memory Write und Farbdaten
+  #define lcdemu_kl_modus     2             // MADCTL, Pixelformat, Entry Mode
+  #define lcdemu_kl_scroll    3             // Scrollregister
+  #define lcdemu_kl_sonst     4             // Initialisierung, Power, Gamma ...
+  #define lcdemu_klassen      5
+
+  typedef struct
+  {
+    int       ctrl;
+    int       w, h;                         // sichtbare Groesse (Einbaulage)
+    int       xo, yo;                       // Versatz sichtbarer Bereich im Adressraum
+    int       gw, gh;                       // Groesse Display-Ram (physikalisch)
+    uint16_t *gram;
+    int       c1, c2, r1, r2;               // Fenster
+    int       cc, rr;                       // Schreibadresse
+    uint8_t   cmd, kl, argi, args[8], hi, half;
+    uint8_t   mad, madref;                  // MADCTL, Einbaulage
+    uint16_t  drv, drvref;                  // ILI9225: Driver Output Control, Einbaulage
+    uint16_t  entry, entryref;              // ILI9225: Entry Mode, Einbaulage
+    uint8_t   refset;                       // 1 : Einbaulage festgehalten
+    uint16_t  sea, ssa, sst;                // ILI9225: Scrollregister 0x31..0x33
+    uint16_t  tfa, vsa, bfa, vsp;           // Scrollregister
+    uint8_t   scroll;                       // 1 : Scrollbereich aktiv
+    uint32_t  ncmd, ndata;                  // Anzahl Kommando- / Datenbytes
+    uint32_t  nscroll;                      // Anzahl Schreibzugriffe auf 0x37 (ILI9225: 0x33)
+    uint32_t  nkl[lcdemu_klassen];          // Bytes je Kommandoklasse
+  } lcdemu_t;
+
+  extern const char *const lcdemu_klname[lcdemu_klassen];
+
+  void     lcdemu_init(lcdemu_t *e, int w, int h);                  // ILI9340, Ram w x h
+  void     lcdemu_init_ctrl(lcdemu_t *e, int ctrl, int w, int h);
+  void     lcdemu_free(lcdemu_t *e);
+  void     lcdemu_byte(lcdemu_t *e, int dc, uint8_t b);       // dc= 0 : Kommando, 1 : Datum
+  int      lcdemu_memrow(const lcdemu_t *e, int y);           // in Displayzeile y sichtbare Ram-Zeile
+  uint16_t lcdemu_pixel(const lcdemu_t *e, int x, int y);     // sichtbarer Bildpunkt
+  int      lcdemu_write_ppm(const lcdemu_t *e, const char *fname);
+
+  #ifdef __cplusplus
+  }
+  #endif
+
+#endif
@@ -0,0 +1,463 @@
+/* -------------------------------------------------------
+                     libopencm3.h  (Host)
+
+   Ersatz fuer lib/libopencm3/include/libopencm3.h beim
+   Uebersetzen der Softwaremodule aus src und der Projekte
+   fuer den PC (Linux). Die Funktionen haben dieselben
+   Namen und Parameter wie in der libopencm3, ausgefuehrt
+   werden sie von host_hal.c: GPIO-Zustaende werden in
+   Variablen gehalten, gesendete SPI-Bytes, Pinwechsel und
+   UART-Zeichen koennen ueber Hookfunktionen und den Trace-
+   puffer (host_hal.h) mitgeschnitten werden.
+
+   Nur was von den Modulen und Projekten tatsaechlich be-
+   nutzt wird, ist hier nachgebildet.
+
+   Das Verzeichnis host muss beim Uebersetzen VOR allen
+   anderen Include-Verzeichnissen angegeben werden:
+
+       gcc -I../host -I./ -I../include ...
+  -------------------------------------------------------- */
+
+#ifndef in_libopen
+  #define in_libopen
+
+  #include <stdint.h>
+  #include <stdbool.h>
+
+  #ifdef __cplusplus
+  extern "C" {
+  #endif
+
+  /*  ------------------------------------------------------------
+                                 GPIO
+      ------------------------------------------------------------ */
+
+  #define GPIOA                       0x40010800u
+  #define GPIOB                       0x40010c00u
+  #define GPIOC                       0x40011000u
+
+  #define GPIO0                       (1 << 0)
+  #define GPIO1                       (1 << 1)
+  #define GPIO2                       (1 << 2)
+  #define GPIO3                       (1 << 3)
+  #define GPIO4                       (1 << 4)
+  #define GPIO5                       (1 << 5)
+  #define GPIO6                       (1 << 6)
+  #define GPIO7                       (1 << 7)
+  #define GPIO8                       (1 << 8)
+  #define GPIO9                       (1 << 9)
+  #define GPIO10                      (1 << 10)
+  #define GPIO11                      (1 << 11)
+  #define GPIO12                      (1 << 12)
+  #define GPIO13                      (1 << 13)
+  #define GPIO14                      (1 << 14)
+  #define GPIO15                      (1 << 15)
+  #define GPIO_ALL                    0xffff
+
+  #define GPIO_MODE_INPUT             0x00
+  #define GPIO_MODE_OUTPUT_10_MHZ     0x01
+  #define GPIO_MODE_OUTPUT_2_MHZ      0x02
+  #define GPIO_MODE_OUTPUT_50_MHZ     0x03
+
+  #define GPIO_CNF_INPUT_ANALOG       0x00
+  #define GPIO_CNF_INPUT_FLOAT        0x01
+  #define GPIO_CNF_INPUT_PULL_UPDOWN  0x02
+  #define GPIO_CNF_OUTPUT_PUSHPULL    0x00
+  #define GPIO_CNF_OUTPUT_OPENDRAIN   0x01
+  #define GPIO_CNF_OUTPUT_ALTFN_PUSHPULL   0x02
+  #define GPIO_CNF_OUTPUT_ALTFN_OPENDRAIN  0x03
+
+  void gpio_set_mode(uint32_t gpioport, uint8_t mode, uint8_t cnf, uint16_t gpios);
+  void gpio_set(uint32_t gpioport, uint16_t gpios);
+  void gpio_clear(uint32_t gpioport, uint16_t gpios);
+  uint16_t gpio_get(uint32_t gpioport, uint16_t gpios);
+  void gpio_toggle(uint32_t gpioport, uint16_t gpios);
+  void gpio_port_write(uint32_t gpioport, uint16_t data);
+  uint16_t gpio_port_read(uint32_t gpioport);
+
+  // direkter Registerzugriff: der geschriebene Wert wird beim naechsten
+  // Aufruf einer Funktion aus host_hal.c auf das Ausgangsregister uebertragen
+  #define GPIO_BSRR(port)             (*host_bsrr(port))
+  #define GPIO_BRR(port)              (*host_brr(port))
+  #define GPIO_ODR(port)              (*host_odr(port))
+
+  volatile uint32_t *host_bsrr(uint32_t gpioport);
+  volatile uint32_t *host_brr(uint32_t gpioport);
+  volatile uint32_t *host_odr(uint32_t gpioport);
+
+  /*  ------------------------------------------------------------
+                                 RCC
+      ------------------------------------------------------------ */
+
+  enum rcc_periph_clken
+  {
+    RCC_GPIOA, RCC_GPIOB, RCC_GPIOC, RCC_AFIO,
+    RCC_SPI1, RCC_SPI2, RCC_USART1, RCC_USART2, RCC_USART3,
+    RCC_DMA1, RCC_TIM2, RCC_TIM3, RCC_ADC1, RCC_I2C1, RCC_I2C2
+  };
+
+  void rcc_periph_clock_enable(enum rcc_periph_clken clken);
+
+  // Takte in Hz (nach Reset 8 MHz), bestimmen die Dauer der Zugriffe
+  // in der virtuellen Zeit
+  extern uint32_t rcc_ahb_frequency;
+  extern uint32_t rcc_apb1_frequency;
+  extern uint32_t rcc_apb2_frequency;
+
+  void rcc_clock_setup_in_hse_8mhz_out_72mhz(void);
+  void rcc_clock_setup_in_hsi_out_64mhz(void);
+  void rcc_clock_setup_in_hsi_out_48mhz(void);
+
+  /*  ------------------------------------------------------------
+                            AFIO (Remap)
+      ------------------------------------------------------------ */
+
+  #define AFIO_MAPR_SWJ_CFG_FULL_SWJ          (0x0 << 24)
+  #define AFIO_MAPR_SWJ_CFG_JTAG_OFF_SW_ON    (0x2 << 24)
+  #define AFIO_MAPR_SWJ_CFG_JTAG_OFF_SW_OFF   (0x4 << 24)
+
+  #define GPIO_TIM3_CH1               GPIO6     // PA6
+  #define GPIO_TIM3_CH2               GPIO7     // PA7
+
+  void gpio_primary_remap(uint32_t swjenable, uint32_t maps);
+
+  /*  ------------------------------------------------------------
+                                 SPI
+      ------------------------------------------------------------ */
+
+  #define SPI1                        0x40013000u
+  #define SPI2                        0x40003800u
+
+  #define SPI_CR1_BAUDRATE_FPCLK_DIV_2     (0x00 << 3)
+  #define SPI_CR1_BAUDRATE_FPCLK_DIV_4     (0x01 << 3)
+  #define SPI_CR1_BAUDRATE_FPCLK_DIV_8     (0x02 << 3)
+  #define SPI_CR1_BAUDRATE_FPCLK_DIV_16    (0x03 << 3)
+  #define SPI_CR1_BAUDRATE_FPCLK_DIV_32    (0x04 << 3)
+  #define SPI_CR1_BAUDRATE_FPCLK_DIV_64    (0x05 << 3)
+  #define SPI_CR1_BAUDRATE_FPCLK_DIV_128   (0x06 << 3)
+  #define SPI_CR1_BAUDRATE_FPCLK_DIV_256   (0x07 << 3)
+  #define SPI_CR1_CPOL_CLK_TO_0_WHEN_IDLE  (0 << 1)
+  #define SPI_CR1_CPOL_CLK_TO_1_WHEN_IDLE  (1 << 1)
+  #define SPI_CR1_CPHA_CLK_TRANSITION_1    (0 << 0)
+  #define SPI_CR1_CPHA_CLK_TRANSITION_2    (1 << 0)
+  #define SPI_CR1_DFF_8BIT                 (0 << 11)
+  #define SPI_CR1_DFF_16BIT                (1 << 11)
+  #define SPI_CR1_MSBFIRST                 (0 << 7)
+  #define SPI_CR1_LSBFIRST                 (1 << 7)
+
+  #define SPI_SR_TXE                  (1 << 1)
+  #define SPI_SR_BSY                  (1 << 7)
+
+  // Statusregister: der SPI sendet ohne Verzoegerung, TXE ist immer
+  // gesetzt, BSY nie. Das Datenregister dient nur als Zieladresse fuer
+  // den DMA (direkte Schreibzugriffe werden nicht gesendet)
+  #define SPI_SR(spi)                 (*host_spi_sr(spi))
+  #define SPI_DR(spi)                 (*host_spi_dr(spi))
+  #define SPI1_DR                     SPI_DR(SPI1)
+  #define SPI2_DR                     SPI_DR(SPI2)
+
+  volatile uint32_t *host_spi_sr(uint32_t spi);
+  volatile uint32_t *host_spi_dr(uint32_t spi);
+
+  void spi_reset(uint32_t spi_peripheral);
+  int  spi_init_master(uint32_t spi, uint32_t br, uint32_t cpol, uint32_t cpha,
+                       uint32_t dff, uint32_t lsbfirst);
+  void spi_enable(uint32_t spi);
+  void spi_disable(uint32_t spi);
+  void spi_enable_software_slave_management(uint32_t spi);
+  void spi_set_nss_high(uint32_t spi);
+  void spi_set_dff_8bit(uint32_t spi);
+  void spi_set_dff_16bit(uint32_t spi);
+  void spi_enable_tx_dma(uint32_t spi);
+  void spi_disable_tx_dma(uint32_t spi);
+  void spi_send(uint32_t spi, uint16_t data);
+  uint16_t spi_read(uint32_t spi);
+  uint16_t spi_xfer(uint32_t spi, uint16_t data);
+
+  /*  ------------------------------------------------------------
+                                 I2C
+      ------------------------------------------------------------ */
+
+  #define I2C1                        0x40005400u
+  #define I2C2                        0x40005800u
+
+  #define I2C_CR2_FREQ_2MHZ           0x02
+  #define I2C_CR2_FREQ_24MHZ          0x18
+  #define I2C_CR2_FREQ_36MHZ          0x24
+
+  #define I2C_SR1_SB                  (1 << 0)
+  #define I2C_SR1_ADDR                (1 << 1)
+  #define I2C_SR1_BTF                 (1 << 2)
+  #define I2C_SR1_TxE                 (1 << 7)
+  #define I2C_SR2_MSL                 (1 << 0)
+  #define I2C_SR2_BUSY                (1 << 1)
+
+  #define I2C_WRITE                   0
+  #define I2C_READ                    1
+
+  // Statusregister: jede Uebertragung ist sofort fertig (SB, ADDR, BTF,
+  // TxE gesetzt, Master-Mode)
+  #define I2C_SR1(i2c)                (*host_i2c_sr1(i2c))
+  #define I2C_SR2(i2c)                (*host_i2c_sr2(i2c))
+
+  volatile uint32_t *host_i2c_sr1(uint32_t i2c);
+  volatile uint32_t *host_i2c_sr2(uint32_t i2c);
+
+  void i2c_peripheral_enable(uint32_t i2c);
+  void i2c_peripheral_disable(uint32_t i2c);
+  void i2c_set_clock_frequency(uint32_t i2c, uint8_t freq);
+  void i2c_set_standard_mode(uint32_t i2c);
+  void i2c_set_fast_mode(uint32_t i2c);
+  void i2c_set_ccr(uint32_t i2c, uint16_t freq);
+  void i2c_set_trise(uint32_t i2c, uint16_t trise);
+  void i2c_set_own_7bit_slave_address(uint32_t i2c, uint8_t slave);
+  void i2c_send_start(uint32_t i2c);
+  void i2c_send_stop(uint32_t i2c);
+  void i2c_send_7bit_address(uint32_t i2c, uint8_t slave, uint8_t readwrite);
+  void i2c_send_data(uint32_t i2c, uint8_t data);
+
+  /*  ------------------------------------------------------------
+                                USART
+      ------------------------------------------------------------ */
+
+  #define USART1                      0x40013800u
+  #define USART2                      0x40004400u
+  #define USART3                      0x40004800u
+
+  #define USART_STOPBITS_1            (0x00 << 12)
+  #define USART_STOPBITS_2            (0x02 << 12)
+  #define USART_MODE_RX               (1 << 2)
+  #define USART_MODE_TX               (1 << 3)
+  #define USART_MODE_TX_RX            (USART_MODE_RX | USART_MODE_TX)
+  #define USART_PARITY_NONE           0x00
+  #define USART_FLOWCONTROL_NONE      0x00
+
+  #define USART_SR_RXNE               (1 << 5)
+  #define USART_SR_TC                 (1 << 6)
+  #define USART_SR_TXE                (1 << 7)
+
+  // Statusregister: RXNE ist gesetzt, wenn host_uart_rx_hook (bzw. stdin)
+  // ein Zeichen bereithaelt, TXE und TC sind immer gesetzt
+  #define USART_SR(usart)             (*host_usart_sr(usart))
+
+  volatile uint32_t *host_usart_sr(uint32_t usart);
+
+  void usart_set_baudrate(uint32_t usart, uint32_t baud);
+  void usart_set_databits(uint32_t usart, uint32_t bits);
+  void usart_set_stopbits(uint32_t usart, uint32_t stopbits);
+  void usart_set_mode(uint32_t usart, uint32_t mode);
+  void usart_set_parity(uint32_t usart, uint32_t parity);
+  void usart_set_flow_control(uint32_t usart, uint32_t flowcontrol);
+  void usart_enable(uint32_t usart);
+  void usart_disable(uint32_t usart);
+  void usart_send(uint32_t usart, uint16_t data);
+  void usart_send_blocking(uint32_t usart, uint16_t data);
+  uint16_t usart_recv(uint32_t usart);
+  uint16_t usart_recv_blocking(uint32_t usart);
+
+  /*  ------------------------------------------------------------
+                               Systick
+      ------------------------------------------------------------ */
+
+  #define STK_CSR_CLKSOURCE_AHB_DIV8  (0 << 2)
+  #define STK_CSR_CLKSOURCE_EXT       STK_CSR_CLKSOURCE_AHB_DIV8
+  #define STK_CSR_CLKSOURCE_AHB       (1 << 2)
+
+  void systick_set_clocksource(uint8_t clocksource);
+  void systick_set_reload(uint32_t value);
+  uint32_t systick_get_value(void);
+  void systick_interrupt_enable(void);
+  void systick_interrupt_disable(void);
+  void systick_counter_enable(void);
+  void systick_counter_disable(void);
+  void systick_clear(void);
+
+  /*  ------------------------------------------------------------
+                                 Timer
+      ------------------------------------------------------------ */
+
+  #define TIM2                        0x40000000u
+  #define TIM3                        0x40000400u
+
+  #define TIM_CR1_CEN                 (1 << 0)
+  #define TIM_CR1_ARPE                (1 << 7)
+  #define TIM_CR1_CMS_EDGE            (0x0 << 5)
+  #define TIM_CR1_CKD_CK_INT          (0x0 << 8)
+  #define TIM_CR1_CKD_CK_INT_MUL_2    (0x1 << 8)
+  #define TIM_CR1_CKD_CK_INT_MUL_4    (0x2 << 8)
+  #define TIM_SR_UIF                  (1 << 0)
+  #define TIM_DIER_UIE                (1 << 0)
+  #define TIM_EGR_UG                  (1 << 0)
+  #define TIM_CCMR1_OC1PE             (1 << 3)
+  #define TIM_CCMR1_OC1M_PWM1         (0x6 << 4)
+  #define TIM_CCMR1_OC1M_PWM2         (0x7 << 4)
+  #define TIM_CCER_CC1E               (1 << 0)
+  #define TIM_CCER_CC1P               (1 << 1)
+
+  // Register als Variablen: ist der Zaehler (CEN) und der Update-Interrupt
+  // (UIE, nvic_enable_irq) eingeschaltet, wird tim2_isr / tim3_isr nach
+  // jeweils (PSC+1) * (ARR+1) Takten der virtuellen Zeit aufgerufen
+  typedef struct
+  {
+    volatile uint32_t cr1, dier, sr, egr, ccmr1, ccmr2, ccer;
+    volatile uint32_t cnt, psc, arr, ccr1, ccr2, ccr3, ccr4;
+  } host_tim_t;
+
+  host_tim_t *host_tim(uint32_t timer_peripheral);
+
+  #define TIM_CR1(tim)                (host_tim(tim)->cr1)
+  #define TIM_DIER(tim)               (host_tim(tim)->dier)
+  #define TIM_SR(tim)                 (host_tim(tim)->sr)
+  #define TIM_EGR(tim)                (host_tim(tim)->egr)
+  #define TIM_CCMR1(tim)              (host_tim(tim)->ccmr1)
+  #define TIM_CCMR2(tim)              (host_tim(tim)->ccmr2)
+  #define TIM_CCER(tim)               (host_tim(tim)->ccer)
+  #define TIM_CNT(tim)                (host_tim(tim)->cnt)
+  #define TIM_PSC(tim)                (host_tim(tim)->psc)
+  #define TIM_ARR(tim)                (host_tim(tim)->arr)
+  #define TIM_CCR1(tim)               (host_tim(tim)->ccr1)
+  #define TIM_CCR2(tim)               (host_tim(tim)->ccr2)
+
+  #define TIM3_CR1                    TIM_CR1(TIM3)
+  #define TIM3_EGR                    TIM_EGR(TIM3)
+  #define TIM3_CCMR1                  TIM_CCMR1(TIM3)
+  #define TIM3_CCER                   TIM_CCER(TIM3)
+  #define TIM3_PSC                    TIM_PSC(TIM3)
+  #define TIM3_ARR                    TIM_ARR(TIM3)
+  #define TIM3_CCR1                   TIM_CCR1(TIM3)
+
+  void timer_reset(uint32_t timer_peripheral);
+  void timer_set_prescaler(uint32_t timer_peripheral, uint32_t value);
+  void timer_set_period(uint32_t timer_peripheral, uint32_t period);
+  void timer_enable_update_event(uint32_t timer_peripheral);
+  void timer_enable_irq(uint32_t timer_peripheral, uint32_t irq);
+  void timer_enable_counter(uint32_t timer_peripheral);
+
+  /*  ------------------------------------------------------------
+                                 DMA
+      ------------------------------------------------------------ */
+
+  #define DMA1                        0x40020000u
+  #define DMA_CHANNEL3                3
+
+  #define DMA_CCR_PSIZE_8BIT          (0x0 << 8)
+  #define DMA_CCR_PSIZE_16BIT         (0x1 << 8)
+  #define DMA_CCR_MSIZE_8BIT          (0x0 << 10)
+  #define DMA_CCR_MSIZE_16BIT         (0x1 << 10)
+  #define DMA_CCR_PL_LOW              (0x0 << 12)
+  #define DMA_CCR_PL_HIGH             (0x2 << 12)
+  #define DMA_TCIF                    (1 << 1)
+
+  // Adressen sind auf dem Controller uint32_t, auf dem PC muss ein Zeiger
+  // hineinpassen. dma_enable_channel fuehrt den Transfer sofort aus (Daten
+  // an spi_send, virtuelle Zeit wie SPI) und ruft danach dma1_channel3_isr
+  // auf, wenn der Transfer-Complete Interrupt eingeschaltet ist
+  void dma_channel_reset(uint32_t dma, uint8_t channel);
+  void dma_set_peripheral_address(uint32_t dma, uint8_t channel, uintptr_t address);
+  void dma_set_memory_address(uint32_t dma, uint8_t channel, uintptr_t address);
+  void dma_set_number_of_data(uint32_t dma, uint8_t channel, uint16_t number);
+  void dma_set_read_from_memory(uint32_t dma, uint8_t channel);
+  void dma_set_peripheral_size(uint32_t dma, uint8_t channel, uint32_t peripheral_size);
+  void dma_set_memory_size(uint32_t dma, uint8_t channel, uint32_t mem_size);
+  void dma_enable_memory_increment_mode(uint32_t dma, uint8_t channel);
+  void dma_disable_memory_increment_mode(uint32_t dma, uint8_t channel);
+  void dma_set_priority(uint32_t dma, uint8_t channel, uint32_t prio);
+  void dma_enable_transfer_complete_interrupt(uint32_t dma, uint8_t channel);
+  void dma_enable_channel(uint32_t dma, uint8_t channel);
+  void dma_disable_channel(uint32_t dma, uint8_t channel);
+  bool dma_get_interrupt_flag(uint32_t dma, uint8_t channel, uint32_t interrupts);
+  void dma_clear_interrupt_flags(uint32_t dma, uint8_t channel, uint32_t interrupts);
+
+  /*  ------------------------------------------------------------
+                                 ADC
+      ------------------------------------------------------------ */
+
+  #define ADC1                        0x40012400u
+  #define ADC_CHANNEL_TEMP            16
+
+  // jede Wandlung ist sofort fertig, Messwert aus host_adc[kanal]
+  void adc_power_on(uint32_t adc);
+  void adc_power_off(uint32_t adc);
+  void adc_disable_scan_mode(uint32_t adc);
+  void adc_set_single_conversion_mode(uint32_t adc);
+  void adc_disable_external_trigger_regular(uint32_t adc);
+  void adc_set_right_aligned(uint32_t adc);
+  void adc_reset_calibration(uint32_t adc);
+  void adc_calibration(uint32_t adc);
+  void adc_set_regular_sequence(uint32_t adc, uint8_t length, uint8_t channel[]);
+  void adc_start_conversion_direct(uint32_t adc);
+  bool adc_eoc(uint32_t adc);
+  uint32_t adc_read_regular(uint32_t adc);
+
+  /*  ------------------------------------------------------------
+                                 NVIC
+      ------------------------------------------------------------ */
+
+  #define NVIC_DMA1_CHANNEL3_IRQ      13
+  #define NVIC_TIM2_IRQ               28
+  #define NVIC_TIM3_IRQ               29
+
+  void nvic_enable_irq(uint8_t irqn);
+  void nvic_disable_irq(uint8_t irqn);
+  void nvic_set_priority(uint8_t irqn, uint8_t priority);
+
+  /*  ------------------------------------------------------------
+                       Interruptserviceroutinen
+
+      host_hal.c enthaelt leere (weak) Fassungen, ein Programm
+      ersetzt sie durch eigene Funktionen gleichen Namens
+      ------------------------------------------------------------ */
+
+  void sys_tick_handler(void);
+  void tim2_isr(void);
+  void tim3_isr(void);
+  void dma1_channel3_isr(void);
+
+  /*  ------------------------------------------------------------
+                                 WFI
+
+      __asm volatile("wfi") der Verzoegerungsschleifen (delay in
+      sysf103_init.c, smallio.c) gibt es auf dem PC nicht. Der
+      Assemblermakro wfi ruft statt dessen host_wfi auf, das die
+      virtuelle Zeit bis zum naechsten Interrupt weiterzaehlt und
+      diesen ausfuehrt. Alle Register (auch SSE, Flags) werden ge-
+      sichert, die Red Zone der Aufruferfunktion wird uebersprungen.
+      ------------------------------------------------------------ */
+
+  void host_wfi(void);
+
+  /*  ------------------------------------------------------------
+                  newlib-Funktionen ohne glibc-Gegenstueck
+      ------------------------------------------------------------ */
+
+  char *itoa(int value, char *str, int base);
+
+  #if defined(__x86_64__)
+    __asm__
+    (
+      ".macro wfi\n"
+      "  lea   -128(%rsp), %rsp\n"
+      "  pushfq\n"
+      "  push  %rax\n  push  %rcx\n  push  %rdx\n  push  %rsi\n  push  %rdi\n"
+      "  push  %r8\n  push  %r9\n  push  %r10\n  push  %r11\n  push  %rbp\n"
+      "  mov   %rsp, %rbp\n"
+      "  and   $-16, %rsp\n"
+      "  sub   $512, %rsp\n"
+      "  fxsave (%rsp)\n"
+      "  call  host_wfi\n"
+      "  fxrstor (%rsp)\n"
+      "  mov   %rbp, %rsp\n"
+      "  pop   %rbp\n  pop   %r11\n  pop   %r10\n  pop   %r9\n  pop   %r8\n"
+      "  pop   %rdi\n  pop   %rsi\n  pop   %rdx\n  pop   %rcx\n  pop   %rax\n"
+      "  popfq\n"
+      "  lea   128(%rsp), %rsp\n"
+      ".endm\n"
+    );
+  #endif
+
+  #ifdef __cplusplus
+  }
+  #endif
+
+#endif
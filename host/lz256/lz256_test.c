@@ -0,0 +1,372 @@
+/* -------------------------------------------------------
+                       lz256_test.c
+
+   lz256 auf dem PC: jedes Bild aus gen/bilder.h wurde mit
+   image2c -z aus einer PCX- oder BMP-Datei erzeugt. Die
+   Originaldatei wird hier unabhaengig von image2c dekodiert
+   (PCX-RLE bzw. BMP 8 Bit, unterste Zeile zuerst, Zeilen
+   auf 4 Bytes aufgefuellt) und mit putpixel in eine Con-
+   troller-Nachbildung (lcdemu) gezeichnet, lz256_show
+   zeichnet das komprimierte Array in eine zweite. Beide
+   Bilder muessen gleich sein.
+
+   Die Palette ist eineindeutig (Index i -> Farbe
+   i * 0x0101), gleiche Farben bedeuten gleiche Paletten-
+   indizes.
+
+   Faelle je Bild (Display 320x240, outmode 1):
+
+     ganz         : bei 0,0
+     links_oben   : um 1/3 Breite und 1/4 Hoehe nach links
+                    oben aus dem Display geschoben
+     rechts_unten : buendig in der rechten unteren Ecke
+                    (gfx_clip beschneidet wie bei pcx256_show
+                    nur links und oben, ueber den rechten bzw.
+                    unteren Rand hinaus wird nicht gezeichnet)
+     ausschnitt   : gfx_srcrect mit der mittleren Haelfte
+                    des Bildes bei 7,5
+
+   Dazu Groesse (lz256 / Quelldatei / unkomprimiert) und
+   Pixel je Sekunde (PC, ohne Nachbildung) von lz256_show
+   gegenueber pcx256_show (PCX) bzw. bmp256_show (BMP) mit
+   den Bytes je Pixel auf dem Displaybus.
+
+   Rueckgabewert 1, wenn sich ein Bild unterscheidet oder
+   eine Datei nicht gelesen werden kann.
+  -------------------------------------------------------- */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "tftdisplay.h"
+#include "gfx_pictures.h"
+#include "host_hal.h"
+#include "lcdemu.h"
+
+#define mess_ns        100000000ull           // Mindestdauer einer Zeitmessung
+
+#define dw             _yres                  // Display mit outmode 1
+#define dh             _xres
+
+typedef struct
+{
+  const char          *name;
+  const char          *datei;                 // Original (PCX / BMP)
+  const unsigned char *lz;                    // image2c -z
+  uint32_t             lzlen;
+} bild_t;
+
+#include "bilder.h"
+
+#define bild_anz       (sizeof(bilder) / sizeof(bilder[0]))
+
+static lcdemu_t  emu_soll, emu_ist;
+static lcdemu_t *emu;                         // Ziel der Bus-Bytes, NULL : nur zaehlen
+static uint32_t  busbytes;
+static uint16_t  pal[256];
+
+/* -------------------------------------------------------
+     8-Bit Parallelbus in die Nachbildung (wie ../parfill)
+   ------------------------------------------------------- */
+
+#define port_nr(p)     ( ((p) - GPIOA) / (GPIOB - GPIOA) )
+#define wr_bit         GPIO1                  // PA1, beide Boardversionen
+#if (boardversion == 0)
+  #define rs_bit       GPIO2                  // PA2
+#else
+  #define rs_bit       GPIO4                  // PA4
+#endif
+
+static uint16_t odr[3];                       // Spiegel der Ausgangsregister
+
+static uint8_t busbyte(void)
+{
+  uint16_t a= odr[0], b= odr[1];
+
+  #if (boardversion == 0)
+    (void)a;
+    return ((b >> 4) & 0xfc) | ((b >> 12) & 0x03);
+  #else
+    return ((b & 0x2000) ? 0x01 : 0) | ((b & 0x0080) ? 0x02 : 0)
+         | ((b & 0x0002) ? 0x04 : 0) | ((b & 0x0008) ? 0x08 : 0)
+         | ((b & 0x0020) ? 0x10 : 0) | ((b & 0x0010) ? 0x20 : 0)
+         | ((a & 0x8000) ? 0x40 : 0) | ((a & 0x0100) ? 0x80 : 0);
+  #endif
+}
+
+static void gpio_decode(uint32_t gpioport, uint16_t oldval, uint16_t newval)
+{
+  uint32_t nr;
+
+  nr= port_nr(gpioport);
+  if (nr > 2) return;
+  odr[nr]= newval;
+  if ((nr == 0) && ((oldval ^ newval) & wr_bit) && !(newval & wr_bit))
+  {
+    busbytes++;
+    if (emu) lcdemu_byte(emu, (odr[0] & rs_bit) ? 1 : 0, busbyte());
+  }
+}
+
+static uint32_t image_hash(const lcdemu_t *e)
+{
+  uint32_t h= 2166136261u;
+  uint16_t c;
+  int      x, y;
+
+  for (y= 0; y < e->h; y++)
+    for (x= 0; x < e->w; x++)
+    {
+      c= lcdemu_pixel(e, x, y);
+      h= (h ^ (c & 0xff)) * 16777619u;
+      h= (h ^ (c >> 8)) * 16777619u;
+    }
+  return h;
+}
+
+static uint64_t ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+/* -------------------------------------------------------
+                   Originaldateien lesen
+
+   liefern die Palettenindizes zeilenweise von oben nach
+   unten (w*h Bytes, malloc), *datlen : Laenge der Datei
+   ------------------------------------------------------- */
+
+static uint8_t *datei_lesen(const char *fname, long *len)
+{
+  FILE    *f;
+  uint8_t *dat;
+
+  f= fopen(fname, "rb");
+  if (!f) return NULL;
+  fseek(f, 0, SEEK_END);
+  *len= ftell(f);
+  fseek(f, 0, SEEK_SET);
+  dat= malloc(*len);
+  if (fread(dat, 1, *len, f) != (size_t)*len) { free(dat); dat= NULL; }
+  fclose(f);
+  return dat;
+}
+
+#define le16(p)        ( (p)[0] | ((p)[1] << 8) )
+#define le32(p)        ( (uint32_t)le16(p) | ((uint32_t)le16((p)+2) << 16) )
+
+static uint8_t *pcx_dekodieren(const uint8_t *dat, long len, int *w, int *h)
+{
+  uint8_t *px, b;
+  long     pos;
+  int      bpl, x, y, n;
+
+  if ((len < 128+769) || (dat[0] != 10) || (dat[3] != 8)) return NULL;
+  *w= le16(dat+8) - le16(dat+4) + 1;
+  *h= le16(dat+10) - le16(dat+6) + 1;
+  bpl= le16(dat+66);
+  px= calloc((*w) * (*h), 1);
+
+  pos= 128; x= 0; y= 0;
+  while ((y < *h) && (pos < len-769))
+  {
+    b= dat[pos++];
+    n= 1;
+    if ((b & 0xc0) == 0xc0) { n= b & 0x3f; b= dat[pos++]; }
+    while ((n--) && (y < *h))
+    {
+      if (x < *w) px[y * (*w) + x]= b;
+      if (++x == bpl) { x= 0; y++; }
+    }
+  }
+  return px;
+}
+
+static uint8_t *bmp_dekodieren(const uint8_t *dat, long len, int *w, int *h)
+{
+  uint8_t  *px;
+  uint32_t  off;
+  int       y, stride;
+
+  if ((len < 54) || (dat[0] != 'B') || (dat[1] != 'M') || (le16(dat+28) != 8)) return NULL;
+  *w= le32(dat+18);
+  *h= le32(dat+22);
+  off= le32(dat+10);
+  stride= (*w + 3) & ~3;
+  if (off + (long)stride * (*h) > len) return NULL;
+  px= malloc((*w) * (*h));
+  for (y= 0; y < *h; y++)
+    memcpy(&px[y * (*w)], &dat[off + (long)(*h-1-y) * stride], *w);
+  return px;
+}
+
+/* -------------------------------------------------------
+                         Faelle
+   ------------------------------------------------------- */
+
+// Sollbild: Ausschnitt sx,sy,sw,sh der Indizes bei ox,oy, beschnitten auf das Display
+static void soll_zeichnen(const uint8_t *px, int w, int ox, int oy, int sx, int sy, int sw, int sh)
+{
+  int x, y;
+
+  for (y= 0; y < sh; y++)
+    for (x= 0; x < sw; x++)
+      if ((ox+x >= 0) && (ox+x < dw) && (oy+y >= 0) && (oy+y < dh))
+        putpixel(ox+x, oy+y, pal[px[(sy+y) * w + sx+x]]);
+}
+
+static int fall(const bild_t *b, const uint8_t *px, int w, int h, int art)
+{
+  int ox, oy, sx= 0, sy= 0, sw= w, sh= h;
+
+  switch (art)
+  {
+    case 0 : ox= 0; oy= 0; break;
+    case 1 : ox= -w/3; oy= -h/4; break;
+    case 2 : ox= dw - w; oy= dh - h; break;
+    default: ox= 7; oy= 5; sx= w/4; sy= h/4; sw= w/2; sh= h/2; break;
+  }
+
+  emu= &emu_soll;
+  clrscr();
+  soll_zeichnen(px, w, ox, oy, sx, sy, sw, sh);
+
+  emu= &emu_ist;
+  clrscr();
+  if (art == 3) gfx_srcrect(sx, sy, sw, sh);
+  lz256_show(ox, oy, b->lz, pal);
+  gfx_srcrect(0, 0, 0, 0);
+
+  return (image_hash(&emu_soll) == image_hash(&emu_ist));
+}
+
+static const char *fallname[4] = { "ganz", "links_oben", "rechts_unten", "ausschnitt" };
+
+/* -------------------------------------------------------
+     messen
+
+     Pixel je Sekunde von lz256_show (lz != NULL) bzw.
+     der Ausgabe des Quellformats, *bytes : Bus-Bytes je
+     Pixel
+   ------------------------------------------------------- */
+static const uint8_t *m_lz, *m_pcx, *m_bmp;
+
+static void zeigen(void)
+{
+  if (m_lz) lz256_show(0, 0, m_lz, pal);
+  else if (m_pcx) pcx256_show(0, 0, m_pcx, pal);
+  else bmp256_show(0, 0, m_bmp, pal);
+}
+
+static double messen(int n, double *bytes)
+{
+  uint64_t t0, t;
+  uint32_t b0;
+  long     anz;
+
+  emu= NULL;
+  b0= busbytes;
+  zeigen();
+  *bytes= (double)(busbytes - b0) / n;
+  anz= 0;
+  t0= ns();
+  do
+  {
+    zeigen();
+    anz += n;
+    t= ns() - t0;
+  } while (t < mess_ns);
+  return anz * 1e9 / t;
+}
+
+int main(void)
+{
+  uint32_t i;
+  uint8_t *dat, *px, *bmp;
+  long     len;
+  int      w, h, art, ispcx, gleich, fail= 0;
+  double   pl, pq, bl, bq;
+
+  for (i= 0; i < 256; i++) pal[i]= i * 0x0101;
+
+  host_reset();
+  odr[0]= host_port(GPIOA); odr[1]= host_port(GPIOB); odr[2]= host_port(GPIOC);
+  host_gpio_hook= gpio_decode;
+
+  lcdemu_init_ctrl(&emu_soll, lcdemu_ili9340, _xres, _yres);
+  lcdemu_init_ctrl(&emu_ist, lcdemu_ili9340, _xres, _yres);
+  emu= &emu_soll; lcd_init();
+  emu= &emu_ist; lcd_init();
+  outmode= 1;
+  bkcolor= 0xf81f;                            // kommt in der Palette nicht vor
+
+  printf("\nlz256 gegen Originaldatei, Display %dx%d\n", dw, dh);
+  printf("  %-12s %8s %7s %7s %7s  %-6s %-6s %-6s %-6s\n", "Bild", "Groesse", "Pixel",
+         "Datei", "lz256", fallname[0], fallname[1], fallname[2], fallname[3]);
+  for (i= 0; i < bild_anz; i++)
+  {
+    dat= datei_lesen(bilder[i].datei, &len);
+    ispcx= (dat) && (dat[0] == 10);
+    px= NULL;
+    if (dat) px= ispcx ? pcx_dekodieren(dat, len, &w, &h) : bmp_dekodieren(dat, len, &w, &h);
+    if (!px)
+    {
+      printf("  %-12s %s nicht lesbar\n", bilder[i].name, bilder[i].datei);
+      fail= 1;
+      free(dat);
+      continue;
+    }
+
+    printf("  %-12s %3dx%-4d %7d %7ld %7lu ", bilder[i].name, w, h, w*h,
+           ispcx ? len - 128 - 769 : (long)w*h, (unsigned long)bilder[i].lzlen);
+    if ((w != ((bilder[i].lz[0] << 8) | bilder[i].lz[1])) || (h != ((bilder[i].lz[2] << 8) | bilder[i].lz[3])))
+    {
+      printf(" Groesse im lz256-Kopf falsch\n");
+      fail= 1;
+    }
+    else
+    {
+      for (art= 0; art < 4; art++)
+      {
+        gleich= fall(&bilder[i], px, w, h, art);
+        if (!gleich) fail= 1;
+        printf(" %-6s", gleich ? "gleich" : "FEHLER");
+      }
+      printf("\n");
+    }
+
+    // Zeit: lz256 gegen das Quellformat
+    m_lz= bilder[i].lz; m_pcx= NULL; m_bmp= NULL;
+    pl= messen(w*h, &bl);
+    bmp= NULL;
+    m_lz= NULL;
+    if (ispcx)
+    {
+      m_pcx= dat;
+    }
+    else
+    {
+      // bmp256_show: Kopf wie image2c, Zeilen von unten nach oben ohne Fuellbytes
+      bmp= malloc(4 + w*h);
+      bmp[0]= w >> 8; bmp[1]= w & 0xff; bmp[2]= h >> 8; bmp[3]= h & 0xff;
+      for (art= 0; art < h; art++) memcpy(&bmp[4 + (h-1-art) * w], &px[art * w], w);
+      m_bmp= bmp;
+    }
+    pq= messen(w*h, &bq);
+    printf("  %12s Pixel/s lz256 %.0f, %s %.0f (Faktor %.2f), Bytes/P %.2f / %.2f\n", "",
+           pl, ispcx ? "pcx256" : "bmp256", pq, pq > 0 ? pl / pq : 0.0, bl, bq);
+    emu= &emu_ist;
+
+    free(bmp);
+    free(px);
+    free(dat);
+  }
+
+  lcdemu_free(&emu_soll);
+  lcdemu_free(&emu_ist);
+  return fail;
+}
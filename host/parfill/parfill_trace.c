@@ -0,0 +1,259 @@
+/* -------------------------------------------------------
+                      parfill_trace.c
+
+   GPIO-Mitschnitt des 8-Bit Parallelbusses von
+   tftdisplay.c auf dem PC (host_hal.c).
+
+   Bei jeder fallenden WR-Flanke werden RS und das an
+   D0..D7 anliegende Byte in einen Pruefwert (FNV-1a)
+   eingerechnet. Zwei Uebersetzungen von tftdisplay.c
+   (tft_fastfill 0 / 1) sind gleichwertig, wenn fuer jede
+   Funktion Anzahl der Takte und Pruefwert uebereinstimmen.
+
+   Zusaetzlich wird geprueft, dass CS bei jedem Takt aktiv
+   ist und sich RS und D0..D7 nicht aendern, solange WR
+   low ist.
+
+   Aufruf:
+
+       parfill_trace                : Ausgabe der Werte je
+                                      Funktion (Referenz)
+       parfill_trace ref.txt        : Vergleich mit einer
+                                      Referenzausgabe
+
+   Rueckgabewert 1, wenn sich ein Mitschnitt unterscheidet
+   oder ein Timingfehler auftritt.
+  -------------------------------------------------------- */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "libopencm3.h"
+#include "host_hal.h"
+#include "tftdisplay.h"
+
+#define port_nr(p)     ( ((p) - GPIOA) / (GPIOB - GPIOA) )
+
+#define wr_bit         GPIO1                  // PA1, beide Boardversionen
+
+#if (boardversion == 0)
+  #define rs_bit       GPIO2                  // PA2
+  #define cs_port      0                      // PA3
+  #define cs_bit       GPIO3
+  #define datab_mask   0x3fc0                 // PB6..PB13
+  #define dataa_mask   0x0000
+#else
+  #define rs_bit       GPIO4                  // PA4
+  #define cs_port      1                      // PB0
+  #define cs_bit       GPIO0
+  #define datab_mask   0x20ba                 // PB13, 7, 5, 4, 3, 1
+  #define dataa_mask   0x8100                 // PA15, 8
+#endif
+
+static uint16_t odr[3];                       // Spiegel der Ausgangsregister
+static uint32_t strobes;
+static uint32_t hash;
+static uint32_t errors;
+
+/* -------------------------------------------------------
+     busbyte
+
+     liest das an D0..D7 anliegende Byte aus den
+     Ausgangsregistern
+   ------------------------------------------------------- */
+static uint8_t busbyte(void)
+{
+  uint16_t a= odr[0], b= odr[1];
+
+  #if (boardversion == 0)
+    (void)a;
+    return ((b >> 4) & 0xfc) | ((b >> 12) & 0x03);
+  #else
+    return ((b & 0x2000) ? 0x01 : 0) | ((b & 0x0080) ? 0x02 : 0)
+         | ((b & 0x0002) ? 0x04 : 0) | ((b & 0x0008) ? 0x08 : 0)
+         | ((b & 0x0020) ? 0x10 : 0) | ((b & 0x0010) ? 0x20 : 0)
+         | ((a & 0x8000) ? 0x40 : 0) | ((a & 0x0100) ? 0x80 : 0);
+  #endif
+}
+
+static void hash_byte(uint8_t b)
+{
+  hash ^= b;
+  hash *= 16777619u;
+}
+
+static void gpio_trace(uint32_t gpioport, uint16_t oldval, uint16_t newval)
+{
+  uint32_t nr;
+  uint16_t chg;
+
+  nr= port_nr(gpioport);
+  if (nr > 2) return;
+  odr[nr]= newval;
+  chg= oldval ^ newval;
+
+  // solange WR low ist, muessen RS und die Daten stabil sein
+  if (!(odr[0] & wr_bit))
+  {
+    if ((nr == 0) && (chg & (rs_bit | dataa_mask))) errors++;
+    if ((nr == 1) && (chg & datab_mask)) errors++;
+  }
+
+  // fallende Flanke an WR: Byte wird vom Display uebernommen
+  if ((nr == 0) && (chg & wr_bit) && !(newval & wr_bit))
+  {
+    if (odr[cs_port] & cs_bit) errors++;
+    strobes++;
+    hash_byte((odr[0] & rs_bit) ? 1 : 0);
+    hash_byte(busbyte());
+  }
+}
+
+/* -------------------------------------------------------
+                        Funktionen
+   ------------------------------------------------------- */
+
+static uint32_t rnd_state= 12345;
+
+static int rnd(int n)
+{
+  rnd_state= rnd_state * 1103515245u + 12345u;
+  return (rnd_state >> 16) % n;
+}
+
+static void w_init(void)       { lcd_init(); }
+static void w_clr_black(void)  { bkcolor= 0x0000; clrscr(); }
+static void w_clr_red(void)    { bkcolor= 0xf800; clrscr(); }
+static void w_clr_blue(void)   { bkcolor= 0x001f; clrscr(); }
+static void w_rect_1234(void)  { fillrect(10, 20, 200, 300, 0x1234); }
+
+static void w_rect_mixed(void)
+{
+  int i;
+
+  for (i= 0; i < 200; i++)
+    fillrect(rnd(_xres), rnd(_yres), rnd(_xres), rnd(_yres), rnd(0x10000));
+}
+
+static void w_putpixel(void)
+{
+  int i;
+
+  for (i= 0; i < 2000; i++) putpixel(rnd(_xres), rnd(_yres), rnd(0x10000));
+}
+
+static void w_line(void)
+{
+  int i;
+
+  for (i= 0; i < 100; i++)
+    line(rnd(_xres), rnd(_yres), rnd(_xres), rnd(_yres), rnd(0x10000));
+}
+
+static void w_text(void)
+{
+  int i;
+
+  setfont(0);
+  textcolor= 0xffe0; bkcolor= 0x0010;
+  for (i= 0; i < 20; i++)
+    outtextxy(0, i * 8, 0, "Parallelbus 0123456789");
+}
+
+static void w_fillcircle(void)
+{
+  int i;
+
+  for (i= 0; i < 30; i++)
+    fillcircle(rnd(_xres), rnd(_yres), rnd(60), rnd(0x10000));
+}
+
+static void w_ori1(void)
+{
+  lcd_orientation(1);
+  bkcolor= 0x07e0; clrscr();
+  fillrect(5, 5, 150, 100, 0xa5a5);
+  lcd_orientation(0);
+}
+
+typedef struct
+{
+  const char *name;
+  void (*fn)(void);
+} workload_t;
+
+static const workload_t workloads[] =
+{
+  { "lcd_init",        w_init       },
+  { "clrscr_schwarz",  w_clr_black  },
+  { "clrscr_rot",      w_clr_red    },
+  { "clrscr_blau",     w_clr_blue   },
+  { "fillrect_1234",   w_rect_1234  },
+  { "fillrect_zufall", w_rect_mixed },
+  { "putpixel",        w_putpixel   },
+  { "line",            w_line       },
+  { "text_8x8",        w_text       },
+  { "fillcircle",      w_fillcircle },
+  { "orientation_1",   w_ori1       },
+};
+
+#define workload_anz   (sizeof(workloads) / sizeof(workloads[0]))
+
+int main(int argc, char **argv)
+{
+  FILE     *f= NULL;
+  char      rname[32];
+  unsigned long rstrobes, rhash, rwrites, rcalls;
+  uint32_t  i, writes, calls;
+  int       fail= 0;
+
+  host_reset();
+  host_gpio_hook= gpio_trace;
+
+  if (argc > 1)
+  {
+    f= fopen(argv[1], "r");
+    if (!f) { perror(argv[1]); return 1; }
+    printf("\nboardversion %d, tft_fastfill %d gegen %s\n", boardversion, tft_fastfill, argv[1]);
+    printf("  %-16s %9s %6s %10s %10s %10s %10s\n", "Funktion", "Takte", "Trace",
+           "GPIO alt", "GPIO neu", "Aufr. alt", "Aufr. neu");
+  }
+
+  for (i= 0; i < workload_anz; i++)
+  {
+    strobes= 0; hash= 2166136261u; errors= 0;
+    host_gpio_writes= 0;
+    host_gpio_calls= 0;
+
+    workloads[i].fn();
+    host_flush();
+    writes= host_gpio_writes;
+    calls= host_gpio_calls;
+
+    if (!f)
+    {
+      printf("%s %lu %08lx %lu %lu\n", workloads[i].name, (unsigned long)strobes,
+             (unsigned long)hash, (unsigned long)writes, (unsigned long)calls);
+      if (errors) fail= 1;
+      continue;
+    }
+
+    if ((fscanf(f, "%31s %lu %lx %lu %lu", rname, &rstrobes, &rhash, &rwrites, &rcalls) != 5) ||
+        strcmp(rname, workloads[i].name))
+    {
+      printf("  %-16s Referenz fehlt\n", workloads[i].name);
+      fail= 1;
+      continue;
+    }
+    if ((rstrobes != strobes) || (rhash != hash) || errors) fail= 1;
+    printf("  %-16s %9lu %6s %10lu %10lu %10lu %10lu",
+           workloads[i].name, (unsigned long)strobes,
+           ((rstrobes == strobes) && (rhash == hash)) ? "gleich" : "FEHLER",
+           rwrites, (unsigned long)writes, rcalls, (unsigned long)calls);
+    if (errors) printf("  %lu Timingfehler", (unsigned long)errors);
+    printf("\n");
+  }
+
+  if (f) fclose(f);
+  return fail;
+}
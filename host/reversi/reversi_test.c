@@ -0,0 +1,243 @@
+/* -------------------------------------------------------
+                       reversi_test.c
+
+   KI von game_reversi (reversi_ki.c, Bitboard-Suche) auf
+   dem PC gegen die urspruengliche KI (../alt/reversi_ki_
+   alt.c, minmax mit malloc je Knoten).
+
+     gleiche Zuege : Zufallsstellungen, die Strategien
+                     diff3, wdiff1 und wdiff3 muessen in
+                     jeder Stellung denselben Zug wie das
+                     Original waehlen. Dazu untersuchte
+                     Stellungen (BOARDS) und Zeit je Zug,
+                     fuer wdiff5 nur die Bitboard-Suche.
+     wmob          : erreichte Suchtiefe (ki_depth) und
+                     Stellungen je Zug innerhalb der
+                     Bedenkzeit ki_timebudget
+
+   tick_ms zaehlt wie der Systick jede Millisekunde (Timer-
+   signal SIGALRM). Mit der Zeitlupe k zaehlt er k ms je
+   ms weiter: die Bedenkzeit ist dann ki_timebudget / k
+   auf dem PC, so viel Rechenzeit, wie ein k-mal langsamerer
+   Controller in ki_timebudget hat.
+
+   Rueckgabewert 1, wenn ein Zug abweicht
+  -------------------------------------------------------- */
+
+#include <stdio.h>
+#include <string.h>
+#include <signal.h>
+#include <sys/time.h>
+#include <time.h>
+
+#include "reversi_ki.h"
+
+#define stellungen     300
+#define wmob_anz       12                      // Stellungen fuer wmob
+
+// reversi_ki.c
+extern const int WHITE, BLACK;
+int  *initialboard(void);
+int  legalp(int move, int player, int * board);
+void makemove(int move, int player, int * board);
+int  nexttoplay(int * board, int previousplayer);
+int  maxdiffstrategy3(int, int *);
+int  maxweighteddiffstrategy1(int, int *);
+int  maxweighteddiffstrategy3(int, int *);
+int  maxweighteddiffstrategy5(int, int *);
+int  mobilitystrategy(int, int *);
+
+// ../alt/reversi_ki_alt.c
+extern long int alt_BOARDS;
+int  alt_maxdiffstrategy3(int, int *);
+int  alt_maxweighteddiffstrategy1(int, int *);
+int  alt_maxweighteddiffstrategy3(int, int *);
+
+typedef struct
+{
+  const char *name;
+  int (* neu)(int, int *);
+  int (* alt)(int, int *);
+} strategie_t;
+
+static const strategie_t strategien[] =
+{
+  { "diff3",  maxdiffstrategy3,         alt_maxdiffstrategy3         },
+  { "wdiff1", maxweighteddiffstrategy1, alt_maxweighteddiffstrategy1 },
+  { "wdiff3", maxweighteddiffstrategy3, alt_maxweighteddiffstrategy3 },
+  { "wdiff5", maxweighteddiffstrategy5, NULL                         }
+};
+#define strategie_anz  (sizeof(strategien) / sizeof(strategien[0]))
+
+static const int zeitlupe_tab[] = { 1, 10, 30 };
+#define zeitlupe_anz   (sizeof(zeitlupe_tab) / sizeof(zeitlupe_tab[0]))
+
+/* -------------------------------------------------------
+       vom Spiel erwartete Funktionen, Systick-Ersatz
+   ------------------------------------------------------- */
+
+volatile int tick_ms = 0;
+static volatile int zeitlupe = 1;
+
+uint8_t stone_gettoset(void) { return 0; }
+void printboard(int *board) { (void)board; }
+void status_meld(uint8_t nr) { (void)nr; }
+
+static void tick(int sig)
+{
+  (void)sig;
+  tick_ms += zeitlupe;
+}
+
+static void tick_start(void)
+{
+  struct itimerval it;
+
+  signal(SIGALRM, tick);
+  it.it_interval.tv_sec= 0; it.it_interval.tv_usec= 1000;
+  it.it_value= it.it_interval;
+  setitimer(ITIMER_REAL, &it, NULL);
+}
+
+static uint64_t ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+/* -------------------------------------------------------
+                     Zufallsstellungen
+   ------------------------------------------------------- */
+
+static int pos_board[stellungen][100];
+static int pos_player[stellungen];
+static int pos_steine[stellungen];
+
+static uint32_t zufall_r = 4711;
+
+static uint32_t zufall(void)
+{
+  zufall_r ^= zufall_r << 13; zufall_r ^= zufall_r >> 17; zufall_r ^= zufall_r << 5;
+  return zufall_r;
+}
+
+// Zufallspartie mit 0 .. 50 Zuegen, der Spieler am Zug hat mindestens einen Zug
+static void stellungen_erzeugen(void)
+{
+  int *board, nr, i, n, player, next, moves[64], anz, sq;
+
+  for (nr= 0; nr < stellungen; )
+  {
+    board= initialboard();
+    player= WHITE;
+    n= zufall() % 51;
+    for (i= 0; (i < n) && player; i++)
+    {
+      anz= 0;
+      for (sq= 11; sq <= 88; sq++)
+        if (legalp(sq, player, board)) moves[anz++]= sq;
+      makemove(moves[zufall() % anz], player, board);
+      next= nexttoplay(board, player);
+      player= next;
+    }
+    if (!player) continue;                    // Spielende
+    memcpy(pos_board[nr], board, sizeof(pos_board[nr]));
+    pos_player[nr]= player;
+    pos_steine[nr]= 4 + i;
+    nr++;
+  }
+}
+
+/* -------------------------------------------------------
+                     Tests und Messungen
+   ------------------------------------------------------- */
+
+static int zuege_test(void)
+{
+  int      s, nr, m1, m2, gleich, fail= 0, board[100];
+  long     n_neu, n_alt;
+  uint64_t t0, t_neu, t_alt;
+
+  printf("\ngleiche Zuege, %d Zufallsstellungen (4 .. 54 Steine)\n", stellungen);
+  printf("  %-8s %7s %12s %12s %11s %11s %8s\n", "", "gleich", "Stell. neu", "Stell. alt",
+         "Stell/s neu", "Stell/s alt", "Faktor");
+  for (s= 0; s < (int)strategie_anz; s++)
+  {
+    gleich= 0; n_neu= 0; n_alt= 0; t_neu= 0; t_alt= 0;
+    for (nr= 0; nr < stellungen; nr++)
+    {
+      memcpy(board, pos_board[nr], sizeof(board));
+      BOARDS= 0;
+      t0= ns();
+      m1= strategien[s].neu(pos_player[nr], board);
+      t_neu += ns() - t0;
+      n_neu += BOARDS;
+      if (!strategien[s].alt) continue;
+
+      memcpy(board, pos_board[nr], sizeof(board));
+      alt_BOARDS= 0;
+      t0= ns();
+      m2= strategien[s].alt(pos_player[nr], board);
+      t_alt += ns() - t0;
+      n_alt += alt_BOARDS;
+      if (m1 == m2) gleich++;
+    }
+    if (strategien[s].alt)
+    {
+      if (gleich != stellungen) fail= 1;
+      printf("  %-8s %7d %12ld %12ld %11.0f %11.0f %7.1fx\n", strategien[s].name, gleich, n_neu, n_alt,
+             n_neu * 1e9 / t_neu, n_alt * 1e9 / t_alt, (double)t_alt / t_neu);
+    }
+    else
+      printf("  %-8s %7s %12ld %12s %11.0f %11s %8s\n", strategien[s].name, "-", n_neu, "-",
+             n_neu * 1e9 / t_neu, "-", "-");
+  }
+  printf("  (Stellungen je Strategie gesamt, Faktor: Zeit je Zug alt / neu)\n");
+  return fail;
+}
+
+static void wmob_test(void)
+{
+  int      z, nr, dmin, dmax, dsum, board[100];
+  long     n;
+  uint64_t t0, t;
+
+  printf("\nwmob, ki_timebudget %d ms, ki_maxdepth %d, %d Stellungen\n", ki_timebudget, ki_maxdepth, wmob_anz);
+  printf("  %8s %10s %6s %6s %6s %12s %11s\n", "Zeitlupe", "ms je Zug", "Tiefe", "min", "max",
+         "Stell./Zug", "Stell/s");
+  for (z= 0; z < (int)zeitlupe_anz; z++)
+  {
+    zeitlupe= zeitlupe_tab[z];
+    dmin= 99; dmax= 0; dsum= 0; n= 0;
+    t0= ns();
+    for (nr= 0; nr < wmob_anz; nr++)
+    {
+      memcpy(board, pos_board[nr * (stellungen / wmob_anz)], sizeof(board));
+      BOARDS= 0;
+      ki_depth= 0;
+      mobilitystrategy(pos_player[nr * (stellungen / wmob_anz)], board);
+      n += BOARDS;
+      dsum += ki_depth;
+      if (ki_depth < dmin) dmin= ki_depth;
+      if (ki_depth > dmax) dmax= ki_depth;
+    }
+    t= ns() - t0;
+    printf("  %7dx %10.0f %6.1f %6d %6d %12ld %11.0f\n", zeitlupe, t / 1e6 / wmob_anz,
+           (double)dsum / wmob_anz, dmin, dmax, n / wmob_anz, n * 1e9 / t);
+  }
+  zeitlupe= 1;
+}
+
+int main(void)
+{
+  int fail;
+
+  tick_start();
+  stellungen_erzeugen();
+  fail= zuege_test();
+  wmob_test();
+  printf("\n%s\n", fail ? "FEHLER" : "alle Zuege gleich");
+  return fail;
+}
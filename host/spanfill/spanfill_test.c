@@ -0,0 +1,525 @@
+/* -------------------------------------------------------
+                      spanfill_test.c
+
+   Gefuellte Formen (tft_spanfill.c) auf dem PC: Bilder
+   gegen Sollbilder, Bus-Bytes und Rechenzeit je Szene.
+
+   Uebersetzt wird dieselbe Datei gegen
+
+     spanfill_spi    : tftdisplay.c, SPI (S6D02A1 128x160)
+     spanfill_par    : tftdisplay.c, 8-Bit Parallelbus
+                       (ILI9341 240x320)
+     spanfill_tftpar : tft_parallel.c, 8-Bit Parallelbus
+                       (ILI9341 240x320, Header aus tftpar/)
+
+   Die Bytes auf dem Bus laufen in eine Controller-Nach-
+   bildung (lcdemu): beim SPI mit D/C ueber host_spi_hook,
+   beim Parallelbus mit RS und D0..D7 bei jeder fallenden
+   WR-Flanke ueber host_gpio_hook.
+
+   Sollbild: tft_spanfill.c wird hier ein zweites Mal mit
+   einer fill_span eingebunden, die in einen Bildspeicher
+   (logische Koordinaten) zeichnet. Der Bildspeicher wird
+   Punkt fuer Punkt mit putpixel in eine zweite Nachbildung
+   uebertragen, beide Nachbildungen muessen dasselbe Bild
+   zeigen. Der Pruefwert des Bildspeichers jeder Szene ist
+   in ref/<programm>.txt abgelegt (goldenes Bild).
+
+   Die tftdisplay.c-Varianten zeichnen Ellipsen und Kreise
+   zusaetzlich mit den Funktionen vor tft_spanfill.c
+   (host/alt/tft_alt.c), Bild, Bytes und Zeit werden
+   gegenuebergestellt (ohne Radius 0, dort terminieren
+   die alten Funktionen nicht).
+
+   Rechenzeit: Zyklen (rdtsc, sonst ns) fuer das Zeichnen
+   der Szene ohne Nachbildung (Hook aus), bestes von 5
+   Durchlaeufen.
+
+   Aufruf:
+
+       spanfill_xxx              Tabelle
+       spanfill_xxx ppm-verz.    dto., zusaetzlich je Szene
+                                 <verz>/<szene>.ppm
+       spanfill_xxx -r           nur Szene, Pruefwert und
+                                 Bytes (Vergleich mit ref/)
+
+   Rueckgabewert 1, wenn sich ein Bild unterscheidet.
+  -------------------------------------------------------- */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "tftdisplay.h"
+#include "host_hal.h"
+#include "lcdemu.h"
+
+#ifndef in_tft_parallel
+  #include "tft_alt.h"
+  #define mit_alt      1
+#else
+  #define mit_alt      0
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+  #include <x86intrin.h>
+  static inline uint64_t zyklen(void) { return __rdtsc(); }
+#else
+  static inline uint64_t zyklen(void)
+  {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+  }
+#endif
+
+#define bw             _xres                  // logische Groesse (outmode 0 / orientation 1)
+#define bh             _yres
+
+#define hg_farbe       0x0000
+
+/* -------------------------------------------------------
+                         Sollbild
+   ------------------------------------------------------- */
+
+static uint16_t soll[bw * bh];
+
+static void fill_span(int x1, int x2, int y, uint16_t color)
+{
+  int t;
+
+  if (x2 < x1) { t= x1; x1= x2; x2= t; }
+  if ((y < 0) || (y >= bh) || (x2 < 0) || (x1 >= bw)) return;
+  if (x1 < 0) x1= 0;
+  if (x2 >= bw) x2= bw-1;
+  for (t= x1; t <= x2; t++) soll[y * bw + t]= color;
+}
+
+#define fillellipse    soll_fillellipse
+#define fillcircle     soll_fillcircle
+#define fillroundrect  soll_fillroundrect
+#define fillpoly       soll_fillpoly
+#define filltriangle   soll_filltriangle
+
+#include "tft_spanfill.c"
+
+#undef fillellipse
+#undef fillcircle
+#undef fillroundrect
+#undef fillpoly
+#undef filltriangle
+
+static uint32_t soll_hash(void)
+{
+  uint32_t h= 2166136261u;
+  int      i;
+
+  for (i= 0; i < bw * bh; i++)
+  {
+    h= (h ^ (soll[i] & 0xff)) * 16777619u;
+    h= (h ^ (soll[i] >> 8)) * 16777619u;
+  }
+  return h;
+}
+
+/* -------------------------------------------------------
+                Bus in die Nachbildung
+   ------------------------------------------------------- */
+
+static lcdemu_t  emu_ist, emu_soll;
+static lcdemu_t *emu;                         // Ziel der Bus-Bytes
+
+#if (USE_SPI_TFT == 1)
+
+  static uint32_t dc_port;
+  static uint16_t dc_mask;
+
+  // Port und Pin von D/C aus den Makros in tft_pindefs.h ermitteln
+  static void find_dc(void)
+  {
+    uint16_t a, b;
+
+    dc_clr();
+    a= host_port(GPIOA); b= host_port(GPIOB);
+    dc_set();
+    if (host_port(GPIOA) != a) { dc_port= GPIOA; dc_mask= host_port(GPIOA) ^ a; }
+                          else { dc_port= GPIOB; dc_mask= host_port(GPIOB) ^ b; }
+  }
+
+  static void spi_decode(uint32_t spi, uint16_t data)
+  {
+    (void)spi;
+    lcdemu_byte(emu, (host_port(dc_port) & dc_mask) ? 1 : 0, data);
+  }
+
+  static void bus_ein(void) { host_spi_hook= spi_decode; }
+  static void bus_aus(void) { host_spi_hook= NULL; }
+
+#else
+
+  #define port_nr(p)   ( ((p) - GPIOA) / (GPIOB - GPIOA) )
+  #define wr_bit       GPIO1                  // PA1, beide Boardversionen
+  #if (boardversion == 0)
+    #define rs_bit     GPIO2                  // PA2
+  #else
+    #define rs_bit     GPIO4                  // PA4
+  #endif
+
+  static uint16_t odr[3];                     // Spiegel der Ausgangsregister
+
+  // liest das an D0..D7 anliegende Byte aus den Ausgangsregistern (wie host/parfill)
+  static uint8_t busbyte(void)
+  {
+    uint16_t a= odr[0], b= odr[1];
+
+    #if (boardversion == 0)
+      (void)a;
+      return ((b >> 4) & 0xfc) | ((b >> 12) & 0x03);
+    #else
+      return ((b & 0x2000) ? 0x01 : 0) | ((b & 0x0080) ? 0x02 : 0)
+           | ((b & 0x0002) ? 0x04 : 0) | ((b & 0x0008) ? 0x08 : 0)
+           | ((b & 0x0020) ? 0x10 : 0) | ((b & 0x0010) ? 0x20 : 0)
+           | ((a & 0x8000) ? 0x40 : 0) | ((a & 0x0100) ? 0x80 : 0);
+    #endif
+  }
+
+  static void gpio_decode(uint32_t gpioport, uint16_t oldval, uint16_t newval)
+  {
+    uint32_t nr;
+
+    nr= port_nr(gpioport);
+    if (nr > 2) return;
+    odr[nr]= newval;
+    if ((nr == 0) && ((oldval ^ newval) & wr_bit) && !(newval & wr_bit))
+      lcdemu_byte(emu, (odr[0] & rs_bit) ? 1 : 0, busbyte());
+  }
+
+  static void bus_ein(void)
+  {
+    odr[0]= host_port(GPIOA); odr[1]= host_port(GPIOB); odr[2]= host_port(GPIOC);
+    host_gpio_hook= gpio_decode;
+  }
+  static void bus_aus(void) { host_gpio_hook= NULL; }
+
+#endif
+
+static uint32_t image_hash(const lcdemu_t *e)
+{
+  uint32_t h= 2166136261u;
+  uint16_t c;
+  int      x, y;
+
+  for (y= 0; y < e->h; y++)
+    for (x= 0; x < e->w; x++)
+    {
+      c= lcdemu_pixel(e, x, y);
+      h= (h ^ (c & 0xff)) * 16777619u;
+      h= (h ^ (c >> 8)) * 16777619u;
+    }
+  return h;
+}
+
+/* -------------------------------------------------------
+                         Szenen
+
+   Jede Szene zeichnet mit einem Satz Fuellfunktionen,
+   Koordinaten relativ zur Displaygroesse
+   ------------------------------------------------------- */
+
+typedef struct
+{
+  void (*ellipse)(int xm, int ym, int a, int b, uint16_t color);
+  void (*circle)(int x, int y, int r, uint16_t color);
+  void (*roundrect)(int x1, int y1, int x2, int y2, int r, uint16_t color);
+  void (*poly)(int anz, const int *pts, uint16_t color);
+  void (*triangle)(int x0, int y0, int x1, int y1, int x2, int y2, uint16_t color);
+} formen_t;
+
+static const formen_t f_soll =
+  { soll_fillellipse, soll_fillcircle, soll_fillroundrect, soll_fillpoly, soll_filltriangle };
+static const formen_t f_ist =
+  { fillellipse, fillcircle, fillroundrect, fillpoly, filltriangle };
+#if (mit_alt == 1)
+  static const formen_t f_alt =
+    { alt_fillellipse, alt_fillcircle, NULL, NULL, NULL };
+#endif
+
+static uint32_t rnd_state;
+
+static int rnd(int n)
+{
+  rnd_state= rnd_state * 1103515245u + 12345u;
+  return (rnd_state >> 16) % n;
+}
+
+static void s_ellipsen(const formen_t *f)
+{
+  int i;
+
+  f->ellipse(bw/2, bh/2, bw/2-2, bh/2-2, 0x001f);
+  f->ellipse(bw/2, bh/2, bw/3, bh/5, 0xf800);
+  f->ellipse(bw/4, bh/4, bw/5, 1, 0xffe0);             // flach (b=1)
+  f->ellipse(bw/4, 3*bh/4, 1, bh/6, 0x07e0);           // schmal (a=1)
+  f->ellipse(3*bw/4, bh/4, 0, 5, 0xffff);              // a=0
+  rnd_state= 1;
+  for (i= 0; i < 20; i++)
+    f->ellipse(10 + rnd(bw-20), 10 + rnd(bh-20), 1 + rnd(9), 1 + rnd(9), rnd(0x10000));
+}
+
+static void s_kreise(const formen_t *f)
+{
+  int i;
+
+  for (i= bw/2-1; i > 0; i -= 3)
+    f->circle(bw/2, bh/2, i, (i & 1) ? 0xf81f : 0x07ff);
+  rnd_state= 2;
+  for (i= 0; i < 30; i++)
+    f->circle(12 + rnd(bw-24), 12 + rnd(bh-24), 1 + rnd(11), rnd(0x10000));
+}
+
+// Radius 0 (die alten Funktionen terminieren hier nicht)
+static void s_punkte(const formen_t *f)
+{
+  int i;
+
+  rnd_state= 4;
+  for (i= 0; i < 20; i++)
+  {
+    f->circle(rnd(bw), rnd(bh), 0, 0xffff);
+    f->ellipse(rnd(bw), rnd(bh), 0, 0, 0xf800);
+    f->roundrect(rnd(bw), rnd(bh/2), rnd(bw), rnd(bh/2), 0, 0x07e0);
+  }
+}
+
+static void s_rundrechteck(const formen_t *f)
+{
+  f->roundrect(2, 2, bw-3, bh-3, bw/6, 0x001f);
+  f->roundrect(10, 10, bw/2, bh/3, 0, 0xf800);           // r= 0
+  f->roundrect(bw-10, bh/2, bw/2, 10, 4, 0x07e0);        // Ecken vertauscht
+  f->roundrect(10, bh/2, bw/2, bh-10, 200, 0xffe0);      // r zu gross
+  f->roundrect(bw/2+5, bh/2+5, bw/2+5, bh/2+40, 3, 0xffff);   // eine Spalte
+}
+
+static void s_polygone(const formen_t *f)
+{
+  int stern[20], pfeil[14], treppe[16], schleife[8];
+  int i, r;
+
+  // Stern mit 10 Ecken, ganzzahlige Koordinaten aus einer Tabelle (kein libm)
+  static const int sx[10] = {   0,  22,  95,  36,  59,   0, -59, -36, -95, -22 };
+  static const int sy[10] = {-100, -30, -31,  12,  81,  38,  81,  12, -31, -30 };
+  r= ((bw < bh) ? bw : bh) / 4;
+  for (i= 0; i < 10; i++)
+  {
+    stern[2*i]  = bw/4 + sx[i] * r / 100;
+    stern[2*i+1]= bh/4 + sy[i] * r / 100;
+  }
+  f->poly(10, stern, 0xffe0);
+
+  // Pfeil (konkav)
+  pfeil[0]= bw/2;     pfeil[1]= bh/2;
+  pfeil[2]= bw-5;     pfeil[3]= bh/2 + 20;
+  pfeil[4]= bw/2;     pfeil[5]= bh/2 + 40;
+  pfeil[6]= bw/2;     pfeil[7]= bh/2 + 28;
+  pfeil[8]= bw/2-30;  pfeil[9]= bh/2 + 28;
+  pfeil[10]= bw/2-30; pfeil[11]= bh/2 + 12;
+  pfeil[12]= bw/2;    pfeil[13]= bh/2 + 12;
+  f->poly(7, pfeil, 0xf800);
+
+  // Treppe: waagrechte Kanten und Durchgangspunkte
+  treppe[0]= 5;       treppe[1]= bh-5;
+  treppe[2]= 5;       treppe[3]= bh-35;
+  treppe[4]= 15;      treppe[5]= bh-35;
+  treppe[6]= 15;      treppe[7]= bh-25;
+  treppe[8]= 25;      treppe[9]= bh-25;
+  treppe[10]= 25;     treppe[11]= bh-15;
+  treppe[12]= 35;     treppe[13]= bh-15;
+  treppe[14]= 35;     treppe[15]= bh-5;
+  f->poly(8, treppe, 0x07ff);
+
+  // Schleife (ueberschneidende Kanten, gerade-ungerade Regel)
+  schleife[0]= bw-40; schleife[1]= 10;
+  schleife[2]= bw-5;  schleife[3]= 45;
+  schleife[4]= bw-5;  schleife[5]= 10;
+  schleife[6]= bw-40; schleife[7]= 45;
+  f->poly(4, schleife, 0xf81f);
+}
+
+static void s_dreiecke(const formen_t *f)
+{
+  int i;
+
+  f->triangle(5, 5, 5, 5, 5, 5, 0xffff);                    // Punkt
+  f->triangle(10, 5, 40, 5, 25, 5, 0xffff);                 // waagrecht
+  f->triangle(bw-5, 10, bw-5, 40, bw-5, 25, 0xffff);        // senkrecht
+  rnd_state= 3;
+  for (i= 0; i < 40; i++)
+    f->triangle(rnd(bw), rnd(bh), rnd(bw), rnd(bh), rnd(bw), rnd(bh), rnd(0x10000));
+}
+
+// ueber die Displaygrenzen hinaus (fill_span beschneidet)
+static void s_rand(const formen_t *f)
+{
+  static int aussen[8];
+
+  f->circle(0, 0, bw/3, 0xf800);
+  f->circle(bw, bh, bw/3, 0x07e0);
+  f->ellipse(bw/2, bh/2, bw, bh/8, 0x001f);
+  f->roundrect(-20, bh-30, bw+20, bh+20, 10, 0xffe0);
+  aussen[0]= -50;    aussen[1]= bh/3;
+  aussen[2]= bw/2;   aussen[3]= -40;
+  aussen[4]= bw+50;  aussen[5]= bh/3;
+  aussen[6]= bw/2;   aussen[7]= bh/2;
+  f->poly(4, aussen, 0xf81f);
+  f->triangle(-30, bh-60, bw/3, bh+30, 20, bh-90, 0x07ff);
+}
+
+typedef struct
+{
+  const char *name;
+  void (*szene)(const formen_t *f);
+  int   alt;                                  // Vergleich mit den alten Funktionen
+} workload_t;
+
+static const workload_t workloads[] =
+{
+  { "ellipsen",     s_ellipsen,     1 },
+  { "kreise",       s_kreise,       1 },
+  { "punkte",       s_punkte,       0 },
+  { "rundrechteck", s_rundrechteck, 0 },
+  { "polygone",     s_polygone,     0 },
+  { "dreiecke",     s_dreiecke,     0 },
+  { "rand",         s_rand,         0 },
+};
+
+#define workload_anz   (sizeof(workloads) / sizeof(workloads[0]))
+
+static void zaehler_null(lcdemu_t *e)
+{
+  e->ncmd= 0; e->ndata= 0;
+  memset(e->nkl, 0, sizeof(e->nkl));
+}
+
+// Szene mit Nachbildung zeichnen, liefert die Bytes auf dem Bus
+static uint32_t zeichnen(const workload_t *w, const formen_t *f)
+{
+  emu= &emu_ist;
+  bkcolor= hg_farbe;
+  clrscr();
+  zaehler_null(&emu_ist);
+  w->szene(f);
+  return emu_ist.ncmd + emu_ist.ndata;
+}
+
+// Szene ohne Nachbildung zeichnen, bestes von 5 Durchlaeufen
+static uint64_t messen(const workload_t *w, const formen_t *f)
+{
+  uint64_t t, best= 0;
+  int      i;
+
+  bus_aus();
+  for (i= 0; i < 5; i++)
+  {
+    t= zyklen();
+    w->szene(f);
+    t= zyklen() - t;
+    if ((!i) || (t < best)) best= t;
+  }
+  bus_ein();
+  return best;
+}
+
+int main(int argc, char *argv[])
+{
+  char        fname[256];
+  uint32_t    i, hs, bytes;
+  uint64_t    zyk;
+  int         x, y, gleich, fail= 0, nurref= 0;
+  const char *ppmdir= NULL;
+  #if (mit_alt == 1)
+    uint32_t  bytes_alt;
+    uint64_t  zyk_alt;
+    int       gleich_alt;
+  #endif
+
+  if (argc > 1)
+  {
+    if (!strcmp(argv[1], "-r")) nurref= 1; else ppmdir= argv[1];
+  }
+
+  host_reset();
+  #if (USE_SPI_TFT == 1)
+    find_dc();
+    lcdemu_init_ctrl(&emu_ist, lcdemu_s6d02a1, _xres, _yres);
+    lcdemu_init_ctrl(&emu_soll, lcdemu_s6d02a1, _xres, _yres);
+  #else
+    lcdemu_init_ctrl(&emu_ist, lcdemu_ili9340, _xres, _yres);
+    lcdemu_init_ctrl(&emu_soll, lcdemu_ili9340, _xres, _yres);
+  #endif
+  bus_ein();
+  emu= &emu_soll; lcd_init();
+  emu= &emu_ist; lcd_init();
+
+  if (!nurref)
+  {
+    printf("\nGefuellte Formen %dx%d, Zyklen ohne Nachbildung\n", bw, bh);
+    printf("  %-12s %8s  %-6s %9s %11s", "Szene", "Soll", "Bild", "Bytes", "Zyklen");
+    #if (mit_alt == 1)
+      printf("  %-6s %9s %11s", "alt", "Bytes alt", "Zyklen alt");
+    #endif
+    printf("\n");
+  }
+
+  for (i= 0; i < workload_anz; i++)
+  {
+    // Sollbild im Bildspeicher, mit putpixel auf die zweite Nachbildung
+    for (x= 0; x < bw * bh; x++) soll[x]= hg_farbe;
+    workloads[i].szene(&f_soll);
+    hs= soll_hash();
+
+    emu= &emu_soll;
+    bkcolor= hg_farbe;
+    clrscr();
+    for (y= 0; y < bh; y++)
+      for (x= 0; x < bw; x++)
+        if (soll[y * bw + x] != hg_farbe) putpixel(x, y, soll[y * bw + x]);
+
+    bytes= zeichnen(&workloads[i], &f_ist);
+    gleich= (image_hash(&emu_ist) == image_hash(&emu_soll));
+    if (!gleich) fail= 1;
+
+    if (nurref)
+    {
+      printf("%s %08lx %lu %s\n", workloads[i].name, (unsigned long)hs, (unsigned long)bytes,
+             gleich ? "gleich" : "FEHLER");
+      continue;
+    }
+
+    if ((ppmdir) && (gleich))
+    {
+      snprintf(fname, sizeof(fname), "%s/%s.ppm", ppmdir, workloads[i].name);
+      if (!lcdemu_write_ppm(&emu_ist, fname)) fail= 1;
+    }
+
+    zyk= messen(&workloads[i], &f_ist);
+    printf("  %-12s %08lx  %-6s %9lu %11llu", workloads[i].name, (unsigned long)hs,
+           gleich ? "gleich" : "FEHLER", (unsigned long)bytes, (unsigned long long)zyk);
+
+    #if (mit_alt == 1)
+      if (workloads[i].alt)
+      {
+        bytes_alt= zeichnen(&workloads[i], &f_alt);
+        gleich_alt= (image_hash(&emu_ist) == image_hash(&emu_soll));
+        if (!gleich_alt) fail= 1;
+        zyk_alt= messen(&workloads[i], &f_alt);
+        printf("  %-6s %9lu %11llu", gleich_alt ? "gleich" : "FEHLER",
+               (unsigned long)bytes_alt, (unsigned long long)zyk_alt);
+      }
+    #endif
+    printf("\n");
+  }
+
+  lcdemu_free(&emu_ist);
+  lcdemu_free(&emu_soll);
+  return fail;
+}
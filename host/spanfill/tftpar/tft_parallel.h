@@ -0,0 +1,95 @@
+/* -------------------------------------------------------
+                      tft_parallel.h
+
+   Header fuer src/tft_parallel.c im Testrahmen spanfill
+   (im Baum fehlt tft_parallel.h). Stellt die Definitionen
+   bereit, die tft_parallel.c erwartet:
+
+     - ILI9341, 240x320, 8-Bit Parallelbus
+     - Pinbelegung aus tft_pindefs.h (boardversion)
+     - MADCTL-Bits MEM_*, lcdinit_seq aus tft_lcdseq.c
+     - Fonts 8x8 und 12x16
+
+   und die Prototypen der Funktionen von tft_parallel.c.
+  -------------------------------------------------------- */
+
+#ifndef in_tft_parallel
+  #define in_tft_parallel
+
+  #include <stdint.h>
+  #include <stdlib.h>
+  #include <libopencm3.h>
+
+  #include "sysf103_init.h"
+
+  #define ili9341                 1
+  #define _xres                   240
+  #define _yres                   320
+
+  #define USE_SPI_TFT             0
+  #define USE_8BIT_TFT            1
+
+  #define boardversion            1                 // 0: Nucleo R3, 1: STM32 Board r3
+
+  // Bits im MADCTL-Register
+  #define MEM_Y    7
+  #define MEM_X    6
+  #define MEM_V    5
+  #define MEM_L    4
+  #define MEM_BGR  3
+  #define MEM_H    2
+
+  #define delay_flag              0x80
+
+  // tft_pindefs.h bindet tftdisplay.h ein, hier nicht gewuenscht
+  #define in_tftdisplay_module
+  #include "tft_pindefs.h"
+  #include "tft_lcdseq.c"
+
+  #include "font8x8.fnt"
+  #include "font12x16.fnt"
+
+  extern uint16_t egapalette[];
+  extern uint16_t textcolor, bkcolor;
+  extern uint16_t aktxp, aktyp;
+  extern uint8_t  textsize, txoutmode, fntfilled, orientation;
+  extern uint16_t tftwidth, tftheight;
+
+  uint16_t rgbfromvalue(uint8_t r, uint8_t g, uint8_t b);
+  uint16_t rgbfromega(uint8_t entry);
+  void lcd_bus_write(uint8_t val);
+  void lcd_write_com(uint8_t val);
+  void lcd_write_data(unsigned char val);
+  void address_set(unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2);
+  void invertcolor();
+  void normalcolor();
+  void lcd_orientation (uint8_t ori);
+  void lcd_init(void);
+  void putpixel(int x, int y, uint16_t color);
+  void putpixeltx(int x, int y, uint16_t color);
+  void clrscr(void);
+  void line(int x0, int y0, int x1, int y1, uint16_t color);
+  void fastxline(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t color);
+  void rectangle(int x1, int y1, int x2, int y2, uint16_t color);
+  void fillrect(int x1, int y1, int x2, int y2, uint16_t color);
+  void ellipse(int xm, int ym, int a, int b, uint16_t color );
+  void circle(int x, int y, int r, uint16_t color );
+  void fillellipse(int xm, int ym, int a, int b, uint16_t color );
+  void fillcircle(int x, int y, int r, uint16_t color );
+  void fillroundrect(int x1, int y1, int x2, int y2, int r, uint16_t color);
+  void fillpoly(int anz, const int *pts, uint16_t color);
+  void filltriangle(int x0, int y0, int x1, int y1, int x2, int y2, uint16_t color);
+  void showimage(char ox, char oy, const unsigned char* const image, uint16_t fwert);
+  void gotoxy(unsigned char x, unsigned char y);
+  void gotoxy_12x16(unsigned char x, unsigned char y);
+  void lcd_putchar8x8(unsigned char ch);
+  void lcd_putchar8x8_nobk(unsigned char ch);
+  void lcd_putchar12x16(unsigned char ch);
+  void lcd_putchar12x16_nobk(unsigned char ch);
+  void outtextxy(int x, int y, uint8_t dir, char *dataPtr);
+  void setfont(uint8_t nr);
+  void lcd_putchar(char ch);
+  void turtle_moveto(int x, int y);
+  void turtle_lineto(int x, int y, uint16_t col);
+
+#endif
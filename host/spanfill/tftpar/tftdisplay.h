@@ -0,0 +1,8 @@
+/* -------------------------------------------------------
+                      tftdisplay.h
+
+   spanfill_test.c bindet tftdisplay.h ein, fuer
+   spanfill_tftpar ist das der Header von tft_parallel.c
+  -------------------------------------------------------- */
+
+#include "tft_parallel.h"
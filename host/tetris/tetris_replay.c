@@ -0,0 +1,440 @@
+/* -------------------------------------------------------
+                      tetris_replay.c
+
+   Spielablauf von game_tetris/tetris_v2.c auf dem PC,
+   ohne Display und ohne Tasten.
+
+   tetris_v2.c wird hier eingebunden (main heisst dann
+   tetris_main), die ueber SPI gesendeten Bytes laufen in
+   die Controller-Nachbildung host/lcdemu.c. Die Tasten
+   (Variable keys, sonst vom Timer-Interrupt gesetzt)
+   werden bei jedem delay von einem einfachen Spieler
+   gesetzt: fuer jede neue Figur wird unter den erreich-
+   baren Lagen (Drehung, Spalte) die mit der besten Be-
+   wertung (Hoehe, volle Reihen, Loecher, Unebenheit)
+   gesucht, die Figur gedreht, verschoben und fallen
+   gelassen. Der Ablauf haengt nur vom
+   Spielfeld ab und ist damit fuer bitfeld 0 und 1 gleich.
+
+   Gemessen wird je eingerasteter Figur:
+
+     Einrasten : Abschnitt zwischen zwei delay-Aufrufen,
+                 in dem die Figur ins Spielfeld uebernommen
+                 wurde (copyfig, volle Reihen entfernen,
+                 drawfeld, neue Figur zeichnen)
+     gesamt    : alle Ausgaben der Figur (Bewegungen,
+                 Drehungen, Score)
+
+   jeweils Bytes auf dem Displaybus und Zyklen des PC
+   (Zeitstempelzaehler, ohne die Zeit der Controller-
+   Nachbildung, nicht des STM32!).
+
+   Aufruf:
+
+       tetris_replay            : Ausgabe der Messwerte und
+                                  der Pruefwerte
+       tetris_replay ref.txt    : zusaetzlich Vergleich der
+                                  Pruefwerte (Score, Anzahl
+                                  Figuren, Spielfeld, Bild)
+                                  mit einem anderen Lauf
+       tetris_replay -s datei   : Tastenfolge der ersten
+                                  recpieces Figuren als Ein-
+                                  gabeskript fuer host/games
+                                  schreiben
+
+   Rueckgabewert 1, wenn sich die Pruefwerte unterscheiden.
+  -------------------------------------------------------- */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <setjmp.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+  #include <x86intrin.h>
+  static inline uint64_t cycles(void) { return __rdtsc(); }
+#else
+  #include <time.h>
+  static inline uint64_t cycles(void)
+  {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+  }
+#endif
+
+#include "host_hal.h"
+#include "lcdemu.h"
+
+void sys_init(void);
+
+#define main tetris_main
+#include "tetris_v2.c"
+#undef main
+#undef printf
+
+#define maxpieces   400
+#define recpieces   60                        // Figuren im Eingabeskript (-s)
+
+static lcdemu_t emu;
+static uint32_t dc_port;
+static uint16_t dc_mask;
+static jmp_buf  replay_end;
+
+static uint64_t spi_cyc;                      // Zyklen in der Controller-Nachbildung
+static uint64_t t_leave;                      // Zeitpunkt am Ende des letzten delay
+static uint32_t b_leave;                      // Bytezaehler dto.
+static int      lastsig= -1;
+static uint8_t  started;                      // 1 : Startbild quittiert
+
+static uint32_t pieces;
+static uint64_t lock_bytes, lock_cyc, all_bytes, all_cyc;
+static uint32_t lock_max;
+
+static FILE     *rec;                         // Tastenfolge als Eingabeskript (-s)
+static uint8_t  rec_keys= 0x08;               // Start: unten bis zum Spielbeginn gehalten
+static int      rec_t0[4];
+
+static int      t_rot, t_x;                   // Ziel fuer die aktuelle Figur
+static int      last_rot, rot_tries;
+
+/* -------------------------------------------------------
+     Ersatz fuer sysf103_init.c
+   ------------------------------------------------------- */
+void sys_init(void)
+{
+}
+
+/* -------------------------------------------------------
+     Displaybus
+   ------------------------------------------------------- */
+
+// Port und Pin von D/C aus den Makros in tft_pindefs.h ermitteln
+static void find_dc(void)
+{
+  uint16_t a, b;
+
+  dc_clr();
+  a= host_port(GPIOA); b= host_port(GPIOB);
+  dc_set();
+  if (host_port(GPIOA) != a) { dc_port= GPIOA; dc_mask= host_port(GPIOA) ^ a; }
+                        else { dc_port= GPIOB; dc_mask= host_port(GPIOB) ^ b; }
+}
+
+static void spi_decode(uint32_t spi, uint16_t data)
+{
+  uint64_t t;
+
+  (void)spi;
+  t= cycles();
+  lcdemu_byte(&emu, (host_port(dc_port) & dc_mask) ? 1 : 0, data);
+  spi_cyc += cycles() - t;
+}
+
+static uint32_t busbytes(void)
+{
+  return emu.ncmd + emu.ndata;
+}
+
+/* -------------------------------------------------------
+     Spielfeld lesen (beide Darstellungen)
+   ------------------------------------------------------- */
+static int cell(int x, int y)
+{
+  #if (bitfeld == 1)
+    return (tetfeld[y] >> (15 - x)) & 1;
+  #else
+    return tetfeld[y][x] != 0;
+  #endif
+}
+
+// Anzahl belegter Felder + Reihen * gamcol: waechst mit jeder eingerasteten Figur um 4
+static int feld_sig(void)
+{
+  int x, y, n;
+
+  n= scorecx * gamcol;
+  for (y= 0; y < gamrows-1; y++)
+    for (x= 1; x <= gamcol; x++)
+      n += cell(x, y);
+  return n;
+}
+
+/* -------------------------------------------------------
+     Spieler
+   ------------------------------------------------------- */
+static uint8_t grid[gamrows][gamcol+2];
+
+static int fits(uint16_t fig, int fx, int fy)
+{
+  int i, x, y;
+
+  for (i= 0; i < 16; i++)
+  {
+    if (!(fig & (0x8000 >> i))) continue;
+    x= fx + (i % 4); y= fy + (i / 4);
+    if ((x < 1) || (x > gamcol) || (y < 0) || (y >= gamrows-1)) return 0;
+    if (grid[y][x]) return 0;
+  }
+  return 1;
+}
+
+// Bewertung nach dem Ablegen: Hoehe, volle Reihen, Loecher, Unebenheit und (das Spielfeld
+// ist nur 14 Reihen hoch) die hoechste Spalte
+static int rate(void)
+{
+  int x, y, h[gamcol+2], agg= 0, lines= 0, holes= 0, bump= 0, full, top, maxh;
+
+  for (y= 0; y < gamrows-1; y++)
+  {
+    full= 1;
+    for (x= 1; x <= gamcol; x++) if (!grid[y][x]) full= 0;
+    lines += full;
+  }
+  for (x= 1; x <= gamcol; x++)
+  {
+    top= gamrows-1;
+    for (y= gamrows-2; y >= 0; y--) if (grid[y][x]) top= y;
+    h[x]= (gamrows-1) - top;
+    agg += h[x];
+    for (y= top+1; y < gamrows-1; y++) if (!grid[y][x]) holes++;
+    if (x > 1) bump += (h[x] > h[x-1]) ? h[x] - h[x-1] : h[x-1] - h[x];
+  }
+  maxh= 0;
+  for (x= 1; x <= gamcol; x++) if (h[x] > maxh) maxh= h[x];
+  return -51 * agg + 76 * lines - 36 * holes - 18 * bump - 5 * maxh * maxh;
+}
+
+/* -------------------------------------------------------
+     reachable
+
+     prueft, ob die aktuelle Figur mit Drehen und anschlies-
+     sendem Verschieben in die Lage r, fx gebracht werden
+     kann. Nach jeweils zwei Tastendruecken faellt die Figur
+     eine Reihe (outerloop 2), die Figur darf dabei nicht
+     aufsetzen.
+   ------------------------------------------------------- */
+static int reachable(int r, int fx)
+{
+  uint16_t fig;
+  int      rot, x, y, n;
+
+  rot= aktrot; x= (signed char)figx; y= (signed char)figy;
+  fig= tetfigures[aktfig][rot];
+  for (n= 1; (rot != r) || (x != fx); n++)
+  {
+    if (rot != r)
+    {
+      // der lange Stab braucht zum Drehen die ganzen 4x4 Felder (siehe tetris_v2.c)
+      if (!fits((aktfig == 6) ? 0xffff : tetfigures[aktfig][(rot+1) & 3], x, y)) return 0;
+      rot= (rot+1) & 3;
+      fig= tetfigures[aktfig][rot];
+    }
+    else
+    {
+      x += (fx > x) ? 1 : -1;
+      if (!fits(fig, x, y)) return 0;
+    }
+    if (!(n & 1))
+    {
+      if (!fits(fig, x, y+1)) return 0;
+      y++;
+    }
+  }
+  return 1;
+}
+
+static void plan(void)
+{
+  uint16_t fig;
+  int      r, fx, fy, i, x, y, v, best= -1000000;
+
+  for (y= 0; y < gamrows-1; y++)
+    for (x= 0; x < gamcol+2; x++) grid[y][x]= cell(x, y);
+
+  t_rot= aktrot; t_x= (signed char)figx;
+  for (r= 0; r < 4; r++)
+  {
+    fig= tetfigures[aktfig][r];
+    for (fx= -3; fx <= gamcol; fx++)
+    {
+      fy= (signed char)figy;
+      if ((!fits(fig, fx, fy)) || (!reachable(r, fx))) continue;
+      while (fits(fig, fx, fy+1)) fy++;
+
+      for (i= 0; i < 16; i++)
+        if (fig & (0x8000 >> i)) grid[fy + i/4][fx + i%4]= 1;
+      v= rate();
+      for (i= 0; i < 16; i++)
+        if (fig & (0x8000 >> i)) grid[fy + i/4][fx + i%4]= 0;
+
+      if (v > best) { best= v; t_rot= r; t_x= fx; }
+    }
+  }
+  last_rot= aktrot; rot_tries= 0;
+}
+
+static void player(void)
+{
+  keys= 0;
+  if (aktrot != t_rot)
+  {
+    // je Tastendruck etwa 64 delay-Aufrufe, nach 4 erfolglosen Versuchen die Lage beibehalten
+    if (aktrot != last_rot) { last_rot= aktrot; rot_tries= 0; }
+    if (rot_tries++ < 256) { keys= 0x02; return; }
+    t_rot= aktrot;
+  }
+  if ((signed char)figx < t_x) keys= 0x01;
+  else if ((signed char)figx > t_x) keys= 0x04;
+  else keys= 0x08;
+}
+
+/* -------------------------------------------------------
+     record
+
+     schreibt jede losgelassene Taste als Zeile des Ein-
+     gabeskripts fuer host/games (Zeitpunkt, Taste, Dauer),
+     nach recpieces Figuren das Ende
+   ------------------------------------------------------- */
+static void record(void)
+{
+  static const char *name[4]= { "rechts", "oben", "links", "unten" };
+  int i;
+
+  if (!rec) return;
+  for (i= 0; i < 4; i++)
+  {
+    if ((keys & ~rec_keys) & (1 << i)) rec_t0[i]= tick_ms;
+    if ((rec_keys & ~keys) & (1 << i))
+      fprintf(rec, "%-7d %-8s %d\n", rec_t0[i], name[i], tick_ms - rec_t0[i]);
+  }
+  rec_keys= keys;
+
+  if (pieces >= recpieces)
+  {
+    fprintf(rec, "\nende    %d\n", tick_ms + 1000);
+    fclose(rec);
+    rec= NULL;
+  }
+}
+
+/* -------------------------------------------------------
+     Messung
+   ------------------------------------------------------- */
+static void replay_delay(int ms)
+{
+  uint64_t c;
+  uint32_t b;
+  int      sig;
+
+  // bis zum Spielbeginn (delay(300) nach gamefeld_init) Taste fuer das Startbild halten
+  if (!started)
+  {
+    keys= 0x08;
+    if (ms == 300) { started= 1; keys= 0; record(); }
+    return;
+  }
+
+  c= cycles() - t_leave - spi_cyc;
+  b= busbytes() - b_leave;
+  sig= feld_sig();
+
+  if (lastsig >= 0)
+  {
+    all_bytes += b;
+    all_cyc   += c;
+    if (sig != lastsig)
+    {
+      pieces++;
+      lock_bytes += b;
+      lock_cyc   += c;
+      if (b > lock_max) lock_max= b;
+    }
+  }
+  if ((sig != lastsig) || (lastsig < 0)) plan();
+  lastsig= sig;
+
+  if ((gameover) || (pieces >= maxpieces)) longjmp(replay_end, 1);
+
+  player();
+  record();
+  spi_cyc= 0;
+  b_leave= busbytes();
+  t_leave= cycles();
+}
+
+int main(int argc, char **argv)
+{
+  uint32_t hfeld= 2166136261u, hbild= 2166136261u;
+  unsigned long rscore, rpieces, rhfeld, rhbild;
+  const char *ref= NULL;
+  int      x, y, fail= 0;
+  uint16_t c;
+  FILE     *f;
+
+  if ((argc > 2) && (!strcmp(argv[1], "-s")))
+  {
+    rec= fopen(argv[2], "w");
+    if (!rec) { perror(argv[2]); return 1; }
+    fprintf(rec, "# Tetris: Tastenfolge des Spielers aus host/tetris/tetris_replay.c, die ersten\n"
+                 "# %d Figuren (tetris_replay -s). Die Starttaste wird in einer Schleife ohne\n"
+                 "# delay abgefragt, sie ist deshalb ab 0 ms gedrueckt.\n\n", recpieces);
+  }
+  else if (argc > 1) ref= argv[1];
+
+  host_reset();
+  find_dc();
+  lcdemu_init(&emu, _xres, _yres);
+  host_spi_hook= spi_decode;
+  host_delay_hook= replay_delay;
+  host_irq_ein= 0;                            // keys setzt replay_delay, nicht tim3_isr
+
+  if (!setjmp(replay_end)) tetris_main();
+
+  for (y= 0; y < gamrows; y++)
+    for (x= 0; x < gamcol+2; x++)
+      hfeld= (hfeld ^ cell(x, y)) * 16777619u;
+  for (y= 0; y < _yres; y++)
+    for (x= 0; x < _xres; x++)
+    {
+      c= lcdemu_pixel(&emu, x, y);
+      hbild= (hbild ^ (c & 0xff)) * 16777619u;
+      hbild= (hbild ^ (c >> 8)) * 16777619u;
+    }
+
+  printf("\nbitfeld %d: %lu Figuren, %d Reihen, %s\n", bitfeld, (unsigned long)pieces, scorecx,
+         gameover ? "Game over" : "abgebrochen");
+  printf("  %-26s %10s %12s\n", "je Figur", "Bytes", "Zyklen (PC)");
+  printf("  %-26s %10.0f %12.0f\n", "Einrasten + drawfeld",
+         (double)lock_bytes / (pieces ? pieces : 1), (double)lock_cyc / (pieces ? pieces : 1));
+  printf("  %-26s %10.0f %12.0f\n", "gesamt",
+         (double)all_bytes / (pieces ? pieces : 1), (double)all_cyc / (pieces ? pieces : 1));
+  printf("  %-26s %10lu\n", "Einrasten maximal", (unsigned long)lock_max);
+  printf("  %-26s %08lx / %08lx\n", "Pruefwert Feld / Bild", (unsigned long)hfeld, (unsigned long)hbild);
+
+  if (rec) fclose(rec);
+  if (ref)
+  {
+    f= fopen(ref, "r");
+    if (!f) { perror(ref); return 1; }
+    if ((fscanf(f, "%lu %lu %lx %lx", &rscore, &rpieces, &rhfeld, &rhbild) != 4) ||
+        (rscore != (unsigned long)scorecx) || (rpieces != pieces) ||
+        (rhfeld != hfeld) || (rhbild != hbild))
+      fail= 1;
+    fclose(f);
+    printf("  %-26s %s\n", "Vergleich mit Referenz", fail ? "FEHLER" : "gleich");
+  }
+  else
+  {
+    f= fopen("ref.txt", "w");
+    if (f)
+    {
+      fprintf(f, "%d %lu %08lx %08lx\n", scorecx, (unsigned long)pieces,
+              (unsigned long)hfeld, (unsigned long)hbild);
+      fclose(f);
+    }
+  }
+
+  lcdemu_free(&emu);
+  return fail;
+}
@@ -0,0 +1,419 @@
+/* -----------------------------------------------------------------------------------
+                            tftdisplay.h
+
+     Header Softwaremodul fuer farbige TFT-Displays
+
+     unterstuetzte Displaycontroller:
+     SPI
+     -----------------------------------
+           ili9163
+           ili9340
+           st7735r
+           s6d02a1
+           ili9225
+
+     8-Bit parallel
+     -----------------------------------
+           ili9341
+           ili9481
+           ili9486
+
+     MCU   :  STM32F103
+     Takt  :  interner Takt 72MHz
+
+     17.06.2017  R. Seelig
+   ----------------------------------------------------------------------------------- */
+
+#ifndef in_tftdisplay_module
+  #define in_tftdisplay_module
+
+  #include <stdint.h>
+  #include <stdlib.h>
+  #include <libopencm3.h>
+
+  #include "sysf103_init.h"
+
+
+  /* ------------------------------------------------------------------
+                            Displayauswahl
+
+       es kann (und muss) nur ein einziges Display ausgewaehlt sein.
+     ------------------------------------------------------------------ */
+
+  // ----------------------- SPI- Displays ----------------------------
+
+  #define  ili9163                  0
+  #define  ili9340                  0
+  #define  st7735r                  0
+  #define  s6d02a1                  1
+  #define  ili9225                  0
+  #define  st7789                   0
+
+  // -----------------  ST7735R, 2. Generation Controller ------------
+  //  die 128er Display der 2. Generation haben in Verebindung mit
+  //  ST7735 eine andere StartColum und RowColum
+
+  #define  st7735r_g2               0
+
+
+  // -------------- Displays mit 8-Bit Parallelinterface -------------
+
+  #define  ili9341                  0                // 320 x 240 Pixel
+  #define  ili9481                  0                // 480 x 320 Pixel
+  #define  ili9486                  0                // 480 x 320 Pixel
+
+  /* ------------------------------------------------------------------
+        verfuegbare Textfonts auswaehlen (auch Kombinationen erlaubt)
+     ------------------------------------------------------------------ */
+
+  #define fnt5x7_enable             1                // 1 : Font verfuegbar
+                                                     // 0 : nicht verfuegbar
+  #define fnt8x8_enable             1                // 1 : Font verfuegbar
+                                                     // 0 : nicht verfuegbar
+  #define fnt12x16_enable           1                // 1 : Font verfuegbar
+                                                     // 0 : nicht verfuegbar
+
+  #define lastascii 126                              // letztes verfuegbares Asciizeichen
+
+  #define fnt_cache                 1                // 1 : aufbereitete Zeichen (mit Hintergrund) werden zwischengespeichert
+  #define fnt_cacheanz              4                // Anzahl zwischengespeicherter Zeichen
+  #define fnt_cachepix            192                // max. Pixel je Zeichenzelle (12x16 einfach, 8x8 einfach)
+                                                     // Ram-Bedarf: fnt_cacheanz * (fnt_cachepix * 2 + 9) Bytes
+
+  /*  ------------------------------------------------------------
+                         Displayaufloesung
+      ------------------------------------------------------------ */
+
+  #define _xres                   128
+  #define _yres                   160
+
+  #define mirror                  0                 // 0 : normale Ausgabe
+                                                    // 1 : Spiegelbildausgabe
+
+
+  #if ((ili9163 == 1) || (ili9340 == 1) || (st7735r == 1) || (s6d02a1 == 1 ) || (ili9225 == 1) || (st7789 == 1))
+    #define USE_SPI_TFT             1
+    #define USE_8BIT_TFT            0
+  #endif
+
+  #if ((ili9341 == 1) || (ili9481 == 1) || (ili9486 == 1))
+    #define USE_8BIT_TFT            1
+    #define USE_SPI_TFT             0
+  #endif
+
+  #if (USE_SPI_TFT == 1)
+
+    /*  ------------------------------------------------------------
+                         Setupflags fuer SPI-Displays
+        ------------------------------------------------------------ */
+
+    // fuer Berechnung Bildadressen. ACHTUNG: manche Chinadisplays behandeln 128x128 Displays
+    // so, als haette es 160 Pixel in Y-Aufloesung.
+
+    // In diesem Fall ist fuer _lcyofs  -32 anzugeben
+    // (hat nur Effekt, wenn _yres   128 , im Hauptprogramm dann outmode= 3; damit das Bild
+    // nicht af dem Kopf steht)
+
+    #define tft128                  2                 // 1: Display ohne Offset (aelter)
+                                                      // 2: Display mit Offset (neuer)
+
+    #define rgbseq                  1                 // Reihenfolge der erwarteten Farbuebergabe bei ST7735 LC-Controllern
+                                                      // 0: blau-gruen-rot
+                                                      // 1: rot-gruen-blau
+
+    #define pindefs                 6                 // unterschiedliche Anschluesse an den Controller
+                                                      // Deklarationen der Anschlusspins in tft_pindefs.h
+                                                      // 1 : Anschluss Lochrasterboard
+                                                      // 2 : Anschluss R3 - Evalboard (gedruckte Schaltung)
+                                                      // 3 : Steckbrett
+                                                      // 4 : TFT-Test Shield (umschaltbares Board 3.3V / 5V)
+                                                      // 5 : TFT-Button Shield
+                                                      // 6 : Steckbrett 2
+
+    #define tft_wait                0                 // 0 = keine Wartefunktion nach spi_out
+                                                      // 1 = es wird nach spi_out ein nop eingefuegt
+
+
+    #define flickerreduce           0                 // 0 : normal
+                                                      // 1 : Reduzierung fuer neuere KMR-1.8 SPI Displays
+
+    #define negativout              0                 // 0 : normal
+                                                      // 1 : Farben werden invertiert wiedergegeben (fuer ST7789 notwendig)
+
+    #define tft_dma                 0                 // 1 : Fuellfunktionen (clrscr, fillrect) und tft_dma_pixels
+                                                      //     senden ueber DMA1 Kanal 3 im Hintergrund (16-Bit SPI)
+                                                      // 0 : Ausgabe ausschliesslich per Polling
+
+    /*  ------------------------------------------------------------
+          Sonderfall TFT 128x128 / ST7735 Controller 2. Generation
+        ------------------------------------------------------------ */
+    #if ((st7735r == 1) && (st7735r_g2 == 1) && (_xres == 128) && (_yres == 128))
+      #define colofs                2
+      #define rowofs                3
+    #else
+      #define colofs                0
+      #define rowofs                0
+    #endif
+
+    /*  ------------------------------------------------------------
+          Display-Offset neue/alte 128x128 Pixel TFTs
+        ------------------------------------------------------------ */
+    #if (tft128 == 2)
+      #define _lcyofs               -32               // manche Display sprechen das Display an
+                                                      // als haette es 160 Pixel Y-Aufloesung
+    #else
+      #define _lcyofs               0
+    #endif
+
+
+  #endif // USE_SPI_TFT
+
+  #if (USE_8BIT_TFT == 1)
+
+    /*  ------------------------------------------------------------
+                Setupflags fuer 8-Bit TFT mit Parallelinterface
+        ------------------------------------------------------------ */
+
+      #define colofs                0
+      #define rowofs                0
+
+    /* ------------------------------------------------------------
+                     Pinbelegung Display zu Controller
+       ------------------------------------------------------------ */
+      #define boardversion     1                           // 0: Nucleo R3
+                                                           // 1: eigenes STM32F103 Board R3
+
+      #define tft_fastfill     1                           // 1 : Tabelle fuer die Byteausgabe, Fuellungen
+                                                           //     (clrscr, fillrect) mit vorberechneten
+                                                           //     Portzustaenden
+
+      //  Defines LCD Darstellung
+
+      #define MEM_Y    7
+      #define MEM_X    6
+      #define MEM_V    5
+      #define MEM_L    4
+      #define MEM_BGR  3
+      #define MEM_H    2
+
+  #endif    // USE_8BIT_TFT
+
+  /*  ------------------------------------------------------------
+                Anschlusspins Display zu Controller
+       ----------------------------------------------------------- */
+  #include "tft_pindefs.h"
+
+  /*  ------------------------------------------------------------
+       soll innerhalb der fillrect - Funktion ein Fastfill mittels
+       der Funktionen des Displays vorgenommen werden (hier
+       funktioniert dann ein "Drehen" mittels outmode NICHT)
+     ------------------------------------------------------------- */
+
+  #define  fastfillmode             0
+
+  #define  fillpoly_maxpoints       16               // max. Anzahl Eckpunkte fuer fillpoly (Stackbedarf 14 Bytes je Punkt)
+
+  /*  ------------------------------------------------------------
+       Kachelpuffer (Off-Screen, RGB565): bei eingeschaltetem
+       Puffer zeichnen alle Funktionen in Kacheln zu 32x32 Pixel
+       im RAM, tft_tiles_flush sendet einmal je Frame nur die
+       geaenderten Bereiche (flackerfreie Animationen)
+
+       Ram-Bedarf: tft_tilecount * 2182 Bytes
+     ------------------------------------------------------------- */
+
+  #define  tft_tilecache            0                // 1 : Kachelpuffer verfuegbar
+  #define  tft_tilecount            4                // Anzahl Kacheln im RAM
+
+  /*  ------------------------------------------------------------
+       Textkonsole: fortlaufende Textausgabe mit Zeilenpuffer und
+       VT100 Escape-Sequenzen. ILI9340 / ILI9341 scrollen ueber
+       den Scrollbereich des Controllers, andere Controller
+       zeichnen den Bildschirm neu
+
+       Ram-Bedarf: tft_conlines * tft_concols * 2 Bytes
+     ------------------------------------------------------------- */
+
+  #define  tft_console              0                // 1 : Konsole verfuegbar
+  #define  tft_conlines            48                // Zeilen im Ringpuffer (Bildschirm + Rueckblick)
+  #define  tft_concols             40                // max. Zeichen je Zeile
+
+  /*  ------------------------------------------------------------
+       Sprites mit Hintergrundsicherung: ein bewegtes Objekt wird
+       zusammen mit dem geretteten Hintergrund in einem Fenster
+       ueber alte und neue Position gesendet (kein Loeschen und
+       Neuzeichnen mit putpixel, kein Flackern)
+
+       Ram-Bedarf: tft_spriteanz * (tft_spritepix * 2 + 13)
+                   + (tft_spritebuf + tft_spritepix) * 2 Bytes
+     ------------------------------------------------------------- */
+
+  #define  tft_sprite               0                // 1 : Sprites verfuegbar
+  #define  tft_spriteanz            4                // Anzahl Sprites
+  #define  tft_spritepix           96                // max. Pixel je Sprite (Breite * Hoehe)
+  #define  tft_spritebuf          160                // Sendepuffer in Pixel (alte und neue Position)
+
+  /*  ------------------------------------------------------------
+                         P R O T O T Y P E N
+      ------------------------------------------------------------ */
+
+  // ----------------- LCD - Benutzerfunktionen ---------------
+
+  void lcd_init(void);                                                        // initialisiert Display
+  void lcd_orientation (uint8_t ori);                                         // kompletten Displayinhalt bei der Ausgabe drehen
+  void putpixel(int x, int y,uint16_t color);                                 // schreibt einen einzelnen Punkt auf das Display
+  void clrscr();                                                              // loescht Display-Inhalt
+  void fastxline(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t color);      // zeichnet eine Linie in X-Achse
+  void fillrect(int x1, int y1, int x2, int y2, uint16_t color);              // fuellt einen rechteckigen Bereich mit Farbe aus
+  uint16_t rgbfromvalue(uint8_t r, uint8_t g, uint8_t b);                     // konvertiert einen 24 Bit RGB-Farbwert in einen 16 Bit Farbwert
+  uint16_t rgbfromega(uint8_t entry);                                         // konvertiert einen Farbwert aus der EGA-Palette in einen 16 Bit Farbwert
+  void gotoxy(unsigned char x, unsigned char y);                              // setzt den Textcursor fuer Textausgaben
+  void setfont(uint8_t nr);                                                   // setzt Schriftstil: 0= 8x8 Pixel, 2= 5x7 Pixel
+  void lcd_putchar(char ch);                                                  // setzt ein Zeichen auf das Display
+  void lcd_putchar5x7(unsigned char ch);
+  void lcd_putchar8x8(unsigned char ch);
+  void lcd_putchar12x16(unsigned char ch);
+  void putcharxy(int oldx, int oldy, unsigned char ch);                       // setzt ein Zeichen an der angegebenen  Grafikkoordinate
+  void outtextxy(int x, int y, uint8_t dir, char *dataPtr);                   // gibt einen String an Pixelkoordinaten auf dem LCD aus
+  void line(int x0, int y0, int x1, int y1, uint16_t color);                  // zeichnet eine Linie
+  void rectangle(int x1, int y1, int x2, int y2, uint16_t color);             // zeichnet ein Rechteck
+  void ellipse(int xm, int ym, int a, int b, uint16_t color );                // zeichnet eine Ellipse
+  void fillellipse(int xm, int ym, int a, int b, uint16_t color );            // zeichnet eine ausgefuellte Ellipse
+  void circle(int x, int y, int r, uint16_t color );                          // zeichnet einen Kreis
+  void fillcircle(int x, int y, int r, uint16_t color );                      // zeichnet einen ausgefuellten Kreis
+  void fillroundrect(int x1, int y1, int x2, int y2, int r, uint16_t color);  // zeichnet ein ausgefuelltes Rechteck mit runden Ecken
+  void filltriangle(int x0, int y0, int x1, int y1, int x2, int y2, uint16_t color);  // zeichnet ein ausgefuelltes Dreieck
+  void fillpoly(int anz, const int *pts, uint16_t color);                     // zeichnet ein ausgefuelltes Polygon
+  void showimage(uint16_t ox, uint16_t oy, const unsigned char* const image, uint16_t fwert);     // zeichnet ein monochromes Bitmap
+  void putstring(char *c);                                                    // schreibt einen Textstring auf das LCD
+  void turtle_moveto(int x, int y);
+  void turtle_lineto(int x, int y, uint16_t col);
+
+  // ---------------- Low-level Displayfunktionen -------------
+
+  void set_ram_address (uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2);  // setzt den zu beschreibenden Speicherbereich
+  void setcol(int startcol);                    // setzt zu beschreibende Spalte
+  void setpage(int startpage);                  // setzt zu beschreibende Reihe
+  void setxypos(int x, int y);                  // setzt die zu beschreibende Koordinate im Display-Ram
+
+  // ------------- Fensterausgabe (Burst-Transfer) ------------
+
+  void tft_window_begin(int x1, int y1, int x2, int y2);  // setzt ein Ausgabefenster (beruecksichtigt outmode)
+  void tft_push_pixels(const uint16_t *buf, int n);       // sendet n Farbwerte fortlaufend in das Fenster
+  void tft_push_color(uint16_t color, uint32_t n);        // sendet n mal denselben Farbwert in das Fenster
+  void tft_window_end(void);                              // beendet die Fensterausgabe
+
+  // ------------------ Kachelpuffer (Off-Screen) --------------
+
+  #if (tft_tilecache == 1)
+    void tft_tiles_enable(uint8_t on);                    // 1 : Ausgaben in den Kachelpuffer, 0 : direkt auf das Display
+    void tft_tiles_flush(void);                           // sendet die geaenderten Bereiche an das Display
+    void tft_tiles_invalidate(void);                      // verwirft den Kachelpuffer ohne zu senden
+  #endif
+
+  // ------------------------- Textkonsole ---------------------
+
+  #if (tft_console == 1)
+    void tft_con_init(uint8_t fg, uint8_t bg);            // Konsole fuer den aktuellen Font einrichten (EGA-Farben)
+    void tft_con_putchar(char ch);                        // Zeichen, Steuerzeichen, Escape-Sequenzen ausgeben
+    void tft_con_puts(char *s);                           // String ausgeben
+    int  tft_con_scrollback(int n);                       // n Zeilen zurueckblaettern, 0 : aktuelle Ausgabe
+    void tft_con_exit(void);                              // Scrollbereich zuruecksetzen, Display loeschen
+  #endif
+
+  // --------------------------- Sprites -----------------------
+
+  #if (tft_sprite == 1)
+    void tft_sprite_init(uint8_t nr, const uint16_t *img, uint16_t (*bkget)(int x, int y));  // Bild und Hintergrund zuweisen
+    void tft_sprite_show(uint8_t nr, int x, int y);       // Sprite an x,y zeichnen, ggf. von der alten Position verschieben
+    void tft_sprite_hide(uint8_t nr);                     // Hintergrund unter dem Sprite wiederherstellen
+  #endif
+
+  // --------------------- SPI-Funktionen ---------------------
+
+  void spi_init(void);
+  void spi_out(uint8_t data);
+  void wrcmd(uint8_t cmd);                      // schreibt einzelnes Kommandodatum (Registerzugriff)
+  void wrdata(uint8_t data);                    // schreibt einzelnen Registerwert oder Ramwert
+  void wrdata16(int data);                      // schreibt einen Integerwert
+
+  // ------------- DMA-Transfer (nur SPI-Displays) -------------
+
+  #if ((USE_SPI_TFT == 1) && (tft_dma == 1))
+    void tft_dma_fill(uint16_t color, uint32_t n);                            // sendet n mal color im Hintergrund
+    void tft_dma_pixels(const uint16_t *buf, uint32_t n, void (*callback)(void));  // sendet einen Puffer im Hintergrund
+    uint8_t tft_dma_busy(void);                                               // 1 : DMA-Transfer laeuft noch
+    void tft_dma_wait(void);                                                  // wartet auf das Ende des DMA-Transfers
+  #endif
+
+  /*  ------------------------------------------------------------
+                      EGA - Farbzuweisungen
+      ------------------------------------------------------------ */
+
+  #define black                   0
+  #define blue                    1
+  #define green                   2
+  #define cyan                    3
+  #define red                     4
+  #define magenta                 5
+  #define brown                   6
+  #define grey                    7
+  #define darkgrey                8
+  #define lightblue               9
+  #define lightgreen              10
+  #define lightcyan               11
+  #define lightred                12
+  #define lightmagenta            13
+  #define yellow                  14
+  #define white                   15
+
+  //-------------------------------------------------------------
+  // Registerzuordnung der Adressierungsregister der
+  // verschiedenen Displaycontroller
+  //-------------------------------------------------------------
+
+
+  #if  (ili9225 == 1)
+    #define coladdr      0x20
+    #define rowaddr      0x21
+    #define writereg     0x22
+  #else
+    #define coladdr      0x2a
+    #define rowaddr      0x2b
+    #define writereg     0x2c
+  #endif
+
+  //-------------------------------------------------------------
+  //  Variable Farben
+  //-------------------------------------------------------------
+
+  extern uint16_t textcolor;        // Beinhaltet die Farbwahl fuer die Vordergrundfarbe
+  extern uint16_t bkcolor;          // dto. fuer die Hintergrundfarbe
+  extern uint16_t egapalette [];    // Farbwerte der DOS EGA/VGA Farben
+
+
+  //-------------------------------------------------------------
+  //  Variable und Defines Schriftzeichen
+  //-------------------------------------------------------------
+
+  extern int aktxp;                 // Beinhaltet die aktuelle Position des Textcursors in X-Achse
+  extern int aktyp;                 // dto. fuer die Y-Achse
+  extern uint8_t outmode;           // Richtungssinn der Displayausgabe
+  extern uint8_t textsize;          // Skalierung der Ausgabeschriftgroesse
+  extern uint8_t fntfilled;         // gibt an, ob eine Zeichenausgabe ueber einen Hintergrund gelegt
+                                    // wird, oder ob es mit der Hintergrundfarbe aufgefuellt wird
+                                    // 1 = Hintergrundfarbe wird gesetzt, 0 = es wird nur das Fontbitmap
+                                    // gesetzt, der Hintergrund wird belassen
+
+  extern uint8_t fontnr;            // 0= 8x8 Pixel, 1, 12x16, 2= 5x7 Pixel
+  extern uint8_t fontsizex;
+  extern uint8_t fontsizey;
+
+  #define PSTR(txt)   ((char*)txt)  // uebergibt einen Zeiger auf einen Text (fuer outtextxy)
+
+  //-------------------------------------------------------------
+  //  Variable Turtle-Grafik
+  //-------------------------------------------------------------
+  extern int t_lastx, t_lasty;       // x,y - Positionen der letzten Zeichenaktion von moveto
+
+#endif
@@ -0,0 +1,452 @@
+/* -------------------------------------------------------
+                      tftcore_bench.cpp
+
+   Vergleich des C++ Kerns (include/tft_core.hpp) mit dem
+   C-Treiber (src/tftdisplay.c) auf dem PC.
+
+   Beide Treiber werden mit derselben Konfiguration (spi/
+   bzw. par/tftdisplay.h) uebersetzt und senden ueber die
+   Host-Nachbildung der libopencm3 (host/host_hal.c). Die
+   gesendeten Bytes werden mit D/C bzw. RS mitgeschnitten
+   und wie in einem Displaycontroller (Spalten-, Reihen-
+   adresse, Memory Write) in ein RGB565 Abbild geschrieben.
+
+   Fuer jede Ausgaberichtung (outmode 0..3) und jede Zei-
+   chenfunktion wird ausgegeben:
+
+     Bytes C / C++  : Anzahl Kommando- + Datenbytes auf dem
+                      Displaybus
+     Bild           : identisch, wenn beide Treiber dasselbe
+                      Abbild erzeugen
+     Zyklen C / C++ : Laufzeit des Treibers auf dem PC (TSC,
+                      Busfunktionen zaehlen nur), nicht die
+                      Laufzeit auf dem STM32!
+     Mock           : C++ Kern mit einem Mock-Bus, der je Byte
+                      nur in ein volatile "Datenregister"
+                      schreibt (entspricht einem inline
+                      Registerzugriff auf dem Controller)
+  -------------------------------------------------------- */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+extern "C" {
+  #include "tftdisplay.h"
+  #include "host_hal.h"
+}
+
+#include "tft_core.hpp"
+#include "font8x8.fnt"
+
+#if defined(__x86_64__) || defined(__i386__)
+  #include <x86intrin.h>
+  static inline uint64_t cycles(void) { return __rdtsc(); }
+#else
+  static inline uint64_t cycles(void)
+  {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+  }
+#endif
+
+/* -------------------------------------------------------
+               Displaycontroller - Nachbildung
+   ------------------------------------------------------- */
+
+struct lcdmodel
+{
+  uint16_t fb[_xres * _yres];
+  int      c1, c2, r1, r2;            // Fenster
+  int      cc, rr;                    // Schreibadresse
+  uint8_t  cmd, argi, args[4], hi, half;
+  uint32_t ncmd, ndata;
+
+  void reset()
+  {
+    memset(fb, 0, sizeof(fb));
+    c1 = 0; c2 = _xres-1; r1 = 0; r2 = _yres-1;
+    cc = rr = 0; cmd = 0; argi = 0; half = 0;
+    ncmd = ndata = 0;
+  }
+
+  void byte(bool dc, uint8_t b)
+  {
+    if (!dc)
+    {
+      ncmd++;
+      cmd = b; argi = 0;
+      if (cmd == writereg) { cc = c1; rr = r1; half = 0; }
+      return;
+    }
+    ndata++;
+    if ((cmd == coladdr) || (cmd == rowaddr))
+    {
+      if (argi < 4) args[argi] = b;
+      argi++;
+      int v = (args[(argi-1) & 2] << 8) | b;
+      if (argi == 2) { if (cmd == coladdr) c1 = v; else r1 = v; }
+      if (argi == 4) { if (cmd == coladdr) c2 = v; else r2 = v; }
+      return;
+    }
+    if (cmd != writereg) return;
+    if (!half) { hi = b; half = 1; return; }
+    half = 0;
+    if ((cc >= 0) && (cc < _xres) && (rr >= 0) && (rr < _yres))
+      fb[rr * _xres + cc] = (hi << 8) | b;
+    if (++cc > c2)
+    {
+      cc = c1;
+      if (++rr > r2) rr = r1;
+    }
+  }
+};
+
+static lcdmodel model;
+static uint32_t busbytes;             // Zaehler im Zeitmessbetrieb
+
+#if (USE_SPI_TFT == 1)
+
+  static uint32_t dc_port;
+  static uint16_t dc_mask;
+
+  // Port und Pin von D/C aus den Makros in tft_pindefs.h ermitteln
+  static void find_dc(void)
+  {
+    uint16_t a, b;
+
+    dc_clr();
+    a = host_port(GPIOA); b = host_port(GPIOB);
+    dc_set();
+    if (host_port(GPIOA) != a) { dc_port = GPIOA; dc_mask = host_port(GPIOA) ^ a; }
+                          else { dc_port = GPIOB; dc_mask = host_port(GPIOB) ^ b; }
+  }
+
+  static void spi_decode(uint32_t spi, uint16_t data)
+  {
+    (void)spi;
+    model.byte(host_port(dc_port) & dc_mask, data);
+  }
+
+  static void spi_count(uint32_t spi, uint16_t data)
+  {
+    (void)spi; (void)data;
+    busbytes++;
+  }
+
+  static void hooks_decode(void) { host_spi_hook = spi_decode; host_gpio_hook = NULL; }
+  static void hooks_count(void)  { host_spi_hook = spi_count;  host_gpio_hook = NULL; }
+  static const char *busname = "SPI1";
+
+#else
+
+  // WR (PA1) fallende Flanke: Datum von D0..D7 lesen
+  static uint8_t busbyte(void)
+  {
+    uint16_t a = host_port(GPIOA), b = host_port(GPIOB);
+    #if (boardversion == 0)
+      (void)a;
+      return ((b >> 12) & 0x03) | ((b >> 4) & 0xfc);
+    #else
+      return ((b >> 13) & 0x01) | ((b >> 6) & 0x02) | ((b << 1) & 0x04) | (b & 0x08) |
+             ((b >> 1) & 0x10) | ((b << 1) & 0x20) | ((a >> 9) & 0x40) | ((a >> 1) & 0x80);
+    #endif
+  }
+
+  #if (boardversion == 0)
+    #define rs_mask  GPIO2
+  #else
+    #define rs_mask  GPIO4
+  #endif
+
+  static void gpio_decode(uint32_t port, uint16_t oldval, uint16_t newval)
+  {
+    if ((port == GPIOA) && (oldval & GPIO1) && !(newval & GPIO1))
+      model.byte(newval & rs_mask, busbyte());
+  }
+
+  static void gpio_count(uint32_t port, uint16_t oldval, uint16_t newval)
+  {
+    if ((port == GPIOA) && (oldval & GPIO1) && !(newval & GPIO1)) busbytes++;
+  }
+
+  static void hooks_decode(void) { host_gpio_hook = gpio_decode; host_spi_hook = NULL; }
+  static void hooks_count(void)  { host_gpio_hook = gpio_count;  host_spi_hook = NULL; }
+  static const char *busname = "8-Bit GPIO";
+
+#endif
+
+/* -------------------------------------------------------
+     mock_bus
+
+     ideale Busanbindung: jedes Byte ein Schreibzugriff
+     auf ein "Datenregister"
+   ------------------------------------------------------- */
+
+static volatile uint8_t mock_dr;
+static uint32_t         mock_bytes;
+
+struct mock_bus
+{
+  static void init()                      { }
+  static void ready()                     { }
+  static inline void cmd(uint8_t c)       { mock_dr = c; mock_bytes++; }
+  static inline void datamode()           { }
+  static inline void put(uint8_t d)       { mock_dr = d; mock_bytes++; }
+  static inline void put16(uint16_t d)    { mock_dr = d >> 8; mock_dr = d; mock_bytes += 2; }
+  static inline void fill(uint16_t c, uint32_t n) { while (n--) put16(c); }
+  static void wait_ms(uint16_t ms)        { (void)ms; }
+};
+
+/* -------------------------------------------------------
+     Zeichenfunktionen beider Treiber mit gleicher
+     Schnittstelle
+   ------------------------------------------------------- */
+
+struct c_drv
+{
+  static void rot(int r)                                          { outmode = r; }
+  static void clr(uint16_t c)                                     { bkcolor = c; clrscr(); }
+  static void pixel(int x, int y, uint16_t c)                     { putpixel(x, y, c); }
+  static void rect(int x1, int y1, int x2, int y2, uint16_t c)    { fillrect(x1, y1, x2, y2, c); }
+  static void ln(int x1, int y1, int x2, int y2, uint16_t c)      { line(x1, y1, x2, y2, c); }
+  static void circ(int x, int y, int r, uint16_t c)               { circle(x, y, r, c); }
+  static void fcirc(int x, int y, int r, uint16_t c)              { fillcircle(x, y, r, c); }
+
+  static void glyph(int x, int y, uint8_t ch, uint16_t fg, uint16_t bg)
+  {
+    textcolor = fg; bkcolor = bg; aktxp = x; aktyp = y;
+    lcd_putchar8x8(ch);
+  }
+
+  static void blit(int x, int y, int w, int h, const uint16_t *buf)
+  {
+    tft_window_begin(x, y, x+w-1, y+h-1);
+    tft_push_pixels(buf, w*h);
+    tft_window_end();
+  }
+};
+
+template <class T>
+struct t_drv
+{
+  static void rot(int r)                                          { (void)r; }
+  static void clr(uint16_t c)                                     { T::clrscr(c); }
+  static void pixel(int x, int y, uint16_t c)                     { T::putpixel(x, y, c); }
+  static void rect(int x1, int y1, int x2, int y2, uint16_t c)    { T::fillrect(x1, y1, x2, y2, c); }
+  static void ln(int x1, int y1, int x2, int y2, uint16_t c)      { T::line(x1, y1, x2, y2, c); }
+  static void circ(int x, int y, int r, uint16_t c)               { T::circle(x, y, r, c); }
+  static void fcirc(int x, int y, int r, uint16_t c)              { T::fillcircle(x, y, r, c); }
+
+  static void glyph(int x, int y, uint8_t ch, uint16_t fg, uint16_t bg)
+  {
+    T::bitmap1(x, y, 8, 8, &font8x8[ch-32][0], fg, bg);
+  }
+
+  static void blit(int x, int y, int w, int h, const uint16_t *buf)
+  {
+    T::push_pixels(x, y, w, h, buf);
+  }
+};
+
+/* -------------------------------------------------------
+                         Lastprofile
+   ------------------------------------------------------- */
+
+struct rnd
+{
+  uint32_t s;
+  rnd(uint32_t seed) : s(seed) { }
+  int n(int max) { s = s * 1103515245u + 12345u; return (s >> 16) % max; }
+};
+
+static uint16_t blitbuf[32*24];
+
+template <class D> static void wl_clrscr(int w, int h)
+{
+  (void)w; (void)h;
+  for (int i = 0; i < 4; i++) D::clr(i * 0x1234);
+}
+
+template <class D> static void wl_putpixel(int w, int h)
+{
+  rnd r(1);
+  for (int i = 0; i < 4000; i++) D::pixel(r.n(w), r.n(h), r.n(0x10000));
+}
+
+template <class D> static void wl_fillrect(int w, int h)
+{
+  rnd r(2);
+  for (int i = 0; i < 300; i++)
+  {
+    int x = r.n(w), y = r.n(h);
+    D::rect(x, y, x + r.n(w-x), y + r.n(h-y), r.n(0x10000));
+  }
+}
+
+template <class D> static void wl_line(int w, int h)
+{
+  rnd r(3);
+  for (int i = 0; i < 300; i++)
+    D::ln(r.n(w), r.n(h), r.n(w), r.n(h), r.n(0x10000));
+  for (int i = 0; i < 100; i++)                     // achsparallel (Rahmen, Gitter)
+  {
+    int x = r.n(w), y = r.n(h);
+    D::ln(0, y, w-1, y, 0xffff);
+    D::ln(x, 0, x, h-1, 0x001f);
+  }
+}
+
+template <class D> static void wl_circle(int w, int h)
+{
+  rnd r(4);
+  int m = (w < h) ? w : h;
+  for (int i = 0; i < 100; i++)
+  {
+    int rad = 1 + r.n(m/2 - 1);
+    D::circ(rad + r.n(w - 2*rad), rad + r.n(h - 2*rad), rad, r.n(0x10000));
+  }
+}
+
+template <class D> static void wl_fillcircle(int w, int h)
+{
+  rnd r(5);
+  for (int i = 0; i < 100; i++)
+    D::fcirc(r.n(w), r.n(h), r.n(w/3), r.n(0x10000));
+}
+
+template <class D> static void wl_glyph(int w, int h)
+{
+  rnd r(6);
+  for (int y = 0; y+8 <= h; y += 8)
+    for (int x = 0; x+8 <= w; x += 8)
+      D::glyph(x, y, 32 + r.n(95), 0xffe0, 0x0010);
+}
+
+template <class D> static void wl_blit(int w, int h)
+{
+  rnd r(7);
+  for (int i = 0; i < 60; i++) D::blit(r.n(w-32), r.n(h-24), 32, 24, blitbuf);
+}
+
+struct workload
+{
+  const char *name;
+  void (*c)(int, int);
+  void (*t)(int, int);
+  void (*mock)(int, int);
+};
+
+/* -------------------------------------------------------
+     measure
+
+     fuehrt ein Lastprofil mehrfach aus, kleinste Anzahl
+     Zyklen
+   ------------------------------------------------------- */
+static uint64_t measure(void (*fn)(int, int), int w, int h)
+{
+  uint64_t best = ~(uint64_t)0, t;
+
+  for (int i = 0; i < 5; i++)
+  {
+    t = cycles();
+    fn(w, h);
+    t = cycles() - t;
+    if (t < best) best = t;
+  }
+  return best;
+}
+
+static uint16_t fb_c[_xres * _yres];
+static int      fails = 0;
+
+template <int R>
+static void run_rotation(void)
+{
+  typedef tftcore::cfg_display<R>                                          tft;
+  typedef tftcore::display<mock_bus, tftcore::cfg_ctrl, R, (mirror == 1)>  tftmock;
+  typedef c_drv                                                            dc;
+  typedef t_drv<tft>                                                       dt;
+  typedef t_drv<tftmock>                                                   dm;
+
+  const workload wl[] =
+  {
+    { "clrscr",     wl_clrscr<dc>,     wl_clrscr<dt>,     wl_clrscr<dm>     },
+    { "putpixel",   wl_putpixel<dc>,   wl_putpixel<dt>,   wl_putpixel<dm>   },
+    { "fillrect",   wl_fillrect<dc>,   wl_fillrect<dt>,   wl_fillrect<dm>   },
+    { "line",       wl_line<dc>,       wl_line<dt>,       wl_line<dm>       },
+    { "circle",     wl_circle<dc>,     wl_circle<dt>,     wl_circle<dm>     },
+    { "fillcircle", wl_fillcircle<dc>, wl_fillcircle<dt>, wl_fillcircle<dm> },
+    { "glyph 8x8",  wl_glyph<dc>,      wl_glyph<dt>,      wl_glyph<dm>      },
+    { "blit 32x24", wl_blit<dc>,       wl_blit<dt>,       wl_blit<dm>       },
+  };
+
+  int w = tft::width, h = tft::height;
+  uint32_t bc, bt;
+  uint64_t cc, ct, cm;
+  bool same;
+
+  outmode = R;
+  printf("\noutmode %d (%dx%d)\n", R, w, h);
+  printf("  %-12s %10s %10s %6s  %10s %10s %10s\n",
+         "Funktion", "Bytes C", "Bytes C++", "Bild", "Zyklen C", "Zyklen C++", "Mock");
+
+  for (unsigned i = 0; i < sizeof(wl) / sizeof(wl[0]); i++)
+  {
+    // Bytes und Abbild: beide Treiber beginnen mit geloeschtem Display
+    hooks_decode();
+    model.reset(); c_drv::clr(0);
+    model.reset(); wl[i].c(w, h);
+    bc = model.ncmd + model.ndata;
+    memcpy(fb_c, model.fb, sizeof(fb_c));
+
+    model.reset(); tft::clrscr(0);
+    model.reset(); wl[i].t(w, h);
+    bt = model.ncmd + model.ndata;
+    same = (memcmp(fb_c, model.fb, sizeof(fb_c)) == 0);
+    if (!same) fails++;
+
+    // Laufzeit: Busfunktionen zaehlen nur
+    hooks_count();
+    cc = measure(wl[i].c, w, h);
+    ct = measure(wl[i].t, w, h);
+    mock_bytes = 0;
+    tftmock::clrscr(0);
+    cm = measure(wl[i].mock, w, h);
+
+    printf("  %-12s %10u %10u %6s  %9uk %9uk %9uk\n", wl[i].name, bc, bt, same ? "ja" : "NEIN",
+           (unsigned)(cc / 1000), (unsigned)(ct / 1000), (unsigned)(cm / 1000));
+  }
+}
+
+int main(void)
+{
+  uint32_t bc, bt;
+
+  for (unsigned i = 0; i < sizeof(blitbuf) / sizeof(blitbuf[0]); i++) blitbuf[i] = i * 37;
+
+  fntfilled = 1; textsize = 0;
+  setfont(0);
+
+  #if (USE_SPI_TFT == 1)
+    find_dc();
+  #endif
+
+  hooks_decode();
+  host_reset(); model.reset(); lcd_init();
+  bc = model.ncmd + model.ndata;
+  host_reset(); model.reset(); tftcore::cfg_display<0>::init();
+  bt = model.ncmd + model.ndata;
+
+  printf("Bus: %s, Display %dx%d\n", busname, _xres, _yres);
+  printf("lcd_init: C %u Bytes, C++ %u Bytes\n", bc, bt);
+
+  run_rotation<0>();
+  run_rotation<1>();
+  run_rotation<2>();
+  run_rotation<3>();
+
+  if (fails) printf("\n%d Abweichungen im Abbild\n", fails);
+  return fails ? 1 : 0;
+}
@@ -0,0 +1,289 @@
+/* -------------------------------------------------------
+                       tiles_test.c
+
+   Kachelpuffer (tft_tiles.c) auf dem PC: Bytes je Frame
+   mit und ohne Kachelpuffer.
+
+   tftdisplay.c wird mit tft_tilecache 1 uebersetzt, jede
+   Animation laeuft zweimal: direkt auf das Display (Puffer
+   aus) und in den Kachelpuffer mit tft_tiles_flush am Ende
+   jedes Frames. Die Bytes auf dem SPI-Bus laufen mit D/C
+   in je eine Controller-Nachbildung (lcdemu). Nach jedem
+   Frame muessen beide Nachbildungen dasselbe Bild zeigen.
+
+   Animationen (je 40 Frames, vollstaendig im Display, fill-
+   rect und fillcircle der direkten Ausgabe beschneiden
+   nicht an den Displaygrenzen):
+
+     rechteck   : 20x20 Rechteck wandert schraeg ueber
+                  einfarbigen Hintergrund (loeschen mit
+                  fillrect in Hintergrundfarbe)
+     flaeche    : 40x40 Flaeche ueber 4 Kacheln wechselt
+                  die Farbe (Bereiche benachbarter Kacheln
+                  werden zusammengefasst)
+     ball       : fillcircle Radius 6 wandert schraeg
+     zaehler    : Text "Frame nnn" mit Hintergrund
+     felder     : Figur aus 6x6-Feldern im 7-Pixel-Raster
+                  wie game_tetris faellt Feld fuer Feld,
+                  die Zwischenraeume sind nie gezeichnet
+                  (unbekannt)
+
+   Jede Animation wird in allen Ausgaberichtungen (outmode
+   0..3) geprueft.
+
+   Aufruf:
+
+       tiles_test [ppm-verzeichnis]
+
+   schreibt zusaetzlich das letzte Bild jeder Animation
+   (Kachelpuffer, outmode 0) als <verzeichnis>/<name>.ppm.
+
+   Rueckgabewert 1, wenn sich ein Bild unterscheidet.
+  -------------------------------------------------------- */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "tftdisplay.h"
+#include "host_hal.h"
+#include "lcdemu.h"
+
+#define frame_anz      40
+
+static lcdemu_t  emu_dir, emu_kac;
+static lcdemu_t *emu;                         // Ziel der SPI-Bytes
+static uint32_t  dc_port;
+static uint16_t  dc_mask;
+
+// Port und Pin von D/C aus den Makros in tft_pindefs.h ermitteln
+static void find_dc(void)
+{
+  uint16_t a, b;
+
+  dc_clr();
+  a= host_port(GPIOA); b= host_port(GPIOB);
+  dc_set();
+  if (host_port(GPIOA) != a) { dc_port= GPIOA; dc_mask= host_port(GPIOA) ^ a; }
+                        else { dc_port= GPIOB; dc_mask= host_port(GPIOB) ^ b; }
+}
+
+static void spi_decode(uint32_t spi, uint16_t data)
+{
+  (void)spi;
+  lcdemu_byte(emu, (host_port(dc_port) & dc_mask) ? 1 : 0, data);
+}
+
+static uint32_t image_hash(const lcdemu_t *e)
+{
+  uint32_t h= 2166136261u;
+  uint16_t c;
+  int      x, y;
+
+  for (y= 0; y < e->h; y++)
+    for (x= 0; x < e->w; x++)
+    {
+      c= lcdemu_pixel(e, x, y);
+      h= (h ^ (c & 0xff)) * 16777619u;
+      h= (h ^ (c >> 8)) * 16777619u;
+    }
+  return h;
+}
+
+/* -------------------------------------------------------
+                        Animationen
+
+   vorbereiten zeichnet direkt auf das Display (der Inhalt
+   ist dem Kachelpuffer danach unbekannt), frame(i) zeich-
+   net Frame i
+   ------------------------------------------------------- */
+
+#define hg_farbe       rgbfromega(1)
+
+static void v_einfarbig(void)
+{
+  bkcolor= hg_farbe;
+  clrscr();
+}
+
+static void f_rechteck(int i)
+{
+  if (i) fillrect(2*(i-1), 3*(i-1)/2, 2*(i-1)+19, 3*(i-1)/2+19, hg_farbe);
+  fillrect(2*i, 3*i/2, 2*i+19, 3*i/2+19, rgbfromega(14));
+}
+
+static void f_flaeche(int i)
+{
+  fillrect(20, 20, 59, 59, rgbfromega(2 + (i % 12)));
+}
+
+static void f_ball(int i)
+{
+  if (i) fillcircle(10+2*(i-1), 10+2*(i-1), 6, hg_farbe);
+  fillcircle(10+2*i, 10+2*i, 6, rgbfromega(12));
+}
+
+static void f_zaehler(int i)
+{
+  char s[16];
+  int  n;
+
+  setfont(0);
+  fntfilled= 1;
+  textcolor= rgbfromega(15);
+  bkcolor= hg_farbe;
+  snprintf(s, sizeof(s), "Frame %3d", i * 7);
+  aktxp= 8; aktyp= 40;
+  for (n= 0; s[n]; n++) lcd_putchar(s[n]);
+}
+
+// Raster wie game_tetris: Feld 6x6 Pixel, Abstand 7 Pixel, Zwischenraum Hintergrund
+#define feld_x(fx)     (10 + (fx)*7)
+#define feld_y(fy)     (4 + (fy)*7)
+
+static void feld(int fx, int fy, uint16_t col)
+{
+  fillrect(feld_x(fx)+1, feld_y(fy)+1, feld_x(fx)+4, feld_y(fy)+4, col);
+  rectangle(feld_x(fx), feld_y(fy), feld_x(fx)+5, feld_y(fy)+5, col);
+}
+
+static void v_felder(void)
+{
+  int fx, fy;
+
+  bkcolor= rgbfromvalue(0x08, 0x08, 0x00);
+  clrscr();
+  for (fy= 0; fy < 15; fy++)
+    for (fx= 0; fx < 11; fx++) feld(fx, fy, 0);
+}
+
+// T-Figur, faellt ein Feld je Frame und beginnt nach 12 Feldern oben neu
+static void figur(int i, uint16_t col)
+{
+  int fx, fy;
+
+  fx= 2 + (i / 12) % 6;
+  fy= i % 12;
+  feld(fx, fy, col);
+  feld(fx+1, fy, col);
+  feld(fx+2, fy, col);
+  feld(fx+1, fy+1, col);
+}
+
+static void f_felder(int i)
+{
+  if (i) figur(i-1, 0);
+  figur(i, rgbfromega(13));
+}
+
+typedef struct
+{
+  const char *name;
+  void (*vorbereiten)(void);
+  void (*frame)(int i);
+} workload_t;
+
+static const workload_t workloads[] =
+{
+  { "rechteck",   v_einfarbig, f_rechteck },
+  { "flaeche",    v_einfarbig, f_flaeche  },
+  { "ball",       v_einfarbig, f_ball     },
+  { "zaehler",    v_einfarbig, f_zaehler  },
+  { "felder",     v_felder,    f_felder   },
+};
+
+#define workload_anz   (sizeof(workloads) / sizeof(workloads[0]))
+
+static uint32_t busbytes(const lcdemu_t *e)
+{
+  return e->ncmd + e->ndata;
+}
+
+static void zaehler_null(lcdemu_t *e)
+{
+  e->ncmd= 0; e->ndata= 0;
+  memset(e->nkl, 0, sizeof(e->nkl));
+}
+
+int main(int argc, char *argv[])
+{
+  char     fname[256];
+  uint32_t hash[frame_anz];
+  uint32_t i, b0, bd, bk, maxd, maxk, sumd= 0, sumk= 0;
+  int      om, f, gleich, fail= 0;
+  const char *ppmdir = (argc > 1) ? argv[1] : NULL;
+
+  host_reset();
+  find_dc();
+  host_spi_hook= spi_decode;
+
+  lcdemu_init_ctrl(&emu_dir, lcdemu_s6d02a1, _xres, _yres);
+  lcdemu_init_ctrl(&emu_kac, lcdemu_s6d02a1, _xres, _yres);
+  emu= &emu_dir; lcd_init();
+  emu= &emu_kac; lcd_init();
+
+  printf("\nKachelpuffer (%d Kacheln) gegen direkte Ausgabe, %d Frames je Animation\n",
+         tft_tilecount, frame_anz);
+  for (om= 0; om < 4; om++)
+  {
+    outmode= om;
+    printf("\noutmode %d\n", om);
+    printf("  %-10s %10s %10s %7s %9s %9s %9s %9s  %s\n", "Animation", "Bytes dir.", "Bytes Kach",
+           "Faktor", "B/Fr dir.", "B/Fr Kach", "max dir.", "max Kach", "Bild");
+    for (i= 0; i < workload_anz; i++)
+    {
+      // direkt, Pruefwert des Bildes nach jedem Frame
+      emu= &emu_dir;
+      workloads[i].vorbereiten();
+      zaehler_null(&emu_dir);
+      maxd= 0;
+      for (f= 0; f < frame_anz; f++)
+      {
+        b0= busbytes(&emu_dir);
+        workloads[i].frame(f);
+        if (busbytes(&emu_dir) - b0 > maxd) maxd= busbytes(&emu_dir) - b0;
+        hash[f]= image_hash(&emu_dir);
+      }
+
+      // Kachelpuffer, tft_tiles_flush am Ende jedes Frames
+      emu= &emu_kac;
+      workloads[i].vorbereiten();
+      zaehler_null(&emu_kac);
+      maxk= 0;
+      gleich= 1;
+      tft_tiles_enable(1);
+      for (f= 0; f < frame_anz; f++)
+      {
+        b0= busbytes(&emu_kac);
+        workloads[i].frame(f);
+        tft_tiles_flush();
+        if (busbytes(&emu_kac) - b0 > maxk) maxk= busbytes(&emu_kac) - b0;
+        if (image_hash(&emu_kac) != hash[f]) gleich= 0;
+      }
+      tft_tiles_enable(0);
+
+      bd= busbytes(&emu_dir);
+      bk= busbytes(&emu_kac);
+      sumd += bd; sumk += bk;
+      if (!gleich) fail= 1;
+
+      printf("  %-10s %10lu %10lu %7.1f %9lu %9lu %9lu %9lu  %s\n", workloads[i].name,
+             (unsigned long)bd, (unsigned long)bk, bk ? (double)bd / bk : 0.0,
+             (unsigned long)(bd / frame_anz), (unsigned long)(bk / frame_anz),
+             (unsigned long)maxd, (unsigned long)maxk, gleich ? "gleich" : "FEHLER");
+
+      if ((ppmdir) && (om == 0))
+      {
+        snprintf(fname, sizeof(fname), "%s/%s.ppm", ppmdir, workloads[i].name);
+        if (!lcdemu_write_ppm(&emu_kac, fname)) fail= 1;
+      }
+    }
+  }
+  outmode= 0;
+
+  printf("\nSumme: direkt %lu Bytes, Kachelpuffer %lu Bytes (Faktor %.1f)\n",
+         (unsigned long)sumd, (unsigned long)sumk, sumk ? (double)sumd / sumk : 0.0);
+
+  lcdemu_free(&emu_dir);
+  lcdemu_free(&emu_kac);
+  return fail;
+}
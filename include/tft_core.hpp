@@ -0,0 +1,894 @@
+/* -----------------------------------------------------------------------------------
+                                  tft_core.hpp
+
+     Header-only C++ Kern fuer farbige TFT-Displays
+
+     Bus (SPI1 oder 8-Bit Parallelbus), Displaycontroller (Initialisierungs-
+     sequenz aus tft_lcdseq.c, Adressregister, Offsets) und die Ausgabe-
+     richtung sind Templateparameter. Jede Zeichenfunktion wird damit fuer
+     genau eine Konfiguration uebersetzt: die Umrechnung der Koordinaten
+     (outmode, mirror) steht zur Compilezeit fest, die switch - Anweisungen
+     aus putpixel / tft_physxy in tftdisplay.c entfallen und die Bus-
+     zugriffe werden zu geradlinigen Transfers zusammengefasst.
+
+     Ein Rechteck (auch Bitmap oder Puffer) wird in jeder Ausgaberichtung
+     mit genau einem Fenster im Display-Ram gesendet, die Reihenfolge der
+     Farbwerte ergibt sich aus Schrittweiten, die ebenfalls zur Compile-
+     zeit feststehen.
+
+     Die erzeugten Bytefolgen entsprechen denen von tftdisplay.c (gleiche
+     Register, gleiche Farbreihenfolge), so dass beide Treiber auf dem-
+     selben Display nebeneinander benutzt werden koennen.
+
+     Verwendung (Konfiguration aus tftdisplay.h):
+
+       extern "C" {
+         #include "tftdisplay.h"
+       }
+       #include "tft_core.hpp"
+
+       typedef tftcore::cfg_display<1> tft;     // wie outmode= 1
+
+       tft::init();
+       tft::clrscr(0);
+       tft::fillrect(10,10, 50,30, 0xf800);
+
+     Ohne vorher eingebundenes tftdisplay.h stehen nur die Templates zur
+     Verfuegung, Bus und Controller sind dann selbst anzugeben
+     (z.B. mit einem Mock-Bus auf dem PC, siehe host/tftcore).
+
+     MCU   :  STM32F103
+     Takt  :  interner Takt 72 MHz
+   ----------------------------------------------------------------------------------- */
+
+#ifndef in_tft_core
+  #define in_tft_core
+
+  #include <stdint.h>
+
+namespace tftcore
+{
+
+  /* ------------------------------------------------------------------
+       controller
+
+       beschreibt einen Displaycontroller:
+
+         Seq      : Initialisierungssequenz im Format von tft_lcdseq.c
+                    (Anzahl Kommandos, dann je Kommando: Kommando,
+                    Anzahl Datenbytes (| delay_flag), Datenbytes,
+                    ggf. Wartezeit in ms, 255 = 500 ms)
+         Tail     : weitere Sequenz im selben Format, die nach Seq
+                    gesendet wird (0 = keine)
+         Xres,
+         Yres     : Aufloesung im Display-Ram
+         Coladdr,
+         Rowaddr,
+         Writereg : Adressregister (ili9225: 0x20, 0x21, 0x22)
+         Colofs,
+         Rowofs   : Offsets im Display-Ram (colofs, rowofs)
+         Rowbase  : wird zu jeder Zeilenadresse addiert (128 Pixel
+                    hohe Displays: 32 + _lcyofs)
+         Window   : 1 : Coladdr / Rowaddr setzen Start- und Endadresse
+                        (Fensterausgabe moeglich)
+                    0 : nur Startadresse (ili9225), Flaechen werden
+                        punktweise gezeichnet
+     ------------------------------------------------------------------ */
+
+  template <const uint8_t *Seq, int Xres, int Yres,
+            uint8_t Coladdr = 0x2a, uint8_t Rowaddr = 0x2b, uint8_t Writereg = 0x2c,
+            int Colofs = 0, int Rowofs = 0, int Rowbase = 0, bool Window = true,
+            const uint8_t *Tail = nullptr>
+  struct controller
+  {
+    enum
+    {
+      xres       = Xres,
+      yres       = Yres,
+      col_reg    = Coladdr,
+      row_reg    = Rowaddr,
+      ram_reg    = Writereg,
+      col_ofs    = Colofs,
+      row_ofs    = Rowofs,
+      row_base   = Rowbase,
+      has_window = Window
+    };
+
+    static const uint8_t *seq()  { return Seq; }
+    static const uint8_t *tail() { return Tail; }
+  };
+
+  /* ------------------------------------------------------------------
+       rotation
+
+       Umrechnung logischer Koordinaten in Spalte / Reihe des Display-
+       Rams, identisch zu putpixel / tft_physxy in tftdisplay.c:
+
+         Rot 0 :  col= x            row= y
+         Rot 1 :  col= y            row= Yres-1-x
+         Rot 2 :  col= Xres-1-y     row= x
+         Rot 3 :  col= Xres-1-x     row= Yres-1-y
+
+         Mirror:  col= Xres - col   (wie mirror == 1 in tftdisplay.c)
+
+       dxc, dyc : Aenderung der logischen Koordinate, wenn die Spalte
+                  im Display-Ram um eins weiter geht
+       dxr, dyr : dto. fuer die naechste Reihe
+     ------------------------------------------------------------------ */
+
+  template <int Rot, bool Mirror, int Xres, int Yres>
+  struct rotation
+  {
+    enum
+    {
+      width  = (Rot == 1 || Rot == 2) ? Yres : Xres,     // logische Breite
+      height = (Rot == 1 || Rot == 2) ? Xres : Yres,     // logische Hoehe
+
+      m   = Mirror ? -1 : 1,
+      dxc = (Rot == 0) ? m : (Rot == 3) ? -m : 0,
+      dyc = (Rot == 1) ? m : (Rot == 2) ? -m : 0,
+      dxr = (Rot == 1) ? -1 : (Rot == 2) ? 1 : 0,
+      dyr = (Rot == 0) ? 1 : (Rot == 3) ? -1 : 0
+    };
+
+    static inline int col(int x, int y)
+    {
+      int c = (Rot == 0) ? x : (Rot == 1) ? y : (Rot == 2) ? Xres-1-y : Xres-1-x;
+      return Mirror ? Xres - c : c;
+    }
+
+    static inline int row(int x, int y)
+    {
+      return (Rot == 0) ? y : (Rot == 1) ? Yres-1-x : (Rot == 2) ? x : Yres-1-y;
+    }
+
+    // Umkehrung: logische Koordinate einer Spalte / Reihe im Display-Ram
+    static inline int lx(int c, int r)
+    {
+      if (Mirror) c = Xres - c;
+      return (Rot == 0) ? c : (Rot == 1) ? Yres-1-r : (Rot == 2) ? r : Xres-1-c;
+    }
+
+    static inline int ly(int c, int r)
+    {
+      if (Mirror) c = Xres - c;
+      return (Rot == 0) ? r : (Rot == 1) ? c : (Rot == 2) ? Xres-1-c : Yres-1-r;
+    }
+  };
+
+  /* ------------------------------------------------------------------
+       display
+
+       Zeichenfunktionen fuer eine Kombination aus Bus, Controller
+       und Ausgaberichtung. Alle Funktionen sind statisch, es gibt
+       kein Objekt.
+
+       Ein Bus stellt bereit (alles static):
+
+         init()             : Pins / Peripherie einrichten, Reset
+         ready()            : nach der Initialisierungssequenz
+         cmd(c)             : Kommandobyte senden
+         datamode()         : D/C bzw. RS auf Daten schalten
+         put(d)             : Datenbyte senden (datamode gesetzt)
+         put16(d)           : 16 Bit, hoeherwertiges Byte zuerst
+         fill(color, n)     : datamode, dann n mal put16(color)
+         wait_ms(ms)        : Wartezeit
+     ------------------------------------------------------------------ */
+
+  template <class Bus, class Ctrl, int Rot = 0, bool Mirror = false>
+  class display
+  {
+    public:
+
+      typedef rotation<Rot, Mirror, Ctrl::xres, Ctrl::yres> rot;
+
+      enum { width = rot::width, height = rot::height };
+
+    private:
+
+      static uint8_t win_restore;     // 1 : Adressbereich des Controllers ist eingeschraenkt
+
+      /* ----------------------------------------------------------
+           sendseq
+
+           sendet eine Sequenz im Format von tft_lcdseq.c
+         ---------------------------------------------------------- */
+      static void sendseq(const uint8_t *tabseq)
+      {
+        uint8_t  cmd_anz, arg_anz;
+        uint16_t ms;
+
+        cmd_anz = *tabseq++;
+        while (cmd_anz--)
+        {
+          Bus::cmd(*tabseq++);
+          arg_anz = *tabseq++;
+          ms = arg_anz & 0x80;                              // delay_flag
+          arg_anz &= ~0x80;
+          if (arg_anz) Bus::datamode();
+          while (arg_anz--) Bus::put(*tabseq++);
+          if (ms)
+          {
+            ms = *tabseq++;
+            if (ms == 255) ms = 500;
+            Bus::wait_ms(ms);
+          }
+        }
+      }
+
+      // Start- und Endadresse fuer Spalte und Reihe (Display-Ram)
+      static inline void setwindow(int c1, int r1, int c2, int r2)
+      {
+        Bus::cmd(Ctrl::col_reg);
+        Bus::datamode();
+        Bus::put16(c1 + Ctrl::col_ofs);
+        Bus::put16(c2 + Ctrl::col_ofs);
+
+        Bus::cmd(Ctrl::row_reg);
+        Bus::datamode();
+        Bus::put16(r1 + Ctrl::row_base + Ctrl::row_ofs);
+        Bus::put16(r2 + Ctrl::row_base + Ctrl::row_ofs);
+      }
+
+      // Adressbereich wieder auf das gesamte Display (putpixel setzt nur Startadressen)
+      static void restore()
+      {
+        setwindow(0, 0, Ctrl::xres-1, Ctrl::yres-1);
+        win_restore = 0;
+      }
+
+      /* ----------------------------------------------------------
+           physwindow
+
+           setzt fuer das logische Rechteck x1,y1 .. x2,y2 (x1 <= x2,
+           y1 <= y2) das Fenster im Display-Ram und liefert dessen
+           linke obere Ecke zurueck
+         ---------------------------------------------------------- */
+      static inline void physwindow(int x1, int y1, int x2, int y2, int *c1, int *r1)
+      {
+        int ca = rot::col(x1, y1), cb = rot::col(x2, y2);
+        int ra = rot::row(x1, y1), rb = rot::row(x2, y2);
+
+        *c1 = (ca < cb) ? ca : cb;
+        *r1 = (ra < rb) ? ra : rb;
+        setwindow(*c1, *r1, (ca < cb) ? cb : ca, (ra < rb) ? rb : ra);
+        Bus::cmd(Ctrl::ram_reg);
+        win_restore = 1;
+      }
+
+      // beschneidet ein Rechteck auf den Displaybereich, 0 = nichts sichtbar
+      static inline bool clip(int &x1, int &y1, int &x2, int &y2)
+      {
+        int t;
+
+        if (x2 < x1) { t = x1; x1 = x2; x2 = t; }
+        if (y2 < y1) { t = y1; y1 = y2; y2 = t; }
+        if ((x2 < 0) || (y2 < 0) || (x1 >= width) || (y1 >= height)) return false;
+        if (x1 < 0) x1 = 0;
+        if (y1 < 0) y1 = 0;
+        if (x2 >= width)  x2 = width-1;
+        if (y2 >= height) y2 = height-1;
+        return true;
+      }
+
+    public:
+
+      /* ----------------------------------------------------------
+           init
+
+           initialisiert Bus und Display (Sequenz aus tft_lcdseq.c)
+         ---------------------------------------------------------- */
+      static void init()
+      {
+        Bus::init();
+        sendseq(Ctrl::seq());
+        if (Ctrl::tail()) sendseq(Ctrl::tail());
+        Bus::ready();
+        win_restore = 1;
+      }
+
+      /* ----------------------------------------------------------
+           putpixel
+
+           zeichnet einen Punkt (9 Bytes Adressierung + 2 Bytes
+           Farbe wie in tftdisplay.c). Wie dort wird nicht auf die
+           Displaygrenzen geprueft.
+         ---------------------------------------------------------- */
+      static inline void putpixel(int x, int y, uint16_t color)
+      {
+        if (win_restore) restore();
+
+        Bus::cmd(Ctrl::col_reg);
+        Bus::datamode();
+        Bus::put16(rot::col(x, y) + Ctrl::col_ofs);
+        Bus::cmd(Ctrl::row_reg);
+        Bus::datamode();
+        Bus::put16(rot::row(x, y) + Ctrl::row_base + Ctrl::row_ofs);
+        Bus::cmd(Ctrl::ram_reg);
+        Bus::datamode();
+        Bus::put16(color);
+      }
+
+      /* ----------------------------------------------------------
+           fillrect
+
+           fuellt ein Rechteck (beliebige Eckpunkte, wird auf den
+           Displaybereich beschnitten) mit einem Fenster und einem
+           fortlaufenden Farbtransfer
+         ---------------------------------------------------------- */
+      static void fillrect(int x1, int y1, int x2, int y2, uint16_t color)
+      {
+        int c1, r1, x, y;
+
+        if (!clip(x1, y1, x2, y2)) return;
+
+        if (!Ctrl::has_window)
+        {
+          for (y = y1; y <= y2; y++)
+            for (x = x1; x <= x2; x++) putpixel(x, y, color);
+          return;
+        }
+
+        physwindow(x1, y1, x2, y2, &c1, &r1);
+        Bus::fill(color, (uint32_t)(x2-x1+1) * (y2-y1+1));
+      }
+
+      static inline void fastxline(int x1, int y1, int x2, uint16_t color)
+      {
+        fillrect(x1, y1, x2, y1, color);
+      }
+
+      static inline void fastyline(int x1, int y1, int y2, uint16_t color)
+      {
+        fillrect(x1, y1, x1, y2, color);
+      }
+
+      /* ----------------------------------------------------------
+           clrscr
+
+           fuellt das gesamte Display. Das Fenster entspricht danach
+           wieder dem gesamten Display.
+         ---------------------------------------------------------- */
+      static void clrscr(uint16_t color)
+      {
+        if (!Ctrl::has_window)
+        {
+          fillrect(0, 0, width-1, height-1, color);
+          return;
+        }
+        setwindow(0, 0, Ctrl::xres-1, Ctrl::yres-1);
+        Bus::cmd(Ctrl::ram_reg);
+        Bus::fill(color, (uint32_t)Ctrl::xres * Ctrl::yres);
+        win_restore = 0;
+      }
+
+      /* ----------------------------------------------------------
+           line
+
+           Linienalgorithmus nach Bresenham (identische Punkte wie
+           line in tftdisplay.c). Zusammenhaengende waagrechte bzw.
+           senkrechte Strecken ab 4 Punkten werden als Fenster
+           gefuellt, kuerzere punktweise gezeichnet (ein Fenster
+           kostet 11 Bytes Adressierung, danach bei putpixel noch
+           einmal 10 Bytes fuer die Wiederherstellung).
+         ---------------------------------------------------------- */
+      static void line(int x0, int y0, int x1, int y1, uint16_t color)
+      {
+        int dx =  (x1 > x0) ? x1-x0 : x0-x1, sx = (x0 < x1) ? 1 : -1;
+        int dy = -((y1 > y0) ? y1-y0 : y0-y1), sy = (y0 < y1) ? 1 : -1;
+        int err = dx+dy, e2;
+        int rx = x0, ry = y0, n = 0;                      // aktuelle Strecke: Anfang, Laenge
+        bool horz = (dx >= -dy);
+
+        for (;;)
+        {
+          n++;
+          if ((x0 == x1) && (y0 == y1)) break;
+          e2 = 2*err;
+          bool stepx = (e2 > dy), stepy = (e2 < dx);
+          if (stepx) { err += dy; x0 += sx; }
+          if (stepy) { err += dx; y0 += sy; }
+
+          // Strecke endet, wenn die Nebenachse einen Schritt macht
+          if (horz ? stepy : stepx)
+          {
+            span(rx, ry, n, horz ? sx : 0, horz ? 0 : sy, color);
+            rx = x0; ry = y0; n = 0;
+          }
+        }
+        span(rx, ry, n, horz ? sx : 0, horz ? 0 : sy, color);
+      }
+
+      static void rectangle(int x1, int y1, int x2, int y2, uint16_t color)
+      {
+        fastxline(x1, y1, x2, color);
+        fastxline(x1, y2, x2, color);
+        fastyline(x1, y1, y2, color);
+        fastyline(x2, y1, y2, color);
+      }
+
+      /* ----------------------------------------------------------
+           ellipse, circle
+
+           Ellipsenalgorithmus nach Bresenham (identisch zu ellipse
+           in tftdisplay.c)
+         ---------------------------------------------------------- */
+      static void ellipse(int xm, int ym, int a, int b, uint16_t color)
+      {
+        int dx = 0, dy = b;
+        long a2 = (long)a*a, b2 = (long)b*b;
+        long err = b2-(2*b-1)*a2, e2;
+
+        do
+        {
+          putpixel(xm+dx, ym+dy, color);
+          putpixel(xm-dx, ym+dy, color);
+          putpixel(xm-dx, ym-dy, color);
+          putpixel(xm+dx, ym-dy, color);
+
+          e2 = 2*err;
+          if (e2 <  (2*dx+1)*b2) { dx++; err += (2*dx+1)*b2; }
+          if (e2 > -(2*dy-1)*a2) { dy--; err -= (2*dy-1)*a2; }
+        } while (dy >= 0);
+
+        while (dx++ < a)
+        {
+          putpixel(xm+dx, ym, color);
+          putpixel(xm-dx, ym, color);
+        }
+      }
+
+      static inline void circle(int x, int y, int r, uint16_t color)
+      {
+        ellipse(x, y, r, r, color);
+      }
+
+      /* ----------------------------------------------------------
+           fillcircle
+
+           Midpoint-Algorithmus, jede Zeile wird genau einmal als
+           Strecke gezeichnet (identisch zu fillcircle in
+           tftdisplay.c)
+         ---------------------------------------------------------- */
+      static void fillcircle(int x, int y, int r, uint16_t color)
+      {
+        int dx = 0, dy = r, d = 1-r;
+
+        while (dx <= dy)
+        {
+          fastxline(x-dy, y+dx, x+dy, color);
+          if (dx) fastxline(x-dy, y-dx, x+dy, color);
+          if (d < 0)
+          {
+            d += 2*dx+3;
+          }
+          else
+          {
+            if (dx != dy)
+            {
+              fastxline(x-dx, y+dy, x+dx, color);
+              fastxline(x-dx, y-dy, x+dx, color);
+            }
+            d += 2*(dx-dy)+5;
+            dy--;
+          }
+          dx++;
+        }
+      }
+
+      /* ----------------------------------------------------------
+           push_pixels
+
+           sendet einen Puffer mit w*h RGB565 Farbwerten (zeilen-
+           weise, logische Koordinaten) an die Position x,y. Das
+           Rechteck muss vollstaendig im Displaybereich liegen.
+         ---------------------------------------------------------- */
+      static void push_pixels(int x, int y, int w, int h, const uint16_t *buf)
+      {
+        int c1, r1, c, r, nc, nr;
+        const uint16_t *p;
+
+        if (!Ctrl::has_window)
+        {
+          for (r = 0; r < h; r++)
+            for (c = 0; c < w; c++) putpixel(x+c, y+r, *buf++);
+          return;
+        }
+
+        physwindow(x, y, x+w-1, y+h-1, &c1, &r1);
+        nc = (rot::dxc != 0) ? w : h;                     // Spalten im Display-Ram
+        nr = (rot::dxc != 0) ? h : w;
+        buf += (rot::ly(c1, r1) - y) * w + (rot::lx(c1, r1) - x);
+
+        Bus::datamode();
+        for (r = 0; r < nr; r++)
+        {
+          p = buf;
+          for (c = 0; c < nc; c++)
+          {
+            Bus::put16(*p);
+            p += rot::dyc * w + rot::dxc;
+          }
+          buf += rot::dyr * w + rot::dxr;
+        }
+      }
+
+      /* ----------------------------------------------------------
+           bitmap1
+
+           zeichnet ein monochromes Bitmap (w*h Punkte, jede Reihe
+           beginnt mit einem neuen Byte, Bit 7 = linker Punkt, wie
+           die Fonts font8x8 / font5x7) mit Vorder- und Hinter-
+           grundfarbe als ein Fenster, z.B. fuer Zeichen:
+
+             tft::bitmap1(x, y, 8, 8, &font8x8[ch-32][0], textcolor, bkcolor);
+         ---------------------------------------------------------- */
+      static void bitmap1(int x, int y, int w, int h, const uint8_t *bits,
+                          uint16_t fg, uint16_t bg)
+      {
+        int c1, r1, c, r, nc, nr, bx, by, px, py;
+        int bpr = (w+7) >> 3;
+
+        if (!Ctrl::has_window)
+        {
+          for (r = 0; r < h; r++)
+            for (c = 0; c < w; c++)
+              putpixel(x+c, y+r, (bits[r*bpr + (c >> 3)] & (0x80 >> (c & 7))) ? fg : bg);
+          return;
+        }
+
+        physwindow(x, y, x+w-1, y+h-1, &c1, &r1);
+        nc = (rot::dxc != 0) ? w : h;
+        nr = (rot::dxc != 0) ? h : w;
+        bx = rot::lx(c1, r1) - x;
+        by = rot::ly(c1, r1) - y;
+
+        Bus::datamode();
+        for (r = 0; r < nr; r++)
+        {
+          px = bx; py = by;
+          for (c = 0; c < nc; c++)
+          {
+            Bus::put16((bits[py*bpr + (px >> 3)] & (0x80 >> (px & 7))) ? fg : bg);
+            px += rot::dxc; py += rot::dyc;
+          }
+          bx += rot::dxr; by += rot::dyr;
+        }
+      }
+
+    private:
+
+      // n Punkte ab x,y in Richtung sx,sy (eine Achse ist 0)
+      static inline void span(int x, int y, int n, int sx, int sy, uint16_t color)
+      {
+        if (n < 4)
+        {
+          while (n--) { putpixel(x, y, color); x += sx; y += sy; }
+          return;
+        }
+        fillrect(x, y, x + (n-1)*sx, y + (n-1)*sy, color);
+      }
+  };
+
+  template <class Bus, class Ctrl, int Rot, bool Mirror>
+  uint8_t display<Bus, Ctrl, Rot, Mirror>::win_restore = 1;
+
+} // namespace tftcore
+
+
+/* -----------------------------------------------------------------------------------
+                      Busse fuer den STM32F103 (libopencm3)
+   ----------------------------------------------------------------------------------- */
+
+#if defined(in_libopen)
+
+namespace tftcore
+{
+
+  /* ------------------------------------------------------------------
+       spi1_bus
+
+       SPI1 (PA5 = SCK, PA7 = MOSI) wie spi_init / wrcmd / wrdata in
+       tftdisplay.c. Pins ist eine Klasse mit den Funktionen
+
+         init()                 : Pins als Ausgang
+         cmdmode(), datamode()  : D/C - Pin
+         select(), deselect()   : CE - Pin
+         reset_on(), reset_off(): RST - Pin
+
+       sowie den Konstanten wait (nop nach jedem Byte) und cmdpulse
+       (CE-Impuls nach jedem Kommando, ili9225).
+     ------------------------------------------------------------------ */
+
+  template <class Pins>
+  struct spi1_bus
+  {
+    static void init()
+    {
+      rcc_periph_clock_enable(RCC_SPI1);
+      ::delay(100);
+
+      gpio_set_mode(GPIOA, GPIO_MODE_OUTPUT_50_MHZ, GPIO_CNF_OUTPUT_ALTFN_PUSHPULL, GPIO4 | GPIO5 | GPIO7);
+      gpio_set_mode(GPIOA, GPIO_MODE_INPUT, GPIO_CNF_INPUT_FLOAT, GPIO6);
+
+      spi_reset(SPI1);
+      spi_init_master(SPI1, SPI_CR1_BAUDRATE_FPCLK_DIV_2, SPI_CR1_CPOL_CLK_TO_0_WHEN_IDLE,
+                      SPI_CR1_CPHA_CLK_TRANSITION_1, SPI_CR1_DFF_8BIT, SPI_CR1_MSBFIRST);
+      spi_enable_software_slave_management(SPI1);
+      spi_set_nss_high(SPI1);
+      spi_enable(SPI1);
+
+      Pins::init();
+      Pins::reset_on();
+      ::delay(2);
+      Pins::reset_off();
+    }
+
+    static inline void ready()   { Pins::select(); }
+
+    static inline void out(uint8_t b)
+    {
+      spi_send(SPI1, b);
+      if (Pins::wait) __asm volatile("nop");
+    }
+
+    static inline void cmd(uint8_t c)
+    {
+      Pins::cmdmode();
+      out(c);
+      if (Pins::cmdpulse) { Pins::deselect(); Pins::select(); }
+    }
+
+    static inline void datamode()          { Pins::datamode(); }
+    static inline void put(uint8_t d)      { out(d); }
+    static inline void put16(uint16_t d)   { out(d >> 8); out(d & 0xff); }
+
+    static inline void fill(uint16_t color, uint32_t n)
+    {
+      datamode();
+      while (n--) put16(color);
+    }
+
+    static inline void wait_ms(uint16_t ms) { ::delay(ms); }
+  };
+
+  /* ------------------------------------------------------------------
+       gpio8_bus
+
+       8-Bit Parallelbus wie byteout / lcd_bus_write in tftdisplay.c,
+       Board = boardversion (0: Nucleo R3, 1: eigenes Board R3)
+     ------------------------------------------------------------------ */
+
+  template <int Board> struct gpio8_pins;
+
+  template <> struct gpio8_pins<0>
+  {
+    // D0..D7 = PB12, PB13, PB6..PB11; RD= PA0, WR= PA1, RS= PA2, CS= PA3, RST= PB0
+    enum { pin_wr = GPIO1, pin_rs = GPIO2, pin_rd = GPIO0 };
+
+    static inline void init()
+    {
+      gpio_set_mode(GPIOB, GPIO_MODE_OUTPUT_50_MHZ, GPIO_CNF_OUTPUT_PUSHPULL,
+                    GPIO0 | GPIO6 | GPIO7 | GPIO8 | GPIO9 | GPIO10 | GPIO11 | GPIO12 | GPIO13);
+      gpio_set_mode(GPIOA, GPIO_MODE_OUTPUT_50_MHZ, GPIO_CNF_OUTPUT_PUSHPULL, GPIO0 | GPIO1 | GPIO2 | GPIO3);
+    }
+
+    static inline void select()    { gpio_clear(GPIOA, GPIO3); }
+    static inline void deselect()  { gpio_set(GPIOA, GPIO3); }
+    static inline void reset_on()  { gpio_clear(GPIOB, GPIO0); }
+    static inline void reset_off() { gpio_set(GPIOB, GPIO0); }
+
+    static inline void byteout(uint8_t val)
+    {
+      gpio_port_write(GPIOB, ((val & 0xfc) << 4) | ((val & 0x03) << 12) | 1);   // Reset auf 1 belassen
+    }
+
+    // BSRR-Worte fuer fill, alle Datenpins liegen auf GPIOB
+    enum { has_porta = 0 };
+    static inline uint32_t bsrr_b(uint8_t v) { return 0x3fc00000 | ((v & 0xfc) << 4) | ((v & 0x03) << 12); }
+    static inline uint32_t bsrr_a(uint8_t v) { (void)v; return 0; }
+  };
+
+  template <> struct gpio8_pins<1>
+  {
+    // D0..D7 = PB13, PB7, PB1, PB3, PB5, PB4, PA15, PA8; RD= PA0, WR= PA1, RS= PA4, CS= PB0, RST= PB8
+    enum { pin_wr = GPIO1, pin_rs = GPIO4, pin_rd = GPIO0 };
+
+    static inline void init()
+    {
+      gpio_set_mode(GPIOB, GPIO_MODE_OUTPUT_50_MHZ, GPIO_CNF_OUTPUT_PUSHPULL,
+                    GPIO0 | GPIO1 | GPIO3 | GPIO4 | GPIO5 | GPIO7 | GPIO8 | GPIO13);
+      gpio_set_mode(GPIOA, GPIO_MODE_OUTPUT_50_MHZ, GPIO_CNF_OUTPUT_PUSHPULL,
+                    GPIO0 | GPIO1 | GPIO4 | GPIO8 | GPIO15);
+    }
+
+    static inline void select()    { gpio_clear(GPIOB, GPIO0); }
+    static inline void deselect()  { gpio_set(GPIOB, GPIO0); }
+    static inline void reset_on()  { gpio_clear(GPIOB, GPIO8); }
+    static inline void reset_off() { gpio_set(GPIOB, GPIO8); }
+
+    static inline void byteout(uint8_t val)
+    {
+      GPIO_BSRR(GPIOB) = bsrr_b(val);
+      GPIO_BSRR(GPIOA) = bsrr_a(val);
+    }
+
+    // BSRR-Worte fuer byteout und fill: Resetbits aller Datenpins des Ports
+    // im oberen, zu setzende Pins im unteren Halbwort (Set hat Vorrang)
+    enum { has_porta = 1 };
+    static inline uint32_t bsrr_b(uint8_t v)
+    {
+      return 0x20ba0000 | ((v & 0x01) << 13) | ((v & 0x02) << 6) | ((v & 0x04) >> 1) |
+             (v & 0x08) | ((v & 0x10) << 1) | ((v & 0x20) >> 1);
+    }
+    static inline uint32_t bsrr_a(uint8_t v) { return 0x81000000 | ((v & 0x40) << 9) | ((v & 0x80) << 1); }
+  };
+
+  template <int Board>
+  struct gpio8_bus
+  {
+    typedef gpio8_pins<Board> pins;
+
+    static void init()
+    {
+      pins::init();
+
+      gpio_set(GPIOA, pins::pin_rd | pins::pin_wr | pins::pin_rs);
+      pins::deselect();
+      pins::reset_off();
+
+      ::delay(5);                                       // Display reset
+      pins::reset_on();
+      ::delay(15);
+      pins::reset_off();
+      ::delay(15);
+
+      pins::select();
+    }
+
+    static inline void ready()   { }
+
+    static inline void strobe()                         // WR-Taktimpuls
+    {
+      GPIO_BRR(GPIOA) = pins::pin_wr;
+      GPIO_BSRR(GPIOA) = pins::pin_wr;
+    }
+
+    static inline void write(uint8_t val)
+    {
+      pins::byteout(val);
+      strobe();
+    }
+
+    static inline void cmd(uint8_t c)
+    {
+      gpio_clear(GPIOA, pins::pin_rs);
+      write(c);
+    }
+
+    static inline void datamode()          { gpio_set(GPIOA, pins::pin_rs); }
+    static inline void put(uint8_t d)      { write(d); }
+    static inline void put16(uint16_t d)   { write(d >> 8); write(d & 0xff); }
+
+    /* --------------------------------------------------------
+         fill wie lcd_bus_fill in tftdisplay.c (tft_fastfill):
+         die BSRR-Worte fuer High- und Lowbyte werden einmal
+         berechnet. Sind beide Bytes gleich, wird das Byte
+         einmal angelegt und danach nur noch WR getaktet, sind
+         D6/D7 (GPIOA) gleich, genuegt je Byte ein Zugriff auf
+         GPIOB.
+       -------------------------------------------------------- */
+    static inline void fill(uint16_t color, uint32_t n)
+    {
+      uint8_t  hi = color >> 8, lo = color & 0xff;
+      uint32_t hb = pins::bsrr_b(hi), lb = pins::bsrr_b(lo);
+      uint32_t ha = pins::bsrr_a(hi), la = pins::bsrr_a(lo);
+
+      datamode();
+      if (!n) return;
+
+      GPIO_BSRR(GPIOB) = hb;
+      if (pins::has_porta)
+      {
+        GPIO_BSRR(GPIOA) = ha;
+        if (ha != la)
+        {
+          while (n--)
+          {
+            GPIO_BSRR(GPIOB) = hb; GPIO_BSRR(GPIOA) = ha; strobe();
+            GPIO_BSRR(GPIOB) = lb; GPIO_BSRR(GPIOA) = la; strobe();
+          }
+          return;
+        }
+      }
+
+      if (hi == lo)
+      {
+        n <<= 1;
+        while (n--) strobe();
+        return;
+      }
+
+      while (n--)
+      {
+        GPIO_BSRR(GPIOB) = hb; strobe();
+        GPIO_BSRR(GPIOB) = lb; strobe();
+      }
+    }
+
+    static inline void wait_ms(uint16_t ms) { ::delay(ms); }
+  };
+
+} // namespace tftcore
+
+#endif // in_libopen
+
+
+/* -----------------------------------------------------------------------------------
+             Konfiguration aus tftdisplay.h (falls vorher eingebunden)
+
+     cfg_display<Rot> ist der Treiber fuer das in tftdisplay.h ausgewaehlte
+     Display, Rot entspricht outmode.
+   ----------------------------------------------------------------------------------- */
+
+#if defined(in_tftdisplay_module)
+
+  #include "../src/tft_lcdseq.c"
+
+namespace tftcore
+{
+
+  #if (USE_SPI_TFT == 1)
+
+    // Anschlusspins aus tft_pindefs.h (dc_set, ce_clr ... sind dort Makros)
+    struct cfg_pins
+    {
+      enum { wait = ((ili9225 == 1) || (tft_wait == 1)), cmdpulse = (ili9225 == 1) };
+
+      static inline void init()      { lcd_pin_init(); }
+      static inline void cmdmode()   { dc_clr(); }
+      static inline void datamode()  { dc_set(); }
+      static inline void select()    { ce_clr(); }
+      static inline void deselect()  { ce_set(); }
+      static inline void reset_on()  { rst_clr(); }
+      static inline void reset_off() { rst_set(); }
+    };
+
+    typedef spi1_bus<cfg_pins> cfg_bus;
+
+    #if (_yres == 128)
+      enum { cfg_rowbase = 32 + _lcyofs };
+    #else
+      enum { cfg_rowbase = 0 };
+    #endif
+
+    typedef controller<lcdinit_seq, _xres, _yres, coladdr, rowaddr, writereg,
+                       colofs, rowofs, cfg_rowbase, (ili9225 == 0)> cfg_ctrl;
+
+  #endif
+
+  #if (USE_8BIT_TFT == 1)
+
+    // wie lcd_init in tftdisplay.c: Farben normal, Ausgaberichtung 0
+    static const uint8_t cfg_tailseq[] =
+    {
+      2,
+      0x20, 0,
+      0x36, 1, (1 << MEM_X) | (1 << MEM_BGR)
+    };
+
+    typedef gpio8_bus<boardversion> cfg_bus;
+
+    typedef controller<lcdinit_seq, _xres, _yres, coladdr, rowaddr, writereg,
+                       colofs, rowofs, 0, true, cfg_tailseq> cfg_ctrl;
+
+  #endif
+
+  template <int Rot>
+  using cfg_display = display<cfg_bus, cfg_ctrl, Rot, (mirror == 1)>;
+
+} // namespace tftcore
+
+#endif // in_tftdisplay_module
+
+#endif
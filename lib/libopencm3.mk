@@ -37,7 +37,7 @@ ifeq ($(LSCRIPT),)
 	LSCRIPT   := stm32f103c8.ld
 endif
 
-.PHONY: all lib size flash list clean cleanlib
+.PHONY: all lib size flash list host clean cleanlib
 
 all: clean $(PROJECT).elf size
 
@@ -73,6 +73,11 @@ endif
 
 # serieller Bootloader mit Aktivierung ueber Reset-Controller (ATtiny13)
 # RTS Leitung pulst 3 mal zum Aktivieren des Bootloadermodus
+# ELFFLASH=1 : die .elf Datei statt der .bin Datei flashen, es werden nur
+#              die belegten Bereiche geschrieben (Luecken im Image werden
+#              weder geloescht noch uebertragen). Benoetigt das stm32flash_rts
+#              aus diesem Repository (stm32flash_rts/, neu uebersetzen und
+#              installieren), aeltere Versionen kennen kein ELF
 
 ifeq ($(FLASHERPROG), 1)
 
@@ -81,8 +86,12 @@ ifeq ($(CH340RESET), 1)
 	@sleep 1
 endif
 
+ifeq ($(ELFFLASH), 1)
+	stm32flash_rts -b 230400 -w $(PROJECT).elf -g 0 $(PROGPORT)
+else
 	stm32flash_rts -b 230400 -w $< -g 0 $(PROGPORT)
 endif
+endif
 
 ####################################################################
 
@@ -109,6 +118,22 @@ endif
 
 ####################################################################
 
+# Uebersetzen fuer den PC (Linux): host/libopencm3.h und host/host_hal.c
+# ersetzen die libopencm3. SPI-, I2C-, GPIO- und UART-Zugriffe, Systick und
+# Timerinterrupts laufen in einer virtuellen Zeit und koennen mitge-
+# schnitten werden (siehe host/readme.txt)
+
+HOSTDIR    ?= ../host
+HOSTCC     ?= gcc
+HOSTCFLAGS  = -std=gnu99 -Wall -Os -g -I$(HOSTDIR) $(INC_DIR)
+
+host: $(PROJECT)_host
+
+$(PROJECT)_host: $(PROJECT).c $(SRCS:.o=.c) $(HOSTDIR)/host_hal.c $(HOSTDIR)/host_hal.h $(HOSTDIR)/libopencm3.h
+	$(HOSTCC) $(HOSTCFLAGS) -o $@ $(filter %.c,$^) -lm
+
+####################################################################
+
 
 clean:
 	rm -f *.bin
@@ -116,6 +141,7 @@ clean:
 	rm -f *.elf
 	rm -f *.list
 	rm -f ../src/*.o
+	rm -f $(PROJECT)_host
 
 cleanlib: clean
 	rm -f $(LIBOPENCM3DIR)/lib/stm32/f1/*.d
@@ -11,12 +11,15 @@
 
      hinzugelinkt werden, die die Ausgabe eines farbigen
      Punktes im RGB565-Format vornimmt (5 Bit fuer rot,
-     6 Bit fuer gruen, 5 Bit fuer blau)
+     6 Bit fuer gruen, 5 Bit fuer blau) sowie die Fenster-
+     ausgabe tft_window_begin / tft_push_pixels /
+     tft_push_color / tft_window_end
 
      Verfuegbare Formate sind:
 
        PCX 256 Farben
        BMP s/w, 4, 16, 256 Farben
+       LZ256 (komprimiert, image2c -z)
 
      MCU   :  AVR / STM32 / STM8
 
@@ -25,6 +28,120 @@
 
 #include "gfx_pictures.h"
 
+/* ----------------------------------------------------------
+     Ausgabe-Pipeline
+
+     Alle Formate werden zeilenweise dekodiert:
+
+       Dekoder -> Palette -> Zeilenpuffer -> Fenster (Burst)
+
+     Die Pixel einer Zeile werden nach der Palettenumsetzung
+     im Zeilenpuffer gesammelt und blockweise (gfx_bufsize)
+     in das mit tft_window_begin gesetzte Fenster geschrieben.
+     Es wird nur der sichtbare Ausschnitt (Quellrechteck,
+     siehe gfx_srcrect) dekodiert bzw. ausgegeben.
+   ---------------------------------------------------------- */
+static uint16_t gfx_buf[gfx_bufsize];
+static uint8_t  gfx_bufcnt = 0;
+
+static int gfx_srcx = 0, gfx_srcy = 0;         // Quellrechteck (gfx_srcw == 0 : ganzes Bild)
+static int gfx_srcw = 0, gfx_srch = 0;
+
+static int gfx_cx1, gfx_cy1, gfx_cx2, gfx_cy2; // auszugebender Bereich in Bildkoordinaten
+static int gfx_dx, gfx_dy;                     // Displaykoordinate des Bildpunktes gfx_cx1/gfx_cy1
+
+static void gfx_flush(void)
+{
+  if (gfx_bufcnt) tft_push_pixels(&gfx_buf[0], gfx_bufcnt);
+  gfx_bufcnt= 0;
+}
+
+static void gfx_put(uint16_t color)
+{
+  gfx_buf[gfx_bufcnt++]= color;
+  if (gfx_bufcnt == gfx_bufsize) gfx_flush();
+}
+
+/* ----------------------------------------------------------
+     gfx_srcrect
+
+     legt fuer alle folgenden Bildausgaben einen Ausschnitt
+     der Quellgrafik fest (z.B. ein einzelnes Sprite aus
+     einem Spritesheet). Der Bildpunkt x,y des Ausschnitts
+     wird an der bei der Ausgabe angegebenen Koordinate
+     gezeichnet.
+
+       x,y   : linke obere Ecke des Ausschnitts in der Grafik
+       w,h   : Breite, Hoehe des Ausschnitts
+               w == 0 : gesamte Grafik ausgeben (Standard)
+
+     Beispiel (3. Sprite eines Sheets mit 16x16 Sprites):
+
+       gfx_srcrect(32, 0, 16, 16);
+       bmp256_show(50, 60, &sheet[0], &sheetpal[0]);
+       gfx_srcrect(0, 0, 0, 0);
+   ---------------------------------------------------------- */
+void gfx_srcrect(int x, int y, int w, int h)
+{
+  gfx_srcx= x; gfx_srcy= y;
+  gfx_srcw= w; gfx_srch= h;
+}
+
+/* ----------------------------------------------------------
+     gfx_clip
+
+     berechnet den auszugebenden Bereich einer Grafik der
+     Groesse w x h aus Quellrechteck und Bildgrenzen.
+     Bildpunkte, die links oder oberhalb des Displays
+     (negative Koordinaten) laegen, werden abgeschnitten.
+
+       ox,oy : Displaykoordinate der linken oberen Ecke
+               des Quellrechtecks
+
+     Rueckgabe: 0 = nichts sichtbar
+   ---------------------------------------------------------- */
+static uint8_t gfx_clip(int ox, int oy, int w, int h)
+{
+  int sx, sy;
+
+  if (gfx_srcw)
+  {
+    sx= gfx_srcx; sy= gfx_srcy;
+    gfx_cx2= sx + gfx_srcw - 1;
+    gfx_cy2= sy + gfx_srch - 1;
+  }
+  else
+  {
+    sx= 0; sy= 0;
+    gfx_cx2= w - 1;
+    gfx_cy2= h - 1;
+  }
+  gfx_cx1= sx; gfx_cy1= sy;
+
+  if (gfx_cx1 < 0) gfx_cx1= 0;
+  if (gfx_cy1 < 0) gfx_cy1= 0;
+  if (gfx_cx2 > w-1) gfx_cx2= w-1;
+  if (gfx_cy2 > h-1) gfx_cy2= h-1;
+  if (ox + gfx_cx1 - sx < 0) gfx_cx1= sx - ox;
+  if (oy + gfx_cy1 - sy < 0) gfx_cy1= sy - oy;
+
+  gfx_dx= ox + gfx_cx1 - sx;
+  gfx_dy= oy + gfx_cy1 - sy;
+
+  return ((gfx_cx1 <= gfx_cx2) && (gfx_cy1 <= gfx_cy2));
+}
+
+/* ----------------------------------------------------------
+     gfx_window
+
+     setzt das Fenster fuer den mit gfx_clip berechneten
+     Bereich
+   ---------------------------------------------------------- */
+static void gfx_window(void)
+{
+  tft_window_begin(gfx_dx, gfx_dy, gfx_dx + gfx_cx2 - gfx_cx1, gfx_dy + gfx_cy2 - gfx_cy1);
+}
+
 /* ----------------------------------------------------------
    bmpsw_show
 
@@ -56,24 +173,37 @@
    ---------------------------------------------------------- */
 void bmpsw_show(uint16_t ox, uint16_t oy, const unsigned char* const image, uint16_t fwert)
 {
-  int      x,y;
-  uint8_t  b,bp;
-  uint16_t resX, resY;
+  int      x, y, xs= 0, run;
+  uint16_t resX, resY, bpl;
 
   resX= (readarray(image,0) << 8) + readarray(image,1);
   resY= (readarray(image,2) << 8) + readarray(image,3);
 
-  if ((resX % 8) == 0) { resX= resX / 8; }
-                 else  { resX= (resX / 8)+1; }
+  bpl= (resX + 7) / 8;                                 // Bytes pro Zeile
 
-  for (y=0;y< resY;y++)
+  if (!gfx_clip(ox, (int)oy-4, bpl*8, resY)) return;
+
+  // gesetzte Pixel einer Reihe werden zusammengefasst und jeweils
+  // als ein Fenster ausgegeben (nicht gesetzte Pixel sind transparent)
+  for (y= gfx_cy1; y <= gfx_cy2; y++)
   {
-    for (x= 0;x<resX;x++)
+    run= 0;
+    for (x= gfx_cx1; x <= gfx_cx2+1; x++)
     {
-      b= readarray(image, y *resX + x + 4);
-      for (bp=8; bp>0; bp--)
+      if ((x <= gfx_cx2) && (readarray(image, y*bpl + (x >> 3) + 4) & (0x80 >> (x & 7))))
       {
-        if (b & (1 << (bp-1))) {putpixel(ox+(x*8)+8-bp, oy+y-4,fwert);}
+        if (!run) xs= x;
+        run++;
+      }
+      else
+      {
+        if (run)
+        {
+          tft_window_begin(gfx_dx+xs-gfx_cx1, gfx_dy+y-gfx_cy1, gfx_dx+xs-gfx_cx1+run-1, gfx_dy+y-gfx_cy1);
+          tft_push_color(fwert, run);
+          tft_window_end();
+        }
+        run= 0;
       }
     }
   }
@@ -96,42 +226,26 @@ void bmpsw_show(uint16_t ox, uint16_t oy, const unsigned char* const image, uint
    -------------------------------------------------------- */
 void bmpcga_show(int ox, int oy, const uint8_t* const image, const uint16_t* const pal)
 {
-  int16_t  x, y;
-  uint16_t  width, height;
-  uint16_t  ptr;
-  uint8_t   pixpos, fb, cvalue;
-  uint16_t  cgacolor;
-
+  int       x, y;
+  uint16_t  width, height, bpl;
+  uint32_t  ptr;
 
   width= (readarray(image,0) << 8) + readarray(image,1);
   height= (readarray(image, 2) << 8) + readarray(image,3);
 
-  ptr= 4;
-  y= height;
+  bpl= (width + 3) / 4;                                // 4 Pixel je Byte
 
-  for (y= 0; y < height; y++)
-  {
-    for (x= 0; x < width; x++)
-    {
-      if ((x % 4)== 0)
-      {
-        fb= readarray(image,ptr);
-        ptr++;
-      }
-      pixpos=  (3-(x % 4))*2;
+  if (!gfx_clip(ox, oy-1, width, height)) return;
 
-      cvalue= (fb >> pixpos) & 0x03;
-      switch (cvalue)
-      {
-        case 00 : cgacolor= *pal;  break;
-        case 01 : cgacolor= *(pal+1);  break;
-        case 02 : cgacolor= *(pal+2);  break;
-        case 03 : cgacolor= *(pal+3);  break;
-        default : break;
-      }
-      putpixel(x+ox, y+oy-1, cgacolor);
-    }
+  gfx_window();
+  for (y= gfx_cy1; y <= gfx_cy2; y++)
+  {
+    ptr= 4 + (uint32_t)y*bpl;
+    for (x= gfx_cx1; x <= gfx_cx2; x++)
+      gfx_put(readwarray(pal, (readarray(image, ptr + (x >> 2)) >> ((3-(x & 3))*2)) & 0x03));
   }
+  gfx_flush();
+  tft_window_end();
 }
 
 /* --------------------------------------------------------
@@ -152,36 +266,33 @@ void bmpcga_show(int ox, int oy, const uint8_t* const image, const uint16_t* con
    -------------------------------------------------------- */
 void bmp16_show(int16_t ox, int16_t oy, const uint8_t* const image, const uint16_t* const palette)
 {
-
-  int16_t x,y,f;
-  int16_t width, height;
-  uint16_t ptr;
-
+  int       x, y;
+  uint16_t  width, height, bpl;
+  uint32_t  ptr;
+  uint8_t   b;
 
   width= (readarray(image,0) << 8) + readarray(image,1);
   height= (readarray(image,2) << 8) + readarray(image, 3);
 
-  ptr= 4;
-  y= height;
+  bpl= width / 2;                                      // 2 Pixel je Byte
 
-  while(y)
+  if (!gfx_clip(ox, oy, width, height)) return;
+
+  // BMP: Reihen liegen von unten nach oben im Array, da jede Reihe
+  // direkt adressierbar ist, wird von oben nach unten in ein Fenster
+  // geschrieben
+  gfx_window();
+  for (y= gfx_cy1; y <= gfx_cy2; y++)
   {
-    for (x= 0; x< width; x++)
+    ptr= 4 + (uint32_t)(height-1-y)*bpl;
+    for (x= gfx_cx1; x <= gfx_cx2; x++)
     {
-      if (x & 1)                          // bei 2 Farbpixel / Byte nur bei jedem zweiten Byte
-                                          // den Zeiger auf naechstes Bilddatenbyte erhoehen
-      {
-        f= readarray(image, ptr) & 0x0f;
-        ptr++;
-      }
-      else
-      {
-        f= (readarray(image,ptr) >> 4) & 0x0f;
-      }
-      putpixel(ox+x,oy+y-1, readwarray(palette,f) );
+      b= readarray(image, ptr + (x >> 1));
+      gfx_put(readwarray(palette, (x & 1) ? (b & 0x0f) : (b >> 4)));
     }
-    y--;
   }
+  gfx_flush();
+  tft_window_end();
 }
 
 /* --------------------------------------------------------
@@ -201,26 +312,25 @@ void bmp16_show(int16_t ox, int16_t oy, const uint8_t* const image, const uint16
    -------------------------------------------------------- */
 void bmp256_show(uint16_t ox, uint16_t oy, const uint8_t* const image, const uint16_t* const palette)
 {
-
-  uint16_t x,y,f;
-  uint16_t width, height;
-  uint16_t ptr;
+  int       x, y;
+  uint16_t  width, height;
+  uint32_t  ptr;
 
   width= (readarray(image,0) << 8) + readarray(image,1);
   height= (readarray(image,2) << 8) + readarray(image, 3);
 
-  ptr= 4;
-  y= height;
-  while(y)
+  if (!gfx_clip(ox, oy+1, width, height)) return;
+
+  // BMP: Reihen von unten nach oben im Array, Ausgabe von oben nach unten
+  gfx_window();
+  for (y= gfx_cy1; y <= gfx_cy2; y++)
   {
-    for (x= 0; x< width; x++)
-    {
-      f= readarray(image, ptr);
-      putpixel(ox+x,oy+y, readwarray(palette,f));
-      ptr++;
-    }
-    y--;
+    ptr= 4 + (uint32_t)(height-1-y)*width;
+    for (x= gfx_cx1; x <= gfx_cx2; x++)
+      gfx_put(readwarray(palette, readarray(image, ptr + x)));
   }
+  gfx_flush();
+  tft_window_end();
 }
 
 
@@ -232,6 +342,10 @@ void bmp256_show(uint16_t ox, uint16_t oy, const uint8_t* const image, const uin
      auf dem Bildschirm an. PCX-Grafik muss zwingend
      eine 256 Farben Grafik beinhalten.
 
+     Da PCX lauflaengenkodiert ist, werden Zeilen ober-
+     halb des Ausschnitts dekodiert aber nicht ausgegeben,
+     nach der letzten sichtbaren Zeile wird abgebrochen.
+
         *image     : Zeiger auf das Bytearray, dass die
                      PCX-Grafik enthaellt
         x,y        : linke obere Ecke, ab der die
@@ -244,8 +358,8 @@ void pcx256_show(int16_t x, int16_t y, const unsigned char* const image, const u
   #define  pcx(nr)         ( readarray(image,nr) )
   #define  pcxw(nr)        ( readwarray(image,nr) )
 
-  int32_t  pos, c, w, h, e, pack;
-  int32_t  c2;
+  int32_t  pos, c, w, h, bpl, row, pack;
+  uint8_t  b;
   uint16_t f;
 
   if ((pcx(0) != 10) | (pcx(3) != 8))                  // Identity Bytes abfragen
@@ -259,53 +373,145 @@ void pcx256_show(int16_t x, int16_t y, const unsigned char* const image, const u
   w= ((pcx(9) - pcx(5))*256 + pcx(8) - pcx(4))+1;
   h= ((pcx(11) - pcx(7))*256 + pcx(10) - pcx(6))+1;
 
-  pack= 0; c= 0; e= y+h;
+  bpl= pcx(66) + (pcx(67) * 256);                      // Bytes pro Zeile (evtl. mit Fuellbyte)
+  if (bpl < w) bpl= w;
+
+  if (!gfx_clip(x, y, w, h)) return;
 
+  gfx_window();
+
+  c= 0; row= 0;
   pos= 128;
-  while (y <e)
+  while (row <= gfx_cy2)
   {
-    if (pack != 0)
+    b= pcx(pos++);
+    if ((b & 0xc0)== 0xc0)                             // Wiederholungszaehler
     {
-      for (c2= 0; c2< (pack); c2++)
-      {
-          f= readwarray(pal, pcx(pos));                 // Farbe aus Palettenarray holen
-
-          putpixel(x+c,y,f);
-
-        if (c== w)
-        {
-          c= 0;
-          y++;
-        }
-        else
-        {
-          c++;
-        }
-      }
-      pack= 0;
+      pack= b & 0x3f;
+      b= pcx(pos++);
     }
     else
     {
-      if ((pcx(pos) & 0xc0)== 0xc0)
+      pack= 1;
+    }
+
+    while ((pack) && (row < gfx_cy1))                  // Zeilen oberhalb des Ausschnitts
+    {                                                  // nur dekodieren
+      pack--;
+      c++;
+      if (c== bpl) { c= 0; row++; }
+    }
+
+    f= readwarray(pal, b);                             // Farbe aus Palettenarray holen
+
+    while (pack--)
+    {
+      if ((c >= gfx_cx1) && (c <= gfx_cx2)) gfx_put(f); // Fuellbytes am Zeilenende und Pixel
+      c++;                                             // ausserhalb des Ausschnitts nicht anzeigen
+      if (c== bpl)
       {
-        pack= pcx(pos) & 0x3f;
+        c= 0;
+        row++;
+        if (row > gfx_cy2) break;
       }
-      else
-      {
+    }
+  }
+  gfx_flush();
+  tft_window_end();
+}
 
-        f= readwarray(pal, pcx(pos));                 // Farbe aus Palettenarray holen
+/* --------------------------------------------------------
+     lz256_show
+
+     zeigt eine mit image2c (Option -z) komprimierte
+     256 Farben Grafik ab den Koordinaten x / y (linke
+     obere Ecke) auf dem Bildschirm an.
+
+     Aufbau:
+
+       Byte 0..1 : Breite (High-, Lowbyte)
+       Byte 2..3 : Hoehe
+       Byte 4    : Kennung 'L'
+       ab Byte 5 : Tokenstrom, Bildpunkte zeilenweise von
+                   oben nach unten
+
+         0nnnnnnn           : n+1 Palettenindizes folgen
+         1lllllaa aaaaaaaa  : l+3 Bildpunkte ab dem a+1
+                              Bildpunkte zurueckliegenden
+                              Punkt kopieren (l == 31: ein
+                              weiteres Byte wird zur Laenge
+                              addiert)
+
+     Kopien greifen auf die letzten 1024 Palettenindizes
+     zurueck, diese werden in einem Ringpuffer auf dem
+     Stack gehalten. Es wird kein Bildspeicher benoetigt,
+     die Pixel gehen ueber den Zeilenpuffer direkt in das
+     Fenster. Zeilen oberhalb des Ausschnitts werden nur
+     dekodiert, nach der letzten sichtbaren Zeile wird
+     abgebrochen.
 
-        putpixel(x+c,y,f);
+        *image     : Zeiger auf das Bytearray, dass die
+                     komprimierte Grafik enthaellt
+        x,y        : linke obere Ecke, ab der die
+                     Grafik angezeigt werden soll
+        *pal       : Zeiger auf die zur Grafik ge-
+                     hoerende Farbpalette (image2c -p)
+   -------------------------------------------------------- */
+void lz256_show(int16_t x, int16_t y, const unsigned char* const image, const uint16_t *const pal)
+{
+  #define  lz(nr)          ( readarray(image,nr) )
 
-        c++;
-      }
+  uint8_t  ring[lz256_window];
+  int32_t  pos;
+  uint16_t w, h, c, row, p, d, l;
+  uint8_t  b, tok;
+
+  if (lz(4) != 'L') return;                            // Kennung
+
+  w= (lz(0) << 8) | lz(1);
+  h= (lz(2) << 8) | lz(3);
+
+  if (!gfx_clip(x, y, w, h)) return;
+
+  gfx_window();
+
+  c= 0; row= 0; p= 0;
+  pos= 5;
+  while (row <= gfx_cy2)
+  {
+    tok= lz(pos++);
+    if (tok & 0x80)                                    // Kopie aus dem Ringpuffer
+    {
+      l= (tok >> 2) & 0x1f;
+      d= (((tok & 0x03) << 8) | lz(pos)) + 1;
+      pos++;
+      if (l == 31) l += lz(pos++);
+      l += 3;
     }
-    pos++;
-    if (c== w)
+    else                                               // unverschluesselte Indizes
     {
-      c= 0;
-      y++;
+      l= tok + 1;
+      d= 0;
+    }
+
+    while (l--)
+    {
+      if (d) b= ring[(p - d) & (lz256_window-1)];
+        else b= lz(pos++);
+      ring[p & (lz256_window-1)]= b;
+      p++;
+
+      if ((row >= gfx_cy1) && (c >= gfx_cx1) && (c <= gfx_cx2))
+        gfx_put(readwarray(pal, b));
+      c++;
+      if (c == w)
+      {
+        c= 0;
+        row++;
+        if (row > gfx_cy2) break;
+      }
     }
   }
+  gfx_flush();
+  tft_window_end();
 }
-
@@ -0,0 +1,499 @@
+/* -------------------------------------------------------
+                         tft_console.c
+
+     Textkonsole mit Hardware-Scrolling fuer tftdisplay.c
+
+     Die Konsole gibt Text fortlaufend aus (z.B. eine
+     ueber die serielle Schnittstelle empfangene Log-
+     ausgabe). Erreicht der Cursor die letzte Zeile, wird
+     der Bildschirminhalt um eine Textzeile nach oben
+     geschoben.
+
+     ILI9340 / ILI9341 besitzen einen vertikalen Scroll-
+     bereich (Register 0x33) und eine Startadresse des
+     Scrollbereichs (Register 0x37). Die Konsole legt den
+     Scrollbereich ueber das ganze Display, eine neue
+     Zeile kostet damit nur das Loeschen einer Textzeile
+     (die bisher oberste, die jetzt unten erscheint) und
+     einen Registerzugriff.
+
+     Voraussetzung fuer das Hardware-Scrolling ist die
+     Ausgabe hochkant (outmode= 0, bei 8-Bit Displays
+     ausserdem lcd_orientation(0) wie nach lcd_init), da
+     der Controller nur entlang der Displayzeilen
+     scrollen kann. Bei anderen Controllern oder anderen
+     Ausgaberichtungen wird der Bildschirm aus dem Zeilen-
+     puffer neu gezeichnet (langsam).
+
+     Die letzten tft_conlines Textzeilen (Zeichen und
+     Farbattribut) werden in einem Ringpuffer gehalten,
+     tft_con_scrollback blaettert darin zurueck.
+
+     Unterstuetzte Steuerzeichen und Escape-Sequenzen:
+
+       \r, \n (Zeilenvorschub mit Wagenruecklauf), \b,
+       \t (8er Tabulator), \f (Bildschirm loeschen)
+
+       ESC [ n A / B / C / D      Cursor hoch, runter,
+                                  rechts, links
+       ESC [ z ; s H  (oder f)    Cursor auf Zeile z,
+                                  Spalte s (ab 1)
+       ESC [ n J                  loeschen: 0 ab Cursor,
+                                  1 bis Cursor, 2 alles
+       ESC [ n K                  dto. innerhalb der Zeile
+       ESC [ n ; ... m            Attribute: 0 normal,
+                                  1 hell, 7 invers,
+                                  30..37 / 90..97 Vorder-
+                                  grund, 40..47 Hinter-
+                                  grund, 39 / 49 Standard
+       ESC [ s, ESC 7             Cursor merken
+       ESC [ u, ESC 8             Cursor zurueck
+       ESC c                      Konsole zuruecksetzen
+
+     alle anderen Sequenzen werden ueberlesen. Ein Cursor
+     wird nicht dargestellt.
+
+     Dieses Modul wird von tftdisplay.c eingebunden
+     (tft_console == 1 in tftdisplay.h).
+
+     Beispiel:
+
+       void my_putchar(char ch)
+       {
+         tft_con_putchar(ch);
+       }
+
+       lcd_init();
+       setfont(0);
+       tft_con_init(grey, black);
+       while(1) my_putchar(uart_getchar());
+   ------------------------------------------------------ */
+
+#if ((ili9340 == 1) || (ili9341 == 1))
+  #define con_hwscroll    1
+#else
+  #define con_hwscroll    0
+#endif
+
+#define con_esc_none      0
+#define con_esc_esc       1                   // ESC empfangen
+#define con_esc_csi       2                   // ESC [ empfangen, Parameter folgen
+#define con_maxpar        4
+
+static uint8_t  con_ch[tft_conlines][tft_concols];      // Zeichen
+static uint8_t  con_at[tft_conlines][tft_concols];      // Attribut: Bit 0..3 Vordergrund,
+                                                        // Bit 4..7 Hintergrund (EGA-Farbe)
+static int      con_cols, con_rows;           // Bildschirmgroesse in Zeichen
+static int      con_cw, con_chh;              // Zeichenzelle in Pixel
+static int      con_vsa;                      // Hoehe des Scrollbereichs in Pixel
+static int      con_top;                      // Displayzeile (Pixel) der obersten Textzeile
+static int      con_head;                     // Ringindex der obersten Textzeile
+static int      con_hist;                     // Anzahl Zeilen oberhalb des Bildschirms im Ring
+static int      con_back;                     // Anzahl zurueckgeblaetterter Zeilen
+static int      con_cx, con_cy;               // Cursor (Spalte, Zeile)
+static int      con_sx, con_sy;               // gemerkter Cursor
+static uint8_t  con_attr, con_defattr;
+static uint8_t  con_hw;                       // 1 : Hardware-Scrolling aktiv
+static uint8_t  con_esc;
+static uint8_t  con_npar;
+static uint16_t con_par[con_maxpar];
+
+// ANSI-Farbnummer (schwarz, rot, gruen, gelb, blau, magenta, cyan, weiss) => EGA-Farbe
+static const uint8_t con_ansi2ega[8] = { 0, 4, 2, 6, 1, 5, 3, 7 };
+
+/* ----------------------------------------------------------
+     con_line
+
+     liefert den Ringindex der Bildschirmzeile row unter
+     Beruecksichtigung des Zurueckblaetterns
+   ---------------------------------------------------------- */
+static int con_line(int row)
+{
+  return (con_head - con_back + row + tft_conlines) % tft_conlines;
+}
+
+static void con_fill(uint8_t *p, uint8_t val, int n)
+{
+  while (n-- > 0) *p++= val;
+}
+
+// Pixelzeile der Bildschirmzeile row
+static int con_ypos(int row)
+{
+  return (con_top + row * con_chh) % con_vsa;
+}
+
+static void con_scrollstart(void)
+{
+  #if (con_hwscroll == 1)
+    wrcmd(0x37);                                // Vertical Scrolling Start Address
+    wrdata16(con_top);
+  #endif
+}
+
+/* ----------------------------------------------------------
+     con_drawcell
+
+     zeichnet das Zeichen in Spalte col, Bildschirmzeile row
+     aus dem Ringpuffer
+   ---------------------------------------------------------- */
+static void con_drawcell(int col, int row)
+{
+  int      l, y, xp, yp;
+  uint8_t  ch, at;
+  uint16_t tc, bc;
+
+  l=  con_line(row);
+  ch= con_ch[l][col];
+  at= con_at[l][col];
+  y=  con_ypos(row);
+
+  // Textposition und Farben des Anwenders bleiben erhalten
+  tc= textcolor; bc= bkcolor; xp= aktxp; yp= aktyp;
+
+  bkcolor=   egapalette[at >> 4];
+  textcolor= egapalette[at & 0x0f];
+  if ((fontnr == 2) || (ch == ' '))             // 5x7 zeichnet keinen Hintergrund
+    fillrect(col * con_cw, y, col * con_cw + con_cw - 1, y + con_chh - 1, bkcolor);
+  if (ch != ' ')
+  {
+    aktxp= col * con_cw;
+    aktyp= y;
+    lcd_putchar(ch);
+  }
+
+  textcolor= tc; bkcolor= bc; aktxp= xp; aktyp= yp;
+}
+
+/* ----------------------------------------------------------
+     con_clearcells
+
+     loescht in Bildschirmzeile row die Spalten c1..c2 (im
+     Ringpuffer und auf dem Display) mit dem aktuellen
+     Attribut
+   ---------------------------------------------------------- */
+static void con_clearcells(int row, int c1, int c2)
+{
+  int l, x2, y;
+
+  if (c1 > c2) return;
+  l= con_line(row);
+  con_fill(&con_ch[l][c1], ' ', c2 - c1 + 1);
+  con_fill(&con_at[l][c1], con_attr, c2 - c1 + 1);
+
+  x2= (c2 == con_cols-1) ? _xres-1 : (c2+1) * con_cw - 1;
+  y=  con_ypos(row);
+  fillrect(c1 * con_cw, y, x2, y + con_chh - 1, egapalette[con_attr >> 4]);
+}
+
+static void con_redraw(void)
+{
+  int r, c;
+
+  for (r= 0; r < con_rows; r++)
+    for (c= 0; c < con_cols; c++) con_drawcell(c, r);
+}
+
+/* ----------------------------------------------------------
+     con_scroll
+
+     schiebt den Bildschirminhalt um eine Textzeile nach
+     oben, die unterste Zeile ist danach leer
+   ---------------------------------------------------------- */
+static void con_scroll(void)
+{
+  int l;
+
+  if (con_hw)
+  {
+    // die bisher oberste Zeile wird geloescht und erscheint nach dem Verschieben unten
+    fillrect(0, con_top, _xres-1, con_top + con_chh - 1, egapalette[con_attr >> 4]);
+    con_top= (con_top + con_chh) % con_vsa;
+    con_scrollstart();
+  }
+
+  con_head= (con_head + 1) % tft_conlines;
+  if (con_hist < tft_conlines - con_rows) con_hist++;
+  l= con_line(con_rows-1);
+  con_fill(con_ch[l], ' ', con_cols);
+  con_fill(con_at[l], con_attr, con_cols);
+
+  if (!con_hw) con_redraw();
+}
+
+static void con_newline(void)
+{
+  con_cx= 0;
+  if (con_cy < con_rows-1) con_cy++; else con_scroll();
+}
+
+/* ----------------------------------------------------------
+     con_clearrows
+
+     loescht die Zeilen r1..r2 vollstaendig
+   ---------------------------------------------------------- */
+static void con_clearrows(int r1, int r2)
+{
+  for (; r1 <= r2; r1++) con_clearcells(r1, 0, con_cols-1);
+}
+
+/* ----------------------------------------------------------
+     con_sgr
+
+     wertet die Parameter von ESC [ ... m aus
+   ---------------------------------------------------------- */
+static void con_sgr(void)
+{
+  uint8_t i, p, fg, bg;
+
+  if (!con_npar) con_npar= 1;                   // ESC [ m entspricht ESC [ 0 m
+  for (i= 0; i < con_npar; i++)
+  {
+    p=  con_par[i];
+    fg= con_attr & 0x0f;
+    bg= con_attr >> 4;
+    if (p == 0) { con_attr= con_defattr; continue; }
+    if (p == 1)               fg |= 8;
+    else if (p == 7)          { fg= con_attr >> 4; bg= con_attr & 0x0f; }
+    else if ((p >= 30) && (p <= 37)) fg= (fg & 8) | con_ansi2ega[p-30];
+    else if ((p >= 90) && (p <= 97)) fg= 8 | con_ansi2ega[p-90];
+    else if ((p >= 40) && (p <= 47)) bg= con_ansi2ega[p-40];
+    else if (p == 39)         fg= con_defattr & 0x0f;
+    else if (p == 49)         bg= con_defattr >> 4;
+    con_attr= (bg << 4) | fg;
+  }
+}
+
+/* ----------------------------------------------------------
+     con_csi
+
+     fuehrt die mit ch abgeschlossene Sequenz ESC [ ... aus
+   ---------------------------------------------------------- */
+static void con_csi(char ch)
+{
+  int n;
+
+  n= (con_npar && con_par[0]) ? con_par[0] : 1;
+
+  switch (ch)
+  {
+    case 'A' : con_cy -= n; break;
+    case 'B' : con_cy += n; break;
+    case 'C' : con_cx += n; break;
+    case 'D' : con_cx -= n; break;
+    case 'H' :
+    case 'f' : con_cy= n - 1;
+               con_cx= ((con_npar > 1) && con_par[1]) ? con_par[1] - 1 : 0;
+               break;
+    case 'J' : switch (con_npar ? con_par[0] : 0)
+               {
+                 case 0 : if (con_cx < con_cols) con_clearcells(con_cy, con_cx, con_cols-1);
+                          con_clearrows(con_cy+1, con_rows-1);
+                          break;
+                 case 1 : con_clearrows(0, con_cy-1);
+                          con_clearcells(con_cy, 0, (con_cx < con_cols) ? con_cx : con_cols-1);
+                          break;
+                 default: con_clearrows(0, con_rows-1); break;
+               }
+               break;
+    case 'K' : switch (con_npar ? con_par[0] : 0)
+               {
+                 case 0 : if (con_cx < con_cols) con_clearcells(con_cy, con_cx, con_cols-1); break;
+                 case 1 : con_clearcells(con_cy, 0, (con_cx < con_cols) ? con_cx : con_cols-1); break;
+                 default: con_clearcells(con_cy, 0, con_cols-1); break;
+               }
+               break;
+    case 'm' : con_sgr(); break;
+    case 's' : con_sx= con_cx; con_sy= con_cy; break;
+    case 'u' : con_cx= con_sx; con_cy= con_sy; break;
+    default  : break;
+  }
+
+  if (con_cx < 0) con_cx= 0;
+  if (con_cx > con_cols-1) con_cx= con_cols-1;
+  if (con_cy < 0) con_cy= 0;
+  if (con_cy > con_rows-1) con_cy= con_rows-1;
+}
+
+/* ----------------------------------------------------------
+     tft_con_init
+
+     richtet die Konsole fuer den aktuell gesetzten Font
+     (setfont, textsize) ein und loescht das Display
+
+       fg, bg : Vorder- und Hintergrundfarbe (EGA-Farb-
+                nummer, z.B. lightgrey, black)
+   ---------------------------------------------------------- */
+void tft_con_init(uint8_t fg, uint8_t bg)
+{
+  if (fontnr == 2)
+  {
+    con_cw=  fontsizex + 1;                     // 5x7 wird nicht vergroessert
+    con_chh= fontsizey + 1;
+  }
+  else
+  {
+    con_cw=  fontsizex * (textsize + 1);
+    con_chh= fontsizey * (textsize + 1);
+  }
+
+  con_cols= _xres / con_cw;
+  if (con_cols > tft_concols) con_cols= tft_concols;
+  con_rows= _yres / con_chh;
+  if (con_rows > tft_conlines) con_rows= tft_conlines;
+
+  con_vsa= con_rows * con_chh;
+  con_top= 0;
+  con_head= 0;
+  con_hist= 0;
+  con_back= 0;
+  con_cx= 0; con_cy= 0;
+  con_sx= 0; con_sy= 0;
+  con_esc= con_esc_none;
+  con_defattr= ((bg & 0x0f) << 4) | (fg & 0x0f);
+  con_attr= con_defattr;
+  txoutmode= 0;
+  fntfilled= 1;
+
+  con_fill(&con_ch[0][0], ' ', sizeof(con_ch));
+  con_fill(&con_at[0][0], con_attr, sizeof(con_at));
+
+  con_hw= (con_hwscroll == 1) && (outmode == 0);
+
+  #if (con_hwscroll == 1)
+    if (con_hw)
+    {
+      // Scrollbereich: oben 0 feste Zeilen, con_vsa Zeilen scrollen, Rest unten fest
+      wrcmd(0x33);                              // Vertical Scrolling Definition
+      wrdata16(0);
+      wrdata16(con_vsa);
+      wrdata16(_yres - con_vsa);
+      con_scrollstart();
+    }
+  #endif
+
+  fillrect(0, 0, _xres-1, _yres-1, egapalette[bg & 0x0f]);
+}
+
+/* ----------------------------------------------------------
+     tft_con_exit
+
+     beendet die Konsole: der Scrollbereich wird zurueck-
+     gesetzt (normale Darstellung), das Display geloescht
+   ---------------------------------------------------------- */
+void tft_con_exit(void)
+{
+  #if (con_hwscroll == 1)
+    if (con_hw)
+    {
+      con_top= 0;
+      con_scrollstart();
+      wrcmd(0x13);                              // Normal Display Mode On
+    }
+  #endif
+  con_hw= 0;
+  fillrect(0, 0, _xres-1, _yres-1, egapalette[con_defattr >> 4]);
+}
+
+/* ----------------------------------------------------------
+     tft_con_scrollback
+
+     zeigt die Ausgabe n Zeilen weiter oben an (n= 0 : die
+     aktuelle Ausgabe). Mit der naechsten Zeichenausgabe
+     wird wieder die aktuelle Ausgabe angezeigt.
+
+     Rueckgabe: tatsaechlich zurueckgeblaetterte Zeilen
+   ---------------------------------------------------------- */
+int tft_con_scrollback(int n)
+{
+  if (n < 0) n= 0;
+  if (n > con_hist) n= con_hist;
+  if (n != con_back)
+  {
+    con_back= n;
+    con_redraw();
+  }
+  return n;
+}
+
+/* ----------------------------------------------------------
+     tft_con_putchar
+
+     gibt ein Zeichen, Steuerzeichen oder einen Teil einer
+     Escape-Sequenz auf der Konsole aus
+   ---------------------------------------------------------- */
+void tft_con_putchar(char ch)
+{
+  uint8_t c = (uint8_t)ch;
+  int     l;
+
+  if (con_back) tft_con_scrollback(0);
+
+  if (con_esc == con_esc_esc)
+  {
+    con_esc= con_esc_none;
+    switch (c)
+    {
+      case '[' : con_esc= con_esc_csi; con_npar= 0; con_par[0]= 0; break;
+      case '7' : con_sx= con_cx; con_sy= con_cy; break;
+      case '8' : con_cx= con_sx; con_cy= con_sy; break;
+      case 'c' : con_attr= con_defattr;
+                 con_clearrows(0, con_rows-1);
+                 con_cx= 0; con_cy= 0;
+                 break;
+      default  : break;
+    }
+    return;
+  }
+
+  if (con_esc == con_esc_csi)
+  {
+    if ((c >= '0') && (c <= '9'))
+    {
+      if (!con_npar) con_npar= 1;
+      if (con_npar <= con_maxpar)
+        con_par[con_npar-1]= con_par[con_npar-1] * 10 + (c - '0');
+      return;
+    }
+    if (c == ';')
+    {
+      if (!con_npar) con_npar= 1;
+      if (con_npar < con_maxpar) con_par[con_npar]= 0;
+      con_npar++;
+      return;
+    }
+    if ((c >= 0x20) && (c < 0x40)) return;      // '?' u.ae. Zwischenzeichen ueberlesen
+    con_esc= con_esc_none;
+    if (con_npar > con_maxpar) con_npar= con_maxpar;
+    con_csi(c);
+    return;
+  }
+
+  switch (c)
+  {
+    case 27 : con_esc= con_esc_esc; return;
+    case 13 : con_cx= 0; return;
+    case 10 : con_newline(); return;
+    case  8 : if (con_cx) con_cx--; return;
+    case  9 : con_cx= (con_cx + 8) & ~7;
+              if (con_cx > con_cols) con_cx= con_cols;
+              return;
+    case 12 : con_clearrows(0, con_rows-1); con_cx= 0; con_cy= 0; return;
+    default : break;
+  }
+
+  if ((c < 32) || (c > lastascii)) return;
+
+  if (con_cx >= con_cols) con_newline();        // verzoegerter Zeilenumbruch
+
+  l= con_line(con_cy);
+  con_ch[l][con_cx]= c;
+  con_at[l][con_cx]= con_attr;
+  con_drawcell(con_cx, con_cy);
+  con_cx++;
+}
+
+void tft_con_puts(char *s)
+{
+  while (*s) tft_con_putchar(*s++);
+}
@@ -126,33 +126,52 @@ uint16_t rgbfromega(uint8_t entry)
 
     gpio_port_write(GPIOB,outbye | 1);   // Reset auf 1 belassen
   }
+
+  // BSRR-Wort fuer GPIOB (PB6..PB13), nur die Datenpins werden veraendert
+  #define lcd_bsrr_b(v)    ( 0x3fc00000 | (((v) & 0xfc) << 4) | (((v) & 0x03) << 12) )
 #endif
 
 #if (boardversion == 1)
 
+  /* -----------------------------------------------------
+       BSRR-Tabellen fuer die Byteausgabe
+
+       D0..D5 liegen auf GPIOB, D6 und D7 auf GPIOA. Ein
+       Eintrag loescht (oberes Halbwort) alle Datenpins des
+       Ports und setzt (unteres Halbwort) die Pins des
+       Bytes, Set hat Vorrang vor Reset.
+     ----------------------------------------------------- */
+
+  #define bsrr_db(v)       ( 0x20ba0000                      \
+                           | (((v) & 0x01) ? 0x2000 : 0)     \
+                           | (((v) & 0x02) ? 0x0080 : 0)     \
+                           | (((v) & 0x04) ? 0x0002 : 0)     \
+                           | (((v) & 0x08) ? 0x0008 : 0)     \
+                           | (((v) & 0x10) ? 0x0020 : 0)     \
+                           | (((v) & 0x20) ? 0x0010 : 0) )
+  #define bsrr_db4(v)      bsrr_db(v), bsrr_db(v+1), bsrr_db(v+2), bsrr_db(v+3)
+  #define bsrr_db16(v)     bsrr_db4(v), bsrr_db4(v+4), bsrr_db4(v+8), bsrr_db4(v+12)
+
+  static const uint32_t bsrr_portb[64] =
+    { bsrr_db16(0), bsrr_db16(16), bsrr_db16(32), bsrr_db16(48) };
+
+  static const uint32_t bsrr_porta[4] =
+    { 0x81000000, 0x81008000, 0x81000100, 0x81008100 };     // PA15 = D6, PA8 = D7
+
+  #define lcd_bsrr_b(v)    ( bsrr_portb[(v) & 0x3f] )
+  #define lcd_bsrr_a(v)    ( bsrr_porta[((v) >> 6) & 0x03] )
+
   void byteout(uint32_t val)
   {
-    uint32_t outbyeA = 0;
-    uint32_t outbyeB = 0;
-
-    GPIO_BSRR(GPIOB)= 0x20ba0000;
-    GPIO_BSRR(GPIOA)= 0x81000000;
-
-    if (val & 0x01) outbyeB |= 0x2000;
-    if (val & 0x02) outbyeB |= 0x0080;
-    if (val & 0x04) outbyeB |= 0x0002;
-    if (val & 0x08) outbyeB |= 0x0008;
-    if (val & 0x10) outbyeB |= 0x0020;
-    if (val & 0x20) outbyeB |= 0x0010;
-    if (val & 0x40) outbyeA |= 0x8000;
-    if (val & 0x80) outbyeA |= 0x0100;
-
-    GPIO_BSRR(GPIOB) = outbyeB;
-    GPIO_BSRR(GPIOA) = outbyeA;
+    GPIO_BSRR(GPIOB)= lcd_bsrr_b(val);
+    GPIO_BSRR(GPIOA)= lcd_bsrr_a(val);
   }
 
 #endif
 
+// WR liegt bei beiden Boardversionen an PA1
+#define lcd_wr_strobe()    { GPIO_BRR(GPIOA)= GPIO1; GPIO_BSRR(GPIOA)= GPIO1; }
+
 /* -------------------------------------------------------------
    LCD_BUS_WRITE
 
@@ -164,8 +183,63 @@ void lcd_bus_write(uint8_t val)
 {
   byteout(val);
   // lcd_wr Taktimpuls, ggf. ein Delay dazwischen
-  lcd_wr_clr();
-  lcd_wr_set();
+  lcd_wr_strobe();
+}
+
+/* -------------------------------------------------------------
+   lcd_bus_fill
+
+     sendet n mal das 16-Bit Datum color an das Display. Die
+     Portzustaende fuer High- und Lowbyte werden einmal vor
+     der Schleife berechnet. Sind High- und Lowbyte gleich,
+     wird das Byte nur einmal angelegt und danach nur noch
+     WR getaktet.
+   ------------------------------------------------------------- */
+static void lcd_bus_fill(uint16_t color, uint32_t n)
+{
+  uint8_t  hi, lo;
+  uint32_t hb, lb;
+  #if (boardversion == 1)
+    uint32_t ha, la;
+  #endif
+
+  if (!n) return;
+
+  lcd_rs_set();
+  hi= color >> 8;
+  lo= color & 0xff;
+  hb= lcd_bsrr_b(hi);
+  lb= lcd_bsrr_b(lo);
+
+  GPIO_BSRR(GPIOB)= hb;
+  #if (boardversion == 1)
+    ha= lcd_bsrr_a(hi);
+    la= lcd_bsrr_a(lo);
+    GPIO_BSRR(GPIOA)= ha;
+
+    if (ha != la)
+    {
+      while (n--)
+      {
+        GPIO_BSRR(GPIOB)= hb; GPIO_BSRR(GPIOA)= ha; lcd_wr_strobe();
+        GPIO_BSRR(GPIOB)= lb; GPIO_BSRR(GPIOA)= la; lcd_wr_strobe();
+      }
+      return;
+    }
+  #endif
+
+  if (hi == lo)
+  {
+    n <<= 1;
+    while (n--) lcd_wr_strobe();
+    return;
+  }
+
+  while (n--)
+  {
+    GPIO_BSRR(GPIOB)= hb; lcd_wr_strobe();
+    GPIO_BSRR(GPIOB)= lb; lcd_wr_strobe();
+  }
 }
 
 /* -------------------------------------------------------------
@@ -401,16 +475,8 @@ void putpixeltx(int x, int y, uint16_t color)
    ------------------------------------------------------------- */
 void clrscr(void)
 {
-  unsigned int i, m;
-
   address_set(0, 0, tftwidth-1, tftheight-1);
-
-  for (i = 0; i < _yres; i++)
-    for (m = 0; m < _xres; m++)
-    {
-      lcd_write_data(bkcolor >> 8);
-      lcd_write_data(bkcolor);
-    }
+  lcd_bus_fill(bkcolor, (uint32_t)_xres * _yres);
 }
 
 /* -------------------------------------------------------------
@@ -464,12 +530,7 @@ void fastxline(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t color)
   if (x2< x1) { x= x1; x1= x2; x= x2= x; }
 
   address_set(x1, y1, tftwidth - 1, tftheight - 1);
-
-  for (x= x1; x< (x2+1); x++)
-  {
-    lcd_write_data(color >> 8);
-    lcd_write_data(color);
-  }
+  lcd_bus_fill(color, x2 - x1 + 1);
 }
 
 /* -------------------------------------------------------------
@@ -562,45 +623,6 @@ void ellipse(int xm, int ym, int a, int b, uint16_t color )
   }
 }
 
-/* -------------------------------------------------------------
-     fillellipse
-
-     Zeichnet eine ausgefuellte Ellipse mit Mittelpunt an der
-     Koordinate xm,ym mit den Hoehen- Breitenverhaeltnis a:b
-     mit der angegebenen Farbe
-
-        xm,ym  : Koordinate des Mittelpunktes der Ellipse
-        a,b    : Hoehen- Breitenverhaeltnis
-        color  : 16 - Bit RGB565 Farbwert der gezeichnet
-                 werden soll
-
-   Ellipsenalgorithmus nach Bresenham (www.wikipedia.org)
-   ------------------------------------------------------------- */
-void fillellipse(int xm, int ym, int a, int b, uint16_t color )
-{
-  // Algorithmus nach Bresenham (www.wikipedia.org)
-
-  int dx = 0, dy = b;                       // im I. Quadranten von links oben nach rechts unten
-  long a2 = a*a, b2 = b*b;
-  long err = b2-(2*b-1)*a2, e2;             // Fehler im 1. Schritt */
-
-  do
-  {
-    fastxline(xm+dx, ym+dy,xm-dx, color);            // I. und II.   Quadrant
-    fastxline(xm-dx, ym-dy,xm+dx, color);            // III. und IV. Quadrant
-
-    e2 = 2*err;
-    if (e2 <  (2*dx+1)*b2) { dx++; err += (2*dx+1)*b2; }
-    if (e2 > -(2*dy-1)*a2) { dy--; err -= (2*dy-1)*a2; }
-  } while (dy >= 0);
-
-  while (dx++ < a)                        // fehlerhafter Abbruch bei flachen Ellipsen (b=1)
-  {
-    putpixel(xm+dx, ym,color);             // -> Spitze der Ellipse vollenden
-    putpixel(xm-dx, ym,color);
-  }
-}
-
 /* -------------------------------------------------------------
      circle
 
@@ -618,21 +640,32 @@ void circle(int x, int y, int r, uint16_t color )
 }
 
 /* -------------------------------------------------------------
-     fillcircle
+     fill_span
 
-     Zeichnet einen ausgefuellten Kreis mit Mittelpunt an der
-     Koordinate xm,ym und dem Radius r mit der angegebenen Farbe
+     zeichnet eine waagrechte Strecke (Scanline) von x1 bis x2
+     in Zeile y als einen Burst (fastxline). Die Strecke wird
+     auf den Displaybereich (tftwidth x tftheight) beschnitten.
 
-        x,y    : Koordinate des Mittelpunktes der Ellipse
-        r      : Radius des Kreises
-        color  : 16 - Bit RGB565 Farbwert der gezeichnet
-                 werden soll
+     Grundlage der gefuellten Formen in tft_spanfill.c
    ------------------------------------------------------------- */
-void fillcircle(int x, int y, int r, uint16_t color )
+static void fill_span(int x1, int x2, int y, uint16_t color)
 {
-  fillellipse(x,y,r,r,color);
+  int t;
+
+  if (x2 < x1) { t= x1; x1= x2; x2= t; }
+  if ((y < 0) || (y >= tftheight) || (x2 < 0) || (x1 >= tftwidth)) return;
+  if (x1 < 0) x1= 0;
+  if (x2 >= tftwidth) x2= tftwidth-1;
+
+  fastxline(x1, y, x2, color);
 }
 
+// ------------------------------------
+//   gefuellte Formen (Scanlines)
+// ------------------------------------
+
+#include "tft_spanfill.c"
+
 
 /* ----------------------------------------------------------
      showimage
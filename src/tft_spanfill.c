@@ -0,0 +1,281 @@
+/* -------------------------------------------------------
+                       tft_spanfill.c
+
+     gefuellte Formen ueber waagrechte Strecken (Scanlines)
+     fuer tftdisplay.c und tft_parallel.c
+
+       fillellipse, fillcircle, fillroundrect, fillpoly,
+       filltriangle
+
+     Jede Zeile einer Form wird genau einmal als eine
+     Strecke gezeichnet. Die einbindende Datei stellt dafuer
+
+       static void fill_span(int x1, int x2, int y, uint16_t color);
+
+     bereit: zeichnet x1..x2 (auch x2 < x1) in Zeile y als
+     einen Burst und beschneidet die Strecke auf den Display-
+     bereich. So benutzen der SPI- und der Parallelbus-Teil
+     von tftdisplay.c und tft_parallel.c dieselben Verfahren
+     und liefern dieselben Bilder.
+
+     Dieses Modul wird nicht eigenstaendig uebersetzt.
+   ------------------------------------------------------ */
+
+#ifndef fillpoly_maxpoints
+  #define fillpoly_maxpoints    16          // max. Anzahl Eckpunkte fuer fillpoly
+#endif
+
+/* -------------------------------------------------------------
+     fillellipse
+
+     Zeichnet eine ausgefuellte Ellipse mit Mittelpunt an der
+     Koordinate xm,ym mit den Hoehen- Breitenverhaeltnis a:b
+     mit der angegebenen Farbe
+
+        xm,ym  : Koordinate des Mittelpunktes der Ellipse
+        a,b    : Hoehen- Breitenverhaeltnis
+        color  : 16 - Bit RGB565 Farbwert der gezeichnet
+                 werden soll
+
+   Ellipsenalgorithmus nach Bresenham (www.wikipedia.org), jede
+   Zeile wird genau einmal (mit ihrer groessten Breite) als
+   Strecke gezeichnet
+   ------------------------------------------------------------- */
+void fillellipse(int xm, int ym, int a, int b, uint16_t color )
+{
+  // Algorithmus nach Bresenham (www.wikipedia.org)
+
+  int dx = 0, dy = b;                       // im I. Quadranten von links oben nach rechts unten
+  int ox, oy;
+  long a2 = a*a, b2 = b*b;
+  long err = b2-(2*b-1)*a2, e2;             // Fehler im 1. Schritt */
+
+  if ((a == 0) && (b == 0))                 // Einzelpunkt (Bresenham terminiert hier nicht)
+  {
+    fill_span(xm, xm, ym, color);
+    return;
+  }
+
+  do
+  {
+    ox= dx; oy= dy;
+    e2 = 2*err;
+    if (e2 <  (2*dx+1)*b2) { dx++; err += (2*dx+1)*b2; }
+    if (e2 > -(2*dy-1)*a2) { dy--; err -= (2*dy-1)*a2; }
+
+    if ((dy != oy) && (oy > 0))             // Zeile ist fertig: I./II. und III./IV. Quadrant
+    {
+      fill_span(xm-ox, xm+ox, ym+oy, color);
+      fill_span(xm-ox, xm+ox, ym-oy, color);
+    }
+  } while (dy >= 0);
+
+  if (dx <= a) ox= a;                       // fehlerhafter Abbruch bei flachen Ellipsen (b=1)
+  fill_span(xm-ox, xm+ox, ym, color);       // -> Mittelzeile bis zur Spitze
+}
+
+/* -------------------------------------------------------------
+     fillcircle
+
+     Zeichnet einen ausgefuellten Kreis mit Mittelpunt an der
+     Koordinate xm,ym und dem Radius r mit der angegebenen Farbe
+
+        x,y    : Koordinate des Mittelpunktes der Ellipse
+        r      : Radius des Kreises
+        color  : 16 - Bit RGB565 Farbwert der gezeichnet
+                 werden soll
+
+     Midpoint-Algorithmus, jede Zeile wird genau einmal als
+     Strecke gezeichnet
+   ------------------------------------------------------------- */
+void fillcircle(int x, int y, int r, uint16_t color )
+{
+  int dx, dy, d;
+
+  dx= 0; dy= r; d= 1-r;
+  while (dx <= dy)
+  {
+    fill_span(x-dy, x+dy, y+dx, color);
+    if (dx) fill_span(x-dy, x+dy, y-dx, color);
+    if (d < 0)
+    {
+      d += 2*dx+3;
+    }
+    else
+    {
+      if (dx != dy)                         // Zeilen y+-dy sind fertig
+      {
+        fill_span(x-dx, x+dx, y+dy, color);
+        fill_span(x-dx, x+dx, y-dy, color);
+      }
+      d += 2*(dx-dy)+5;
+      dy--;
+    }
+    dx++;
+  }
+}
+
+/* -------------------------------------------------------------
+     fillroundrect
+
+     Zeichnet ein ausgefuelltes Rechteck mit abgerundeten Ecken
+
+        x1,y1  : Koordinate linke obere Ecke
+        x2,y2  : Koordinate rechte untere Ecke
+        r      : Radius der Ecken
+        color  : 16 - Bit RGB565 Farbwert
+   ------------------------------------------------------------- */
+void fillroundrect(int x1, int y1, int x2, int y2, int r, uint16_t color)
+{
+  int dx, dy, d, t;
+
+  if (x2 < x1) { t= x1; x1= x2; x2= t; }
+  if (y2 < y1) { t= y1; y1= y2; y2= t; }
+  if (r > (x2-x1) / 2) r= (x2-x1) / 2;
+  if (r > (y2-y1) / 2) r= (y2-y1) / 2;
+  if (r < 0) r= 0;
+
+  // Mittelteil ohne Rundungen
+  for (t= y1+r; t <= y2-r; t++) fill_span(x1, x2, t, color);
+
+  // Viertelkreise der Ecken (Midpoint), Mittelpunkte x1+r / x2-r
+  dx= 0; dy= r; d= 1-r;
+  while (dx <= dy)
+  {
+    if (dx)
+    {
+      fill_span(x1+r-dy, x2-r+dy, y1+r-dx, color);
+      fill_span(x1+r-dy, x2-r+dy, y2-r+dx, color);
+    }
+    if (d < 0)
+    {
+      d += 2*dx+3;
+    }
+    else
+    {
+      if (dx != dy)
+      {
+        fill_span(x1+r-dx, x2-r+dx, y1+r-dy, color);
+        fill_span(x1+r-dx, x2-r+dx, y2-r+dy, color);
+      }
+      d += 2*(dx-dy)+5;
+      dy--;
+    }
+    dx++;
+  }
+}
+
+/* -------------------------------------------------------------
+     fillpoly
+
+     Zeichnet ein ausgefuelltes Polygon (Scanline-Verfahren
+     mit Kantentabelle und aktiver Kantenliste, gerade-
+     ungerade Regel). Das Polygon wird automatisch geschlossen,
+     die Kontur gehoert zur Flaeche.
+
+        anz    : Anzahl der Eckpunkte (max. fillpoly_maxpoints)
+        *pts   : Eckpunkte x0,y0, x1,y1, ...
+        color  : 16 - Bit RGB565 Farbwert
+
+     Beispiel:
+
+        static const int dreieck[] = { 10,10, 60,30, 20,70 };
+        fillpoly(3, dreieck, rgbfromega(yellow));
+   ------------------------------------------------------------- */
+
+#define poly_y(k)     (pts[2*(((k) + anz) % anz) + 1])
+
+void fillpoly(int anz, const int *pts, uint16_t color)
+{
+  int     ey1[fillpoly_maxpoints], ey2[fillpoly_maxpoints];      // Kantentabelle: erste / letzte Zeile
+  int32_t ex[fillpoly_maxpoints], edx[fillpoly_maxpoints];       // x-Schnittpunkt und Steigung (16.16)
+  uint8_t ael[fillpoly_maxpoints];                               // aktive Kantenliste, nach x sortiert
+  int     i, i2, j, k, dir, n, na, next, y, ymax;
+  int     xa, ya, xb, yb;
+
+  if ((anz < 2) || (anz > fillpoly_maxpoints)) return;
+
+  // ---------------- Kantentabelle aufbauen ----------------
+  n= 0;
+  ymax= pts[1];
+  for (i= 0; i < anz; i++)
+  {
+    xa= pts[2*i];              ya= pts[2*i+1];
+    xb= pts[2*((i+1) % anz)];  yb= poly_y(i+1);
+    if (ya > ymax) ymax= ya;
+
+    if (ya == yb)                                  // waagrechte Kante direkt zeichnen
+    {
+      fill_span(xa, xb, ya, color);
+      continue;
+    }
+
+    // unterer Eckpunkt k der Kante und Richtung, in der die Kontur dort weiterlaeuft
+    if (ya < yb) { k= i+1; dir=  1; }
+            else { k= i;   dir= -1; j= xa; xa= xb; xb= j; j= ya; ya= yb; yb= j; }
+
+    // nach erster Zeile sortiert einfuegen
+    j= n;
+    while ((j > 0) && (ey1[j-1] > ya))
+    {
+      ey1[j]= ey1[j-1]; ey2[j]= ey2[j-1]; ex[j]= ex[j-1]; edx[j]= edx[j-1];
+      j--;
+    }
+    ey1[j]= ya;
+    ey2[j]= yb;
+    edx[j]= ((int32_t)(xb-xa) << 16) / (yb-ya);
+    ex[j]= ((int32_t)xa << 16) + 0x8000;
+    n++;
+
+    // waagrechte Kanten ueberspringen, laeuft die Kontur danach weiter nach
+    // unten (Durchgangspunkt), gehoert die untere Zeile der Folgekante
+    i2= k + dir;
+    while ((poly_y(i2) == yb) && (i2 != k + dir*anz)) i2 += dir;
+    if (poly_y(i2) > yb) ey2[j]--;
+  }
+  if (!n) return;
+
+  // ---------------- Scanlines ----------------
+  na= 0;
+  next= 0;
+  for (y= ey1[0]; y <= ymax; y++)
+  {
+    while ((next < n) && (ey1[next] == y)) ael[na++]= next++;      // neue Kanten aktivieren
+
+    j= 0;                                                          // beendete Kanten entfernen
+    for (i= 0; i < na; i++)
+      if (ey2[ael[i]] >= y) ael[j++]= ael[i];
+    na= j;
+
+    for (i= 1; i < na; i++)                                        // nach x sortieren
+    {
+      k= ael[i];
+      for (j= i; (j > 0) && (ex[ael[j-1]] > ex[k]); j--) ael[j]= ael[j-1];
+      ael[j]= k;
+    }
+
+    for (i= 0; i+1 < na; i += 2)
+      fill_span(ex[ael[i]] >> 16, ex[ael[i+1]] >> 16, y, color);
+
+    for (i= 0; i < na; i++) ex[ael[i]] += edx[ael[i]];
+    if ((!na) && (next >= n)) break;
+  }
+}
+
+/* -------------------------------------------------------------
+     filltriangle
+
+     Zeichnet ein ausgefuelltes Dreieck
+
+        x0,y0 .. x2,y2 : Eckpunkte
+        color          : 16 - Bit RGB565 Farbwert
+   ------------------------------------------------------------- */
+void filltriangle(int x0, int y0, int x1, int y1, int x2, int y2, uint16_t color)
+{
+  int pts[6];
+
+  pts[0]= x0; pts[1]= y0;
+  pts[2]= x1; pts[3]= y1;
+  pts[4]= x2; pts[5]= y2;
+  fillpoly(3, pts, color);
+}
@@ -0,0 +1,239 @@
+/* -------------------------------------------------------
+                         tft_sprite.c
+
+     Sprites mit Hintergrundsicherung (save-under) fuer
+     tftdisplay.c
+
+     Ein bewegtes Objekt wird ueblicherweise geloescht
+     (in der Hintergrundfarbe nachgezeichnet) und an der
+     neuen Position wieder gezeichnet, jeweils Pixel fuer
+     Pixel mit putpixel (11 Bytes Adressierung fuer 2 Bytes
+     Farbe). Das Objekt ist dabei kurz nicht zu sehen (es
+     flackert) und ein darunter liegender Hintergrund wird
+     zerstoert.
+
+     Hier wird fuer jedes Sprite der Hintergrund unter dem
+     Sprite gesichert. Beim Verschieben wird das Rechteck,
+     das alte und neue Position umschliesst, im RAM aufge-
+     baut (gesicherter Hintergrund, neuer Hintergrund,
+     Sprite darueber) und in einem einzigen Fenster per
+     tft_window_begin / tft_push_pixels gesendet. Jedes
+     Pixel wird genau einmal uebertragen.
+
+     Ist das umschliessende Rechteck groesser als der
+     Sendepuffer (tft_spritebuf) oder teurer als zwei ein-
+     zelne Fenster, werden alte und neue Position getrennt
+     gesendet.
+
+     Sprite-Bild (im Flash):
+
+       img[0]          : Breite
+       img[1]          : Hoehe
+       img[2]          : transparente Farbe (wird nicht
+                         gezeichnet, der Hintergrund bleibt
+                         sichtbar)
+       img[3] ...      : Breite * Hoehe Farbwerte RGB565,
+                         zeilenweise
+
+     Hintergrund:
+
+     Das Display-Ram kann ueber die verwendeten Anschluesse
+     (kein MISO bei SPI, kein RD beim Parallelbus) nicht
+     gelesen werden. Den Hintergrund an einer Koordinate
+     liefert deshalb die bei tft_sprite_init angegebene
+     Funktion bkget (z.B. aus dem Spielfeld errechnet),
+     ohne Funktion (NULL) ist der Hintergrund bkcolor.
+     bkget wird nur fuer Pixel aufgerufen, die nicht schon
+     im gesicherten Hintergrund enthalten sind.
+
+     Wird unter einem sichtbaren Sprite gezeichnet, ist das
+     Sprite vorher mit tft_sprite_hide zu entfernen und an-
+     schliessend mit tft_sprite_show neu zu setzen. Sprites
+     duerfen sich gegenseitig nicht ueberlappen und muessen
+     vollstaendig im Display liegen.
+
+     Dieses Modul wird von tftdisplay.c eingebunden
+     (tft_sprite == 1 in tftdisplay.h).
+
+     Beispiel:
+
+       static const uint16_t ball_spr[] =
+       {
+         3, 3, 0xf81f,
+         0xf81f, 0xffff, 0xf81f,
+         0xffff, 0xffff, 0xffff,
+         0xf81f, 0xffff, 0xf81f
+       };
+
+       tft_sprite_init(0, ball_spr, NULL);
+       while(1)
+       {
+         x++;
+         tft_sprite_show(0, x, y);
+       }
+   ------------------------------------------------------ */
+
+#if (tft_spritebuf < tft_spritepix)
+  #error "tft_spritebuf muss mindestens tft_spritepix Pixel aufnehmen"
+#endif
+
+static const uint16_t *spr_img[tft_spriteanz];                  // Bild im Flash, NULL : nicht belegt
+static uint16_t (*spr_bkget[tft_spriteanz])(int x, int y);      // Funktion fuer den Hintergrund
+static int16_t  spr_x[tft_spriteanz], spr_y[tft_spriteanz];     // Position (linke obere Ecke)
+static uint8_t  spr_visible[tft_spriteanz];                     // 1 : Sprite ist gezeichnet
+static uint16_t spr_save[tft_spriteanz][tft_spritepix];         // gesicherter Hintergrund
+
+static uint16_t spr_buf[tft_spritebuf];                         // Sendepuffer
+static uint16_t spr_newsave[tft_spritepix];                     // Hintergrund an der neuen Position
+
+/* ----------------------------------------------------------
+     spr_background
+
+     liefert den Hintergrund unter Pixel x,y: aus dem ge-
+     sicherten Hintergrund, wenn x,y unter der bisherigen
+     Position liegt, sonst ueber bkget bzw. bkcolor
+   ---------------------------------------------------------- */
+static uint16_t spr_background(uint8_t nr, int x, int y)
+{
+  int w, h;
+
+  w= spr_img[nr][0];
+  h= spr_img[nr][1];
+  if ((spr_visible[nr]) &&
+      (x >= spr_x[nr]) && (x < spr_x[nr] + w) && (y >= spr_y[nr]) && (y < spr_y[nr] + h))
+    return spr_save[nr][(y - spr_y[nr]) * w + (x - spr_x[nr])];
+
+  if (spr_bkget[nr]) return spr_bkget[nr](x, y);
+  return bkcolor;
+}
+
+/* ----------------------------------------------------------
+     spr_compose
+
+     baut den Bereich x1,y1 .. x2,y2 in spr_buf auf: inner-
+     halb der neuen Position nx,ny das Sprite (transparente
+     Pixel mit Hintergrund), ausserhalb den Hintergrund.
+     Der Hintergrund an der neuen Position wird in
+     spr_newsave vermerkt.
+   ---------------------------------------------------------- */
+static void spr_compose(uint8_t nr, int nx, int ny, int x1, int y1, int x2, int y2)
+{
+  const uint16_t *img;
+  uint16_t *p, bk;
+  int       x, y, w, h, i;
+
+  img= spr_img[nr];
+  w= img[0]; h= img[1];
+  p= spr_buf;
+
+  for (y= y1; y <= y2; y++)
+  {
+    for (x= x1; x <= x2; x++)
+    {
+      bk= spr_background(nr, x, y);
+      if ((x >= nx) && (x < nx + w) && (y >= ny) && (y < ny + h))
+      {
+        i= (y - ny) * w + (x - nx);
+        spr_newsave[i]= bk;
+        if (img[3 + i] != img[2]) bk= img[3 + i];
+      }
+      *p++= bk;
+    }
+  }
+}
+
+/* ----------------------------------------------------------
+     spr_send
+
+     sendet spr_buf in das Fenster x1,y1 .. x2,y2
+   ---------------------------------------------------------- */
+static void spr_send(const uint16_t *buf, int x1, int y1, int x2, int y2)
+{
+  tft_window_begin(x1, y1, x2, y2);
+  tft_push_pixels(buf, (x2 - x1 + 1) * (y2 - y1 + 1));
+  tft_window_end();
+}
+
+/* ----------------------------------------------------------
+     tft_sprite_init
+
+     weist einem Sprite ein Bild und die Funktion fuer den
+     Hintergrund zu. Das Sprite ist danach nicht sichtbar.
+
+       nr    : Nummer des Sprites (0 .. tft_spriteanz-1)
+       img   : Bild (Breite, Hoehe, transparente Farbe,
+               Farbwerte), Breite * Hoehe hoechstens
+               tft_spritepix, sonst wird das Sprite nicht
+               belegt
+       bkget : liefert den Hintergrund an einer Koordinate,
+               NULL : bkcolor
+   ---------------------------------------------------------- */
+void tft_sprite_init(uint8_t nr, const uint16_t *img, uint16_t (*bkget)(int x, int y))
+{
+  if (nr >= tft_spriteanz) return;
+
+  spr_visible[nr]= 0;
+  spr_bkget[nr]= bkget;
+  spr_img[nr]= ((img[0] * img[1]) <= tft_spritepix) ? img : NULL;
+}
+
+/* ----------------------------------------------------------
+     tft_sprite_show
+
+     zeichnet ein Sprite an Position x,y. Ist das Sprite
+     bereits sichtbar, wird die alte Position mit dem ge-
+     sicherten Hintergrund im selben Fenster wiederher-
+     gestellt.
+   ---------------------------------------------------------- */
+void tft_sprite_show(uint8_t nr, int x, int y)
+{
+  int w, h, x1, y1, x2, y2, n;
+
+  if ((nr >= tft_spriteanz) || (!spr_img[nr])) return;
+  if ((spr_visible[nr]) && (x == spr_x[nr]) && (y == spr_y[nr])) return;
+
+  w= spr_img[nr][0];
+  h= spr_img[nr][1];
+
+  x1= x; y1= y; x2= x + w - 1; y2= y + h - 1;
+  if (spr_visible[nr])
+  {
+    // Rechteck ueber alte und neue Position
+    if (spr_x[nr] < x1) x1= spr_x[nr];
+    if (spr_y[nr] < y1) y1= spr_y[nr];
+    if (spr_x[nr] + w - 1 > x2) x2= spr_x[nr] + w - 1;
+    if (spr_y[nr] + h - 1 > y2) y2= spr_y[nr] + h - 1;
+
+    // ein Fenster, wenn es in den Puffer passt und nicht mehr Pixel sendet als
+    // zwei einzelne Fenster (Adressierung eines Fensters etwa 6 Pixel)
+    n= (x2 - x1 + 1) * (y2 - y1 + 1);
+    if ((n > tft_spritebuf) || (n > 2 * w * h + 6))
+    {
+      spr_send(spr_save[nr], spr_x[nr], spr_y[nr], spr_x[nr] + w - 1, spr_y[nr] + h - 1);
+      spr_visible[nr]= 0;
+      x1= x; y1= y; x2= x + w - 1; y2= y + h - 1;
+    }
+  }
+
+  spr_compose(nr, x, y, x1, y1, x2, y2);
+  spr_send(spr_buf, x1, y1, x2, y2);
+
+  for (n= 0; n < w * h; n++) spr_save[nr][n]= spr_newsave[n];
+  spr_x[nr]= x;
+  spr_y[nr]= y;
+  spr_visible[nr]= 1;
+}
+
+/* ----------------------------------------------------------
+     tft_sprite_hide
+
+     stellt den Hintergrund unter einem sichtbaren Sprite
+     wieder her
+   ---------------------------------------------------------- */
+void tft_sprite_hide(uint8_t nr)
+{
+  if ((nr >= tft_spriteanz) || (!spr_img[nr]) || (!spr_visible[nr])) return;
+
+  spr_send(spr_save[nr], spr_x[nr], spr_y[nr], spr_x[nr] + spr_img[nr][0] - 1, spr_y[nr] + spr_img[nr][1] - 1);
+  spr_visible[nr]= 0;
+}
@@ -0,0 +1,479 @@
+/* -------------------------------------------------------
+                         tft_tiles.c
+
+     Kachelpuffer (Off-Screen Framebuffer) fuer tftdisplay.c
+
+     Bei eingeschaltetem Puffer schreiben putpixel und die
+     Fensterausgabe (und damit alle Zeichen-, Text- und
+     Bildfunktionen) nicht auf das Display, sondern in
+     Kacheln von 32x32 Pixel (RGB565) im RAM. Fuer jede
+     Kachel wird ein Rechteck der geaenderten Pixel mitge-
+     fuehrt, tft_tiles_flush sendet nur diese Rechtecke
+     per Fensterausgabe an das Display.
+
+     Ein Pixel, das innerhalb eines Frames geloescht und
+     wieder gezeichnet wird (Sprite verschieben) wird nur
+     einmal (oder gar nicht) uebertragen, das Display
+     flackert nicht mehr.
+
+     Da das Display-Ram nicht gelesen werden kann, ist der
+     Inhalt einer Kachel zunaechst unbekannt, fuer jedes
+     Pixel wird in einer Bitmaske vermerkt, ob es bekannt
+     ist. Unbekannte Pixel werden nicht gesendet.
+
+     Es werden tft_tilecount Kacheln gehalten (Ram-Bedarf
+     je Kachel: 2048 Bytes Pixel, 128 Bytes Bitmaske,
+     6 Bytes Verwaltung). Wird eine weitere Kachel benoetigt,
+     wird die am laengsten nicht benutzte gesendet und neu
+     vergeben.
+
+     Die Kacheln liegen im logischen Koordinatensystem, vor
+     einem Wechsel von outmode ist tft_tiles_flush aufzu-
+     rufen. Gesendet wird in der Reihenfolge des Display-
+     Rams, ein Rechteck kostet so in jeder Ausgaberichtung
+     nur ein Fenster.
+
+     Dieses Modul wird von tftdisplay.c eingebunden
+     (tft_tilecache == 1 in tftdisplay.h).
+
+     Beispiel:
+
+       tft_tiles_enable(1);
+       while(1)
+       {
+         sprite_draw(x, y, 0);         // loeschen
+         x++;
+         sprite_draw(x, y, 1);         // neu zeichnen
+         tft_tiles_flush();            // einmal je Frame
+       }
+   ------------------------------------------------------ */
+
+#define tile_size       32
+#define tile_shift       5
+#define tile_free     0xff                  // Kennung fuer unbenutzte Kachel
+
+static uint16_t tile_pix[tft_tilecount][tile_size * tile_size];   // Farbwerte der Kacheln
+static uint32_t tile_known[tft_tilecount][tile_size];             // je Zeile: Bit x = 1 => Pixel bekannt
+static uint8_t  tile_tx[tft_tilecount];                           // Kachelposition (in Kacheln)
+static uint8_t  tile_ty[tft_tilecount];
+static uint8_t  tile_dx1[tft_tilecount], tile_dy1[tft_tilecount]; // geaenderter Bereich innerhalb der Kachel
+static uint8_t  tile_dx2[tft_tilecount], tile_dy2[tft_tilecount]; // dx1 > dx2 : Kachel unveraendert
+static uint16_t tile_stamp[tft_tilecount];                        // Zeitstempel der letzten Benutzung
+
+static uint16_t tile_clock = 0;
+static uint8_t  tile_last  = 0;             // zuletzt benutzte Kachel
+static uint8_t  tiles_on   = 0;             // 1 : Zeichenfunktionen schreiben in die Kacheln
+
+// aus tftdisplay.c, dort erst nach dem Einbinden dieses Moduls definiert
+#if (ili9225 == 0)
+  static void tft_physxy(int x, int y, int *col, int *row);
+#endif
+static void tft_setwindow(int c1, int r1, int c2, int r2);
+static inline void tft_datamode(void);
+static inline void tft_stream16(uint16_t c);
+
+/* ----------------------------------------------------------
+     tile_clean
+
+     markiert den geaenderten Bereich einer Kachel als leer
+   ---------------------------------------------------------- */
+static void tile_clean(uint8_t t)
+{
+  tile_dx1[t]= tile_size; tile_dx2[t]= 0;
+  tile_dy1[t]= tile_size; tile_dy2[t]= 0;
+}
+
+/* ----------------------------------------------------------
+     tile_complete
+
+     1 : alle Pixel des geaenderten Bereichs der Kachel t
+         sind bekannt
+   ---------------------------------------------------------- */
+static uint8_t tile_complete(uint8_t t)
+{
+  int      y, w;
+  uint32_t mask;
+
+  w= tile_dx2[t] - tile_dx1[t] + 1;
+  mask= (w == tile_size) ? 0xffffffff : (((uint32_t)1 << w) - 1) << tile_dx1[t];
+  for (y= tile_dy1[t]; y <= tile_dy2[t]; y++)
+    if ((tile_known[t][y] & mask) != mask) return 0;
+  return 1;
+}
+
+/* ----------------------------------------------------------
+     tile_find
+
+     Index der Kachel an Kachelposition tx,ty, tft_tilecount
+     wenn diese nicht im Puffer ist (ohne neu zu vergeben)
+   ---------------------------------------------------------- */
+static uint8_t tile_find(uint8_t tx, uint8_t ty)
+{
+  uint8_t t;
+
+  for (t= 0; t < tft_tilecount; t++)
+    if ((tile_tx[t] == tx) && (tile_ty[t] == ty)) break;
+  return t;
+}
+
+/* ----------------------------------------------------------
+     tile_rect_out
+
+     sendet das Rechteck x1,y1 - x2,y2 (logische Koordina-
+     ten) aus den Kacheln an das Display. Alle Pixel des
+     Rechtecks muessen bekannt sein, es darf ueber mehrere
+     Kacheln reichen, die alle im Puffer sind.
+
+     Das Rechteck ist auch physikalisch ein Rechteck: es wird
+     ein Fenster gesetzt und die Pixel in der Reihenfolge des
+     Display-Rams gesendet, fuer jede physikalische Spalte
+     und Reihe ergibt sich der Schritt im logischen System
+     aus tft_physxy. ILI9225: ueber die Fensterausgabe.
+   ---------------------------------------------------------- */
+static void tile_rect_out(int x1, int y1, int x2, int y2)
+{
+  int      x, y;
+  uint8_t  t, tx, ty;
+  #if (ili9225 == 0)
+    int    c1, r1, c2, r2, cx, rx, cy, ry, c, r, xs, ys;
+  #else
+    int    xe;
+  #endif
+
+  #if (ili9225 == 0)
+    tft_physxy(x1, y1, &c1, &r1);
+    tft_physxy(x1+1, y1, &cx, &rx);             // physikalischer Schritt je logischem x
+    tft_physxy(x1, y1+1, &cy, &ry);             // dto. je logischem y
+    tft_physxy(x2, y2, &c2, &r2);
+    cx -= c1; rx -= r1;
+    cy -= c1; ry -= r1;
+    // Drehung / Spiegelung: die Umkehrung ist die Transponierte, logischer
+    // Schritt je Spalte (cx,cy), je Reihe (rx,ry), Beginn in der Ecke mit
+    // kleinster Spalte und Reihe
+    xs= (cx + rx > 0) ? x1 : x2;
+    ys= (cy + ry > 0) ? y1 : y2;
+    if (c2 < c1) { c= c1; c1= c2; c2= c; }
+    if (r2 < r1) { r= r1; r1= r2; r2= r; }
+
+    tft_setwindow(c1, r1, c2, r2);
+    wrcmd(writereg);
+    win_restore= 1;
+    tft_datamode();
+
+    tx= ty= tile_free;
+    t= 0;
+    for (r= 0; r <= r2-r1; r++)
+    {
+      x= xs + r*rx;
+      y= ys + r*ry;
+      for (c= 0; c <= c2-c1; c++)
+      {
+        if (((x >> tile_shift) != tx) || ((y >> tile_shift) != ty))
+        {
+          tx= x >> tile_shift; ty= y >> tile_shift;
+          t= tile_find(tx, ty);
+        }
+        tft_stream16(tile_pix[t][((y & (tile_size-1)) << tile_shift) + (x & (tile_size-1))]);
+        x += cx;
+        y += cy;
+      }
+    }
+  #else
+    tft_window_begin(x1, y1, x2, y2);
+    for (y= y1; y <= y2; y++)
+    {
+      for (x= x1; x <= x2; x= xe + 1)
+      {
+        xe= (x | (tile_size-1)) < x2 ? (x | (tile_size-1)) : x2;
+        t= tile_find(x >> tile_shift, y >> tile_shift);
+        tft_push_pixels(&tile_pix[t][((y & (tile_size-1)) << tile_shift) + (x & (tile_size-1))], xe-x+1);
+      }
+    }
+    tft_window_end();
+  #endif
+}
+
+/* ----------------------------------------------------------
+     tile_send
+
+     sendet den geaenderten Bereich der Kachel t an das
+     Display. Ist der Bereich vollstaendig bekannt, wird er
+     mit einem einzigen Fenster uebertragen, ansonsten die
+     zusammenhaengenden bekannten Pixel, Zeilen mit gleicher
+     Maske gemeinsam.
+   ---------------------------------------------------------- */
+static void tile_send(uint8_t t)
+{
+  int      ox, oy, x, y, ye, x1, x2, w;
+  int      sx1, sy1, sx2, sy2, sxp, syp;
+  uint32_t mask;
+  uint8_t  on;
+
+  if (tile_dx1[t] > tile_dx2[t]) return;
+
+  // eine laufende (logische) Fensterausgabe sichern, tile_send wird auch
+  // beim Verdraengen einer Kachel innerhalb von tft_push_pixels aufgerufen
+  sx1= win_x1; sy1= win_y1; sx2= win_x2; sy2= win_y2;
+  sxp= win_xp; syp= win_yp;
+
+  on= tiles_on;
+  tiles_on= 0;                                // Fensterausgabe geht jetzt an das Display
+
+  ox= tile_tx[t] << tile_shift;
+  oy= tile_ty[t] << tile_shift;
+  x1= tile_dx1[t];
+  x2= tile_dx2[t];
+  w= x2 - x1 + 1;
+
+  if (tile_complete(t))
+  {
+    // Rechteck vollstaendig bekannt: ein Fenster
+    tile_rect_out(ox+x1, oy+tile_dy1[t], ox+x2, oy+tile_dy2[t]);
+  }
+  else
+  {
+    // aufeinander folgende Zeilen mit gleicher Maske bekannter Pixel bilden
+    // ein Band, je zusammenhaengendem Abschnitt des Bandes ein Fenster
+    mask= (w == tile_size) ? 0xffffffff : (((uint32_t)1 << w) - 1) << x1;
+    for (y= tile_dy1[t]; y <= tile_dy2[t]; y= ye + 1)
+    {
+      for (ye= y; (ye < tile_dy2[t]) && ((tile_known[t][ye+1] & mask) == (tile_known[t][y] & mask)); ye++);
+      x= x1;
+      while (x <= x2)
+      {
+        while ((x <= x2) && !(tile_known[t][y] & ((uint32_t)1 << x))) x++;
+        if (x > x2) break;
+        w= x;
+        while ((x <= x2) && (tile_known[t][y] & ((uint32_t)1 << x))) x++;
+        tile_rect_out(ox+w, oy+y, ox+x-1, oy+ye);
+      }
+    }
+  }
+
+  tile_clean(t);
+  tiles_on= on;
+
+  win_x1= sx1; win_y1= sy1; win_x2= sx2; win_y2= sy2;
+  win_xp= sxp; win_yp= syp;
+}
+
+/* ----------------------------------------------------------
+     tile_get
+
+     liefert den Index der Kachel an Kachelposition tx,ty.
+     Ist diese nicht im Puffer, wird eine freie oder die am
+     laengsten nicht benutzte Kachel gesendet und vergeben.
+   ---------------------------------------------------------- */
+static uint8_t tile_get(uint8_t tx, uint8_t ty)
+{
+  uint8_t t, old, y;
+
+  if ((tile_tx[tile_last] == tx) && (tile_ty[tile_last] == ty)) return tile_last;
+
+  old= 0;
+  for (t= 0; t < tft_tilecount; t++)
+  {
+    if ((tile_tx[t] == tx) && (tile_ty[t] == ty)) break;
+    if (tile_tx[t] == tile_free) old= t;
+    else if ((tile_tx[old] != tile_free) && ((uint16_t)(tile_clock - tile_stamp[t]) > (uint16_t)(tile_clock - tile_stamp[old]))) old= t;
+  }
+
+  if (t == tft_tilecount)
+  {
+    t= old;
+    if (tile_tx[t] != tile_free) tile_send(t);
+    tile_tx[t]= tx;
+    tile_ty[t]= ty;
+    for (y= 0; y < tile_size; y++) tile_known[t][y]= 0;
+    tile_clean(t);
+  }
+
+  tile_stamp[t]= ++tile_clock;
+  tile_last= t;
+  return t;
+}
+
+/* ----------------------------------------------------------
+     tile_putpixel
+
+     schreibt einen Punkt in den Kachelpuffer. Hat das Pixel
+     bereits diesen Farbwert, wird es nicht als geaendert
+     markiert.
+   ---------------------------------------------------------- */
+static void tile_putpixel(int x, int y, uint16_t color)
+{
+  uint8_t  t;
+  uint16_t *p;
+  uint32_t m;
+
+  if ((x < 0) || (y < 0)) return;
+  if ((outmode == 1) || (outmode == 2))        // x- und y-Achse vertauscht
+  {
+    if ((x >= _yres) || (y >= _xres)) return;
+  }
+  else
+  {
+    if ((x >= _xres) || (y >= _yres)) return;
+  }
+
+  t= tile_get(x >> tile_shift, y >> tile_shift);
+  x &= tile_size-1;
+  y &= tile_size-1;
+  p= &tile_pix[t][(y << tile_shift) + x];
+  m= (uint32_t)1 << x;
+
+  if ((tile_known[t][y] & m) && (*p == color)) return;
+
+  *p= color;
+  tile_known[t][y] |= m;
+  if (x < tile_dx1[t]) tile_dx1[t]= x;
+  if (x > tile_dx2[t]) tile_dx2[t]= x;
+  if (y < tile_dy1[t]) tile_dy1[t]= y;
+  if (y > tile_dy2[t]) tile_dy2[t]= y;
+}
+
+/* ----------------------------------------------------------
+     tile_fillrect
+
+     fuellt ein Rechteck im Kachelpuffer, Kachel fuer Kachel
+     (jede Kachel wird nur einmal angefordert)
+   ---------------------------------------------------------- */
+static void tile_fillrect(int x1, int y1, int x2, int y2, uint16_t color)
+{
+  int tx, ty, x, y, xe, ye;
+
+  if (x1 < 0) x1= 0;
+  if (y1 < 0) y1= 0;
+  for (ty= y1 >> tile_shift; ty <= (y2 >> tile_shift); ty++)
+  {
+    for (tx= x1 >> tile_shift; tx <= (x2 >> tile_shift); tx++)
+    {
+      ye= (ty << tile_shift) + tile_size-1;
+      if (ye > y2) ye= y2;
+      xe= (tx << tile_shift) + tile_size-1;
+      if (xe > x2) xe= x2;
+      for (y= (ty << tile_shift) > y1 ? (ty << tile_shift) : y1; y <= ye; y++)
+        for (x= (tx << tile_shift) > x1 ? (tx << tile_shift) : x1; x <= xe; x++)
+          tile_putpixel(x, y, color);
+    }
+  }
+}
+
+/* ----------------------------------------------------------
+     tft_tiles_invalidate
+
+     verwirft alle Kacheln ohne sie zu senden (z.B. nachdem
+     direkt auf das Display gezeichnet wurde)
+   ---------------------------------------------------------- */
+void tft_tiles_invalidate(void)
+{
+  uint8_t t;
+
+  for (t= 0; t < tft_tilecount; t++)
+  {
+    tile_tx[t]= tile_free;
+    tile_ty[t]= tile_free;
+    tile_clean(t);
+  }
+  tile_last= 0;
+}
+
+/* ----------------------------------------------------------
+     tft_tiles_flush
+
+     sendet alle geaenderten Bereiche an das Display. Wird
+     einmal je Frame aufgerufen, die Kacheln bleiben als
+     bekannter Displayinhalt erhalten.
+
+     Vollstaendig bekannte Bereiche benachbarter Kacheln
+     werden zusammengefasst, wenn sie zusammen wieder ein
+     Rechteck ergeben (gleiche Zeilen und in x aneinander
+     grenzend oder gleiche Spalten und in y aneinander
+     grenzend). Ein zusammengefasstes Rechteck wird mit
+     einem einzigen Fenster gesendet, eine Figur, die
+     ueber eine Kachelgrenze hinausragt, kostet so nur
+     einmal die Adressierung.
+   ---------------------------------------------------------- */
+void tft_tiles_flush(void)
+{
+  int16_t  rx1[tft_tilecount], ry1[tft_tilecount];
+  int16_t  rx2[tft_tilecount], ry2[tft_tilecount];
+  int      n, i, j;
+  int      sx1, sy1, sx2, sy2, sxp, syp;
+  uint8_t  t, on, merged;
+
+  // Bereiche mit unbekannten Pixeln einzeln, die anderen sammeln
+  n= 0;
+  for (t= 0; t < tft_tilecount; t++)
+  {
+    if ((tile_tx[t] == tile_free) || (tile_dx1[t] > tile_dx2[t])) continue;
+    if (!tile_complete(t)) { tile_send(t); continue; }
+    rx1[n]= (tile_tx[t] << tile_shift) + tile_dx1[t];
+    rx2[n]= (tile_tx[t] << tile_shift) + tile_dx2[t];
+    ry1[n]= (tile_ty[t] << tile_shift) + tile_dy1[t];
+    ry2[n]= (tile_ty[t] << tile_shift) + tile_dy2[t];
+    n++;
+  }
+  if (!n) return;
+
+  // aneinander grenzende Rechtecke zusammenfassen, bis keines mehr passt
+  do
+  {
+    merged= 0;
+    for (i= 0; i < n; i++)
+    {
+      for (j= 0; j < n; j++)
+      {
+        if (i == j) continue;
+        if ((ry1[i] == ry1[j]) && (ry2[i] == ry2[j]) && (rx2[i]+1 == rx1[j]))
+          rx2[i]= rx2[j];
+        else if ((rx1[i] == rx1[j]) && (rx2[i] == rx2[j]) && (ry2[i]+1 == ry1[j]))
+          ry2[i]= ry2[j];
+        else
+          continue;
+        n--;
+        rx1[j]= rx1[n]; rx2[j]= rx2[n];
+        ry1[j]= ry1[n]; ry2[j]= ry2[n];
+        if (i == n) i= j;
+        merged= 1;
+        j= -1;                                // mit dem vergroesserten Rechteck von vorn
+      }
+    }
+  } while (merged);
+
+  sx1= win_x1; sy1= win_y1; sx2= win_x2; sy2= win_y2;
+  sxp= win_xp; syp= win_yp;
+  on= tiles_on;
+  tiles_on= 0;
+
+  for (i= 0; i < n; i++) tile_rect_out(rx1[i], ry1[i], rx2[i], ry2[i]);
+
+  for (t= 0; t < tft_tilecount; t++)
+    if (tile_tx[t] != tile_free) tile_clean(t);
+
+  tiles_on= on;
+  win_x1= sx1; win_y1= sy1; win_x2= sx2; win_y2= sy2;
+  win_xp= sxp; win_yp= syp;
+}
+
+/* ----------------------------------------------------------
+     tft_tiles_enable
+
+     on = 1 : Zeichenfunktionen schreiben in den Kachelpuffer
+     on = 0 : Puffer wird gesendet und verworfen, Ausgaben
+              gehen wieder direkt an das Display
+   ---------------------------------------------------------- */
+void tft_tiles_enable(uint8_t on)
+{
+  if (on)
+  {
+    if (!tiles_on) tft_tiles_invalidate();
+    tiles_on= 1;
+  }
+  else
+  {
+    if (tiles_on) tft_tiles_flush();
+    tiles_on= 0;
+    tft_tiles_invalidate();
+  }
+}
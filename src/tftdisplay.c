@@ -144,6 +144,41 @@ uint8_t  fontsizey = 8;
 uint16_t tftwidth  = _xres;
 uint16_t tftheight = _yres;
 
+// ------------------------------------
+//   Fensterausgabe (Burst-Transfer)
+// ------------------------------------
+
+static int     win_x1, win_y1;      // logisches Ausgabefenster (linke obere Ecke)
+static int     win_x2, win_y2;      // dto. rechte untere Ecke
+static int     win_xp, win_yp;      // aktuelle Schreibposition innerhalb des Fensters
+static uint8_t win_direct  = 0;     // 1 : Fenster ist im Controller als Ganzes gesetzt
+static uint8_t win_restore = 0;     // 1 : Adressbereich des Controllers ist eingeschraenkt und
+                                    //     muss vor dem naechsten putpixel wiederhergestellt werden
+
+// ------------------------------------
+//   Kachelpuffer (Off-Screen)
+// ------------------------------------
+
+#if (tft_tilecache == 1)
+  #include "tft_tiles.c"
+#endif
+
+// ------------------------------------
+//   Textkonsole (Hardware-Scrolling)
+// ------------------------------------
+
+#if (tft_console == 1)
+  #include "tft_console.c"
+#endif
+
+// ------------------------------------
+//   Sprites (Hintergrundsicherung)
+// ------------------------------------
+
+#if (tft_sprite == 1)
+  #include "tft_sprite.c"
+#endif
+
 // ------------------------------------
 //           Turtle-Grafiken
 // ------------------------------------
@@ -156,6 +191,18 @@ int t_lastx, t_lasty;       // x,y - Positionen der letzten Zeichenaktion von mo
    ------------------------------------------------------------- */
 
 #if (USE_SPI_TFT == 1)
+
+  #if (tft_dma == 1)
+    static volatile uint8_t dma_busy  = 0;       // 1 : DMA-Kanal sendet noch
+    static uint8_t          dma_spi16 = 0;       // 1 : SPI steht noch im 16-Bit Modus (Transfer
+                                                 //     muss vor dem naechsten Zugriff beendet werden)
+
+    // vor jedem Zugriff auf den SPI / D/C-Pin muss ein laufender DMA-Transfer beendet sein
+    #define tft_dma_sync()     { if (dma_spi16) tft_dma_wait(); }
+  #else
+    #define tft_dma_sync()
+  #endif
+
   /* -------------------------------------------------------------
      spi_init
 
@@ -189,6 +236,10 @@ int t_lastx, t_lasty;       // x,y - Positionen der letzten Zeichenaktion von mo
 
     spi_enable(SPI1);
 
+    #if (tft_dma == 1)
+      rcc_periph_clock_enable(RCC_DMA1);
+      nvic_enable_irq(NVIC_DMA1_CHANNEL3_IRQ);
+    #endif
   }
 
   /* -------------------------------------------------------------
@@ -199,6 +250,7 @@ int t_lastx, t_lasty;       // x,y - Positionen der letzten Zeichenaktion von mo
      ------------------------------------------------------------- */
   void spi_out(uint8_t data)
   {
+    tft_dma_sync();
     spi_send(SPI1, (uint8_t) data);
   }
 
@@ -239,6 +291,7 @@ int t_lastx, t_lasty;       // x,y - Positionen der letzten Zeichenaktion von mo
      ------------------------------------------------------------- */
   void wrcmd(uint8_t cmd)
   {
+    tft_dma_sync();
     dc_clr();                             // C/D = 0 Kommandomodus
     spi_lcdout(cmd);                         // senden
 
@@ -258,6 +311,7 @@ int t_lastx, t_lasty;       // x,y - Positionen der letzten Zeichenaktion von mo
      ------------------------------------------------------------- */
   void wrdata(uint8_t data)
   {
+    tft_dma_sync();
     dc_set();                             // C/D = 1 Kommandomodus
     spi_lcdout(data);                        // senden/
   }
@@ -276,11 +330,208 @@ int t_lastx, t_lasty;       // x,y - Positionen der letzten Zeichenaktion von mo
       int data1 = data>>8;
       int data2 = data&0xff;
 
+      tft_dma_sync();
       dc_set();
       spi_lcdout(data1);
       spi_lcdout(data2);
   }
 
+  #if (tft_dma == 1)
+
+  /* -------------------------------------------------------------
+                  DMA-Transfer SPI1 ueber DMA1 Kanal 3
+
+       Fuellfunktionen und Pufferausgaben werden ueber den DMA-
+       Controller gesendet, die CPU ist waehrend des Transfers
+       frei. Der SPI wird hierfuer auf 16-Bit Datenrahmen umge-
+       schaltet (MSB zuerst, entspricht der Bytefolge von
+       wrdata16).
+
+       Ein DMA-Transfer umfasst maximal 65535 Datenrahmen,
+       groessere Mengen werden im Interrupt nachgeladen.
+
+       Jeder nachfolgende Zugriff auf das Display (wrcmd, wrdata
+       etc.) wartet auf das Ende des Transfers und schaltet den
+       SPI zurueck auf 8-Bit.
+     ------------------------------------------------------------- */
+
+  static uint16_t dma_color;                     // Farbwert im Fuellmodus
+  static uintptr_t dma_memaddr;                  // aktuelle Speicheradresse (Controller: 32 Bit)
+  static uint8_t  dma_meminc;                    // 1 : Puffermodus, 0 : Fuellmodus
+  static uint32_t dma_remain;                    // noch zu sendende Datenrahmen
+  static void     (*dma_callback)(void) = 0;     // wird nach Ende des Transfers aufgerufen
+
+  /* -------------------------------------------------------------
+       tft_dma_next
+
+       startet den naechsten (max. 65535 Datenrahmen grossen)
+       Abschnitt des Transfers
+     ------------------------------------------------------------- */
+  static void tft_dma_next(void)
+  {
+    uint16_t anz;
+
+    anz= (dma_remain > 0xffff) ? 0xffff : dma_remain;
+    dma_remain -= anz;
+
+    dma_set_memory_address(DMA1, DMA_CHANNEL3, dma_memaddr);
+    dma_set_number_of_data(DMA1, DMA_CHANNEL3, anz);
+    if (dma_meminc) dma_memaddr += (uint32_t)anz * 2;
+    dma_enable_channel(DMA1, DMA_CHANNEL3);
+  }
+
+  /* -------------------------------------------------------------
+       tft_dma_start
+
+       richtet DMA1 Kanal 3 fuer einen Transfer zum SPI1 ein und
+       startet diesen. Das Fenster im Display-Ram muss bereits
+       gesetzt sein.
+
+         memaddr  : Adresse der Daten
+         meminc   : 1 = Adresse wird erhoeht (Puffer)
+                    0 = Adresse bleibt stehen (Fuellfarbe)
+         n        : Anzahl 16-Bit Datenrahmen
+         callback : Funktion, die nach dem Transfer aufgerufen
+                    wird (oder 0)
+     ------------------------------------------------------------- */
+  static void tft_dma_start(uintptr_t memaddr, uint8_t meminc, uint32_t n, void (*callback)(void))
+  {
+    tft_dma_sync();
+
+    // letztes (Kommando)byte muss vollstaendig gesendet sein, bevor
+    // D/C und die Rahmenbreite umgeschaltet werden
+    while (!(SPI_SR(SPI1) & SPI_SR_TXE));
+    while (SPI_SR(SPI1) & SPI_SR_BSY);
+
+    dc_set();
+    spi_disable(SPI1);
+    spi_set_dff_16bit(SPI1);
+    spi_enable(SPI1);
+
+    dma_channel_reset(DMA1, DMA_CHANNEL3);
+    dma_set_peripheral_address(DMA1, DMA_CHANNEL3, (uintptr_t)&SPI1_DR);
+    dma_set_read_from_memory(DMA1, DMA_CHANNEL3);
+    dma_set_peripheral_size(DMA1, DMA_CHANNEL3, DMA_CCR_PSIZE_16BIT);
+    dma_set_memory_size(DMA1, DMA_CHANNEL3, DMA_CCR_MSIZE_16BIT);
+    if (meminc) dma_enable_memory_increment_mode(DMA1, DMA_CHANNEL3);
+           else dma_disable_memory_increment_mode(DMA1, DMA_CHANNEL3);
+    dma_set_priority(DMA1, DMA_CHANNEL3, DMA_CCR_PL_HIGH);
+    dma_enable_transfer_complete_interrupt(DMA1, DMA_CHANNEL3);
+
+    dma_memaddr= memaddr;
+    dma_meminc= meminc;
+    dma_remain= n;
+    dma_callback= callback;
+    dma_spi16= 1;
+    dma_busy= 1;
+
+    spi_enable_tx_dma(SPI1);
+    tft_dma_next();
+  }
+
+  /* -------------------------------------------------------------
+       dma1_channel3_isr
+
+       Interrupt nach Ende eines Abschnitts: naechsten Abschnitt
+       starten oder den Transfer als beendet markieren und die
+       Callbackfunktion aufrufen.
+
+       Achtung: die Callbackfunktion wird im Interrupt aufgerufen
+     ------------------------------------------------------------- */
+  void dma1_channel3_isr(void)
+  {
+    if (dma_get_interrupt_flag(DMA1, DMA_CHANNEL3, DMA_TCIF))
+    {
+      dma_clear_interrupt_flags(DMA1, DMA_CHANNEL3, DMA_TCIF);
+      dma_disable_channel(DMA1, DMA_CHANNEL3);
+
+      if (dma_remain)
+      {
+        tft_dma_next();
+      }
+      else
+      {
+        dma_busy= 0;
+        if (dma_callback) dma_callback();
+      }
+    }
+  }
+
+  /* -------------------------------------------------------------
+       tft_dma_busy
+
+       Rueckgabe: 1 = DMA-Transfer laeuft noch
+     ------------------------------------------------------------- */
+  uint8_t tft_dma_busy(void)
+  {
+    return dma_busy;
+  }
+
+  /* -------------------------------------------------------------
+       tft_dma_wait
+
+       wartet auf das Ende eines DMA-Transfers, wartet bis das
+       letzte Datum den SPI verlassen hat und schaltet den SPI
+       zurueck auf 8-Bit Datenrahmen
+     ------------------------------------------------------------- */
+  void tft_dma_wait(void)
+  {
+    if (!dma_spi16) return;
+
+    while (dma_busy);
+    while (!(SPI_SR(SPI1) & SPI_SR_TXE));
+    while (SPI_SR(SPI1) & SPI_SR_BSY);
+
+    spi_disable_tx_dma(SPI1);
+    spi_disable(SPI1);
+    spi_set_dff_8bit(SPI1);
+    spi_enable(SPI1);
+
+    dma_spi16= 0;
+  }
+
+  /* -------------------------------------------------------------
+       tft_dma_fill
+
+       sendet n mal den Farbwert color im Hintergrund in das
+       gesetzte Fenster des Display-Rams (Speicheradresse des
+       DMA wird nicht erhoeht)
+
+         color : RGB565 Farbwert
+         n     : Anzahl Pixel
+     ------------------------------------------------------------- */
+  void tft_dma_fill(uint16_t color, uint32_t n)
+  {
+    if (!n) return;
+    tft_dma_sync();
+    dma_color= color;
+    tft_dma_start((uintptr_t)&dma_color, 0, n, 0);
+  }
+
+  /* -------------------------------------------------------------
+       tft_dma_pixels
+
+       sendet n Farbwerte aus buf im Hintergrund in das ge-
+       setzte Fenster des Display-Rams. Der Puffer darf bis zum
+       Ende des Transfers nicht veraendert werden.
+
+         *buf     : Zeiger auf RGB565 Farbwerte
+         n        : Anzahl Pixel
+         callback : wird nach dem Transfer (im Interrupt) auf-
+                    gerufen, 0 = keine Funktion
+     ------------------------------------------------------------- */
+  void tft_dma_pixels(const uint16_t *buf, uint32_t n, void (*callback)(void))
+  {
+    if (!n)
+    {
+      if (callback) callback();
+      return;
+    }
+    tft_dma_start((uintptr_t)buf, 1, n, callback);
+  }
+
+  #endif      // tft_dma
+
   /* -------------------------------------------------------------
       lcd_init
 
@@ -341,6 +592,9 @@ int t_lastx, t_lasty;       // x,y - Positionen der letzten Zeichenaktion von mo
    ------------------------------------------------------------- */
 #if (USE_8BIT_TFT == 1)
 
+  // WR liegt bei beiden Boardversionen an PA1, Taktimpuls ohne Funktionsaufruf
+  #define lcd_wr_strobe()    { GPIO_BRR(GPIOA)= GPIO1; GPIO_BSRR(GPIOA)= GPIO1; }
+
   #if (boardversion == 0)
     void byteout(uint16_t val)
     {
@@ -355,10 +609,57 @@ int t_lastx, t_lasty;       // x,y - Positionen der letzten Zeichenaktion von mo
 
       gpio_port_write(GPIOB,outbye | 1);   // Reset auf 1 belassen
     }
+
+    // BSRR-Wort fuer GPIOB (PB6..PB13), nur die Datenpins werden veraendert
+    #define lcd_bsrr_b(v)    ( 0x3fc00000 | (((v) & 0xfc) << 4) | (((v) & 0x03) << 12) )
   #endif
 
   #if (boardversion == 1)
 
+    #if (tft_fastfill == 1)
+
+    /* -----------------------------------------------------
+         BSRR-Tabellen fuer die Byteausgabe
+
+         D0..D5 liegen auf GPIOB, D6 und D7 auf GPIOA. Jeder
+         Tabelleneintrag enthaelt im oberen Halbwort die
+         Resetbits aller Datenpins des Ports und im unteren
+         die zu setzenden Pins. Bei gleichzeitig gesetztem
+         Set- und Resetbit hat Set Vorrang, so genuegt ein
+         einziger Schreibzugriff je Port und Byte (statt acht
+         Bitabfragen und zwei Zugriffen je Port).
+
+         Fuer GPIOB ist nur D0..D5 relevant (64 Eintraege),
+         fuer GPIOA nur D6..D7 (4 Eintraege).
+       ----------------------------------------------------- */
+
+    #define bsrr_db(v)       ( 0x20ba0000                      \
+                             | (((v) & 0x01) ? 0x2000 : 0)     \
+                             | (((v) & 0x02) ? 0x0080 : 0)     \
+                             | (((v) & 0x04) ? 0x0002 : 0)     \
+                             | (((v) & 0x08) ? 0x0008 : 0)     \
+                             | (((v) & 0x10) ? 0x0020 : 0)     \
+                             | (((v) & 0x20) ? 0x0010 : 0) )
+    #define bsrr_db4(v)      bsrr_db(v), bsrr_db(v+1), bsrr_db(v+2), bsrr_db(v+3)
+    #define bsrr_db16(v)     bsrr_db4(v), bsrr_db4(v+4), bsrr_db4(v+8), bsrr_db4(v+12)
+
+    static const uint32_t bsrr_portb[64] =
+      { bsrr_db16(0), bsrr_db16(16), bsrr_db16(32), bsrr_db16(48) };
+
+    static const uint32_t bsrr_porta[4] =
+      { 0x81000000, 0x81008000, 0x81000100, 0x81008100 };   // PA15 = D6, PA8 = D7
+
+    #define lcd_bsrr_b(v)    ( bsrr_portb[(v) & 0x3f] )
+    #define lcd_bsrr_a(v)    ( bsrr_porta[((v) >> 6) & 0x03] )
+
+    void byteout(uint32_t val)
+    {
+      GPIO_BSRR(GPIOB)= lcd_bsrr_b(val);
+      GPIO_BSRR(GPIOA)= lcd_bsrr_a(val);
+    }
+
+    #else
+
     void byteout(uint32_t val)
     {
       uint32_t outbyeA = 0;
@@ -403,6 +704,9 @@ int t_lastx, t_lasty;       // x,y - Positionen der letzten Zeichenaktion von mo
       GPIO_BSRR(GPIOB) = outbyeB;
       GPIO_BSRR(GPIOA) = outbyeA;
     }
+
+    #endif    // tft_fastfill
+
   #endif
 
   /* -------------------------------------------------------------
@@ -416,10 +720,80 @@ int t_lastx, t_lasty;       // x,y - Positionen der letzten Zeichenaktion von mo
   {
     byteout(val);
     // lcd_wr Taktimpuls, ggf. ein Delay dazwischen
-    lcd_wr_clr();
-    lcd_wr_set();
+    #if (tft_fastfill == 1)
+      lcd_wr_strobe();
+    #else
+      lcd_wr_clr();
+      lcd_wr_set();
+    #endif
+  }
+
+  #if (tft_fastfill == 1)
+
+  /* -------------------------------------------------------------
+       lcd_bus_fill
+
+       sendet n mal das 16-Bit Datum color an das Display (RS
+       muss bereits auf Daten stehen).
+
+       Die BSRR-Worte fuer High- und Lowbyte werden einmal
+       vor der Schleife berechnet, in der Schleife wird nur
+       noch in die Portregister geschrieben:
+
+         - High- und Lowbyte gleich (schwarz, weiss, ...):
+           das Byte wird einmal angelegt, danach wird nur
+           noch WR getaktet
+         - D6/D7 (GPIOA) gleich: je Byte ein Zugriff auf GPIOB
+         - sonst: je Byte ein Zugriff auf GPIOB und GPIOA
+     ------------------------------------------------------------- */
+  static void lcd_bus_fill(uint16_t color, uint32_t n)
+  {
+    uint8_t  hi, lo;
+    uint32_t hb, lb;
+    #if (boardversion == 1)
+      uint32_t ha, la;
+    #endif
+
+    if (!n) return;
+
+    hi= color >> 8;
+    lo= color & 0xff;
+    hb= lcd_bsrr_b(hi);
+    lb= lcd_bsrr_b(lo);
+
+    GPIO_BSRR(GPIOB)= hb;
+    #if (boardversion == 1)
+      ha= lcd_bsrr_a(hi);
+      la= lcd_bsrr_a(lo);
+      GPIO_BSRR(GPIOA)= ha;
+
+      if (ha != la)
+      {
+        while (n--)
+        {
+          GPIO_BSRR(GPIOB)= hb; GPIO_BSRR(GPIOA)= ha; lcd_wr_strobe();
+          GPIO_BSRR(GPIOB)= lb; GPIO_BSRR(GPIOA)= la; lcd_wr_strobe();
+        }
+        return;
+      }
+    #endif
+
+    if (hi == lo)
+    {
+      n <<= 1;
+      while (n--) lcd_wr_strobe();
+      return;
+    }
+
+    while (n--)
+    {
+      GPIO_BSRR(GPIOB)= hb; lcd_wr_strobe();
+      GPIO_BSRR(GPIOB)= lb; lcd_wr_strobe();
+    }
   }
 
+  #endif    // tft_fastfill
+
   /* -------------------------------------------------------------
        wrcmd
 
@@ -701,6 +1075,65 @@ void setpage(int startpage)
     wrdata16(startpage + rowofs);
 }
 
+/* ----------------------------------------------------------
+     tft_setwindow
+
+     setzt Start- und Endadresse fuer Spalte und Reihe im
+     Display-Ram (physikalische Koordinaten, Offsets wie
+     colofs / rowofs werden hier addiert)
+
+     ILI9225: coladdr / rowaddr sind dort nur der Adress-
+     zaehler, das Fenster liegt in eigenen Registern (0x36
+     .. 0x39). Fuer einfarbige Fuellungen und eindimen-
+     sionale Fenster ist die Zaehlrichtung (Entry Mode AM)
+     ohne Bedeutung.
+
+       c1,r1 : Spalte, Reihe linke obere Ecke
+       c2,r2 : Spalte, Reihe rechte untere Ecke
+   ---------------------------------------------------------- */
+static void tft_setwindow(int c1, int r1, int c2, int r2)
+{
+  #if (ili9225 == 1)
+    wrcmd(0x36);              // Fensterende horizontal
+    wrdata16(c2 + colofs);
+    wrcmd(0x37);              // Fensteranfang horizontal
+    wrdata16(c1 + colofs);
+    wrcmd(0x38);              // Fensterende vertikal
+    wrdata16(r2 + rowofs);
+    wrcmd(0x39);              // Fensteranfang vertikal
+    wrdata16(r1 + rowofs);
+
+    setcol(c1);
+    setpage(r1);
+  #else
+    wrcmd(coladdr);
+    wrdata16(c1 + colofs);
+    wrdata16(c2 + colofs);
+
+    wrcmd(rowaddr);
+    wrdata16(r1 + rowofs);
+    wrdata16(r2 + rowofs);
+  #endif
+}
+
+/* ----------------------------------------------------------
+     tft_window_restore
+
+     setzt den Adressbereich des Controllers nach einer
+     Fensterausgabe wieder auf das gesamte Display.
+     setcol / setpage schreiben nur die Startadresse, die
+     Endadresse muss deshalb das gesamte Display umfassen.
+   ---------------------------------------------------------- */
+static void tft_window_restore(void)
+{
+  #if (_yres == 128)
+    tft_setwindow(0, 32+_lcyofs, _xres-1, 32+_lcyofs+_yres-1);
+  #else
+    tft_setwindow(0, 0, _xres-1, _yres-1);
+  #endif
+  win_restore= 0;
+}
+
 /* ----------------------------------------------------------
      setxypos
 
@@ -712,6 +1145,8 @@ void setpage(int startpage)
    ---------------------------------------------------------- */
 void setxypos(int x, int y)
 {
+      if (win_restore) tft_window_restore();
+
       #if (mirror == 1)
         setcol(_xres-x);
       #else
@@ -744,6 +1179,10 @@ void setxypos(int x, int y)
    ---------------------------------------------------------- */
 void putpixel(int x, int y,uint16_t color)
 {
+  #if (tft_tilecache == 1)
+    if (tiles_on) { tile_putpixel(x, y, color); return; }
+  #endif
+
 //  #if (USE_SPI_TFT == 1)
 
     switch (outmode)
@@ -798,37 +1237,339 @@ void putpixeltx(int x, int y, uint16_t color)
   if (txoutmode) putpixel(_xres-1-y,x,color); else putpixel(x,y,color);
 }
 
+/* ----------------------------------------------------------
+                 Fensterausgabe (Burst-Transfer)
+
+     putpixel setzt fuer jeden einzelnen Punkt die Adresse
+     im Display-Ram (11 Bytes Adressierung fuer 2 Bytes
+     Farbe). Bei der Fensterausgabe wird ein Bereich einmal
+     gesetzt, anschliessend werden die Farbwerte fortlaufend
+     gesendet, der Controller erhoeht die Adresse selbst.
+
+     Die Reihenfolge der Farbwerte entspricht immer dem
+     logischen Koordinatensystem (zeilenweise von links nach
+     rechts, von oben nach unten), outmode wird beachtet:
+
+       outmode 0         : das Fenster wird als Ganzes
+                           gesetzt
+       outmode 1, 2, 3   : fuer jedes Teilstueck einer Zeile
+       (oder mirror)       wird ein eindimensionales Fenster
+                           gesetzt, je nach Drehrichtung
+                           werden die Farbwerte rueckwaerts
+                           gesendet
+       ili9225           : wie outmode 1..3 (eindimensionale
+                           Fenster), da der Entry Mode (AM = 1)
+                           das Fenster spaltenweise fuellt
+
+     Beispiel:
+
+       tft_window_begin(10,10, 17,17);
+       tft_push_pixels(&buffer[0], 64);
+       tft_window_end();
+   ---------------------------------------------------------- */
+
+#if (USE_SPI_TFT == 1)
+  static inline void tft_datamode(void)        { tft_dma_sync(); dc_set(); }
+  static inline void tft_stream16(uint16_t c)  { spi_lcdout(c >> 8); spi_lcdout(c & 0xff); }
+#else
+  static inline void tft_datamode(void)        { lcd_rs_set(); }
+  static inline void tft_stream16(uint16_t c)  { lcd_bus_write(c >> 8); lcd_bus_write(c & 0xff); }
+#endif
+
+#define tft_dma_minpix    32                    // Fuellungen ab dieser Pixelanzahl ueber DMA
 
 /* ----------------------------------------------------------
-     clrscr
+     tft_stream_fill
 
-     loescht den Displayinhalt mit der in der Variable
-     "bkcolor" angegebenen Farbe
+     sendet n mal den Farbwert color in das bereits gesetzte
+     Fenster. Groessere Fuellungen laufen bei SPI-Displays
+     (tft_dma == 1) im Hintergrund ueber DMA, bei 8-Bit
+     Displays (tft_fastfill == 1) ueber lcd_bus_fill.
    ---------------------------------------------------------- */
+static void tft_stream_fill(uint16_t color, uint32_t n)
+{
+  #if ((USE_SPI_TFT == 1) && (tft_dma == 1))
+    if (n >= tft_dma_minpix)
+    {
+      tft_dma_fill(color, n);
+      return;
+    }
+  #endif
 
-void clrscr()
+  tft_datamode();
+  #if ((USE_8BIT_TFT == 1) && (tft_fastfill == 1))
+    lcd_bus_fill(color, n);
+  #else
+    while (n--) tft_stream16(color);
+  #endif
+}
+
+/* ----------------------------------------------------------
+     tft_physxy
+
+     rechnet eine logische Koordinate in die physikalische
+     Adresse im Display-Ram um (identisch zu putpixel und
+     setxypos)
+   ---------------------------------------------------------- */
+static void tft_physxy(int x, int y, int *col, int *row)
+{
+  switch (outmode)
+  {
+    case 1  : *col= y;          *row= _yres-1-x; break;
+    case 2  : *col= _xres-1-y;  *row= x;         break;
+    case 3  : *col= _xres-1-x;  *row= _yres-1-y; break;
+    default : *col= x;          *row= y;         break;
+  }
+  #if (mirror == 1)
+    *col= _xres - *col;
+  #endif
+  #if (_yres == 128)
+    *row= *row + 32 + _lcyofs;
+  #endif
+}
+
+/* ----------------------------------------------------------
+     tft_segment_begin
+
+     setzt fuer die naechsten anz Punkte der aktuellen Zeile
+     des Fensters ein eindimensionales Fenster im Display-
+     Ram.
+
+     Rueckgabe: 0 = Farbwerte vorwaerts senden
+                1 = Farbwerte rueckwaerts senden
+   ---------------------------------------------------------- */
+static uint8_t tft_segment_begin(int anz)
 {
-  int      x,y;
-  uint8_t  colouthi, coloutlo;
+  int c1, r1, c2, r2;
 
-  set_ram_address(0,0,_xres-1,_yres-1);
+  tft_physxy(win_xp, win_yp, &c1, &r1);
+  tft_physxy(win_xp+anz-1, win_yp, &c2, &r2);
+  win_restore= 1;
 
-  colouthi = bkcolor >> 8;
-  coloutlo = bkcolor & 0xff;
+  if ((c1 > c2) || (r1 > r2))
+  {
+    tft_setwindow(c2, r2, c1, r1);
+    wrcmd(writereg);
+    return 1;
+  }
+  tft_setwindow(c1, r1, c2, r2);
+  wrcmd(writereg);
+  return 0;
+}
 
-  #if (USE_SPI_TFT == 1)
-    dc_set();
+/* ----------------------------------------------------------
+     tft_window_advance
+
+     setzt die Schreibposition im Fenster um anz Punkte
+     weiter (anz ueberschreitet nie das Zeilenende)
+   ---------------------------------------------------------- */
+static void tft_window_advance(int anz)
+{
+  win_xp += anz;
+  if (win_xp > win_x2)
+  {
+    win_xp= win_x1;
+    win_yp++;
+  }
+}
+
+/* ----------------------------------------------------------
+     tft_window_begin
+
+     legt das Fenster fest, in das nachfolgende Farbwerte
+     mittels tft_push_pixels / tft_push_color geschrieben
+     werden.
+
+       x1,y1 : linke obere Ecke (logische Koordinaten)
+       x2,y2 : rechte untere Ecke
+   ---------------------------------------------------------- */
+void tft_window_begin(int x1, int y1, int x2, int y2)
+{
+  int t;
+
+  if (x2 < x1) { t= x1; x1= x2; x2= t; }
+  if (y2 < y1) { t= y1; y1= y2; y2= t; }
+
+  win_x1= x1; win_y1= y1;
+  win_x2= x2; win_y2= y2;
+  win_xp= x1; win_yp= y1;
+  win_direct= 0;
+
+  #if (tft_tilecache == 1)
+    if (tiles_on) return;                     // Fenster nur logisch, Ausgabe in den Kachelpuffer
+  #endif
+
+  #if ((ili9225 == 0) && (mirror == 0))
+    if (outmode == 0)
+    {
+      #if (_yres == 128)
+        tft_setwindow(x1, y1+32+_lcyofs, x2, y2+32+_lcyofs);
+      #else
+        tft_setwindow(x1, y1, x2, y2);
+      #endif
+      wrcmd(writereg);
+      win_direct= 1;
+      win_restore= 1;
+    }
+  #endif
+}
+
+/* ----------------------------------------------------------
+     tft_push_pixels
+
+     sendet n Farbwerte aus buf fortlaufend in das mit
+     tft_window_begin gesetzte Fenster
+
+       *buf : Zeiger auf RGB565 Farbwerte
+       n    : Anzahl der Farbwerte
+   ---------------------------------------------------------- */
+void tft_push_pixels(const uint16_t *buf, int n)
+{
+  int anz, i;
+
+  #if (tft_tilecache == 1)
+    if (tiles_on)
+    {
+      while (n--)
+      {
+        tile_putpixel(win_xp, win_yp, *buf++);
+        tft_window_advance(1);
+      }
+      return;
+    }
   #endif
 
-  for (y= 0; y< _yres; y++)
+  if (win_direct)
   {
-    for (x= 0; x< _xres; x++)
+    tft_datamode();
+    while (n--) tft_stream16(*buf++);
+    return;
+  }
+
+  while (n > 0)
+  {
+    anz= win_x2 - win_xp + 1;
+    if (anz > n) anz= n;
+
+    if (tft_segment_begin(anz))
     {
-      wrdata(colouthi);
-      wrdata(coloutlo);
+      tft_datamode();
+      for (i= anz-1; i >= 0; i--) tft_stream16(buf[i]);
     }
+    else
+    {
+      tft_datamode();
+      for (i= 0; i < anz; i++) tft_stream16(buf[i]);
+    }
+    buf += anz;
+    n -= anz;
+    tft_window_advance(anz);
+  }
+}
+
+/* ----------------------------------------------------------
+     tft_push_color
+
+     sendet n mal den Farbwert color in das mit
+     tft_window_begin gesetzte Fenster
+
+       color : RGB565 Farbwert
+       n     : Anzahl der Punkte
+   ---------------------------------------------------------- */
+void tft_push_color(uint16_t color, uint32_t n)
+{
+  uint32_t anz, i;
+  int      c1, r1, c2, r2;
+
+  #if (tft_tilecache == 1)
+    if (tiles_on)
+    {
+      if ((win_xp == win_x1) && (win_yp == win_y1) &&
+          (n == (uint32_t)(win_x2-win_x1+1) * (win_y2-win_y1+1)))
+      {
+        tile_fillrect(win_x1, win_y1, win_x2, win_y2, color);
+        win_yp= win_y2+1;
+        return;
+      }
+      while (n--)
+      {
+        tile_putpixel(win_xp, win_yp, color);
+        tft_window_advance(1);
+      }
+      return;
+    }
+  #endif
+
+  if (win_direct)
+  {
+    tft_stream_fill(color, n);
+    return;
+  }
+
+  // ganzes Fenster mit einer Farbe: unabhaengig von outmode ist das Fenster
+  // auch physikalisch ein Rechteck
+  if ((win_xp == win_x1) && (win_yp == win_y1) &&
+      (n == (uint32_t)(win_x2-win_x1+1) * (win_y2-win_y1+1)))
+  {
+    tft_physxy(win_x1, win_y1, &c1, &r1);
+    tft_physxy(win_x2, win_y2, &c2, &r2);
+    tft_setwindow((c1 < c2) ? c1 : c2, (r1 < r2) ? r1 : r2, (c1 < c2) ? c2 : c1, (r1 < r2) ? r2 : r1);
+    wrcmd(writereg);
+    win_restore= 1;
+    tft_stream_fill(color, n);
+    win_yp= win_y2+1;
+    return;
   }
 
+  while (n > 0)
+  {
+    anz= win_x2 - win_xp + 1;
+    if (anz > n) anz= n;
+
+    tft_segment_begin(anz);
+    tft_datamode();
+    for (i= 0; i < anz; i++) tft_stream16(color);
+    n -= anz;
+    tft_window_advance(anz);
+  }
+}
+
+/* ----------------------------------------------------------
+     tft_window_end
+
+     beendet eine Fensterausgabe. Der Adressbereich des
+     Controllers wird erst beim naechsten putpixel wieder
+     hergestellt (aufeinander folgende Fenster benoetigen
+     das nicht).
+   ---------------------------------------------------------- */
+void tft_window_end(void)
+{
+  win_direct= 0;
+}
+
+
+/* ----------------------------------------------------------
+     clrscr
+
+     loescht den Displayinhalt mit der in der Variable
+     "bkcolor" angegebenen Farbe
+   ---------------------------------------------------------- */
+
+void clrscr()
+{
+  #if (tft_tilecache == 1)
+    if (tiles_on) tft_tiles_invalidate();     // Kacheln enthalten nicht mehr den Displayinhalt
+  #endif
+
+  #if (_yres == 128)
+    tft_setwindow(0, 32+_lcyofs, _xres-1, 32+_lcyofs+_yres-1);
+  #else
+    tft_setwindow(0, 0, _xres-1, _yres-1);
+  #endif
+  wrcmd(writereg);
+  win_restore= 0;
+
+  tft_stream_fill(bkcolor, (uint32_t)_xres * _yres);
 }
 
 /* ----------------------------------------------------------
@@ -951,6 +1692,202 @@ void lcd_putchar5x7(unsigned char ch)
   #endif
 }
 
+/* --------------------------------------------------
+     Zeichenausgabe 8x8 / 12x16
+
+     Das Bitmuster eines Zeichens wird zeilenweise
+     (linksbuendig ab Bit 15) in glyph_bits abgelegt
+     und von glyph_out ausgegeben. Die Vergroesserung
+     ist textsize+1 (ganzzahlig, beliebig).
+
+       - mit Hintergrund (fntfilled) und ohne Text-
+         drehung: die Zeichenzelle wird als ein Fenster
+         gesendet. Kleine Zellen werden fuer die
+         aktuellen Farben / Groesse aufbereitet in einem
+         Zwischenspeicher (fnt_cache) gehalten und
+         erneut verwendet
+       - ohne Hintergrund oder gedreht (outtextxy,
+         putcharxy): jede Pixelreihe wird in zusammen-
+         haengende Strecken zerlegt, jede Strecke ist
+         ein ausgefuelltes Rechteck
+   -------------------------------------------------- */
+
+#define glyph_rowmax    48                      // max. Pixel einer aufbereiteten Reihe (Stack)
+
+static uint16_t glyph_bits[16];                 // Bitmuster des aktuellen Zeichens
+
+#if (fnt_cache == 1)
+  static uint16_t glyph_cpix[fnt_cacheanz][fnt_cachepix];   // aufbereitete Zeichenzellen (RGB565)
+  static uint8_t  glyph_cch[fnt_cacheanz];                  // Zeichen (0 = Eintrag unbenutzt)
+  static uint8_t  glyph_cfnt[fnt_cacheanz];                 // Fontnummer
+  static uint8_t  glyph_csc[fnt_cacheanz];                  // Vergroesserung
+  static uint16_t glyph_cfg[fnt_cacheanz];                  // Vordergrundfarbe
+  static uint16_t glyph_cbg[fnt_cacheanz];                  // Hintergrundfarbe
+  static uint16_t glyph_cstamp[fnt_cacheanz];               // Zeitstempel der letzten Benutzung
+  static uint16_t glyph_cclock = 0;
+#endif
+
+/* --------------------------------------------------
+     glyph_burst_row
+
+     gibt eine Pixelreihe eines Zeichens (mit Hinter-
+     grund) sc mal ueber die Fensterausgabe aus.
+
+       bits  : Bitmuster der Reihe, linksbuendig ab
+               Bit 15
+       w     : Anzahl Pixel der Reihe im Font
+       sc    : Vergroesserungsfaktor
+   -------------------------------------------------- */
+static void glyph_burst_row(uint16_t bits, uint8_t w, uint8_t sc)
+{
+  uint16_t rowbuf[glyph_rowmax];
+  uint16_t b, col;
+  uint8_t  i, s, n;
+
+  if (w*sc <= glyph_rowmax)
+  {
+    n= 0;
+    for (i= 0; i< w; i++)
+    {
+      col= (bits & 0x8000) ? textcolor : bkcolor;
+      for (s= 0; s< sc; s++) rowbuf[n++]= col;
+      bits= bits << 1;
+    }
+    for (s= 0; s< sc; s++) tft_push_pixels(&rowbuf[0], n);
+    return;
+  }
+
+  // sehr grosse Schrift: Strecken gleicher Farbe senden
+  for (s= 0; s< sc; s++)
+  {
+    b= bits;
+    i= 0;
+    while (i < w)
+    {
+      n= 0;
+      col= b & 0x8000;
+      while ((i < w) && ((b & 0x8000) == col)) { n++; i++; b= b << 1; }
+      tft_push_color(col ? textcolor : bkcolor, (uint32_t)n*sc);
+    }
+  }
+}
+
+#if (fnt_cache == 1)
+
+/* --------------------------------------------------
+     glyph_cached
+
+     liefert die fuer Farbe und Groesse aufbereitete
+     Zeichenzelle aus dem Zwischenspeicher. Ist das
+     Zeichen nicht vorhanden, wird der am laengsten
+     nicht benutzte Eintrag neu aufbereitet.
+   -------------------------------------------------- */
+static const uint16_t *glyph_cached(uint8_t ch, uint8_t w, uint8_t h, uint8_t sc)
+{
+  uint8_t  i, j, k, s, e, old;
+  uint16_t bits, col, *p;
+
+  old= 0;
+  for (e= 0; e< fnt_cacheanz; e++)
+  {
+    if ((glyph_cch[e] == ch) && (glyph_cfnt[e] == fontnr) && (glyph_csc[e] == sc) &&
+        (glyph_cfg[e] == textcolor) && (glyph_cbg[e] == bkcolor)) break;
+    if ((uint16_t)(glyph_cclock - glyph_cstamp[e]) > (uint16_t)(glyph_cclock - glyph_cstamp[old])) old= e;
+  }
+
+  if (e == fnt_cacheanz)
+  {
+    e= old;
+    glyph_cch[e]= ch; glyph_cfnt[e]= fontnr; glyph_csc[e]= sc;
+    glyph_cfg[e]= textcolor; glyph_cbg[e]= bkcolor;
+
+    p= &glyph_cpix[e][0];
+    for (i= 0; i< h; i++)
+    {
+      for (s= 0; s< sc; s++)
+      {
+        bits= glyph_bits[i];
+        for (j= 0; j< w; j++)
+        {
+          col= (bits & 0x8000) ? textcolor : bkcolor;
+          bits= bits << 1;
+          for (k= 0; k< sc; k++) *p++= col;
+        }
+      }
+    }
+  }
+
+  glyph_cstamp[e]= ++glyph_cclock;
+  return &glyph_cpix[e][0];
+}
+
+#endif
+
+/* --------------------------------------------------
+     glyph_span
+
+     zeichnet eine Strecke einer Pixelreihe des
+     Zeichens als Rechteck (len Punkte breit, sc
+     Punkte hoch), txoutmode wird beachtet
+   -------------------------------------------------- */
+static void glyph_span(int x, int y, int len, uint8_t sc, uint16_t color)
+{
+  if (txoutmode)
+    fillrect(_xres-y-sc, x, _xres-1-y, x+len-1, color);
+  else
+    fillrect(x, y, x+len-1, y+sc-1, color);
+}
+
+/* --------------------------------------------------
+     glyph_out
+
+     gibt das in glyph_bits abgelegte Zeichen an der
+     Textcursorposition aus
+
+       ch   : Zeichen (Schluessel fuer den Zwischen-
+              speicher)
+       w,h  : Breite und Hoehe des Fonts
+   -------------------------------------------------- */
+static void glyph_out(uint8_t ch, uint8_t w, uint8_t h)
+{
+  uint8_t  i, x, n, sc;
+  uint16_t bits, on;
+
+  sc= textsize+1;
+
+  if ((fntfilled) && (!txoutmode))
+  {
+    tft_window_begin(aktxp, aktyp, aktxp+(w*sc)-1, aktyp+(h*sc)-1);
+    #if (fnt_cache == 1)
+      if ((uint32_t)w*h*sc*sc <= fnt_cachepix)
+      {
+        tft_push_pixels(glyph_cached(ch, w, h, sc), w*h*sc*sc);
+        tft_window_end();
+        return;
+      }
+    #endif
+    for (i= 0; i< h; i++) glyph_burst_row(glyph_bits[i], w, sc);
+    tft_window_end();
+    return;
+  }
+
+  for (i= 0; i< h; i++)
+  {
+    bits= glyph_bits[i];
+    x= 0;
+    while (x < w)
+    {
+      n= 0;
+      on= bits & 0x8000;
+      while ((x < w) && ((bits & 0x8000) == on)) { n++; x++; bits= bits << 1; }
+      if (on)
+        glyph_span(aktxp+(x-n)*sc, aktyp+i*sc, n*sc, sc, textcolor);
+      else
+        if (fntfilled) glyph_span(aktxp+(x-n)*sc, aktyp+i*sc, n*sc, sc, bkcolor);
+    }
+  }
+}
+
 /* --------------------------------------------------
      lcd_putchar8x8
 
@@ -965,11 +1902,7 @@ void lcd_putchar8x8(unsigned char ch)
 
   #if (fnt8x8_enable == 1)
 
-    uint8_t   i,i2;
-    uint8_t   b;
-    int       oldx,oldy;
-    uint16_t  fontint;
-    uint16_t  fmask;
+    uint8_t   i;
 
     if (ch== 13)                                          // Fuer <printf> "/r" Implementation
     {
@@ -982,47 +1915,10 @@ void lcd_putchar8x8(unsigned char ch)
       return;
     }
 
-    fmask= 1<<(fontsizex-1);
+    for (i=0; i<8; i++)
+      glyph_bits[i]= font8x8[(ch-32)][i] << 8;
+    glyph_out(ch, 8, 8);
 
-    oldx= aktxp;
-    oldy= aktyp;
-    for (i=0; i<fontsizey; i++)
-    {
-      b= font8x8[(ch-32)][i];
-      fontint= b;
-
-      for (i2= 0; i2<fontsizex; i2++)
-      {
-        if (fmask & fontint)
-        {
-          putpixeltx(oldx,oldy,textcolor);
-          if ((textsize==1))
-          {
-            putpixeltx(oldx+1,oldy,textcolor);
-            putpixeltx(oldx,oldy+1,textcolor);
-            putpixeltx(oldx+1,oldy+1,textcolor);
-          }
-        }
-        else
-        {
-          if (fntfilled)
-          {
-            putpixeltx(oldx,oldy,bkcolor);
-            if ((textsize==1))
-            {
-              putpixeltx(oldx+1,oldy,bkcolor);
-              putpixeltx(oldx,oldy+1,bkcolor);
-              putpixeltx(oldx+1,oldy+1,bkcolor);
-            }
-          }
-        }
-        fontint= fontint<<1;
-        oldx= oldx+1+textsize;
-      }
-      oldy++;
-      if ((textsize==1)) {oldy++; }
-      oldx= aktxp;
-    }
     aktxp= aktxp+fontsizex+(fontsizex*textsize);
 
   #endif
@@ -1042,11 +1938,8 @@ void lcd_putchar12x16(unsigned char ch)
 
   #if (fnt12x16_enable == 1)
 
-    uint8_t   i,i2;
+    uint8_t   i;
     uint16_t  b;
-    int       oldx,oldy;
-    uint16_t  fontint;
-    uint16_t  fmask;
     uint16_t  findex;
 
     if (ch== 13)                                          // Fuer <printf> "/r" Implementation
@@ -1060,49 +1953,17 @@ void lcd_putchar12x16(unsigned char ch)
       return;
     }
 
-    fmask= 1<<(16-1);
-    oldx= aktxp;
-    oldy= aktyp;
+    findex= (ch-32);
+
     for (i=0; i<16; i++)
     {
-      findex= (ch-32);
       b= (font12x16[findex][i*2])<<4;
       b|= ((font12x16[findex][(i*2)+1])<<12);
-      fontint= b;
-
-      for (i2= 0; i2<12; i2++)
-      {
-        if (fmask & fontint)
-        {
-          putpixeltx(oldx,oldy,textcolor);
-          if ((textsize==1))
-          {
-            putpixeltx(oldx+1,oldy,textcolor);
-            putpixeltx(oldx,oldy+1,textcolor);
-            putpixeltx(oldx+1,oldy+1,textcolor);
-          }
-        }
-        else
-        {
-          if (fntfilled)
-          {
-            putpixeltx(oldx,oldy,bkcolor);
-            if ((textsize==1))
-            {
-              putpixeltx(oldx+1,oldy,bkcolor);
-              putpixeltx(oldx,oldy+1,bkcolor);
-              putpixeltx(oldx+1,oldy+1,bkcolor);
-            }
-          }
-        }
-        fontint= fontint<<1;
-        oldx= oldx+1+textsize;
-      }
-      oldy++;
-      if ((textsize==1)) {oldy++; }
-      oldx= aktxp;
+      glyph_bits[i]= b;
     }
-    if (textsize==1) aktxp= aktxp + 24; else aktxp = aktxp +12;
+    glyph_out(ch, 12, 16);
+
+    aktxp= aktxp+12+(12*textsize);
 
   #endif
 }
@@ -1273,11 +2134,9 @@ void fastxline(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t color)
 
   if (x2< x1) { x= x1; x1= x2; x= x2= x; }
 
-  for (x= x1; x< (x2+1); x++)
-  {
-    putpixel(x,y1, color);
-  }
-
+  tft_window_begin(x1, y1, x2, y1);
+  tft_push_color(color, x2-x1+1);
+  tft_window_end();
 }
 
 /* ----------------------------------------------------------
@@ -1324,10 +2183,9 @@ void fillrect(int x1, int y1, int x2, int y2, uint16_t color)
       y2= y;
     }
 
-    for (y= y1; y< y2+1; y++)
-    {
-      fastxline(x1,y,x2,color);
-    }
+    tft_window_begin(x1, y1, x2, y2);
+    tft_push_color(color, (uint32_t)(abs(x2-x1)+1) * (y2-y1+1));
+    tft_window_end();
   #endif
 
 }
@@ -1443,59 +2301,34 @@ void circle(int x, int y, int r, uint16_t color )
 }
 
 /* -------------------------------------------------------------
-     fillellipse
+     fill_span
 
-     Zeichnet eine ausgefuellte Ellipse mit Mittelpunt an der
-     Koordinate xm,ym mit den Hoehen- Breitenverhaeltnis a:b
-     mit der angegebenen Farbe
+     zeichnet eine waagrechte Strecke (Scanline) von x1 bis x2
+     in Zeile y als einen Burst (fastxline). Die Strecke wird
+     auf den (logischen) Displaybereich beschnitten.
 
-        xm,ym  : Koordinate des Mittelpunktes der Ellipse
-        a,b    : Hoehen- Breitenverhaeltnis
-        color  : 16 - Bit RGB565 Farbwert der gezeichnet
-                 werden soll
-
-   Ellipsenalgorithmus nach Bresenham (www.wikipedia.org)
+     Grundlage der gefuellten Formen in tft_spanfill.c
    ------------------------------------------------------------- */
-void fillellipse(int xm, int ym, int a, int b, uint16_t color )
+static void fill_span(int x1, int x2, int y, uint16_t color)
 {
-  // Algorithmus nach Bresenham (www.wikipedia.org)
-
-  int dx = 0, dy = b;                       // im I. Quadranten von links oben nach rechts unten
-  long a2 = a*a, b2 = b*b;
-  long err = b2-(2*b-1)*a2, e2;             // Fehler im 1. Schritt */
+  int t, w, h;
 
-  do
-  {
-    fastxline(xm+dx, ym+dy,xm-dx, color);            // I. und II.   Quadrant
-    fastxline(xm-dx, ym-dy,xm+dx, color);            // III. und IV. Quadrant
+  if ((outmode == 1) || (outmode == 2)) { w= _yres; h= _xres; }
+                                   else { w= _xres; h= _yres; }
 
-    e2 = 2*err;
-    if (e2 <  (2*dx+1)*b2) { dx++; err += (2*dx+1)*b2; }
-    if (e2 > -(2*dy-1)*a2) { dy--; err -= (2*dy-1)*a2; }
-  } while (dy >= 0);
+  if (x2 < x1) { t= x1; x1= x2; x2= t; }
+  if ((y < 0) || (y >= h) || (x2 < 0) || (x1 >= w)) return;
+  if (x1 < 0) x1= 0;
+  if (x2 >= w) x2= w-1;
 
-  while (dx++ < a)                        // fehlerhafter Abbruch bei flachen Ellipsen (b=1)
-  {
-    putpixel(xm+dx, ym,color);             // -> Spitze der Ellipse vollenden
-    putpixel(xm-dx, ym,color);
-  }
+  fastxline(x1, y, x2, color);
 }
 
-/* -------------------------------------------------------------
-     fillcircle
-
-     Zeichnet einen ausgefuellten Kreis mit Mittelpunt an der
-     Koordinate xm,ym und dem Radius r mit der angegebenen Farbe
+// ------------------------------------
+//   gefuellte Formen (Scanlines)
+// ------------------------------------
 
-        x,y    : Koordinate des Mittelpunktes der Ellipse
-        r      : Radius des Kreises
-        color  : 16 - Bit RGB565 Farbwert der gezeichnet
-                 werden soll
-   ------------------------------------------------------------- */
-void fillcircle(int x, int y, int r, uint16_t color )
-{
-  fillellipse(x,y,r,r,color);
-}
+#include "tft_spanfill.c"
 
 
 /* ----------------------------------------------------------
@@ -1531,6 +2364,7 @@ void fillcircle(int x, int y, int r, uint16_t color )
 void showimage(uint16_t ox, uint16_t oy, const unsigned char* const image, uint16_t fwert)
 {
   int x,y;
+  int xs= 0, run;
   uint8_t b,bp;
   uint16_t resX, resY;
 
@@ -1539,16 +2373,29 @@ void showimage(uint16_t ox, uint16_t oy, const unsigned char* const image, uint1
   if ((resX % 8) == 0) { resX= resX / 8; }
                  else  { resX= (resX / 8)+1; }
 
+  // gesetzte Pixel einer Reihe werden zu horizontalen Linien zusammengefasst
+  // und jeweils als ein Fenster ausgegeben
   for (y=0;y< resY;y++)
   {
+    run= 0;
     for (x= 0;x<resX;x++)
     {
       b= image[y *resX +x+4];
       for (bp=8;bp>0;bp--)
       {
-        if (b & (1 << (bp-1))) {putpixel(ox+(x*8)+8-bp,oy+y,fwert);}
+        if (b & (1 << (bp-1)))
+        {
+          if (!run) xs= (x*8)+8-bp;
+          run++;
+        }
+        else
+        {
+          if (run) fastxline(ox+xs, oy+y, ox+xs+run-1, fwert);
+          run= 0;
+        }
       }
     }
+    if (run) fastxline(ox+xs, oy+y, ox+xs+run-1, fwert);
   }
 }
 
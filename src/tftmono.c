@@ -64,7 +64,7 @@ uint8_t textsize  = 0;                                // Skalierung der Ausgabes
       0x14, 0,
       0xaf, 0 | delay_flag, 150,
       0xa1, 0,
-      0xc0
+      0xc0, 0
     };
 
   #endif
@@ -839,11 +839,12 @@ void lcd_putchar(uint8_t ch)
   {
     uint16_t fbi;
     uint8_t  xr;
-//    uint8_t  yr;
+    uint8_t  yr;
     uint8_t  pixpos;
 
     xr= vram[0];
-//    yr= vram[1];
+    yr= vram[1];
+    if ((x >= xr) || ((y >> 3) >= yr)) return;       // ausserhalb des Framebuffers
     fbi= ((y >> 3) * xr) + 2 + x;
     pixpos= 7- (y & 0x07);
 
@@ -11,6 +11,7 @@ LOCAL_SRC_FILES :=	\
 	i2c.c		\
 	init.c		\
 	main.c		\
+	multi.c		\
 	port.c		\
 	serial_common.c	\
 	serial_platform.c	\
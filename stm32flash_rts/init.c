@@ -27,6 +27,8 @@
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
+#include <termios.h>
+#include <sys/ioctl.h>
 #include <sys/stat.h>
 #include "init.h"
 #include "serial.h"
@@ -270,3 +272,45 @@ int init_bl_exit(stm32_t *stm, struct port_interface *port, const char *seq)
 		return 0;
 	return 1;
 }
+
+/*
+ * Reset control for the ATtiny13 on the CH340 adapter (see
+ * attiny_src/readme.txt): 3 pulses on RTS activate the bootloader of
+ * the STM32, 6 pulses deactivate it and reset the STM32.
+ * returns 0 on success, -1 if the device can't be opened
+ */
+int init_rts_pulses(const char *device, int pulses)
+{
+	struct termios tio;
+	int fd, status, pulse;
+
+	if ((fd = open(device, O_RDWR)) < 0)
+		return -1;
+
+	tcgetattr(fd, &tio);
+	tio.c_cflag &= ~HUPCL;			// HUPCL - Bit loeschen
+	tcsetattr(fd, TCSANOW, &tio);
+
+	ioctl(fd, TIOCMGET, &status);		// Status Serielle Schnittstelle
+
+	status &= ~TIOCM_RTS;			// RTS
+	ioctl(fd, TIOCMSET, &status);		// setzen
+	usleep(100000);
+
+	for (pulse = 0; pulse < pulses; pulse++) {
+		status &= ~TIOCM_RTS;		// RTS
+		ioctl(fd, TIOCMSET, &status);	// setzen
+		usleep(1000);
+
+		status |= TIOCM_RTS;		// RTS
+		ioctl(fd, TIOCMSET, &status);	// loeschen
+		usleep(1000);
+
+		status &= ~TIOCM_RTS;		// RTS
+		ioctl(fd, TIOCMSET, &status);	// setzen
+		usleep(1000);
+	}
+
+	close(fd);				// Device schliessen
+	return 0;
+}
@@ -27,5 +27,6 @@
 
 int init_bl_entry(struct port_interface *port, const char *seq);
 int init_bl_exit(stm32_t *stm, struct port_interface *port, const char *seq);
+int init_rts_pulses(const char *device, int pulses);
 
 #endif
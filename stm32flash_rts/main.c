@@ -35,6 +35,8 @@
 #include <sys/ioctl.h>
 #include <fcntl.h>
 #include <termios.h>
+#include <time.h>
+#include <glob.h>
 
 #include "init.h"
 #include "utils.h"
@@ -42,15 +44,14 @@
 #include "stm32.h"
 #include "parsers/parser.h"
 #include "port.h"
+#include "multi.h"
 
 #include "parsers/binary.h"
 #include "parsers/hex.h"
+#include "parsers/elf.h"
 
 #define VERSION "0.5m"
 
-struct termios tio;                         // Zugriff um HUPCK Bit loeschen zu koennen
-
-
 /* device globals */
 stm32_t		*stm		= NULL;
 
@@ -79,17 +80,36 @@ enum actions {
 };
 
 enum actions	action		= ACT_NONE;
+
+enum verify_modes {
+	VERIFY_READBACK,	/* read back and compare every block */
+	VERIFY_PAGE,		/* CRC (or read back) per flash page */
+	VERIFY_IMAGE		/* CRC of the whole image at the end */
+};
+
+static const char *const verify_names[] = {
+	"readback", "crc-per-page", "crc-whole-image", NULL
+};
+
 int		npages		= 0;
 int             spage           = 0;
 int             no_erase        = 0;
 char		verify		= 0;
+int		verify_mode	= 0;		/* VERIFY_... */
 int		retry		= 10;
 char		exec_flag	= 0;
 uint32_t	execute		= 0;
 char		init_flag	= 1;
 char		force_binary	= 0;
 char		reset_flag	= 0;
+char		diff_flag	= 0;
+char		sparse		= 0;		/* ELF or HEX file written by segments */
+char		baud_probe	= 0;		/* -b auto */
+serial_baud_t	baud_max	= SERIAL_BAUD_2000000;
+char		*json_file	= NULL;
 char		*filename;
+char		**targets	= NULL;		/* all target devices */
+int		ntargets	= 0;
 char		*gpio_seq	= NULL;
 uint32_t	start_addr	= 0;
 uint32_t	readwrite_len	= 0;
@@ -202,6 +222,659 @@ static uint32_t flash_page_to_addr(int page)
 	return addr;
 }
 
+static double time_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* time spent per phase, reported with -J */
+enum phases {
+	PHASE_PROBE,
+	PHASE_CONNECT,
+	PHASE_ERASE,
+	PHASE_WRITE,
+	PHASE_VERIFY,
+	PHASE_MAX
+};
+
+static const char *const phase_names[PHASE_MAX] = {
+	"probe", "connect", "erase", "write", "verify"
+};
+
+static double t_phase[PHASE_MAX];
+
+/* results of -b auto */
+#define PROBE_MAX	SERIAL_BAUD_INVALID
+#define PROBE_PINGS	8		/* GET round trips per rate */
+
+static struct {
+	unsigned int	baud;
+	int		ok;
+	double		t;
+} probe[PROBE_MAX];
+static int nprobe;
+
+/*
+ * Adaptive write chunking. A block is sent in chunks of wchunk bytes. A
+ * NACK or a timeout halves the chunk (after a timeout the link is
+ * resynced first), WCHUNK_GROW good chunks in a row double it again up
+ * to the frame size. On a noisy line the chunk settles where a frame
+ * gets through most of the time, instead of failing the whole write.
+ * Any other error (misaligned address, no WRITE command, a garbled
+ * reply) is not a matter of the line and fails at once.
+ */
+#define WCHUNK_MIN	16
+#define WCHUNK_GROW	32
+
+static unsigned int wchunk;		/* 0 = frame size */
+static struct {
+	unsigned long	frames, nacks, timeouts;
+	unsigned int	chunk_min;
+} wstat;
+
+static stm32_err_t write_adaptive(uint32_t addr, const uint8_t *data, unsigned int len)
+{
+	static unsigned int good;
+	unsigned int max_wlen, n;
+	stm32_err_t s_err;
+	int failed = 0;
+	double t0 = time_now();
+
+	max_wlen = port_opts.tx_frame_max - 2;	/* skip len and crc */
+	max_wlen &= ~3;	/* 32 bit aligned */
+	if (!wchunk || wchunk > max_wlen)
+		wchunk = max_wlen;
+	if (!wstat.chunk_min)
+		wstat.chunk_min = wchunk;
+
+	while (len) {
+		n = len > wchunk ? wchunk : len;
+		s_err = stm32_write_memory(stm, addr, data, n);
+		wstat.frames++;
+		if (s_err == STM32_ERR_OK) {
+			addr += n;
+			data += n;
+			len  -= n;
+			failed = 0;
+			if (++good >= WCHUNK_GROW && wchunk < max_wlen) {
+				wchunk = wchunk * 2 > max_wlen ? max_wlen : wchunk * 2;
+				good = 0;
+			}
+			continue;
+		}
+
+		if (s_err != STM32_ERR_NACK && s_err != STM32_ERR_TIMEOUT)
+			break;
+		good = 0;
+		if (s_err == STM32_ERR_NACK)
+			wstat.nacks++;
+		else
+			wstat.timeouts++;
+		if (failed++ == retry)
+			break;
+		if (s_err == STM32_ERR_TIMEOUT && stm32_resync(stm) != STM32_ERR_OK)
+			break;
+		if (wchunk / 2 >= WCHUNK_MIN)
+			wchunk = (wchunk / 2) & ~3;
+		if (wchunk < wstat.chunk_min)
+			wstat.chunk_min = wchunk;
+	}
+	t_phase[PHASE_WRITE] += time_now() - t0;
+	return len ? s_err : STM32_ERR_OK;
+}
+
+/* a failed command is retried after a resync, for the same noisy line */
+static stm32_err_t erase_pages(uint32_t first, uint32_t num)
+{
+	stm32_err_t s_err;
+	double t0 = time_now();
+	int failed = 0;
+
+	while ((s_err = stm32_erase_memory(stm, first, num)) != STM32_ERR_OK)
+		if (s_err == STM32_ERR_NO_CMD || failed++ == retry || stm32_resync(stm) != STM32_ERR_OK)
+			break;
+	t_phase[PHASE_ERASE] += time_now() - t0;
+	return s_err;
+}
+
+static stm32_err_t read_memory(uint32_t addr, uint8_t *buf, unsigned int len)
+{
+	stm32_err_t s_err;
+	int failed = 0;
+
+	while ((s_err = stm32_read_memory(stm, addr, buf, len)) != STM32_ERR_OK)
+		if (s_err == STM32_ERR_NO_CMD || failed++ == retry || stm32_resync(stm) != STM32_ERR_OK)
+			break;
+	return s_err;
+}
+
+/*
+ * compare "len" bytes of flash at "addr" with "expect".
+ * Uses the bootloader CRC command if available, else reads the range
+ * back and stops at the first difference.
+ * returns 1 if different, 0 if equal, -1 on error
+ */
+static int flash_range_differs(uint32_t addr, const uint8_t *expect, uint32_t len)
+{
+	uint8_t buf[256];
+	uint32_t crc, n, max_rlen;
+
+	if (stm32_has_crc(stm)) {
+		if (stm32_crc_memory(stm, addr, len, &crc) != STM32_ERR_OK)
+			return -1;
+		return crc != stm32_sw_crc(0xFFFFFFFF, (uint8_t *)expect, len);
+	}
+
+	max_rlen = port_opts.rx_frame_max & ~3;
+	while (len) {
+		n = len > max_rlen ? max_rlen : len;
+		if (read_memory(addr, buf, n) != STM32_ERR_OK)
+			return -1;
+		if (memcmp(buf, expect, n))
+			return 1;
+		addr	+= n;
+		expect	+= n;
+		len	-= n;
+	}
+	return 0;
+}
+
+/* the same, the time is counted as verify phase */
+static int flash_page_differs(uint32_t addr, const uint8_t *expect, uint32_t len)
+{
+	double t0 = time_now();
+	int r;
+
+	r = flash_range_differs(addr, expect, len);
+	t_phase[PHASE_VERIFY] += time_now() - t0;
+	return r;
+}
+
+/*
+ * crc-per-page verification of the range written in page "page".
+ * On a mismatch the page is erased (unless -e 0) and written again,
+ * up to "retry" times. "to" and the data must be padded to 4 bytes.
+ * returns 0 on success
+ */
+static int verify_page(int page, uint32_t from, uint32_t to, const uint8_t *data)
+{
+	unsigned int max_wlen, n;
+	uint32_t addr;
+	int r, failed = 0;
+
+	max_wlen = port_opts.tx_frame_max - 2;	/* skip len and crc */
+	max_wlen &= ~3;	/* 32 bit aligned */
+
+	while ((r = flash_page_differs(from, data, to - from)) != 0) {
+		if (r < 0 || failed++ == retry) {
+			fprintf(stderr, "Failed to verify page %d (0x%08x-0x%08x)\n", page, from, to);
+			return -1;
+		}
+		if (!no_erase && erase_pages(page, 1) != STM32_ERR_OK) {
+			fprintf(stderr, "Failed to erase page %d\n", page);
+			return -1;
+		}
+		for (addr = from; addr < to; addr += n) {
+			n = to - addr > max_wlen ? max_wlen : to - addr;
+			if (write_adaptive(addr, data + (addr - from), n) != STM32_ERR_OK) {
+				fprintf(stderr, "Failed to write memory at address 0x%08x\n", addr);
+				return -1;
+			}
+		}
+	}
+	return 0;
+}
+
+/*
+ * Populated ranges of an ELF file or of a HEX file with absolute
+ * addresses (sparse), sorted by address, and any range of the flat image
+ * with the gaps read as 0xFF.
+ */
+static unsigned int segment_count(void)
+{
+	return parser == &PARSER_ELF ? elf_segment_count(p_st) : hex_segment_count(p_st);
+}
+
+static void segment_get(unsigned int idx, uint32_t *addr, uint32_t *len)
+{
+	if (parser == &PARSER_ELF)
+		elf_segment(p_st, idx, addr, len);
+	else
+		hex_segment(p_st, idx, addr, len);
+}
+
+static void segment_read_at(uint32_t addr, void *data, unsigned int len)
+{
+	if (parser == &PARSER_ELF)
+		elf_read_at(p_st, addr, data, len);
+	else
+		hex_read_at(p_st, addr, data, len);
+}
+
+/*
+ * Differential write: only the pages whose content differs from the
+ * image are erased and written. Pages are padded with 0xFF (erased
+ * state) where the image does not cover them, exactly as after a full
+ * erase. Pages outside the image are not touched, for a sparse file
+ * neither are the pages in the gaps between its segments.
+ */
+static int write_differential(uint32_t start, uint32_t end, unsigned int size, FILE *diag)
+{
+	uint8_t		*image = NULL, *dirty = NULL, *used = NULL, *p;
+	uint32_t	img_start, img_end, addr, pg_end, len, a, l;
+	unsigned int	max_wlen, n, seg, written = 0;
+	int		first_page, num_pages, num_used, page, run, i, changed = 0, failed, r;
+	int		ret = 1;
+	double		t0 = time_now();
+
+	if (!is_addr_in_flash(start)) {
+		fprintf(stderr, "Differential write needs a start address in flash\n");
+		return 1;
+	}
+	if (size > end - start)
+		size = end - start;
+
+	first_page = flash_addr_to_page_floor(start);
+	num_pages  = flash_addr_to_page_ceil(start + size) - first_page;
+	img_start  = flash_page_to_addr(first_page);
+	img_end    = flash_page_to_addr(first_page + num_pages);
+
+	max_wlen = port_opts.tx_frame_max - 2;	/* skip len and crc */
+	max_wlen &= ~3;	/* 32 bit aligned */
+
+	image = malloc(img_end - img_start);
+	dirty = calloc(num_pages, 1);
+	used  = malloc(num_pages);
+	if (!image || !dirty || !used) {
+		fprintf(stderr, "Out of memory\n");
+		goto out;
+	}
+
+	/* pages holding data: all of them, for a sparse file those a segment touches */
+	memset(used, !sparse, num_pages);
+	num_used = sparse ? 0 : num_pages;
+	for (seg = 0; sparse && seg < segment_count(); seg++) {
+		segment_get(seg, &a, &l);
+		if (!l || a < img_start || a + l > img_end)
+			continue;
+		for (page = flash_addr_to_page_floor(a); page < flash_addr_to_page_ceil(a + l); page++) {
+			num_used += !used[page - first_page];
+			used[page - first_page] = 1;
+		}
+	}
+
+	/* the image as the flash should look after a full erase and write */
+	memset(image, 0xFF, img_end - img_start);
+	p = image + (start - img_start);
+	for (len = 0; len < size; len += n) {
+		n = size - len;
+		if (parser->read(p_st, p + len, &n) != PARSER_ERR_OK || n == 0) {
+			fprintf(stderr, "Failed to read input file\n");
+			goto out;
+		}
+	}
+
+	/* find the pages that differ */
+	for (page = 0; page < num_pages; page++) {
+		if (!used[page])
+			continue;
+		addr   = flash_page_to_addr(first_page + page);
+		pg_end = flash_page_to_addr(first_page + page + 1);
+		r = flash_page_differs(addr, image + (addr - img_start), pg_end - addr);
+		if (r < 0) {
+			fprintf(stderr, "Failed to compare page %d\n", first_page + page);
+			goto out;
+		}
+		dirty[page] = r;
+		changed += r;
+		fprintf(diag, "\rCompared page %d of %d, %d changed ", page + 1, num_pages, changed);
+		fflush(diag);
+	}
+	fprintf(diag, "\n");
+
+	/* erase and write each run of consecutive changed pages */
+	for (page = 0; page < num_pages; page += run) {
+		for (run = 1; !dirty[page] && page + run < num_pages && !dirty[page + run]; run++)
+			;
+		if (!dirty[page])
+			continue;
+		for (run = 1; page + run < num_pages && dirty[page + run]; run++)
+			;
+
+		failed = 0;
+	again:
+		if (erase_pages(first_page + page, run) != STM32_ERR_OK) {
+			fprintf(stderr, "Failed to erase pages %d..%d\n", first_page + page, first_page + page + run - 1);
+			goto out;
+		}
+
+		addr   = flash_page_to_addr(first_page + page);
+		pg_end = flash_page_to_addr(first_page + page + run);
+		for (; addr < pg_end; addr += n) {
+			n = pg_end - addr > max_wlen ? max_wlen : pg_end - addr;
+			p = image + (addr - img_start);
+
+			/* erased flash already reads 0xFF */
+			for (i = 0; i < n && p[i] == 0xFF; i++)
+				;
+			if (i == n)
+				continue;
+
+			if (write_adaptive(addr, p, n) != STM32_ERR_OK) {
+				fprintf(stderr, "Failed to write memory at address 0x%08x\n", addr);
+				goto out;
+			}
+			written += n;
+			fprintf(diag, "\rWrote address 0x%08x ", addr + n);
+			fflush(diag);
+		}
+
+		if (verify) {
+			addr = flash_page_to_addr(first_page + page);
+			r = flash_page_differs(addr, image + (addr - img_start), pg_end - addr);
+			if (r < 0)
+				goto out;
+			if (r) {
+				if (failed++ == retry) {
+					fprintf(stderr, "Failed to verify pages %d..%d\n", first_page + page, first_page + page + run - 1);
+					goto out;
+				}
+				goto again;
+			}
+		}
+	}
+
+	fprintf(diag, "\nDifferential write: %d of %d pages changed, %u of %u bytes written%s (%.2f s)\n",
+		changed, num_used, written, size, verify ? " and verified" : "", time_now() - t0);
+	ret = 0;
+
+out:
+	free(used);
+	free(dirty);
+	free(image);
+	return ret;
+}
+
+/* every segment of a sparse file must be in the flash of the device */
+static int segments_in_flash(void)
+{
+	unsigned int i;
+	uint32_t a, l;
+	int ret = 1;
+
+	for (i = 0; i < segment_count(); i++) {
+		segment_get(i, &a, &l);
+		if (!is_addr_in_flash(a) || l > stm->dev->fl_end - a) {
+			fprintf(stderr, "ERROR: %s segment 0x%08x-0x%08x is outside of the flash 0x%08x-0x%08x\n",
+				parser == &PARSER_ELF ? "ELF" : "HEX", a, a + l, stm->dev->fl_start, stm->dev->fl_end);
+			ret = 0;
+		}
+	}
+	return ret;
+}
+
+/*
+ * Write a sparse file segment by segment: the gaps between the PT_LOAD
+ * segments or HEX records are neither erased nor transferred. Segments are widened to
+ * 4 byte alignment and segments sharing a flash page are joined to one
+ * range (the gap between them written as 0xFF), so every page is erased
+ * only once. Verification (-v) compares each range by CRC or read back.
+ */
+static int write_segments(FILE *diag)
+{
+	uint32_t	*range, from, to, a, l, addr;
+	uint8_t		*data = NULL;
+	unsigned int	nseg, nrange, max_wlen, n, i, total = 0, done = 0;
+	int		first_page, num_pages, erased = 0, failed, r, k;
+	int		ret = 1;
+	double		t0 = time_now();
+
+	nseg = segment_count();
+	range = malloc(2 * nseg * sizeof(uint32_t));
+	if (!range) {
+		fprintf(stderr, "Out of memory\n");
+		return 1;
+	}
+
+	/* segments are sorted, don't overlap and are in flash (segments_in_flash) */
+	for (i = 0, nrange = 0; i < nseg; i++) {
+		segment_get(i, &a, &l);
+		from = a & ~3;
+		to   = (a + l + 3) & ~3;
+		if (nrange) {
+			uint32_t prev = range[2 * nrange - 1];
+
+			if (from <= prev || flash_addr_to_page_floor(from) == flash_addr_to_page_floor(prev - 1)) {
+				range[2 * nrange - 1] = to;
+				continue;
+			}
+		}
+		range[2 * nrange]     = from;
+		range[2 * nrange + 1] = to;
+		nrange++;
+	}
+	for (i = 0; i < nrange; i++)
+		total += range[2 * i + 1] - range[2 * i];
+
+	max_wlen = port_opts.tx_frame_max - 2;	/* skip len and crc */
+	max_wlen &= ~3;	/* 32 bit aligned */
+
+	fprintf(diag, "%u segments, %u bytes in %u ranges\n", nseg, total, nrange);
+	for (i = 0; i < nrange; i++) {
+		from = range[2 * i];
+		to   = range[2 * i + 1];
+		data = malloc(to - from);
+		if (!data) {
+			fprintf(stderr, "Out of memory\n");
+			goto out;
+		}
+		segment_read_at(from, data, to - from);
+
+		first_page = flash_addr_to_page_floor(from);
+		num_pages  = flash_addr_to_page_ceil(to) - first_page;
+
+		failed = 0;
+	again:
+		if (!no_erase) {
+			if (erase_pages(first_page, num_pages) != STM32_ERR_OK) {
+				fprintf(stderr, "Failed to erase pages %d..%d\n", first_page, first_page + num_pages - 1);
+				goto out;
+			}
+			erased += num_pages;
+		}
+
+		for (addr = from; addr < to; addr += n) {
+			n = to - addr > max_wlen ? max_wlen : to - addr;
+
+			/* erased flash already reads 0xFF */
+			for (k = 0; k < n && data[addr - from + k] == 0xFF; k++)
+				;
+			if (k < n && write_adaptive(addr, data + (addr - from), n) != STM32_ERR_OK) {
+				fprintf(stderr, "Failed to write memory at address 0x%08x\n", addr);
+				goto out;
+			}
+			fprintf(diag, "\rWrote address 0x%08x (%.2f%%) ", addr + n,
+				(100.0f / total) * (done + addr + n - from));
+			fflush(diag);
+		}
+
+		if (verify) {
+			r = flash_page_differs(from, data, to - from);
+			if (r < 0)
+				goto out;
+			if (r) {
+				if (failed++ == retry) {
+					fprintf(stderr, "Failed to verify 0x%08x-0x%08x\n", from, to);
+					goto out;
+				}
+				goto again;
+			}
+		}
+
+		done += to - from;
+		free(data);
+		data = NULL;
+	}
+
+	fprintf(diag, "\nWrote %u bytes%s, erased %d pages (%.2f s)\n",
+		total, verify ? " and verified" : "", erased, time_now() - t0);
+	ret = 0;
+
+out:
+	free(data);
+	free(range);
+	return ret;
+}
+
+/*
+ * -b auto: step up through the baud rates from 57600. At each one the
+ * target is reset into the bootloader, synced and the link checked with
+ * PROBE_PINGS GET commands. Rates the port can't be set to are skipped,
+ * the first rate that fails ends the probe, the last good one is kept in
+ * port_opts for the real work.
+ * returns 0 if at least one rate worked
+ */
+static int probe_baud(FILE *diag)
+{
+	struct port_interface *port;
+	serial_baud_t rate, best = SERIAL_BAUD_INVALID;
+	stm32_t *s;
+	double t0, t_start = time_now();
+	int i, ok;
+
+	fprintf(diag, "Probing baud rate up to %u\n", serial_get_baud_int(baud_max));
+	for (rate = SERIAL_BAUD_57600; rate <= baud_max; rate++) {
+		t0 = time_now();
+		ok = 0;
+		s = NULL;
+		port_opts.baudRate = rate;
+
+		if (init_rts_pulses(port_opts.device, 3) != 0)
+			break;
+		usleep(250000);
+		if (port_open(&port_opts, &port) != PORT_ERR_OK) {
+			fprintf(diag, "  %7u baud: not supported by the port\n", serial_get_baud_int(rate));
+			init_rts_pulses(port_opts.device, 6);
+			continue;
+		}
+		if ((!init_flag || init_bl_entry(port, gpio_seq)) &&
+		    (s = stm32_init(port, init_flag)) != NULL) {
+			for (i = 0; i < PROBE_PINGS; i++)
+				if (stm32_ping(s) != STM32_ERR_OK)
+					break;
+			ok = i == PROBE_PINGS;
+		}
+		if (s)
+			stm32_close(s);
+		port_close(port);
+		init_rts_pulses(port_opts.device, 6);
+
+		probe[nprobe].baud = serial_get_baud_int(rate);
+		probe[nprobe].ok = ok;
+		probe[nprobe].t = time_now() - t0;
+		fprintf(diag, "  %7u baud: %s (%.2f s)\n", probe[nprobe].baud,
+			ok ? "ok" : "failed", probe[nprobe].t);
+		nprobe++;
+		if (!ok)
+			break;
+		best = rate;
+	}
+	t_phase[PHASE_PROBE] = time_now() - t_start;
+
+	if (best == SERIAL_BAUD_INVALID) {
+		fprintf(stderr, "No working baud rate found on %s\n", port_opts.device);
+		return 1;
+	}
+	port_opts.baudRate = best;
+	fprintf(diag, "Using %u baud\n\n", serial_get_baud_int(best));
+	return 0;
+}
+
+/* -J: timing of the phases and the link statistics as JSON */
+static void json_report(int ret, double t_total)
+{
+	FILE *f;
+	int i;
+
+	f = strcmp(json_file, "-") ? fopen(json_file, "w") : stdout;
+	if (!f) {
+		perror(json_file);
+		return;
+	}
+	fprintf(f, "{\n\t\"device\": \"%s\",\n", port_opts.device);
+	fprintf(f, "\t\"baud\": %u,\n", serial_get_baud_int(port_opts.baudRate));
+	fprintf(f, "\t\"result\": %d,\n", ret);
+	fprintf(f, "\t\"probe\": [");
+	for (i = 0; i < nprobe; i++)
+		fprintf(f, "%s\n\t\t{ \"baud\": %u, \"ok\": %s, \"seconds\": %.3f }",
+			i ? "," : "", probe[i].baud, probe[i].ok ? "true" : "false", probe[i].t);
+	fprintf(f, "%s],\n", nprobe ? "\n\t" : "");
+	fprintf(f, "\t\"phases\": {\n");
+	for (i = 0; i < PHASE_MAX; i++)
+		fprintf(f, "\t\t\"%s\": %.3f,\n", phase_names[i], t_phase[i]);
+	fprintf(f, "\t\t\"total\": %.3f\n\t},\n", t_total);
+	fprintf(f, "\t\"write\": { \"frames\": %lu, \"nacks\": %lu, \"timeouts\": %lu, "
+		"\"chunk_min\": %u, \"chunk_final\": %u }\n}\n",
+		wstat.frames, wstat.nacks, wstat.timeouts, wstat.chunk_min, wchunk);
+	if (f != stdout)
+		fclose(f);
+}
+
+extern const stm32_dev_t devices[];
+
+/* read the whole image once and write it to all devices in parallel */
+static int write_multi(FILE *diag)
+{
+	struct multi_options mo;
+	uint8_t *image;
+	unsigned int size, len, n;
+
+	/* the workers reject an image that is not in their flash, but a sparse
+	 * file (ELF or HEX with data outside of flash) should not get that far */
+	size = parser->size(p_st);
+	for (n = 0, len = 0; devices[n].id; n++)
+		if (devices[n].fl_end - devices[n].fl_start > len)
+			len = devices[n].fl_end - devices[n].fl_start;
+	if (size > len) {
+		fprintf(stderr, "ERROR: the image has %u bytes including gaps, more than the flash of any device\n",
+			size);
+		return 1;
+	}
+	image = malloc(size ? size : 1);
+	if (!image) {
+		fprintf(stderr, "Out of memory\n");
+		return 1;
+	}
+	for (len = 0; len < size; len += n) {
+		n = size - len;
+		if (parser->read(p_st, image + len, &n) != PARSER_ERR_OK || n == 0) {
+			fprintf(stderr, "Failed to read input file\n");
+			free(image);
+			return 1;
+		}
+	}
+
+	memset(&mo, 0, sizeof(mo));
+	mo.port		 = port_opts;
+	mo.start_addr	 = start_addr;
+	mo.readwrite_len = readwrite_len;
+	mo.no_erase	 = no_erase;
+	mo.verify	 = verify;
+	mo.retry	 = retry;
+	mo.init_flag	 = init_flag;
+	mo.gpio_seq	 = gpio_seq;
+	mo.exec_flag	 = exec_flag;
+	mo.execute	 = execute;
+
+	fflush(diag);
+	n = multi_write(targets, ntargets, image, size, &mo);
+	free(image);
+	return n;
+}
+
 /* ------------------------------------------------------------------------------
                                       M-A-I-N
    ------------------------------------------------------------------------------ */
@@ -214,10 +887,7 @@ int main(int argc, char* argv[])
 	stm32_err_t    s_err;
 	parser_err_t   perr;
 	FILE           *diag = stdout;
-
-        int fd;
-        int status;
-        int pulse;
+	double         t_total = time_now(), t0;
 
 	fprintf(diag, "f103flash " VERSION "\n\n");
         fprintf(diag, "Original authors of stm32flash:\n"                               \
@@ -235,42 +905,58 @@ int main(int argc, char* argv[])
 	}
 
 	if (action == ACT_WRITE) {
-		/* first try hex */
-		if (!force_binary) {
-			parser = &PARSER_HEX;
+		/* try ELF, then hex, then binary */
+		static parser_t *const parsers[] = { &PARSER_ELF, &PARSER_HEX, &PARSER_BINARY };
+		unsigned int i;
+
+		for (i = force_binary ? 2 : 0; i < 3; i++) {
+			parser = parsers[i];
 			p_st = parser->init();
 			if (!p_st) {
 				fprintf(stderr, "%s Parser failed to initialize\n", parser->name);
 				goto close;
 			}
+			perr = parser->open(p_st, filename, 0);
+			if (perr != PARSER_ERR_INVALID_FILE || parser == &PARSER_BINARY)
+				break;
+			if (parser == &PARSER_ELF && elf_rejected(p_st))
+				break;
+			parser->close(p_st);
+			p_st = NULL;
 		}
 
-		if (force_binary || (perr = parser->open(p_st, filename, 0)) != PARSER_ERR_OK) {
-			if (force_binary || perr == PARSER_ERR_INVALID_FILE) {
-				if (!force_binary) {
-					parser->close(p_st);
-					p_st = NULL;
-				}
+		/* if still have an error, fail */
+		if (perr != PARSER_ERR_OK) {
+			fprintf(stderr, "%s ERROR: %s\n", parser->name, parser_errstr(perr));
+			if (perr == PARSER_ERR_SYSTEM) perror(filename);
+			goto close;
+		}
 
-				/* now try binary */
-				parser = &PARSER_BINARY;
-				p_st = parser->init();
-				if (!p_st) {
-					fprintf(stderr, "%s Parser failed to initialize\n", parser->name);
-					goto close;
-				}
-				perr = parser->open(p_st, filename, 0);
-			}
+		fprintf(diag, "Using Parser : %s\n", parser->name);
 
-			/* if still have an error, fail */
-			if (perr != PARSER_ERR_OK) {
-				fprintf(stderr, "%s ERROR: %s\n", parser->name, parser_errstr(perr));
-				if (perr == PARSER_ERR_SYSTEM) perror(filename);
+		/* an ELF file brings its own load addresses */
+		if (parser == &PARSER_ELF) {
+			if ((start_addr && start_addr != elf_base(p_st)) || spage || npages) {
+				fprintf(stderr, "ERROR: the ELF file is linked for 0x%08x, it can't be moved with -S, -s or -e\n",
+					elf_base(p_st));
 				goto close;
 			}
+			start_addr = elf_base(p_st);
+			sparse = 1;
 		}
 
-		fprintf(diag, "Using Parser : %s\n", parser->name);
+		/* so does a HEX file starting with an address record, unless it
+		 * is moved with -S, -s or -e: then it is written as flat image */
+		if (parser == &PARSER_HEX && hex_base(p_st) &&
+		    (!start_addr || start_addr == hex_base(p_st)) && !spage && !npages) {
+			start_addr = hex_base(p_st);
+			sparse = 1;
+		}
+
+		if (ntargets > 1) {
+			ret = write_multi(diag);
+			goto close_multi;
+		}
 	} else {
 		parser = &PARSER_BINARY;
 		p_st = parser->init();
@@ -281,44 +967,17 @@ int main(int argc, char* argv[])
 	}
 
 
+	if (baud_probe && probe_baud(diag) != 0)
+		goto close;
+
+	t0 = time_now();
         fprintf(stderr, "activate bootloader\n\n");
-        if ((fd = open(port_opts.device,O_RDWR)) < 0)
+        if (init_rts_pulses(port_opts.device, 3) != 0)
         {
-          printf("Failure: %s not present\n",argv[1]);
+          printf("Failure: %s not present\n", port_opts.device);
           exit(1);
         }
 
-        tcgetattr(fd, &tio);
-        tio.c_cflag &= ~HUPCL;             // HUPCL - Bit loeschen
-        tcsetattr(fd, TCSANOW, &tio);
-
-        ioctl(fd, TIOCMGET, &status);      // Status Serielle Schnittstelle
-
-          status &= ~TIOCM_RTS;              // RTS
-          ioctl(fd, TIOCMSET, &status);      // setzen
-          fflush(stdout);
-          usleep(100000);
-
-        for (pulse= 0; pulse< 3; pulse++)
-        {
-          status &= ~TIOCM_RTS;              // RTS
-          ioctl(fd, TIOCMSET, &status);      // setzen
-          fflush(stdout);
-          usleep(1000);
-
-          status |= TIOCM_RTS;               // RTS
-          ioctl(fd, TIOCMSET, &status);      // loeschen
-          fflush(stdout);
-          usleep(1000);
-
-          status &= ~TIOCM_RTS;              // RTS
-          ioctl(fd, TIOCMSET, &status);      // setzen
-          fflush(stdout);
-          usleep(1000);
-        }
-
-        close(fd);                         // Device schliessen
-
         usleep(250000);
 
 
@@ -333,6 +992,7 @@ int main(int argc, char* argv[])
 	stm = stm32_init(port, init_flag);
 	if (!stm)
 		goto close;
+	t_phase[PHASE_CONNECT] = time_now() - t0;
 
 	fprintf(diag, "Version      : 0x%02x\n", stm->bl_version);
 	if (port->flags & PORT_GVR_ETX) {
@@ -345,6 +1005,9 @@ int main(int argc, char* argv[])
 	fprintf(diag, "- Option RAM : %db\n", stm->dev->opt_end - stm->dev->opt_start + 1);
 	fprintf(diag, "- System RAM : %dKiB\n", (stm->dev->mem_end - stm->dev->mem_start) / 1024);
 
+	if (action == ACT_WRITE && sparse && !segments_in_flash())
+		goto close;
+
 	uint8_t		buffer[256];
 	uint32_t	addr, start, end;
 	unsigned int	len;
@@ -491,6 +1154,11 @@ int main(int argc, char* argv[])
 		ssize_t r;
 		unsigned int size;
 		unsigned int max_wlen, max_rlen;
+		uint8_t *pg_buf = NULL;
+		uint32_t pg_start = 0, pg_end = 0, pg_from = 0, pg_to = 0, *psize;
+		uint32_t img_crc = 0xFFFFFFFF, dev_crc;
+		int pg = 0;
+		double t0;
 
 		max_wlen = port_opts.tx_frame_max - 2;	/* skip len and crc */
 		max_wlen &= ~3;	/* 32 bit aligned */
@@ -511,17 +1179,39 @@ int main(int argc, char* argv[])
 		//	goto close;
 		// }
 
+		if (diff_flag) {
+			ret = write_differential(start, end, size, diag);
+			goto close;
+		}
+
+		if (sparse) {
+			ret = write_segments(diag);
+			goto close;
+		}
+
 		// TODO: If writes are not page aligned, we should probably read out existing flash
 		//       contents first, so it can be preserved and combined with new data
 		if (!no_erase && num_pages) {
 			fprintf(diag, "Erasing memory\n");
-			s_err = stm32_erase_memory(stm, first_page, num_pages);
+			s_err = erase_pages(first_page, num_pages);
 			if (s_err != STM32_ERR_OK) {
 				fprintf(stderr, "Failed to erase memory\n");
 				goto close;
 			}
 		}
 
+		if (verify && verify_mode == VERIFY_PAGE) {
+			if (!is_addr_in_flash(start)) {
+				fprintf(stderr, "crc-per-page verification needs a flash address\n");
+				goto close;
+			}
+			for (psize = stm->dev->fl_ps, len = 0; *psize; psize++)
+				len = *psize > len ? *psize : len;
+			pg_buf = malloc(len);
+			if (!pg_buf)
+				goto close;
+		}
+
 		fflush(diag);
 		addr = start;
 		while(addr < end && offset < size) {
@@ -529,6 +1219,18 @@ int main(int argc, char* argv[])
 			len		= max_wlen > left ? left : max_wlen;
 			len		= len > size - offset ? size - offset : len;
 
+			if (pg_buf) {
+				/* a block must not cross a page boundary */
+				if (addr >= pg_end) {
+					pg = flash_addr_to_page_floor(addr);
+					pg_start = flash_page_to_addr(pg);
+					pg_end = flash_page_to_addr(pg + 1);
+					pg_from = pg_to = addr;
+					memset(pg_buf, 0xFF, pg_end - pg_start);
+				}
+				len = len > pg_end - addr ? pg_end - addr : len;
+			}
+
 			if (parser->read(p_st, buffer, &len) != PARSER_ERR_OK)
 				goto close;
 
@@ -542,27 +1244,29 @@ int main(int argc, char* argv[])
 			}
 
 			again:
-			s_err = stm32_write_memory(stm, addr, buffer, len);
+			s_err = write_adaptive(addr, buffer, len);
 			if (s_err != STM32_ERR_OK) {
 				fprintf(stderr, "Failed to write memory at address 0x%08x\n", addr);
 				goto close;
 			}
 
-			if (verify) {
+			if (verify && verify_mode == VERIFY_READBACK) {
 				uint8_t compare[len];
 				unsigned int offset, rlen;
+				double t0 = time_now();
 
 				offset = 0;
 				while (offset < len) {
 					rlen = len - offset;
 					rlen = rlen < max_rlen ? rlen : max_rlen;
-					s_err = stm32_read_memory(stm, addr + offset, compare + offset, rlen);
+					s_err = read_memory(addr + offset, compare + offset, rlen);
 					if (s_err != STM32_ERR_OK) {
 						fprintf(stderr, "Failed to read memory at address 0x%08x\n", addr + offset);
 						goto close;
 					}
 					offset += rlen;
 				}
+				t_phase[PHASE_VERIFY] += time_now() - t0;
 
 				for(r = 0; r < len; ++r)
 					if (buffer[r] != compare[r]) {
@@ -581,12 +1285,29 @@ int main(int argc, char* argv[])
 				failed = 0;
 			}
 
+			if (verify && verify_mode == VERIFY_IMAGE) {
+				/* the device pads the block with 0xFF */
+				for (r = len; r & 3; r++)
+					buffer[r] = 0xFF;
+				img_crc = stm32_sw_crc(img_crc, buffer, r);
+			}
+
+			if (pg_buf) {
+				memcpy(pg_buf + (addr - pg_start), buffer, len);
+				pg_to = (addr + len + 3) & ~3;
+				if (addr + len == pg_end) {
+					if (verify_page(pg, pg_from, pg_to, pg_buf + (pg_from - pg_start)))
+						goto close;
+					pg_from = pg_to;
+				}
+			}
+
 			addr	+= len;
 			offset	+= len;
 
 			fprintf(diag,
 				"\rWrote %saddress 0x%08x (%.2f%%) ",
-				verify ? "and verified " : "",
+				verify && verify_mode == VERIFY_READBACK ? "and verified " : "",
 				addr,
 				(100.0f / size) * offset
 			);
@@ -594,6 +1315,29 @@ int main(int argc, char* argv[])
 
 		}
 
+		/* last, partly written page */
+		if (pg_buf && pg_to > pg_from)
+			if (verify_page(pg, pg_from, pg_to, pg_buf + (pg_from - pg_start)))
+				goto close;
+
+		if (verify && verify_mode == VERIFY_IMAGE) {
+			fprintf(diag, "\n");
+			len = (addr - start + 3) & ~3;
+			t0 = time_now();
+			if (stm32_crc_wrapper(stm, start, len, &dev_crc) != STM32_ERR_OK) {
+				fprintf(stderr, "Failed to read CRC\n");
+				goto close;
+			}
+			t_phase[PHASE_VERIFY] += time_now() - t0;
+			if (dev_crc != img_crc) {
+				fprintf(stderr, "Failed to verify, CRC(0x%08x-0x%08x) is 0x%08x, expected 0x%08x\n",
+					start, start + len, dev_crc, img_crc);
+				goto close;
+			}
+			fprintf(diag, "CRC(0x%08x-0x%08x) = 0x%08x verified\n", start, start + len, img_crc);
+		}
+		free(pg_buf);
+
 		fprintf(diag,	"Done.\n");
 		ret = 0;
 		goto close;
@@ -640,51 +1384,51 @@ close:
 	if (p_st  ) parser->close(p_st);
 	if (stm   ) stm32_close  (stm);
 	if (port)
-		port->close(port);
+		port_close(port);
 
 	fprintf(diag, "\n");
 
         fprintf(stderr, "\ndeactivate bootloader\n\n");
-        if ((fd = open(port_opts.device,O_RDWR)) < 0)
+        if (init_rts_pulses(port_opts.device, 6) != 0)
         {
-          printf("Failure: %s not present\n",argv[1]);
+          printf("Failure: %s not present\n", port_opts.device);
           exit(1);
         }
 
+	if (json_file)
+		json_report(ret, time_now() - t_total);
+	return ret;
 
-        tcgetattr(fd, &tio);
-        tio.c_cflag &= ~HUPCL;             // HUPCL - Bit loeschen
-        tcsetattr(fd, TCSANOW, &tio);
-
-        ioctl(fd, TIOCMGET, &status);      // Status Serielle Schnittstelle
-
-          status &= ~TIOCM_RTS;              // RTS
-          ioctl(fd, TIOCMSET, &status);      // setzen
-          fflush(stdout);
-          usleep(100000);
-
-        for (pulse= 0; pulse< 6; pulse++)
-        {
-          status &= ~TIOCM_RTS;              // RTS
-          ioctl(fd, TIOCMSET, &status);      // setzen
-          fflush(stdout);
-          usleep(1000);
-
-          status |= TIOCM_RTS;               // RTS
-          ioctl(fd, TIOCMSET, &status);      // loeschen
-          fflush(stdout);
-          usleep(1000);
-
-          status &= ~TIOCM_RTS;              // RTS
-          ioctl(fd, TIOCMSET, &status);      // setzen
-          fflush(stdout);
-          usleep(1000);
-        }
+close_multi:
+	if (p_st) parser->close(p_st);
+	return ret;
+}
 
-        close(fd);                         // Device schliessen
+/* add a device, or all devices matching a glob pattern, to the target list */
+static int add_devices(const char *pattern)
+{
+	glob_t g;
+	size_t i;
+	char **n;
+
+	if (!strpbrk(pattern, "*?[")) {
+		g.gl_pathc = 1;
+		g.gl_pathv = (char **)&pattern;
+	} else if (glob(pattern, 0, NULL, &g) != 0) {
+		fprintf(stderr, "ERROR: No device matches %s\n", pattern);
+		return 1;
+	}
 
+	n = realloc(targets, (ntargets + g.gl_pathc) * sizeof(char *));
+	if (!n)
+		return 1;
+	targets = n;
+	for (i = 0; i < g.gl_pathc; i++)
+		targets[ntargets++] = strdup(g.gl_pathv[i]);
 
-	return ret;
+	if (g.gl_pathv != (char **)&pattern)
+		globfree(&g);
+	return 0;
 }
 
 int parse_options(int argc, char *argv[])
@@ -692,13 +1436,26 @@ int parse_options(int argc, char *argv[])
 	int c;
 	char *pLen;
 
-	while ((c = getopt(argc, argv, "a:b:m:r:w:e:vn:g:jkfcChuos:S:F:i:R")) != -1) {
+	while ((c = getopt(argc, argv, "a:b:m:r:w:e:vV:n:g:jkfcChuos:S:F:i:RDx:J:")) != -1) {
 		switch(c) {
 			case 'a':
 				port_opts.bus_addr = strtoul(optarg, NULL, 0);
 				break;
 
 			case 'b':
+				if (!strncmp(optarg, "auto", 4)) {
+					baud_probe = 1;
+					port_opts.baudRate = SERIAL_BAUD_57600;
+					if (optarg[4] == ':')
+						baud_max = serial_get_baud(strtoul(optarg + 5, NULL, 0));
+					else if (optarg[4])
+						baud_max = SERIAL_BAUD_INVALID;
+					if (baud_max == SERIAL_BAUD_INVALID || baud_max < SERIAL_BAUD_57600) {
+						fprintf(stderr, "Invalid maximum baud rate for -b auto\n");
+						return 1;
+					}
+					break;
+				}
 				port_opts.baudRate = serial_get_baud(strtoul(optarg, NULL, 0));
 				if (port_opts.baudRate == SERIAL_BAUD_INVALID) {
 					serial_baud_t baudrate;
@@ -781,6 +1538,17 @@ int parse_options(int argc, char *argv[])
 				verify = 1;
 				break;
 
+			case 'V':
+				for (verify_mode = 0; verify_names[verify_mode]; verify_mode++)
+					if (!strcmp(optarg, verify_names[verify_mode]))
+						break;
+				if (!verify_names[verify_mode]) {
+					fprintf(stderr, "ERROR: Invalid verify strategy, valid are readback, crc-per-page and crc-whole-image\n");
+					return 1;
+				}
+				verify = 1;
+				break;
+
 			case 'n':
 				retry = strtoul(optarg, NULL, 0);
 				break;
@@ -866,6 +1634,19 @@ int parse_options(int argc, char *argv[])
 				reset_flag = 1;
 				break;
 
+			case 'D':
+				diff_flag = 1;
+				break;
+
+			case 'x':
+				if (stm32_crc_select(optarg) != 0)
+					return 1;
+				break;
+
+			case 'J':
+				json_file = optarg;
+				break;
+
 			case 'C':
 				if (action != ACT_NONE) {
 					err_multi_action(ACT_CRC);
@@ -876,14 +1657,11 @@ int parse_options(int argc, char *argv[])
 		}
 	}
 
-	for (c = optind; c < argc; ++c) {
-		if (port_opts.device) {
-			fprintf(stderr, "ERROR: Invalid parameter specified\n");
-			show_help(argv[0]);
+	for (c = optind; c < argc; ++c)
+		if (add_devices(argv[c]) != 0)
 			return 1;
-		}
-		port_opts.device = argv[c];
-	}
+	if (ntargets)
+		port_opts.device = targets[0];
 
 	if (port_opts.device == NULL) {
 		fprintf(stderr, "ERROR: Device not specified\n");
@@ -897,24 +1675,58 @@ int parse_options(int argc, char *argv[])
 		return 1;
 	}
 
+	if (ntargets > 1 && baud_probe) {
+		fprintf(stderr, "ERROR: Invalid usage, -b auto needs a single device\n");
+		return 1;
+	}
+
+	if (ntargets > 1 && (action != ACT_WRITE || filename[0] == '-')) {
+		fprintf(stderr, "ERROR: Invalid usage, several devices are only valid when writing from a file\n");
+		show_help(argv[0]);
+		return 1;
+	}
+
+	/* the workers in multi.c write fixed chunks and only verify by read back */
+	if (ntargets > 1 && (diff_flag || json_file || (verify && verify_mode != VERIFY_READBACK))) {
+		fprintf(stderr, "ERROR: Invalid usage, -D, -J, -V crc-per-page and -V crc-whole-image need a single device\n");
+		return 1;
+	}
+
+	if (diff_flag && (action != ACT_WRITE || filename[0] == '-')) {
+		fprintf(stderr, "ERROR: Invalid usage, -D is only valid when writing from a file\n");
+		show_help(argv[0]);
+		return 1;
+	}
+
 	return 0;
 }
 
 void show_help(char *name) {
 	fprintf(stderr,
-		"Usage: %s [-bvngfhc] [-[rw] filename] [tty_device | i2c_device]\n"
+		"Usage: %s [-bvngfhc] [-[rw] filename] [tty_device ... | i2c_device]\n"
 		"	-a bus_address	Bus address (e.g. for I2C port)\n"
 		"	-b rate		Baud rate (default 57600)\n"
+		"	-b auto[:max]	Probe the highest working baud rate, from 57600\n"
+		"			up to max (default 2000000)\n"
 		"	-m mode		Serial port mode (default 8e1)\n"
 		"	-r filename	Read flash to file (or - stdout)\n"
 		"	-w filename	Write flash from file (or - stdout)\n"
+		"			ELF, Intel HEX or binary, an ELF file is written\n"
+		"			to its load addresses, gaps are not erased\n"
 		"	-C		Compute CRC of flash content\n"
+		"	-x engine	Software CRC engine: slice8 (default), slice4,\n"
+		"			branchless or bitwise\n"
+		"	-J filename	Write the time of each phase as JSON (or - stdout)\n"
 		"	-u		Disable the flash write-protection\n"
 		"	-j		Enable the flash read-protection\n"
 		"	-k		Disable the flash read-protection\n"
 		"	-o		Erase only\n"
 		"	-e n		Only erase n pages before writing the flash\n"
 		"	-v		Verify writes\n"
+		"	-V strategy	Verify writes with strategy readback (default, same\n"
+		"			as -v), crc-per-page or crc-whole-image\n"
+		"	-D		Differential write: erase and write only the\n"
+		"			pages that differ from the file\n"
 		"	-n count	Retry failed writes up to count times (default 10)\n"
 		"	-g address	Start execution at specified address (0 = flash start)\n"
 		"	-S address[:length]	Specify start address and optionally length for\n"
@@ -943,6 +1755,9 @@ void show_help(char *name) {
 		"	Read 100 bytes of flash from 0x1000 to stdout:\n"
 		"		%s -r - -S 0x1000:100 /dev/ttyS0\n"
 		"\n"
+		"	Write the same file to all CH340 adapters in parallel:\n"
+		"		%s -w filename '/dev/ttyUSB*'\n"
+		"\n"
 		"	Start execution:\n"
 		"		%s -g 0x0 /dev/ttyS0\n",
                 name,
@@ -951,6 +1766,7 @@ void show_help(char *name) {
 		name,
 		name,
 		name,
+		name,
 		name
         );
 }
@@ -0,0 +1,319 @@
+/*
+  stm32flash - Open Source ST STM32 flash program for *nix
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+/*
+ * Write the same image to several targets at once, one thread per port.
+ * The image is parsed once by main() and shared read-only. Each worker
+ * runs the complete sequence of a single target: RTS pulses to enter
+ * the bootloader, init, erase, write (and verify), RTS pulses to leave.
+ * The main thread only prints the progress of all targets and a summary.
+ */
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "init.h"
+#include "multi.h"
+#include "port.h"
+#include "stm32.h"
+
+enum job_state {
+	JOB_WAIT,
+	JOB_CONNECT,
+	JOB_ERASE,
+	JOB_WRITE,
+	JOB_OK,
+	JOB_FAIL
+};
+
+static const char *const job_state_str[] = {
+	"wait", "connect", "erase", "write", "ok", "FAIL"
+};
+
+struct job {
+	pthread_t		thread;
+	int			started;
+	const struct multi_options *opts;
+	struct port_options	port_opts;
+	const uint8_t		*image;
+	unsigned int		size;
+
+	/* written by the worker, read by the main thread. While the worker
+	 * runs, state and done are only accessed through the accessors below,
+	 * the other fields are valid once job_state() returned JOB_OK or
+	 * JOB_FAIL (release / acquire on state) */
+	enum job_state		state;
+	unsigned int		done;		/* bytes written */
+	const char		*error;
+	uint16_t		pid;
+	double			t_start, t_end;
+};
+
+static inline void job_set_state(struct job *job, enum job_state state)
+{
+	__atomic_store_n(&job->state, state, __ATOMIC_RELEASE);
+}
+
+static inline enum job_state job_state(struct job *job)
+{
+	return __atomic_load_n(&job->state, __ATOMIC_ACQUIRE);
+}
+
+static inline void job_set_done(struct job *job, unsigned int done)
+{
+	__atomic_store_n(&job->done, done, __ATOMIC_RELAXED);
+}
+
+static inline unsigned int job_done(struct job *job)
+{
+	return __atomic_load_n(&job->done, __ATOMIC_RELAXED);
+}
+
+static double time_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* pages covering [start, end) */
+static void page_range(const stm32_dev_t *dev, uint32_t start, uint32_t end,
+		       uint32_t *first, uint32_t *num)
+{
+	uint32_t addr = dev->fl_start, page = 0;
+	uint32_t *psize = dev->fl_ps;
+
+	*first = 0;
+	while (addr < end && addr < dev->fl_end) {
+		if (addr + psize[0] <= start)
+			*first = page + 1;
+		addr += psize[0];
+		page++;
+		if (psize[1])
+			psize++;
+	}
+	*num = page - *first;
+}
+
+static int job_flash(struct job *job, stm32_t *stm)
+{
+	const struct multi_options *opts = job->opts;
+	uint8_t compare[256];
+	uint32_t start, end, addr, first_page, num_pages;
+	unsigned int max_wlen, max_rlen, len, offset, rlen, done;
+	int failed;
+
+	start = opts->start_addr ? opts->start_addr : stm->dev->fl_start;
+	end = stm->dev->fl_end;
+	if (opts->readwrite_len && end > start + opts->readwrite_len)
+		end = start + opts->readwrite_len;
+	if (start < stm->dev->fl_start || start >= end) {
+		job->error = "start address not in flash";
+		return -1;
+	}
+	if (job->size > end - start) {
+		job->error = "image larger than flash";
+		return -1;
+	}
+
+	if (!opts->no_erase) {
+		job_set_state(job, JOB_ERASE);
+		page_range(stm->dev, start, end, &first_page, &num_pages);
+		if (!first_page && end == stm->dev->fl_end)
+			num_pages = STM32_MASS_ERASE;
+		if (stm32_erase_memory(stm, first_page, num_pages) != STM32_ERR_OK) {
+			job->error = "erase failed";
+			return -1;
+		}
+	}
+
+	max_wlen = job->port_opts.tx_frame_max - 2;	/* skip len and crc */
+	max_wlen &= ~3;	/* 32 bit aligned */
+	max_rlen = job->port_opts.rx_frame_max;
+	max_rlen = max_rlen < max_wlen ? max_rlen : max_wlen;
+
+	job_set_state(job, JOB_WRITE);
+	failed = 0;
+	for (addr = start, done = 0; done < job->size; ) {
+		len = job->size - done;
+		len = len > max_wlen ? max_wlen : len;
+
+		if (stm32_write_memory(stm, addr, job->image + done, len) != STM32_ERR_OK) {
+			job->error = "write failed";
+			return -1;
+		}
+
+		if (opts->verify) {
+			for (offset = 0; offset < len; offset += rlen) {
+				rlen = len - offset;
+				rlen = rlen < max_rlen ? rlen : max_rlen;
+				if (stm32_read_memory(stm, addr + offset, compare + offset, rlen) != STM32_ERR_OK) {
+					job->error = "read back failed";
+					return -1;
+				}
+			}
+			if (memcmp(compare, job->image + done, len)) {
+				if (failed++ == opts->retry) {
+					job->error = "verify failed";
+					return -1;
+				}
+				continue;	/* write the block again */
+			}
+			failed = 0;
+		}
+
+		addr += len;
+		done += len;
+		job_set_done(job, done);
+	}
+
+	if (opts->exec_flag) {
+		addr = opts->execute ? opts->execute : stm->dev->fl_start;
+		if (stm32_go(stm, addr) != STM32_ERR_OK) {
+			job->error = "go failed";
+			return -1;
+		}
+	}
+	return 0;
+}
+
+static void *job_run(void *arg)
+{
+	struct job *job = arg;
+	struct port_interface *port = NULL;
+	stm32_t *stm = NULL;
+	int ret = -1;
+
+	job->t_start = time_now();
+	job_set_state(job, JOB_CONNECT);
+
+	if (init_rts_pulses(job->port_opts.device, 3) != 0) {
+		job->error = "device not present";
+		goto out;
+	}
+	usleep(250000);
+
+	if (port_open(&job->port_opts, &port) != PORT_ERR_OK) {
+		job->error = "failed to open port";
+		goto out;
+	}
+	if (job->opts->init_flag && init_bl_entry(port, job->opts->gpio_seq) == 0) {
+		job->error = "bootloader entry failed";
+		goto out;
+	}
+	stm = stm32_init(port, job->opts->init_flag);
+	if (!stm) {
+		job->error = "no answer from bootloader";
+		goto out;
+	}
+	job->pid = stm->pid;
+
+	ret = job_flash(job, stm);
+
+out:
+	if (stm)
+		stm32_close(stm);
+	if (port)
+		port_close(port);
+	init_rts_pulses(job->port_opts.device, 6);
+
+	job->t_end = time_now();
+	job_set_state(job, ret ? JOB_FAIL : JOB_OK);
+	return NULL;
+}
+
+static const char *short_name(const char *device)
+{
+	const char *p = strrchr(device, '/');
+
+	return p ? p + 1 : device;
+}
+
+int multi_write(char *const devices[], int ndevices,
+		const uint8_t *image, unsigned int size,
+		const struct multi_options *opts)
+{
+	struct job *jobs;
+	enum job_state state;
+	int i, running, failed;
+	double t;
+
+	jobs = calloc(ndevices, sizeof(struct job));
+	if (!jobs)
+		return 1;
+
+	/* make the CRC tables before any thread needs them */
+	stm32_crc_select(NULL);
+
+	for (i = 0; i < ndevices; i++) {
+		jobs[i].opts = opts;
+		jobs[i].port_opts = opts->port;
+		jobs[i].port_opts.device = devices[i];
+		jobs[i].image = image;
+		jobs[i].size = size;
+		jobs[i].state = JOB_WAIT;
+		if (pthread_create(&jobs[i].thread, NULL, job_run, &jobs[i])) {
+			jobs[i].error = "can't create thread";
+			jobs[i].state = JOB_FAIL;
+		} else
+			jobs[i].started = 1;
+	}
+
+	fprintf(stdout, "Writing %u bytes to %d targets\n", size, ndevices);
+	do {
+		usleep(200000);
+		running = 0;
+		fprintf(stdout, "\r");
+		for (i = 0; i < ndevices; i++) {
+			state = job_state(&jobs[i]);
+			if (state == JOB_WRITE)
+				fprintf(stdout, "%s %3u%%  ", short_name(devices[i]),
+					size ? job_done(&jobs[i]) * 100 / size : 100);
+			else
+				fprintf(stdout, "%s %s  ", short_name(devices[i]),
+					job_state_str[state]);
+			running += state < JOB_OK;
+		}
+		fflush(stdout);
+	} while (running);
+	fprintf(stdout, "\n\n");
+
+	failed = 0;
+	fprintf(stdout, "%-20s %-6s %-7s %10s %8s %8s  %s\n",
+		"Device", "Result", "ID", "Bytes", "Time", "KiB/s", "Error");
+	for (i = 0; i < ndevices; i++) {
+		if (jobs[i].started)
+			pthread_join(jobs[i].thread, NULL);
+		t = jobs[i].t_end - jobs[i].t_start;
+		fprintf(stdout, "%-20s %-6s 0x%04x  %10u %7.2fs %8.1f  %s\n",
+			devices[i], job_state_str[jobs[i].state], jobs[i].pid,
+			jobs[i].done, t, t > 0 ? jobs[i].done / t / 1024 : 0,
+			jobs[i].error ? jobs[i].error : "");
+		failed += jobs[i].state != JOB_OK;
+	}
+	fprintf(stdout, "\n%d of %d targets written\n", ndevices - failed, ndevices);
+
+	free(jobs);
+	return failed ? 1 : 0;
+}
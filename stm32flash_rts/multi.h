@@ -0,0 +1,44 @@
+/*
+  stm32flash - Open Source ST STM32 flash program for *nix
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+
+#ifndef _MULTI_H
+#define _MULTI_H
+
+#include <stdint.h>
+#include "port.h"
+
+/* settings shared by all targets, taken from the command line */
+struct multi_options {
+	struct port_options	port;		/* device is set per target */
+	uint32_t		start_addr;	/* 0 = flash start */
+	uint32_t		readwrite_len;	/* 0 = up to the end of flash */
+	int			no_erase;
+	char			verify;
+	int			retry;
+	char			init_flag;
+	const char		*gpio_seq;
+	char			exec_flag;
+	uint32_t		execute;	/* 0 = flash start */
+};
+
+int multi_write(char *const devices[], int ndevices,
+		const uint8_t *image, unsigned int size,
+		const struct multi_options *opts);
+
+#endif
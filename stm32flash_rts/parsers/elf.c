@@ -0,0 +1,270 @@
+/*
+  stm32flash - Open Source ST STM32 flash program for *nix
+  Copyright (C) 2010 Geoffrey McRae <geoff@spacevs.com>
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "elf.h"
+
+/*
+ * Only what is needed to flash an image is taken from the file: the
+ * PT_LOAD program headers of a 32 bit little endian ELF file. Each one
+ * with file data becomes a segment at its physical (load) address, so
+ * initialised data is placed behind the code in flash and not at its
+ * run time address in RAM. Sections, symbols and the memory-only part
+ * of a segment (.bss) are ignored. The header fields are decoded byte
+ * by byte, there is no dependency on the host's <elf.h>.
+ */
+
+#define EI_NIDENT	16
+#define ELFCLASS32	1
+#define ELFDATA2LSB	1
+#define ET_EXEC		2
+#define PT_LOAD		1
+
+#define EHDR_SIZE	52		/* Elf32_Ehdr */
+#define PHDR_SIZE	32		/* Elf32_Phdr */
+
+typedef struct {
+	uint32_t	addr;		/* load address */
+	uint32_t	len;
+	const uint8_t	*data;		/* points into elf_t.file */
+} elf_seg_t;
+
+typedef struct {
+	uint8_t		*file;
+	elf_seg_t	*seg;
+	unsigned int	seg_count;
+	uint32_t	base;		/* address of the first byte of the image */
+	uint32_t	data_len;	/* image size, including gaps */
+	uint32_t	offset;		/* read position in the image */
+	int		rejected;	/* ELF magic, but not usable */
+} elf_t;
+
+static inline uint16_t le16(const uint8_t *p) {
+	return p[0] | (p[1] << 8);
+}
+
+static inline uint32_t le32(const uint8_t *p) {
+	return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+void* elf_init() {
+	return calloc(sizeof(elf_t), 1);
+}
+
+/* read a whole file into memory */
+static uint8_t *elf_load(const char *filename, size_t *size) {
+	struct stat	sb;
+	uint8_t		*buf;
+	size_t		done;
+	ssize_t		r;
+	int		fd;
+
+	fd = open(filename, O_RDONLY);
+	if (fd < 0) return NULL;
+	if (fstat(fd, &sb) != 0 || (buf = malloc(sb.st_size + 1)) == NULL) {
+		close(fd);
+		return NULL;
+	}
+
+	done = 0;
+	while (done < (size_t)sb.st_size) {
+		r = read(fd, buf + done, sb.st_size - done);
+		if (r <= 0) break;
+		done += r;
+	}
+	close(fd);
+
+	*size = done;
+	return buf;
+}
+
+static int elf_seg_cmp(const void *a, const void *b) {
+	const elf_seg_t *x = a, *y = b;
+
+	if (x->addr < y->addr) return -1;
+	return x->addr > y->addr;
+}
+
+/* an ELF file we can't use: say why, elf_rejected() keeps main() from
+ * trying the other parsers on it */
+static parser_err_t elf_bad(elf_t *st, const char *filename, const char *why) {
+	fprintf(stderr, "%s: %s\n", filename, why);
+	st->rejected = 1;
+	return PARSER_ERR_INVALID_FILE;
+}
+
+parser_err_t elf_open(void *storage, const char *filename, const char write) {
+	elf_t *st = storage;
+	const uint8_t *ph;
+	size_t size;
+	uint32_t phoff, off, len, addr;
+	unsigned int phentsize, phnum, i;
+
+	if (write)
+		return PARSER_ERR_RDONLY;
+
+	/* stdin can't be looked at twice, leave it to the binary parser */
+	if (filename[0] == '-' && filename[1] == '\0')
+		return PARSER_ERR_INVALID_FILE;
+
+	st->file = elf_load(filename, &size);
+	if (st->file == NULL)
+		return PARSER_ERR_SYSTEM;
+
+	if (size < EI_NIDENT || memcmp(st->file, "\177ELF", 4) != 0)
+		return PARSER_ERR_INVALID_FILE;
+
+	if (st->file[4] != ELFCLASS32 || st->file[5] != ELFDATA2LSB)
+		return elf_bad(st, filename, "not a 32 bit little endian ELF file");
+	if (size < EHDR_SIZE || le16(st->file + 16) != ET_EXEC)
+		return elf_bad(st, filename, "not an ELF executable");
+
+	phoff     = le32(st->file + 28);
+	phentsize = le16(st->file + 42);
+	phnum     = le16(st->file + 44);
+	if (phnum == 0 || phentsize < PHDR_SIZE ||
+	    phoff > size || (size - phoff) / phentsize < phnum)
+		return elf_bad(st, filename, "invalid program header table");
+
+	st->seg = calloc(phnum, sizeof(elf_seg_t));
+	if (st->seg == NULL)
+		return PARSER_ERR_SYSTEM;
+
+	for (i = 0; i < phnum; i++) {
+		ph = st->file + phoff + i * phentsize;
+		if (le32(ph) != PT_LOAD)
+			continue;
+		off  = le32(ph + 4);
+		addr = le32(ph + 12);		/* p_paddr */
+		len  = le32(ph + 16);		/* p_filesz */
+		if (len == 0)
+			continue;
+		if (off > size || size - off < len || addr + len < addr)
+			return elf_bad(st, filename, "PT_LOAD segment outside of the file");
+
+		st->seg[st->seg_count].addr = addr;
+		st->seg[st->seg_count].len  = len;
+		st->seg[st->seg_count].data = st->file + off;
+		st->seg_count++;
+	}
+	if (st->seg_count == 0)
+		return elf_bad(st, filename, "no loadable data");
+
+	qsort(st->seg, st->seg_count, sizeof(elf_seg_t), elf_seg_cmp);
+	for (i = 1; i < st->seg_count; i++)
+		if (st->seg[i].addr < st->seg[i - 1].addr + st->seg[i - 1].len)
+			return elf_bad(st, filename, "overlapping PT_LOAD segments");
+
+	st->base     = st->seg[0].addr;
+	st->data_len = st->seg[i - 1].addr + st->seg[i - 1].len - st->base;
+	return PARSER_ERR_OK;
+}
+
+parser_err_t elf_close(void *storage) {
+	elf_t *st = storage;
+
+	if (st) {
+		free(st->seg);
+		free(st->file);
+	}
+	free(st);
+	return PARSER_ERR_OK;
+}
+
+unsigned int elf_size(void *storage) {
+	elf_t *st = storage;
+	return st->data_len;
+}
+
+void elf_read_at(void *storage, uint32_t addr, void *data, unsigned int len) {
+	elf_t *st = storage;
+	uint8_t *out = data;
+	unsigned int i;
+	uint32_t from, to;
+
+	memset(out, 0xff, len);
+	for (i = 0; i < st->seg_count; i++) {
+		elf_seg_t *s = &st->seg[i];
+
+		if (s->addr >= addr + len) break;
+		if (s->addr + s->len <= addr) continue;
+		from = s->addr > addr ? s->addr : addr;
+		to   = s->addr + s->len < addr + len ? s->addr + s->len : addr + len;
+		memcpy(out + (from - addr), s->data + (from - s->addr), to - from);
+	}
+}
+
+parser_err_t elf_read(void *storage, void *data, unsigned int *len) {
+	elf_t *st = storage;
+	unsigned int left = st->data_len - st->offset;
+	unsigned int get  = left > *len ? *len : left;
+
+	elf_read_at(st, st->base + st->offset, data, get);
+	st->offset += get;
+
+	*len = get;
+	return PARSER_ERR_OK;
+}
+
+parser_err_t elf_write(void *storage, void *data, unsigned int len) {
+	return PARSER_ERR_RDONLY;
+}
+
+unsigned int elf_segment_count(void *storage) {
+	elf_t *st = storage;
+	return st->seg_count;
+}
+
+int elf_segment(void *storage, unsigned int idx, uint32_t *addr, uint32_t *len) {
+	elf_t *st = storage;
+
+	if (idx >= st->seg_count) return -1;
+	*addr = st->seg[idx].addr;
+	*len  = st->seg[idx].len;
+	return 0;
+}
+
+int elf_rejected(void *storage) {
+	elf_t *st = storage;
+	return st->rejected;
+}
+
+uint32_t elf_base(void *storage) {
+	elf_t *st = storage;
+	return st->base;
+}
+
+parser_t PARSER_ELF = {
+	"ELF",
+	elf_init,
+	elf_open,
+	elf_close,
+	elf_size,
+	elf_read,
+	elf_write
+};
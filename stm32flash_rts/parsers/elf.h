@@ -0,0 +1,42 @@
+/*
+  stm32flash - Open Source ST STM32 flash program for *nix
+  Copyright (C) 2010 Geoffrey McRae <geoff@spacevs.com>
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+
+#ifndef _PARSER_ELF_H
+#define _PARSER_ELF_H
+
+#include "parser.h"
+
+#include <stdint.h>
+
+extern parser_t PARSER_ELF;
+
+/* sparse view of an opened ELF file: one segment per PT_LOAD program header
+ * with file data, at its load (physical) address, sorted by address.
+ * elf_read() returns the flat image from elf_base() with the gaps filled
+ * with 0xff, elf_read_at() any range of it */
+unsigned int elf_segment_count(void *storage);
+int elf_segment(void *storage, unsigned int idx, uint32_t *addr, uint32_t *len);
+uint32_t elf_base(void *storage);
+void elf_read_at(void *storage, uint32_t addr, void *data, unsigned int len);
+
+/* non zero if elf_open() failed on a file with the ELF magic, which
+ * must not be flashed as HEX or binary instead */
+int elf_rejected(void *storage);
+#endif
@@ -19,6 +19,7 @@
 
 
 #include <sys/types.h>
+#include <sys/stat.h>
 #include <fcntl.h>
 #include <unistd.h>
 #include <stdlib.h>
@@ -29,169 +30,299 @@
 #include "hex.h"
 #include "../utils.h"
 
+/*
+ * The file is read in one block and decoded with a lookup table. Data
+ * records are collected in a sparse list of segments (one per contiguous
+ * address range); gaps are not stored but synthesised as 0xff by
+ * hex_read(), so the flat image seen by the caller is unchanged.
+ */
+
+#define HEX_SEG_MIN	4096		/* initial capacity of a segment */
+
 typedef struct {
-	size_t		data_len, offset;
+	uint32_t	addr;		/* absolute start address */
+	uint32_t	len, cap;
 	uint8_t		*data;
-	uint32_t	base;
+} hex_seg_t;
+
+typedef struct {
+	hex_seg_t	*seg;
+	unsigned int	seg_count, seg_cap;
+	unsigned int	seg_last;	/* segment the last data record went to */
+	uint32_t	base;		/* address of the first byte of the image */
+	uint32_t	data_len;	/* image size, including gaps */
+	uint32_t	offset;		/* read position in the image */
+	unsigned int	seg_cur;	/* segment at or after offset */
 } hex_t;
 
+/* hex digit -> value, 0xff for anything else */
+static uint8_t hex_val[256];
+
+static void hex_table_init(void) {
+	int i;
+
+	if (hex_val['0'] == 0 && hex_val['1'] == 1) return;
+	memset(hex_val, 0xff, sizeof(hex_val));
+	for (i = 0; i < 10; i++) hex_val['0' + i] = i;
+	for (i = 0; i < 6; i++) {
+		hex_val['A' + i] = 10 + i;
+		hex_val['a' + i] = 10 + i;
+	}
+}
+
+/* decode one byte (two hex digits), returns -1 on an invalid digit */
+static inline int hex_byte(const uint8_t *p) {
+	uint8_t h = hex_val[p[0]], l = hex_val[p[1]];
+
+	if ((h | l) & 0xf0) return -1;
+	return (h << 4) | l;
+}
+
 void* hex_init() {
+	hex_table_init();
 	return calloc(sizeof(hex_t), 1);
 }
 
+/* append a run of bytes at an absolute address */
+static int hex_add(hex_t *st, uint32_t addr, const uint8_t *data, uint32_t len) {
+	hex_seg_t *s;
+	unsigned int i;
+
+	if (len == 0) return 0;
+
+	/* records are almost always contiguous with the previous one */
+	s = NULL;
+	if (st->seg_count && st->seg[st->seg_last].addr + st->seg[st->seg_last].len == addr)
+		s = &st->seg[st->seg_last];
+	else
+		for (i = 0; i < st->seg_count; i++)
+			if (st->seg[i].addr + st->seg[i].len == addr) {
+				s = &st->seg[i];
+				st->seg_last = i;
+				break;
+			}
+
+	if (s == NULL) {
+		if (st->seg_count == st->seg_cap) {
+			unsigned int cap = st->seg_cap ? st->seg_cap * 2 : 8;
+			hex_seg_t *n = realloc(st->seg, cap * sizeof(hex_seg_t));
+			if (!n) return -1;
+			st->seg = n;
+			st->seg_cap = cap;
+		}
+		st->seg_last = st->seg_count++;
+		s = &st->seg[st->seg_last];
+		s->addr = addr;
+		s->len  = 0;
+		s->cap  = 0;
+		s->data = NULL;
+	}
+
+	if (s->len + len > s->cap) {
+		uint32_t cap = s->cap ? s->cap : HEX_SEG_MIN;
+		uint8_t *n;
+
+		while (cap < s->len + len) cap *= 2;
+		n = realloc(s->data, cap);
+		if (!n) return -1;
+		s->data = n;
+		s->cap  = cap;
+	}
+
+	memcpy(&s->data[s->len], data, len);
+	s->len += len;
+	return 0;
+}
+
+static int hex_seg_cmp(const void *a, const void *b) {
+	const hex_seg_t *x = a, *y = b;
+
+	if (x->addr < y->addr) return -1;
+	return x->addr > y->addr;
+}
+
+/* sort the segments, merge touching ones and reject overlaps */
+static int hex_finish(hex_t *st) {
+	unsigned int i, j;
+
+	if (st->seg_count == 0) return 0;
+
+	qsort(st->seg, st->seg_count, sizeof(hex_seg_t), hex_seg_cmp);
+
+	for (i = 0, j = 1; j < st->seg_count; j++) {
+		hex_seg_t *a = &st->seg[i], *b = &st->seg[j];
+
+		if (b->addr < a->addr + a->len)
+			return -1;			/* overlapping records */
+		if (b->addr == a->addr + a->len) {
+			st->seg_last = i;		/* hex_add() appends to st->seg[i] */
+			if (hex_add(st, b->addr, b->data, b->len) != 0)
+				return -1;
+			free(b->data);
+			b->data = NULL;
+		} else if (++i != j) {
+			st->seg[i] = *b;
+			b->data = NULL;		/* moved, hex_close() frees it once */
+		}
+	}
+	st->seg_count = i + 1;
+
+	if (st->seg[0].addr < st->base)
+		return -1;			/* data below the image base */
+	st->data_len = st->seg[i].addr + st->seg[i].len - st->base;
+	return 0;
+}
+
+/* read a whole file into memory */
+static uint8_t *hex_load(const char *filename, size_t *size) {
+	struct stat	sb;
+	uint8_t		*buf;
+	size_t		done;
+	ssize_t		r;
+	int		fd;
+
+	fd = open(filename, O_RDONLY);
+	if (fd < 0) return NULL;
+	if (fstat(fd, &sb) != 0 || (buf = malloc(sb.st_size + 1)) == NULL) {
+		close(fd);
+		return NULL;
+	}
+
+	done = 0;
+	while (done < (size_t)sb.st_size) {
+		r = read(fd, buf + done, sb.st_size - done);
+		if (r <= 0) break;
+		done += r;
+	}
+	close(fd);
+
+	*size = done;
+	return buf;
+}
+
 parser_err_t hex_open(void *storage, const char *filename, const char write) {
 	hex_t *st = storage;
-	if (write) {
+	uint8_t *buf, *p, *end;
+	uint8_t rec[255];
+	size_t size;
+	uint32_t ext = 0;		/* from the last type 02/04 record */
+	int seg_addr = 0;		/* ext is a type 02 segment address */
+	int have_data = 0, have_base = 0;
+	parser_err_t ret = PARSER_ERR_INVALID_FILE;
+
+	if (write)
 		return PARSER_ERR_RDONLY;
-	} else {
-		char mark;
-		int i, fd;
-		uint8_t checksum;
-		unsigned int c;
-		uint32_t base = 0;
-		unsigned int last_address = 0x0;
-
-		fd = open(filename, O_RDONLY);
-		if (fd < 0)
-			return PARSER_ERR_SYSTEM;
-
-		/* read in the file */
-
-		while(read(fd, &mark, 1) != 0) {
-			if (mark == '\n' || mark == '\r') continue;
-			if (mark != ':')
-				return PARSER_ERR_INVALID_FILE;
-
-			char buffer[9];
-			unsigned int reclen, address, type;
-			uint8_t *record = NULL;
-
-			/* get the reclen, address, and type */
-			buffer[8] = 0;
-			if (read(fd, &buffer, 8) != 8) return PARSER_ERR_INVALID_FILE;
-			if (sscanf(buffer, "%2x%4x%2x", &reclen, &address, &type) != 3) {
-				close(fd);
-				return PARSER_ERR_INVALID_FILE;
-			}
 
-			/* setup the checksum */
-			checksum =
-				reclen +
-				((address & 0xFF00) >> 8) +
-				((address & 0x00FF) >> 0) +
-				type;
-
-			switch(type) {
-				/* data record */
-				case 0:
-					c = address - last_address;
-					st->data = realloc(st->data, st->data_len + c + reclen);
-
-					/* if there is a gap, set it to 0xff and increment the length */
-					if (c > 0) {
-						memset(&st->data[st->data_len], 0xff, c);
-						st->data_len += c;
-					}
-
-					last_address = address + reclen;
-					record = &st->data[st->data_len];
-					st->data_len += reclen;
-					break;
-
-				/* extended segment address record */
-				case 2:
-					base = 0;
-					break;
-
-				/* extended linear address record */
-				case 4:
-					base = 0;
-					break;
-			}
+	buf = hex_load(filename, &size);
+	if (buf == NULL)
+		return PARSER_ERR_SYSTEM;
 
-			buffer[2] = 0;
-			for(i = 0; i < reclen; ++i) {
-				if (read(fd, &buffer, 2) != 2 || sscanf(buffer, "%2x", &c) != 1) {
-					close(fd);
-					return PARSER_ERR_INVALID_FILE;
-				}
+	p   = buf;
+	end = buf + size;
+	while (p < end) {
+		unsigned int reclen, address, type, i;
+		uint8_t checksum;
+		int c;
 
-				/* add the byte to the checksum */
-				checksum += c;
-
-				switch(type) {
-					case 0:
-						if (record != NULL) {
-							record[i] = c;
-						} else {
-							return PARSER_ERR_INVALID_FILE;
-						}
-						break;
-
-					case 2:
-					case 4:
-						base = (base << 8) | c;
-						break;
+		if (*p == '\n' || *p == '\r') {
+			p++;
+			continue;
+		}
+		if (*p != ':')
+			goto out;
+		p++;
+
+		/* reclen, address and type */
+		if (end - p < 10)
+			goto out;
+		for (i = 0; i < 4; i++) {
+			if ((c = hex_byte(p + 2 * i)) < 0) goto out;
+			rec[i] = c;
+		}
+		p += 8;
+		reclen  = rec[0];
+		address = (rec[1] << 8) | rec[2];
+		type    = rec[3];
+		checksum = rec[0] + rec[1] + rec[2] + rec[3];
+
+		/* data and checksum */
+		if ((size_t)(end - p) < 2 * reclen + 2)
+			goto out;
+		for (i = 0; i < reclen; i++) {
+			if ((c = hex_byte(p)) < 0) goto out;
+			rec[i] = c;
+			checksum += c;
+			p += 2;
+		}
+		if ((c = hex_byte(p)) < 0 || (uint8_t)(checksum + c) != 0x00)
+			goto out;
+		p += 2;
+
+		switch (type) {
+			/* data record, with a type 02 segment address the offset
+			 * wraps within the 64 KiB segment, linear addresses don't */
+			case 0: {
+				uint32_t first = 0x10000 - address;
+
+				if (!seg_addr || first > reclen) first = reclen;
+				if (hex_add(st, ext + address, rec, first) != 0 ||
+				    hex_add(st, ext, rec + first, reclen - first) != 0) {
+					ret = PARSER_ERR_SYSTEM;
+					goto out;
 				}
+				have_data |= reclen != 0;
+				break;
 			}
 
-			/* read, scan, and verify the checksum */
-			if (
-				read(fd, &buffer, 2 ) != 2 ||
-				sscanf(buffer, "%2x", &c) != 1 ||
-				(uint8_t)(checksum + c) != 0x00
-			) {
-				close(fd);
-				return PARSER_ERR_INVALID_FILE;
-			}
-
-			switch(type) {
-				/* EOF */
-				case 1:
-					close(fd);
-					return PARSER_ERR_OK;
-
-				/* address record */
-				case 4:	base = base << 12;
-				case 2: base = base << 4;
-					/* Reset last_address since our base changed */
-					last_address = 0;
-
-					/* Only assign the program's base address once, and only
-					 * do so if we haven't seen any data records yet.
-					 * If there are any data records before address records,
-					 * the program's base address must be zero.
-					 */
-					if (st->base == 0 && st->data_len == 0) {
-						st->base = base;
-						break;
-					}
-
-					/* we cant cope with files out of order */
-					if (base < st->base) {
-						close(fd);
-						return PARSER_ERR_INVALID_FILE;
-					}
-
-					/* if there is a gap, enlarge and fill with 0xff */
-					unsigned int len = base - st->base;
-					if (len > st->data_len) {
-						st->data = realloc(st->data, len);
-						memset(&st->data[st->data_len], 0xff, len - st->data_len);
-						st->data_len = len;
-					}
-					break;
-			}
+			/* EOF */
+			case 1:
+				p = end;
+				break;
+
+			/* extended segment address record */
+			case 2:
+			/* extended linear address record */
+			case 4:
+				if (reclen != 2)
+					goto out;
+				ext = (rec[0] << 8) | rec[1];
+				ext <<= (type == 4) ? 16 : 4;
+				seg_addr = type == 2;
+
+				/* Only assign the program's base address once, and only
+				 * do so if we haven't seen any data records yet.
+				 * If there are any data records before address records,
+				 * the program's base address must be zero.
+				 */
+				if (!have_base && !have_data)
+					st->base = ext;
+				have_base = 1;
+				break;
+
+			/* start address records (03/05) are not needed */
+			default:
+				break;
 		}
-
-		close(fd);
-		return PARSER_ERR_OK;
 	}
+
+	if (hex_finish(st) != 0)
+		goto out;
+	ret = PARSER_ERR_OK;
+
+out:
+	free(buf);
+	return ret;
 }
 
 parser_err_t hex_close(void *storage) {
 	hex_t *st = storage;
-	if (st) free(st->data);
+	unsigned int i;
+
+	if (st) {
+		for (i = 0; i < st->seg_count; i++)
+			free(st->seg[i].data);
+		free(st->seg);
+	}
 	free(st);
 	return PARSER_ERR_OK;
 }
@@ -203,20 +334,80 @@ unsigned int hex_size(void *storage) {
 
 parser_err_t hex_read(void *storage, void *data, unsigned int *len) {
 	hex_t *st = storage;
+	uint8_t *out = data;
 	unsigned int left = st->data_len - st->offset;
 	unsigned int get  = left > *len ? *len : left;
-
-	memcpy(data, &st->data[st->offset], get);
+	unsigned int done = 0;
+
+	while (done < get) {
+		uint32_t addr = st->base + st->offset + done;
+		hex_seg_t *s;
+		uint32_t n;
+
+		while (st->seg_cur < st->seg_count &&
+		       st->seg[st->seg_cur].addr + st->seg[st->seg_cur].len <= addr)
+			st->seg_cur++;
+		s = &st->seg[st->seg_cur];	/* always valid: addr < end of image */
+
+		if (addr < s->addr) {
+			/* gap between segments */
+			n = s->addr - addr;
+			if (n > get - done) n = get - done;
+			memset(out + done, 0xff, n);
+		} else {
+			n = s->addr + s->len - addr;
+			if (n > get - done) n = get - done;
+			memcpy(out + done, &s->data[addr - s->addr], n);
+		}
+		done += n;
+	}
 	st->offset += get;
 
 	*len = get;
 	return PARSER_ERR_OK;
 }
 
+void hex_read_at(void *storage, uint32_t addr, void *data, unsigned int len) {
+	hex_t *st = storage;
+	uint8_t *out = data;
+	unsigned int i;
+	uint32_t from, to;
+
+	memset(out, 0xff, len);
+	for (i = 0; i < st->seg_count; i++) {
+		hex_seg_t *s = &st->seg[i];
+
+		if (s->addr >= addr + len) break;
+		if (s->addr + s->len <= addr) continue;
+		from = s->addr > addr ? s->addr : addr;
+		to   = s->addr + s->len < addr + len ? s->addr + s->len : addr + len;
+		memcpy(out + (from - addr), s->data + (from - s->addr), to - from);
+	}
+}
+
 parser_err_t hex_write(void *storage, void *data, unsigned int len) {
 	return PARSER_ERR_RDONLY;
 }
 
+unsigned int hex_segment_count(void *storage) {
+	hex_t *st = storage;
+	return st->seg_count;
+}
+
+int hex_segment(void *storage, unsigned int idx, uint32_t *addr, uint32_t *len) {
+	hex_t *st = storage;
+
+	if (idx >= st->seg_count) return -1;
+	*addr = st->seg[idx].addr;
+	*len  = st->seg[idx].len;
+	return 0;
+}
+
+uint32_t hex_base(void *storage) {
+	hex_t *st = storage;
+	return st->base;
+}
+
 parser_t PARSER_HEX = {
 	"Intel HEX",
 	hex_init,
@@ -226,4 +417,3 @@ parser_t PARSER_HEX = {
 	hex_read,
 	hex_write
 };
-
@@ -23,5 +23,15 @@
 
 #include "parser.h"
 
+#include <stdint.h>
+
 extern parser_t PARSER_HEX;
+
+/* sparse view of an opened HEX file: the data is kept as a sorted list of
+ * contiguous segments, hex_read() fills the gaps between them with 0xff,
+ * hex_read_at() returns any range of that flat image */
+unsigned int hex_segment_count(void *storage);
+int hex_segment(void *storage, unsigned int idx, uint32_t *addr, uint32_t *len);
+uint32_t hex_base(void *storage);
+void hex_read_at(void *storage, uint32_t addr, void *data, unsigned int len);
 #endif
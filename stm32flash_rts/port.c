@@ -19,6 +19,7 @@
 
 #include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
 
 #include "serial.h"
 #include "port.h"
@@ -37,10 +38,21 @@ static struct port_interface *ports[] = {
 port_err_t port_open(struct port_options *ops, struct port_interface **outport)
 {
 	int ret;
-	static struct port_interface **port;
+	struct port_interface **port, *p;
+
+	/*
+	 * Each opened port gets its own copy of the interface, the
+	 * private pointer holds the state of the open device. This allows
+	 * several ports open at the same time (see multi.c).
+	 * Release with port_close().
+	 */
+	p = malloc(sizeof(struct port_interface));
+	if (p == NULL)
+		return PORT_ERR_UNKNOWN;
 
 	for (port = ports; *port; port++) {
-		ret = (*port)->open(*port, ops);
+		*p = **port;
+		ret = p->open(p, ops);
 		if (ret == PORT_ERR_NODEV)
 			continue;
 		if (ret == PORT_ERR_OK)
@@ -51,9 +63,16 @@ port_err_t port_open(struct port_options *ops, struct port_interface **outport)
 	if (*port == NULL) {
 		fprintf(stderr, "Cannot handle device \"%s\"\n",
 			ops->device);
+		free(p);
 		return PORT_ERR_UNKNOWN;
 	}
 
-	*outport = *port;
+	*outport = p;
 	return PORT_ERR_OK;
 }
+
+void port_close(struct port_interface *port)
+{
+	port->close(port);
+	free(port);
+}
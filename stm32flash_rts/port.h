@@ -71,5 +71,6 @@ struct port_interface {
 };
 
 port_err_t port_open(struct port_options *ops, struct port_interface **outport);
+void port_close(struct port_interface *port);
 
 #endif
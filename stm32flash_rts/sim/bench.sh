@@ -0,0 +1,82 @@
+#!/bin/bash
+#
+# bench.sh - flashing speed of stm32flash_rts against the bootloader simulator
+#
+# Usage: ./bench.sh [image] [baud rates ...]
+#
+# For every baud rate a fresh blsim is started and stm32flash_rts runs
+# write, write with verify (read back, CRC per page, CRC of the whole
+# image) and CRC on it, once with the F103 bootloader
+# command set (erase 0x43, no CRC command) and once with extended erase
+# and CRC command (-x). The time of a run without action (connect and
+# device info only) is subtracted, so the fixed RTS pulse and init
+# delays of stm32flash_rts do not show up in the throughput.
+# The CRC run is printed in ms above the baseline rather than as a
+# rate, it is mostly below the timer resolution. It includes the CRC
+# time on the target as modelled by blsim (-c, ns per word, default 100,
+# set with CRC_NS=...), that share is printed next to it.
+
+cd "$(dirname "$0")"
+
+FLASH=../stm32flash_rts
+SIM=./blsim
+TTY=/tmp/blsim_bench.$$
+IMAGE=${1:-}
+shift
+BAUDS=${*:-"57600 115200 230400 460800 921600"}
+CRC_NS=${CRC_NS:-100}
+
+[ -x $FLASH ] || { echo "build stm32flash_rts first (make)"; exit 1; }
+[ -x $SIM ] || make -s blsim || exit 1
+
+if [ -z "$IMAGE" ]; then
+	IMAGE=/tmp/blsim_bench.$$.bin
+	head -c 32768 /dev/urandom > $IMAGE
+	trap 'rm -f $IMAGE' EXIT
+fi
+SIZE=$(stat -c %s "$IMAGE")
+
+# run stm32flash_rts, print the elapsed time in ms
+run() {
+	local t0 t1
+	t0=$(date +%s%N)
+	$FLASH -m 8n1 -b $BAUD "$@" $TTY > /dev/null 2>&1 || echo "  stm32flash_rts $* failed" >&2
+	t1=$(date +%s%N)
+	echo $(( (t1 - t0) / 1000000 ))
+}
+
+# throughput in bytes/s for a run time minus the baseline
+rate() {
+	local ms=$(( $1 - BASE ))
+	[ $ms -gt 0 ] || ms=1
+	echo $(( SIZE * 1000 / ms ))
+}
+
+printf "image %s, %d bytes, target CRC %d ns per word\n\n" "$IMAGE" $SIZE $CRC_NS
+printf "%-8s %-4s %10s %10s %10s %10s %8s %12s %12s\n" "baud" "cmds" "write B/s" "w+v B/s" \
+	"w+page B/s" "w+img B/s" "crc ms" "target ms" "baseline ms"
+
+for BAUD in $BAUDS; do
+	for MODE in std ext; do
+		[ $MODE = ext ] && X=-x || X=
+		$SIM -l $TTY -b $BAUD -c $CRC_NS $X > /dev/null 2>&1 &
+		SIMPID=$!
+		sleep 0.3
+
+		BASE=$(run)
+		W=$(run -w "$IMAGE")
+		WV=$(run -v -w "$IMAGE")
+		WP=$(run -V crc-per-page -w "$IMAGE")
+		WI=$(run -V crc-whole-image -w "$IMAGE")
+		C=$(run -C -S 0x08000000:$(( (SIZE + 3) & ~3 )))
+
+		kill $SIMPID
+		wait $SIMPID 2> /dev/null
+
+		# modelled CRC time on the target in us, none without CRC command
+		T=$(( (SIZE + 3) / 4 * CRC_NS / 1000 ))
+		[ $MODE = ext ] && T=$(printf "%d.%03d" $(( T / 1000 )) $(( T % 1000 ))) || T=-
+		printf "%-8s %-4s %10d %10d %10d %10d %8d %12s %12d\n" $BAUD $MODE \
+			$(rate $W) $(rate $WV) $(rate $WP) $(rate $WI) $(( C - BASE )) $T $BASE
+	done
+done
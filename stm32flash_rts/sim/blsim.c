@@ -0,0 +1,727 @@
+/*
+  blsim - STM32 USART bootloader (AN3155) simulator on a pseudo-terminal
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+/*
+ * Simulates the system memory bootloader of a STM32F103 (medium density,
+ * 64 or 128 KiB flash, 1 KiB pages) behind a serial line, so stm32flash_rts
+ * can be run and timed without hardware:
+ *
+ *	blsim -l /tmp/ttyBL &
+ *	stm32flash_rts -w firmware.bin /tmp/ttyBL
+ *
+ * The serial line is modelled by a per byte delay (11 bit times for 8e1)
+ * in both directions, at a fixed rate or at the one the host sets on the
+ * slave side (-b auto), flash page erase, half word programming and the
+ * CRC of a word (flash read and CRC unit) by configurable delays; a mass
+ * erase takes as long as one page erase.
+ * Flash behaves like real flash: a write can only clear bits, writing to
+ * a non erased location is answered with NACK.
+ *
+ * A PTY has no modem lines, so the RTS reset of the real hardware cannot
+ * be seen. Instead the bootloader starts over (expects the init byte
+ * 0x7F) whenever the last process closes the slave side.
+ */
+
+#define _XOPEN_SOURCE 600
+#define _DEFAULT_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#define ACK		0x79
+#define NACK		0x1F
+
+#define CMD_INIT	0x7F
+#define CMD_GET		0x00
+#define CMD_GVR		0x01
+#define CMD_GID		0x02
+#define CMD_RM		0x11
+#define CMD_GO		0x21
+#define CMD_WM		0x31
+#define CMD_ER		0x43
+#define CMD_EE		0x44
+#define CMD_CRC		0xA1
+
+#define BL_VERSION	0x22
+#define PID		0x410		/* STM32F10xxx medium density */
+
+#define FL_START	0x08000000
+#define FL_PAGE		1024
+#define RAM_START	0x20000000
+#define RAM_SIZE	(20 * 1024)
+
+static uint8_t	*flash;
+static uint32_t	fl_size		= 64 * 1024;
+static uint8_t	ram[RAM_SIZE];
+
+static unsigned int baud	= 115200;
+static int	baud_auto	= 0;		/* follow the rate set by the host */
+static unsigned int erase_us	= 20000;	/* per page */
+static unsigned int prog_us	= 40;		/* per half word */
+static unsigned int crc_ns	= 100;		/* per word: flash read with 2 wait
+						 * states, CRC->DR, loop at 72 MHz */
+static int	extended	= 0;		/* extended erase and CRC */
+static int	err_baud	= 0;		/* inject errors above this baud rate */
+static unsigned int err_rate	= 0;		/* one error every err_rate frames */
+static int	err_bytes	= 0;		/* ... or every err_rate bytes */
+static unsigned long err_mark;
+static int	verbose		= 0;
+static const char *dump_file	= NULL;
+static const char *link_name	= NULL;
+
+static int	fd_master = -1;
+static int	hangup;			/* no process has the slave open */
+static double	t_line;			/* time the line becomes idle */
+
+/* statistics */
+static unsigned long st_rx, st_tx, st_erased, st_written, st_read, st_crc;
+static unsigned long st_frames, st_errors;
+
+static double now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* account for "n" bytes on the line, or a busy time in microseconds */
+static void line_bytes(unsigned int n)
+{
+	double t = now();
+
+	if (t_line < t)
+		t_line = t;
+	t_line += n * 11.0 / baud;
+}
+
+static void line_busy(unsigned long us)
+{
+	double t = now();
+
+	if (t_line < t)
+		t_line = t;
+	t_line += us * 1e-6;
+}
+
+static void line_wait(void)
+{
+	double t = now();
+
+	if (t_line > t)
+		usleep((useconds_t)((t_line - t) * 1e6));
+}
+
+static void sim_dump(void)
+{
+	FILE *f;
+
+	if (!dump_file)
+		return;
+	f = fopen(dump_file, "wb");
+	if (!f) {
+		perror(dump_file);
+		return;
+	}
+	fwrite(flash, 1, fl_size, f);
+	fclose(f);
+}
+
+static void sim_stats(void)
+{
+	fprintf(stderr,
+		"blsim: rx %lu tx %lu bytes, erased %lu pages, "
+		"written %lu read %lu crc %lu bytes, %lu/%lu frames corrupted\n",
+		st_rx, st_tx, st_erased, st_written, st_read, st_crc,
+		st_errors, st_frames);
+}
+
+static void sig_exit(int sig)
+{
+	sim_dump();
+	sim_stats();
+	if (link_name)
+		unlink(link_name);
+	_exit(0);
+}
+
+/* read exactly n bytes, returns 0 on success */
+static int rx(uint8_t *buf, unsigned int n)
+{
+	ssize_t r;
+	unsigned int done = 0;
+
+	while (done < n) {
+		r = read(fd_master, buf + done, n - done);
+		if (r > 0) {
+			hangup = 0;
+			done += r;
+			continue;
+		}
+		if (r < 0 && errno == EIO) {
+			/*
+			 * The last process closed the slave: the session
+			 * ended, abort the command. Then wait for the next
+			 * one, which sees a freshly reset bootloader.
+			 */
+			if (!hangup) {
+				hangup = 1;
+				return -1;
+			}
+		} else if (r < 0 && errno != EINTR && errno != EAGAIN)
+			return -1;
+		usleep(1000);
+	}
+	st_rx += n;
+	line_bytes(n);
+	return 0;
+}
+
+static void tx(const uint8_t *buf, unsigned int n)
+{
+	ssize_t r;
+
+	line_bytes(n);
+	line_wait();
+	while (n) {
+		r = write(fd_master, buf, n);
+		if (r < 0) {
+			if (errno == EINTR || errno == EAGAIN) {
+				usleep(100);
+				continue;
+			}
+			return;
+		}
+		buf += r;
+		n -= r;
+		st_tx += r;
+	}
+}
+
+static void tx_byte(uint8_t b)
+{
+	tx(&b, 1);
+}
+
+/*
+ * Error injection: with "-E baud:rate" and the line faster than "baud",
+ * every "rate"th frame received is treated as corrupted and NACKed, the
+ * way a real UART with framing errors would behave. With "-E baud:rateb"
+ * one byte in "rate" is bad instead, so long frames fail more often.
+ */
+static int rx_corrupt(void)
+{
+	int hit;
+
+	st_frames++;
+	if (!err_rate)
+		return 0;
+	if (err_bytes) {
+		hit = st_rx / err_rate != err_mark;
+		err_mark = st_rx / err_rate;
+	} else
+		hit = st_frames % err_rate == 0;
+	if (!hit || !err_baud || (int)baud <= err_baud)
+		return 0;
+	st_errors++;
+	return 1;
+}
+
+static uint8_t xor_sum(const uint8_t *buf, unsigned int n)
+{
+	uint8_t cs = 0;
+
+	while (n--)
+		cs ^= *buf++;
+	return cs;
+}
+
+/* 4 byte address with checksum, returns -1 on a bad checksum */
+static int rx_addr(uint32_t *addr)
+{
+	uint8_t buf[5];
+
+	if (rx(buf, 5))
+		return -1;
+	if (xor_sum(buf, 4) != buf[4] || rx_corrupt())
+		return -1;
+	*addr = (buf[0] << 24) | (buf[1] << 16) | (buf[2] << 8) | buf[3];
+	return 0;
+}
+
+/* pointer to len bytes of memory at addr, NULL if not mapped */
+static uint8_t *mem(uint32_t addr, uint32_t len)
+{
+	if (addr >= FL_START && addr + len <= FL_START + fl_size)
+		return flash + (addr - FL_START);
+	if (addr >= RAM_START && addr + len <= RAM_START + RAM_SIZE)
+		return ram + (addr - RAM_START);
+	return NULL;
+}
+
+static int erase_page(unsigned int page)
+{
+	if (page >= fl_size / FL_PAGE)
+		return -1;
+	memset(flash + page * FL_PAGE, 0xFF, FL_PAGE);
+	line_busy(erase_us);
+	st_erased++;
+	return 0;
+}
+
+/* mass erase takes about as long as one page erase */
+static void erase_all(void)
+{
+	memset(flash, 0xFF, fl_size);
+	line_busy(erase_us);
+	st_erased += fl_size / FL_PAGE;
+}
+
+/* same algorithm as the CRC unit: MSB first, 32 bit little endian words */
+static uint32_t crc32_stm(uint32_t crc, const uint8_t *p, uint32_t len)
+{
+	uint32_t data;
+	int i;
+
+	for (; len >= 4; len -= 4, p += 4) {
+		data = p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+		crc ^= data;
+		for (i = 0; i < 32; i++)
+			crc = (crc & 0x80000000) ? (crc << 1) ^ 0x04C11DB7 : crc << 1;
+	}
+	return crc;
+}
+
+static void cmd_get(void)
+{
+	static const uint8_t std_cmds[] = { CMD_GET, CMD_GVR, CMD_GID, CMD_RM,
+		CMD_GO, CMD_WM, CMD_ER, 0x63, 0x73, 0x82, 0x92 };
+	static const uint8_t ext_cmds[] = { CMD_GET, CMD_GVR, CMD_GID, CMD_RM,
+		CMD_GO, CMD_WM, CMD_EE, 0x63, 0x73, 0x82, 0x92, CMD_CRC };
+	const uint8_t *cmds = extended ? ext_cmds : std_cmds;
+	unsigned int n = extended ? sizeof(ext_cmds) : sizeof(std_cmds);
+	uint8_t buf[32];
+
+	buf[0] = ACK;
+	buf[1] = n;		/* number of bytes following - 1 */
+	buf[2] = BL_VERSION;
+	memcpy(buf + 3, cmds, n);
+	buf[3 + n] = ACK;
+	tx(buf, n + 4);
+}
+
+static void cmd_gvr(void)
+{
+	uint8_t buf[5] = { ACK, BL_VERSION, 0x00, 0x00, ACK };
+
+	tx(buf, 5);
+}
+
+static void cmd_gid(void)
+{
+	uint8_t buf[5] = { ACK, 1, PID >> 8, PID & 0xFF, ACK };
+
+	tx(buf, 5);
+}
+
+static void cmd_rm(void)
+{
+	uint8_t buf[2];
+	uint32_t addr;
+	uint8_t *p;
+	unsigned int n;
+
+	tx_byte(ACK);
+	if (rx_addr(&addr)) {
+		tx_byte(NACK);
+		return;
+	}
+	tx_byte(ACK);
+	if (rx(buf, 2))
+		return;
+	n = buf[0] + 1;
+	p = mem(addr, n);
+	if ((buf[0] ^ buf[1]) != 0xFF || !p || rx_corrupt()) {
+		tx_byte(NACK);
+		return;
+	}
+	tx_byte(ACK);
+	tx(p, n);
+	st_read += n;
+}
+
+static void cmd_wm(void)
+{
+	uint8_t buf[258];
+	uint32_t addr, i;
+	unsigned int n;
+	uint8_t *p;
+
+	tx_byte(ACK);
+	if (rx_addr(&addr) || (addr & 3)) {
+		tx_byte(NACK);
+		return;
+	}
+	tx_byte(ACK);
+	if (rx(buf, 1) || rx(buf + 1, buf[0] + 2))
+		return;
+	n = buf[0] + 1;
+	p = mem(addr, n);
+	if (xor_sum(buf, n + 2) != 0 || !p || rx_corrupt()) {
+		tx_byte(NACK);
+		return;
+	}
+
+	if (p >= flash && p < flash + fl_size) {
+		/* flash: programming can only clear bits of an erased half word */
+		for (i = 0; i < n; i++)
+			if (p[i] != 0xFF && p[i] != buf[1 + i]) {
+				if (verbose)
+					fprintf(stderr, "blsim: write to non erased flash at 0x%08x\n", addr + i);
+				tx_byte(NACK);
+				return;
+			}
+		line_busy((unsigned long)prog_us * ((n + 1) / 2));
+	}
+	memcpy(p, buf + 1, n);
+	st_written += n;
+	tx_byte(ACK);
+}
+
+static void cmd_er(void)
+{
+	uint8_t buf[258];
+	unsigned int n, i;
+
+	tx_byte(ACK);
+	if (rx(buf, 1))
+		return;
+	if (buf[0] == 0xFF) {
+		/* global erase */
+		if (rx(buf + 1, 1))
+			return;
+		if (buf[1] != 0x00) {
+			tx_byte(NACK);
+			return;
+		}
+		erase_all();
+		tx_byte(ACK);
+		return;
+	}
+	n = buf[0] + 1;
+	if (rx(buf + 1, n + 1))
+		return;
+	if (xor_sum(buf, n + 2) != 0 || rx_corrupt()) {
+		tx_byte(NACK);
+		return;
+	}
+	for (i = 0; i < n; i++)
+		if (erase_page(buf[1 + i])) {
+			tx_byte(NACK);
+			return;
+		}
+	tx_byte(ACK);
+}
+
+static void cmd_ee(void)
+{
+	uint8_t buf[2 + 2 * 65536 + 1];
+	unsigned int n, i;
+
+	tx_byte(ACK);
+	if (rx(buf, 2))
+		return;
+	n = (buf[0] << 8) | buf[1];
+	if (n >= 0xFFF0) {
+		/* mass / bank erase */
+		if (rx(buf + 2, 1))
+			return;
+		if (xor_sum(buf, 3) != 0) {
+			tx_byte(NACK);
+			return;
+		}
+		erase_all();
+		tx_byte(ACK);
+		return;
+	}
+	n++;
+	if (rx(buf + 2, 2 * n + 1))
+		return;
+	if (xor_sum(buf, 2 * n + 3) != 0 || rx_corrupt()) {
+		tx_byte(NACK);
+		return;
+	}
+	for (i = 0; i < n; i++)
+		if (erase_page((buf[2 + 2 * i] << 8) | buf[3 + 2 * i])) {
+			tx_byte(NACK);
+			return;
+		}
+	tx_byte(ACK);
+}
+
+static void cmd_crc(void)
+{
+	uint8_t buf[6];
+	uint32_t addr, len, crc;
+	uint8_t *p;
+
+	tx_byte(ACK);
+	if (rx_addr(&addr)) {
+		tx_byte(NACK);
+		return;
+	}
+	tx_byte(ACK);
+	if (rx_addr(&len) || (addr & 3) || (len & 3) || !(p = mem(addr, len))) {
+		tx_byte(NACK);
+		return;
+	}
+	tx_byte(ACK);
+	line_busy((unsigned long long)len / 4 * crc_ns / 1000 + 1);
+	crc = crc32_stm(0xFFFFFFFF, p, len);
+	st_crc += len;
+	buf[0] = ACK;
+	buf[1] = crc >> 24;
+	buf[2] = crc >> 16;
+	buf[3] = crc >> 8;
+	buf[4] = crc;
+	buf[5] = buf[1] ^ buf[2] ^ buf[3] ^ buf[4];
+	tx(buf, 6);
+}
+
+static void cmd_go(void)
+{
+	uint32_t addr;
+
+	tx_byte(ACK);
+	if (rx_addr(&addr)) {
+		tx_byte(NACK);
+		return;
+	}
+	tx_byte(ACK);
+}
+
+/* -b auto: take the line timing from the rate the host has set */
+static void line_follow(void)
+{
+	static const struct {
+		speed_t		speed;
+		unsigned int	baud;
+	} rates[] = {
+		{ B1200, 1200 }, { B2400, 2400 }, { B4800, 4800 }, { B9600, 9600 },
+		{ B19200, 19200 }, { B38400, 38400 }, { B57600, 57600 },
+		{ B115200, 115200 }, { B230400, 230400 }, { B460800, 460800 },
+		{ B500000, 500000 }, { B576000, 576000 }, { B921600, 921600 },
+		{ B1000000, 1000000 }, { B1500000, 1500000 }, { B2000000, 2000000 },
+	};
+	struct termios tio;
+	speed_t speed;
+	unsigned int i;
+
+	if (!baud_auto || tcgetattr(fd_master, &tio))
+		return;
+	speed = cfgetospeed(&tio);
+	for (i = 0; i < sizeof(rates) / sizeof(rates[0]); i++)
+		if (rates[i].speed == speed && rates[i].baud != baud) {
+			baud = rates[i].baud;
+			if (verbose)
+				fprintf(stderr, "blsim: line at %u baud\n", baud);
+		}
+}
+
+static void serve(void)
+{
+	uint8_t buf[2];
+	int synced = 0;
+
+	for (;;) {
+		if (hangup)
+			synced = 0;
+		if (rx(buf, 1)) {
+			if (hangup)
+				continue;
+			return;
+		}
+		if (!synced) {
+			/* autobaud: wait for the init byte */
+			if (buf[0] == CMD_INIT) {
+				line_follow();
+				synced = 1;
+				tx_byte(ACK);
+			}
+			continue;
+		}
+		if (rx(buf + 1, 1))
+			return;
+		if ((buf[0] ^ buf[1]) != 0xFF || rx_corrupt()) {
+			/* a second init byte after a lost session */
+			tx_byte(NACK);
+			continue;
+		}
+		if (verbose > 1)
+			fprintf(stderr, "blsim: cmd 0x%02x\n", buf[0]);
+		switch (buf[0]) {
+		case CMD_GET:	cmd_get(); break;
+		case CMD_GVR:	cmd_gvr(); break;
+		case CMD_GID:	cmd_gid(); break;
+		case CMD_RM:	cmd_rm(); break;
+		case CMD_WM:	cmd_wm(); break;
+		case CMD_GO:	cmd_go(); synced = 0; break;
+		case CMD_ER:
+			if (extended)
+				tx_byte(NACK);
+			else
+				cmd_er();
+			break;
+		case CMD_EE:
+			if (extended)
+				cmd_ee();
+			else
+				tx_byte(NACK);
+			break;
+		case CMD_CRC:
+			if (extended)
+				cmd_crc();
+			else
+				tx_byte(NACK);
+			break;
+		default:
+			tx_byte(NACK);
+		}
+	}
+}
+
+static void usage(const char *name)
+{
+	fprintf(stderr,
+		"Usage: %s [options]\n"
+		"	-l path		Create a symlink to the slave device\n"
+		"	-b rate		Baud rate used for the line timing (default 115200, 0 = no delay,\n"
+		"			auto = the rate set by the host)\n"
+		"	-s kib		Flash size, 64 or 128 (default 64)\n"
+		"	-x		Extended erase (0x44) and CRC (0xA1) commands\n"
+		"	-e us		Page erase time (default 20000)\n"
+		"	-p us		Half word program time (default 40)\n"
+		"	-c ns		CRC time per word (default 100)\n"
+		"	-i file		Initial flash content\n"
+		"	-o file		Write the flash content to file at exit\n"
+		"	-E baud:n[b]	Corrupt every n-th frame (byte) above baud\n"
+		"	-v		Verbose\n",
+		name);
+}
+
+int main(int argc, char *argv[])
+{
+	struct termios tio;
+	const char *init_file = NULL;
+	char *slave, *p;
+	int c, fd_slave;
+	FILE *f;
+
+	while ((c = getopt(argc, argv, "l:b:s:xe:p:c:i:o:E:vh")) != -1) {
+		switch (c) {
+		case 'l': link_name = optarg; break;
+		case 'b':
+			if (!strcmp(optarg, "auto"))
+				baud_auto = 1;
+			else
+				baud = strtoul(optarg, NULL, 0);
+			break;
+		case 's': fl_size = strtoul(optarg, NULL, 0) * 1024; break;
+		case 'x': extended = 1; break;
+		case 'e': erase_us = strtoul(optarg, NULL, 0); break;
+		case 'p': prog_us = strtoul(optarg, NULL, 0); break;
+		case 'c': crc_ns = strtoul(optarg, NULL, 0); break;
+		case 'i': init_file = optarg; break;
+		case 'o': dump_file = optarg; break;
+		case 'E':
+			err_baud = strtoul(optarg, &p, 0);
+			if (*p == ':')
+				err_rate = strtoul(p + 1, &p, 0);
+			err_bytes = *p == 'b';
+			break;
+		case 'v': verbose++; break;
+		default:
+			usage(argv[0]);
+			return 1;
+		}
+	}
+	if (fl_size != 64 * 1024 && fl_size != 128 * 1024) {
+		fprintf(stderr, "Flash size must be 64 or 128 KiB\n");
+		return 1;
+	}
+	if (baud == 0)
+		baud = 1000000000;
+
+	flash = malloc(fl_size);
+	memset(flash, 0xFF, fl_size);
+	if (init_file) {
+		f = fopen(init_file, "rb");
+		if (!f) {
+			perror(init_file);
+			return 1;
+		}
+		if (fread(flash, 1, fl_size, f) == 0)
+			fprintf(stderr, "blsim: %s is empty\n", init_file);
+		fclose(f);
+	}
+
+	fd_master = posix_openpt(O_RDWR | O_NOCTTY);
+	if (fd_master < 0 || grantpt(fd_master) || unlockpt(fd_master)) {
+		perror("posix_openpt");
+		return 1;
+	}
+	slave = ptsname(fd_master);
+
+	/* raw mode until stm32flash_rts sets up the line */
+	fd_slave = open(slave, O_RDWR | O_NOCTTY);
+	if (fd_slave < 0) {
+		perror(slave);
+		return 1;
+	}
+	tcgetattr(fd_slave, &tio);
+	cfmakeraw(&tio);
+	tcsetattr(fd_slave, TCSANOW, &tio);
+	close(fd_slave);
+
+	if (link_name) {
+		unlink(link_name);
+		if (symlink(slave, link_name)) {
+			perror(link_name);
+			return 1;
+		}
+	}
+
+	signal(SIGINT, sig_exit);
+	signal(SIGTERM, sig_exit);
+	signal(SIGHUP, sig_exit);
+
+	printf("%s\n", link_name ? link_name : slave);
+	fflush(stdout);
+
+	serve();
+	sig_exit(0);
+	return 0;
+}
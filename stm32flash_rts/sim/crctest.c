@@ -0,0 +1,205 @@
+/*
+  crctest - software CRC engines of stm32flash_rts: equivalence and speed
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+/*
+ * Links ../stm32.c and runs every engine of stm32_crc_select() through
+ * stm32_sw_crc():
+ *
+ *	equivalence	random buffers of 0 .. 4096 bytes (multiple of 4)
+ *			at random alignment with random initial values,
+ *			compared to the bitwise CRC of the original
+ *			stm32_sw_crc() (copied below), plus the documented
+ *			result of the CRC unit for the word 0x12345678
+ *	speed		MB/s for a 1 KiB page and a 64 KiB image
+ *
+ *	crctest [-n buffers] [-m MB per measurement]
+ *
+ * Exit status 1 if any engine differs from the reference.
+ */
+
+#define _DEFAULT_SOURCE
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../stm32.h"
+
+#define CRCPOLY_BE	0x04c11db7
+#define CRC_MSBMASK	0x80000000
+#define CRC_INIT_VALUE	0xFFFFFFFF
+
+static const char *engines[] = { "bitwise", "branchless", "slice4", "slice8" };
+#define ENGINES		(sizeof(engines) / sizeof(engines[0]))
+
+static const unsigned int sizes[] = { 1024, 65536 };
+#define SIZES		(sizeof(sizes) / sizeof(sizes[0]))
+
+/* main.c, used by stm32_erase_memory() only */
+int flash_addr_to_page_ceil(uint32_t addr)
+{
+	(void)addr;
+	return 0;
+}
+
+/* stm32_sw_crc() before the table driven engines */
+static uint32_t ref_crc(uint32_t crc, const uint8_t *buf, unsigned int len)
+{
+	int i;
+	uint32_t data;
+
+	while (len) {
+		data = *buf++;
+		data |= *buf++ << 8;
+		data |= *buf++ << 16;
+		data |= *buf++ << 24;
+		len -= 4;
+
+		crc ^= data;
+
+		for (i = 0; i < 32; i++)
+			if (crc & CRC_MSBMASK)
+				crc = (crc << 1) ^ CRCPOLY_BE;
+			else
+				crc = (crc << 1);
+	}
+	return crc;
+}
+
+static uint32_t rnd_state = 4711;
+
+static uint32_t rnd(void)
+{
+	rnd_state ^= rnd_state << 13;
+	rnd_state ^= rnd_state >> 17;
+	rnd_state ^= rnd_state << 5;
+	return rnd_state;
+}
+
+static double now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int check(int n)
+{
+	static uint8_t buf[4096 + 8];
+	static const uint8_t word[4] = { 0x78, 0x56, 0x34, 0x12 };
+	unsigned int e, i, k, off, len;
+	uint32_t init, ref, crc;
+	int bad[ENGINES] = { 0 };
+	int fail = 0;
+
+	for (k = 0; k < (unsigned int)n; k++) {
+		len = (rnd() % 1025) * 4;
+		off = rnd() % 8;
+		init = (k & 1) ? rnd() : CRC_INIT_VALUE;
+		for (i = 0; i < len; i++)
+			buf[off + i] = rnd();
+		ref = ref_crc(init, buf + off, len);
+		for (e = 0; e < ENGINES; e++) {
+			stm32_crc_select(engines[e]);
+			crc = stm32_sw_crc(init, buf + off, len);
+			if (crc != ref && !bad[e]++)
+				printf("%s: len %u off %u init %08x: %08x, expected %08x\n",
+				       engines[e], len, off, init, crc, ref);
+		}
+	}
+
+	printf("equivalence, %d random buffers:\n", n);
+	for (e = 0; e < ENGINES; e++) {
+		stm32_crc_select(engines[e]);
+		crc = stm32_sw_crc(CRC_INIT_VALUE, (uint8_t *)word, 4);
+		if (crc != 0xDF8A8A2B)
+			bad[e]++;
+		printf("  %-10s %6d errors, CRC(0x12345678) = %08x\n", engines[e], bad[e], crc);
+		if (bad[e])
+			fail = 1;
+	}
+	return fail;
+}
+
+static void speed(double mb)
+{
+	uint8_t *buf;
+	unsigned int e, s, i, rounds;
+	uint32_t crc = 0;
+	double t, bitwise[SIZES] = { 0 };
+
+	buf = malloc(sizes[SIZES - 1]);
+	for (i = 0; i < sizes[SIZES - 1]; i++)
+		buf[i] = rnd();
+
+	printf("\nspeed, MB/s (factor against bitwise):\n  %-10s", "");
+	for (s = 0; s < SIZES; s++)
+		printf(" %8u B        ", sizes[s]);
+	printf("\n");
+	for (e = 0; e < ENGINES; e++) {
+		stm32_crc_select(engines[e]);
+		printf("  %-10s", engines[e]);
+		for (s = 0; s < SIZES; s++) {
+			rounds = mb * 1e6 / sizes[s];
+			if (!strcmp(engines[e], "bitwise") || !strcmp(engines[e], "branchless"))
+				rounds = rounds / 20 + 1;
+			t = now();
+			for (i = 0; i < rounds; i++)
+				crc ^= stm32_sw_crc(CRC_INIT_VALUE, buf, sizes[s]);
+			t = (double)rounds * sizes[s] / 1e6 / (now() - t);
+			if (!e)
+				bitwise[s] = t;
+			printf(" %8.0f (%5.1fx)", t, t / bitwise[s]);
+		}
+		printf("\n");
+	}
+	/* keeps the loops from being optimized away */
+	if (crc == 0x12345678)
+		printf("\n");
+	free(buf);
+}
+
+int main(int argc, char *argv[])
+{
+	int c, n = 20000, fail;
+	double mb = 200;
+
+	while ((c = getopt(argc, argv, "n:m:")) != -1) {
+		switch (c) {
+		case 'n':
+			n = atoi(optarg);
+			break;
+		case 'm':
+			mb = atof(optarg);
+			break;
+		default:
+			fprintf(stderr, "usage: %s [-n buffers] [-m MB]\n", argv[0]);
+			return 2;
+		}
+	}
+
+	fail = check(n);
+	if (mb > 0)
+		speed(mb);
+	printf("\n%s\n", fail ? "FAILED" : "all engines equal");
+	return fail;
+}
@@ -0,0 +1,72 @@
+#!/bin/bash
+#
+# diff.sh - differential write (-D) against a full write on the bootloader simulator
+#
+# Usage: ./diff.sh [baud]
+#
+# A 40000 byte random image is written to a fresh blsim, then one 1 KiB
+# page of it is changed. The changed image is written once with -w (full
+# erase and write) and once with -D, both with the F103 bootloader
+# command set (no CRC command) and with extended erase and CRC (-x).
+# After each run the flash content (blsim -o) must match the image.
+# Times include the fixed RTS pulse and init delays of stm32flash_rts,
+# the time of a run without action is printed as baseline.
+
+cd "$(dirname "$0")"
+
+FLASH=../stm32flash_rts
+SIM=./blsim
+TTY=/tmp/blsim_diff.$$
+TMP=/tmp/blsim_diff.$$
+BAUD=${1:-115200}
+SIZE=40000
+PAGE=10
+
+[ -x $FLASH ] || { echo "build stm32flash_rts first (make)"; exit 1; }
+[ -x $SIM ] || make -s blsim || exit 1
+
+trap 'rm -f $TMP.*' EXIT
+head -c $SIZE /dev/urandom > $TMP.old
+cp $TMP.old $TMP.new
+head -c 1024 /dev/urandom | dd of=$TMP.new bs=1024 seek=$PAGE conv=notrunc 2> /dev/null
+
+# run stm32flash_rts, print the elapsed time in ms
+run() {
+	local t0 t1
+	t0=$(date +%s%N)
+	$FLASH -m 8n1 -b $BAUD "$@" $TTY > $TMP.log 2>&1 || echo "  stm32flash_rts $* failed" >&2
+	t1=$(date +%s%N)
+	echo $(( (t1 - t0) / 1000000 ))
+}
+
+# start blsim with the old image in flash, stop it with stop
+start() {
+	$SIM -l $TTY -b $BAUD $X -i $TMP.old -o $TMP.flash > /dev/null 2>&1 &
+	SIMPID=$!
+	sleep 0.3
+}
+
+stop() {
+	kill $SIMPID
+	wait $SIMPID 2> /dev/null
+	cmp -s -n $SIZE $TMP.flash $TMP.new && echo ok || echo FEHLER
+}
+
+printf "image %d bytes, page %d changed, %d baud\n\n" $SIZE $PAGE $BAUD
+printf "%-4s %12s %10s %10s %6s %-s\n" "cmds" "baseline ms" "-w ms" "-D ms" "flash" "-D summary"
+
+for MODE in std ext; do
+	[ $MODE = ext ] && X=-x || X=
+
+	start
+	BASE=$(run)
+	W=$(run -w $TMP.new)
+	R1=$(stop)
+
+	start
+	D=$(run -D -w $TMP.new)
+	SUM=$(grep -i "pages" $TMP.log | tail -1)
+	R2=$(stop)
+
+	printf "%-4s %12d %10d %10d %6s %s\n" $MODE $BASE $W $D "$R1/$R2" "$SUM"
+done
@@ -0,0 +1,90 @@
+#!/bin/bash
+#
+# elftest.sh - ELF and HEX files (elf/) written to the bootloader simulator
+#
+# Usage: ./elftest.sh [baud]
+#
+# Every case of elf/expect.txt runs against a fresh blsim with 128 KiB of
+# random data in flash. Afterwards the flash content (blsim -o) must be
+# the initial content with exactly the listed pages erased and the
+# segments of the file written into them. A page counts as erased when
+# it differs from the initial content. Files that must be rejected have
+# to fail and leave the flash untouched. A segment is given as
+# address:offset:length of its data in the file, or in another file
+# with a fourth field (the HEX files take their data from an ELF file).
+# Exit status 1 if any case fails.
+
+cd "$(dirname "$0")"
+
+FLASH=../stm32flash_rts
+SIM=./blsim
+TTY=/tmp/blsim_elf.$$
+TMP=/tmp/blsim_elf.$$
+BAUD=${1:-115200}
+FL_START=$((0x08000000))
+FL_SIZE=131072
+PAGE=1024
+
+[ -x $FLASH ] || { echo "build stm32flash_rts first (make)"; exit 1; }
+[ -x $SIM ] || make -s blsim || exit 1
+
+trap 'rm -f $TMP.*' EXIT
+head -c $FL_SIZE /dev/urandom > $TMP.init
+head -c $PAGE /dev/zero | tr '\0' '\377' > $TMP.ff
+
+# "0-3,24" -> "0,1,2,3,24"
+pages() {
+	local r
+	[ "$1" = "-" ] && return
+	for r in ${1//,/ }; do
+		seq ${r%-*} ${r#*-}
+	done | paste -sd,
+}
+
+# pages of the flash dump that differ from the initial content
+changed() {
+	cmp -l $TMP.init $TMP.flash | awk -v ps=$PAGE '{ print int(($1 - 1) / ps) }' | uniq | paste -sd,
+}
+
+fail=0
+printf "%-14s %-4s %-8s %-6s %-s\n" "datei" "cmd" "ergebnis" "flash" "geloeschte pages"
+
+while read -r FILE CMD RESULT PAGES SEGS; do
+	case "$FILE" in ""|\#*) continue ;; esac
+
+	# expected flash: erased pages, then the segments
+	cp $TMP.init $TMP.exp
+	for p in $(pages $PAGES | tr , ' '); do
+		dd if=$TMP.ff of=$TMP.exp bs=$PAGE seek=$p conv=notrunc 2> /dev/null
+	done
+	for s in $SEGS; do
+		IFS=: read -r a o l src <<< "$s"
+		dd if=elf/${src:-$FILE} of=$TMP.exp bs=1 skip=$o seek=$((a - FL_START)) count=$l conv=notrunc 2> /dev/null
+	done
+
+	$SIM -l $TTY -b $BAUD -s 128 -i $TMP.init -o $TMP.flash > /dev/null 2>&1 &
+	SIMPID=$!
+	sleep 0.3
+
+	if [ $CMD = -D ]; then
+		$FLASH -m 8n1 -b $BAUD -D -w elf/$FILE $TTY > $TMP.log 2>&1 && R=ok || R=fehler
+	else
+		$FLASH -m 8n1 -b $BAUD -w elf/$FILE $TTY > $TMP.log 2>&1 && R=ok || R=fehler
+	fi
+
+	kill $SIMPID
+	wait $SIMPID 2> /dev/null
+
+	GOT=$(changed)
+	cmp -s $TMP.flash $TMP.exp && F=ok || F=FEHLER
+	if [ $R != $RESULT ] || [ $F != ok ] || [ "$GOT" != "$(pages $PAGES)" ]; then
+		fail=1
+		F=FEHLER
+		sed 's/^/    /' $TMP.log
+	fi
+	printf "%-14s %-4s %-8s %-6s %-s\n" $FILE $CMD $R $F "${GOT:--}"
+done < elf/expect.txt
+
+echo
+[ $fail = 0 ] && echo "alle Faelle gleich" || echo FEHLER
+exit $fail
@@ -0,0 +1,55 @@
+#!/bin/bash
+#
+# multi.sh - one stm32flash_rts call writing several bootloader simulators
+#
+# Usage: ./multi.sh [targets] [baud]
+#
+# Starts the given number of blsim instances (default 4) with random
+# flash content and writes a 40000 byte random image to all of them with
+# a single stm32flash_rts -w call on a glob pattern, once without and
+# once with verify (-v). Afterwards the flash content of every simulator
+# (blsim -o) must start with the image.
+# Exit status 1 if stm32flash_rts fails or any flash differs.
+
+cd "$(dirname "$0")"
+
+FLASH=../stm32flash_rts
+SIM=./blsim
+TMP=/tmp/blsim_multi.$$
+N=${1:-4}
+BAUD=${2:-115200}
+SIZE=40000
+
+[ -x $FLASH ] || { echo "build stm32flash_rts first (make)"; exit 1; }
+[ -x $SIM ] || make -s blsim || exit 1
+
+trap 'rm -f $TMP.*' EXIT
+head -c $SIZE /dev/urandom > $TMP.img
+head -c 65536 /dev/urandom > $TMP.init
+
+fail=0
+for VERIFY in "" -v; do
+	PIDS=
+	for i in $(seq $N); do
+		$SIM -l $TMP.tty$i -b $BAUD -i $TMP.init -o $TMP.flash$i > /dev/null 2>&1 &
+		PIDS="$PIDS $!"
+	done
+	sleep 0.3
+
+	t0=$(date +%s%N)
+	$FLASH -m 8n1 -b $BAUD $VERIFY -w $TMP.img "$TMP.tty*" > $TMP.log 2>&1 || { fail=1; cat $TMP.log; }
+	t1=$(date +%s%N)
+
+	kill $PIDS
+	wait $PIDS 2> /dev/null
+
+	printf "%d targets, %d bytes, %d baud %-2s  %6d ms  " $N $SIZE $BAUD "$VERIFY" $(( (t1 - t0) / 1000000 ))
+	for i in $(seq $N); do
+		cmp -s -n $SIZE $TMP.flash$i $TMP.img && printf "ok " || { printf "FEHLER "; fail=1; }
+	done
+	echo
+done
+
+grep -A$((N + 1)) "^Device" $TMP.log
+[ $fail = 0 ] && echo "alle Flashinhalte gleich" || echo FEHLER
+exit $fail
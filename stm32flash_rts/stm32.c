@@ -153,7 +153,7 @@ static stm32_err_t stm32_get_ack_timeout(const stm32_t *stm, time_t timeout)
 
 		if (p_err != PORT_ERR_OK) {
 			fprintf(stderr, "Failed to read ACK byte\n");
-			return STM32_ERR_UNKNOWN;
+			return p_err == PORT_ERR_TIMEDOUT ? STM32_ERR_TIMEOUT : STM32_ERR_UNKNOWN;
 		}
 
 		if (byte == STM32_ACK)
@@ -192,11 +192,12 @@ static stm32_err_t stm32_send_command_timeout(const stm32_t *stm,
 	s_err = stm32_get_ack_timeout(stm, timeout);
 	if (s_err == STM32_ERR_OK)
 		return STM32_ERR_OK;
-	if (s_err == STM32_ERR_NACK)
+	if (s_err == STM32_ERR_NACK) {
 		fprintf(stderr, "Got NACK from device on command 0x%02x\n", cmd);
-	else
-		fprintf(stderr, "Unexpected reply from device on command 0x%02x\n", cmd);
-	return STM32_ERR_UNKNOWN;
+		return STM32_ERR_NACK;
+	}
+	fprintf(stderr, "Unexpected reply from device on command 0x%02x\n", cmd);
+	return s_err == STM32_ERR_TIMEOUT ? s_err : STM32_ERR_UNKNOWN;
 }
 
 static stm32_err_t stm32_send_command(const stm32_t *stm, const uint8_t cmd)
@@ -205,7 +206,7 @@ static stm32_err_t stm32_send_command(const stm32_t *stm, const uint8_t cmd)
 }
 
 /* if we have lost sync, send a wrong command and expect a NACK */
-static stm32_err_t stm32_resync(const stm32_t *stm)
+stm32_err_t stm32_resync(const stm32_t *stm)
 {
 	struct port_interface *port = stm->port;
 	port_err_t p_err;
@@ -353,6 +354,19 @@ static stm32_err_t stm32_send_init_seq(const stm32_t *stm)
 			? (a) \
 			: (((prev) > (a)) ? (prev) : (a)))
 
+/* expected length of the reply to GET, some ports need to know it */
+static uint8_t stm32_get_reply_len(const stm32_t *stm)
+{
+	struct port_interface *port = stm->port;
+	int i;
+
+	if (port->cmd_get_reply)
+		for (i = 0; port->cmd_get_reply[i].length; i++)
+			if (stm->version == port->cmd_get_reply[i].version)
+				return port->cmd_get_reply[i].length;
+	return STM32_CMD_GET_LENGTH;
+}
+
 stm32_t *stm32_init(struct port_interface *port, const char init)
 {
 	uint8_t len, val, buf[257];
@@ -387,13 +401,7 @@ stm32_t *stm32_init(struct port_interface *port, const char init)
 	}
 
 	/* get the bootloader information */
-	len = STM32_CMD_GET_LENGTH;
-	if (port->cmd_get_reply)
-		for (i = 0; port->cmd_get_reply[i].length; i++)
-			if (stm->version == port->cmd_get_reply[i].version) {
-				len = port->cmd_get_reply[i].length;
-				break;
-			}
+	len = stm32_get_reply_len(stm);
 	if (stm32_guess_len_cmd(stm, STM32_CMD_GET, buf, len) != STM32_ERR_OK)
 		return NULL;
 	len = buf[0] + 1;
@@ -575,8 +583,9 @@ stm32_err_t stm32_write_memory(const stm32_t *stm, uint32_t address,
 	}
 
 	/* send the address and checksum */
-	if (stm32_send_command(stm, stm->cmd->wm) != STM32_ERR_OK)
-		return STM32_ERR_UNKNOWN;
+	s_err = stm32_send_command(stm, stm->cmd->wm);
+	if (s_err != STM32_ERR_OK)
+		return s_err;
 
 	buf[0] = address >> 24;
 	buf[1] = (address >> 16) & 0xFF;
@@ -585,8 +594,9 @@ stm32_err_t stm32_write_memory(const stm32_t *stm, uint32_t address,
 	buf[4] = buf[0] ^ buf[1] ^ buf[2] ^ buf[3];
 	if (port->write(port, buf, 5) != PORT_ERR_OK)
 		return STM32_ERR_UNKNOWN;
-	if (stm32_get_ack(stm) != STM32_ERR_OK)
-		return STM32_ERR_UNKNOWN;
+	s_err = stm32_get_ack(stm);
+	if (s_err != STM32_ERR_OK)
+		return s_err == STM32_ERR_NACK || s_err == STM32_ERR_TIMEOUT ? s_err : STM32_ERR_UNKNOWN;
 
 	aligned_len = (len + 3) & ~3;
 	cs = aligned_len - 1;
@@ -609,11 +619,28 @@ stm32_err_t stm32_write_memory(const stm32_t *stm, uint32_t address,
 		if (port->flags & PORT_STRETCH_W
 		    && stm->cmd->wm != STM32_CMD_WM_NS)
 			stm32_warn_stretching("write");
-		return STM32_ERR_UNKNOWN;
+		/* a NACK leaves the bootloader waiting for the next command,
+		 * after a timeout the caller may resync and try again */
+		return s_err == STM32_ERR_NACK || s_err == STM32_ERR_TIMEOUT ? s_err : STM32_ERR_UNKNOWN;
 	}
 	return STM32_ERR_OK;
 }
 
+/*
+ * Send GET and check that the reply matches what stm32_init() got.
+ * A cheap round trip to test the link, e.g. at a new baud rate.
+ */
+stm32_err_t stm32_ping(const stm32_t *stm)
+{
+	uint8_t buf[257];
+
+	if (stm32_guess_len_cmd(stm, STM32_CMD_GET, buf, stm32_get_reply_len(stm)) != STM32_ERR_OK)
+		return STM32_ERR_UNKNOWN;
+	if (buf[1] != stm->bl_version || buf[2] != STM32_CMD_GET)
+		return STM32_ERR_UNKNOWN;
+	return stm32_get_ack(stm);
+}
+
 stm32_err_t stm32_wunprot_memory(const stm32_t *stm)
 {
 	struct port_interface *port = stm->port;
@@ -1037,30 +1064,55 @@ stm32_err_t stm32_crc_memory(const stm32_t *stm, uint32_t address,
  * But STM32 computes it on units of 32 bits word and swaps the
  * bytes of the word before the computation.
  * Due to byte swap, I cannot use any CRC available in existing
- * libraries, so here is a simple not optimized implementation.
+ * libraries, so here are own implementations, selectable at runtime:
+ *
+ *	bitwise		32 shift/xor steps per word (reference)
+ *	branchless	same, the conditional xor done with a mask; no
+ *			tables and no data dependent branches
+ *	slice4		one word per step with 4 tables of 256 entries
+ *	slice8		two words per step with 8 tables (default)
+ *
+ * The tables hold the usual MSB first byte table and its extensions:
+ * crc_tab[k][b] is the CRC register after shifting b through 8 * (k + 1)
+ * bit positions. Since the STM32 xors a little endian word into the
+ * register, the most significant byte of the word is buf[3].
  */
 #define CRCPOLY_BE	0x04c11db7
 #define CRC_MSBMASK	0x80000000
 #define CRC_INIT_VALUE	0xFFFFFFFF
-uint32_t stm32_sw_crc(uint32_t crc, uint8_t *buf, unsigned int len)
-{
-	int i;
-	uint32_t data;
 
-	if (len & 0x3) {
-		fprintf(stderr, "Buffer length must be multiple of 4 bytes\n");
-		return 0;
-	}
+#define CRC_WORD(p)	((uint32_t)(p)[0] | ((uint32_t)(p)[1] << 8) | \
+			 ((uint32_t)(p)[2] << 16) | ((uint32_t)(p)[3] << 24))
+
+typedef uint32_t (*crc_fn_t)(uint32_t crc, const uint8_t *buf, unsigned int len);
 
-	while (len) {
-		data = *buf++;
-		data |= *buf++ << 8;
-		data |= *buf++ << 16;
-		data |= *buf++ << 24;
-		len -= 4;
+static uint32_t crc_tab[8][256];
 
-		crc ^= data;
+static void crc_tab_init(void)
+{
+	uint32_t crc;
+	int i, j, k;
+
+	if (crc_tab[0][1])
+		return;
+	for (i = 0; i < 256; i++) {
+		crc = (uint32_t)i << 24;
+		for (j = 0; j < 8; j++)
+			crc = (crc & CRC_MSBMASK) ? (crc << 1) ^ CRCPOLY_BE : crc << 1;
+		crc_tab[0][i] = crc;
+	}
+	for (k = 1; k < 8; k++)
+		for (i = 0; i < 256; i++)
+			crc_tab[k][i] = (crc_tab[k - 1][i] << 8)
+				^ crc_tab[0][crc_tab[k - 1][i] >> 24];
+}
 
+static uint32_t crc_bitwise(uint32_t crc, const uint8_t *buf, unsigned int len)
+{
+	int i;
+
+	for (; len; len -= 4, buf += 4) {
+		crc ^= CRC_WORD(buf);
 		for (i = 0; i < 32; i++)
 			if (crc & CRC_MSBMASK)
 				crc = (crc << 1) ^ CRCPOLY_BE;
@@ -1070,11 +1122,109 @@ uint32_t stm32_sw_crc(uint32_t crc, uint8_t *buf, unsigned int len)
 	return crc;
 }
 
+static uint32_t crc_branchless(uint32_t crc, const uint8_t *buf, unsigned int len)
+{
+	int i;
+
+	for (; len; len -= 4, buf += 4) {
+		crc ^= CRC_WORD(buf);
+		for (i = 0; i < 32; i++)
+			crc = (crc << 1) ^ (CRCPOLY_BE & -(crc >> 31));
+	}
+	return crc;
+}
+
+static uint32_t crc_slice4(uint32_t crc, const uint8_t *buf, unsigned int len)
+{
+	for (; len; len -= 4, buf += 4) {
+		crc ^= CRC_WORD(buf);
+		crc = crc_tab[3][crc >> 24] ^ crc_tab[2][(crc >> 16) & 0xFF]
+		    ^ crc_tab[1][(crc >> 8) & 0xFF] ^ crc_tab[0][crc & 0xFF];
+	}
+	return crc;
+}
+
+static uint32_t crc_slice8(uint32_t crc, const uint8_t *buf, unsigned int len)
+{
+	uint32_t w;
+
+	for (; len >= 8; len -= 8, buf += 8) {
+		crc ^= CRC_WORD(buf);
+		w = CRC_WORD(buf + 4);
+		crc = crc_tab[7][crc >> 24] ^ crc_tab[6][(crc >> 16) & 0xFF]
+		    ^ crc_tab[5][(crc >> 8) & 0xFF] ^ crc_tab[4][crc & 0xFF]
+		    ^ crc_tab[3][w >> 24] ^ crc_tab[2][(w >> 16) & 0xFF]
+		    ^ crc_tab[1][(w >> 8) & 0xFF] ^ crc_tab[0][w & 0xFF];
+	}
+	return len ? crc_slice4(crc, buf, len) : crc;
+}
+
+static const struct {
+	const char	*name;
+	crc_fn_t	fn;
+} crc_engines[] = {
+	{ "slice8",	crc_slice8 },
+	{ "slice4",	crc_slice4 },
+	{ "branchless",	crc_branchless },
+	{ "bitwise",	crc_bitwise },
+	{ NULL,		NULL }
+};
+
+static crc_fn_t crc_engine = crc_slice8;
+
+/*
+ * select the software CRC engine by name, NULL selects the default.
+ * The engine is checked against the bitwise reference before use.
+ */
+int stm32_crc_select(const char *name)
+{
+	static const uint8_t test[16] = "123456789abcdef";
+	int i;
+
+	crc_tab_init();
+	for (i = 0; crc_engines[i].name; i++)
+		if (!name || !strcmp(name, crc_engines[i].name))
+			break;
+	if (!crc_engines[i].name) {
+		fprintf(stderr, "Unknown CRC engine \"%s\", valid are:", name);
+		for (i = 0; crc_engines[i].name; i++)
+			fprintf(stderr, " %s", crc_engines[i].name);
+		fprintf(stderr, "\n");
+		return -1;
+	}
+	if (crc_engines[i].fn(CRC_INIT_VALUE, test, sizeof(test))
+	    != crc_bitwise(CRC_INIT_VALUE, test, sizeof(test))) {
+		fprintf(stderr, "CRC engine \"%s\" failed self test\n", crc_engines[i].name);
+		return -1;
+	}
+	crc_engine = crc_engines[i].fn;
+	return 0;
+}
+
+uint32_t stm32_sw_crc(uint32_t crc, uint8_t *buf, unsigned int len)
+{
+	if (len & 0x3) {
+		fprintf(stderr, "Buffer length must be multiple of 4 bytes\n");
+		return 0;
+	}
+
+	crc_tab_init();
+	return crc_engine(crc, buf, len);
+}
+
+/* non zero if the bootloader implements the CRC command */
+int stm32_has_crc(const stm32_t *stm)
+{
+	return stm->cmd->crc != STM32_CMD_ERR;
+}
+
 stm32_err_t stm32_crc_wrapper(const stm32_t *stm, uint32_t address,
 			      uint32_t length, uint32_t *crc)
 {
 	uint8_t buf[256];
 	uint32_t start, total_len, len, current_crc;
+	struct timespec ts;
+	long t_now, t_shown = -1000;
 
 	if (address & 0x3 || length & 0x3) {
 		fprintf(stderr, "Start and end addresses must be 4 byte aligned\n");
@@ -1099,6 +1249,13 @@ stm32_err_t stm32_crc_wrapper(const stm32_t *stm, uint32_t address,
 		length -= len;
 		address += len;
 
+		/* progress at most every 100 ms, and at the end */
+		clock_gettime(CLOCK_MONOTONIC, &ts);
+		t_now = ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+		if (t_now - t_shown < 100 && length)
+			continue;
+		t_shown = t_now;
+
 		fprintf(stderr,
 			"\rCRC address 0x%08x (%.2f%%) ",
 			address,
@@ -35,6 +35,7 @@ typedef enum {
 	STM32_ERR_UNKNOWN,	/* Generic error */
 	STM32_ERR_NACK,
 	STM32_ERR_NO_CMD,	/* Command not available in bootloader */
+	STM32_ERR_TIMEOUT,	/* No answer in time */
 } stm32_err_t;
 
 typedef enum {
@@ -80,6 +81,8 @@ stm32_err_t stm32_wprot_memory(const stm32_t *stm);
 stm32_err_t stm32_erase_memory(const stm32_t *stm, uint32_t spage,
 			       uint32_t pages);
 stm32_err_t stm32_go(const stm32_t *stm, uint32_t address);
+stm32_err_t stm32_ping(const stm32_t *stm);
+stm32_err_t stm32_resync(const stm32_t *stm);
 stm32_err_t stm32_reset_device(const stm32_t *stm);
 stm32_err_t stm32_readprot_memory(const stm32_t *stm);
 stm32_err_t stm32_runprot_memory(const stm32_t *stm);
@@ -88,6 +91,8 @@ stm32_err_t stm32_crc_memory(const stm32_t *stm, uint32_t address,
 stm32_err_t stm32_crc_wrapper(const stm32_t *stm, uint32_t address,
 			      uint32_t length, uint32_t *crc);
 uint32_t stm32_sw_crc(uint32_t crc, uint8_t *buf, unsigned int len);
+int stm32_crc_select(const char *name);
+int stm32_has_crc(const stm32_t *stm);
 
 #endif
 